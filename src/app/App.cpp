@@ -48,7 +48,7 @@ static bool s_transportActive = false;  // Is sequencer running?
 
 // ========== MIDI CLOCK TIMING ==========
 static uint32_t s_lastTickMicros = 0;
-static uint32_t s_avgTickPeriodUs = 20833;  // ~20.8ms @ 120BPM
+static uint32_t s_avgTickPeriodQ8 = (60000000ULL << Timebase::TICK_PERIOD_FRAC_BITS) / (120 * 24);  // 20833.33us @ 120BPM
 
 // ========== DEBUG OUTPUT STATE ==========
 static uint32_t s_lastPrint = 0;
@@ -115,44 +115,15 @@ static int8_t clampIndex(int8_t value, int8_t minValue, int8_t maxValue) {
 static void processInputCommands() {
     Command cmd;
     while (NeokeyInput::popCommand(cmd)) {
-        // Check if CHOKE/FREEZE controllers want to intercept
-        bool handled = false;
+        // Registered controller gets first refusal (one table index, no per-effect branches)
+        bool handled = EffectManager::dispatchToController(cmd);
 
-        if (cmd.targetEffect == EffectID::CHOKE && s_chokeController) {
-            if (cmd.type == CommandType::EFFECT_ENABLE || cmd.type == CommandType::EFFECT_TOGGLE) {
-                handled = s_chokeController->handleButtonPress(cmd);
-            } else if (cmd.type == CommandType::EFFECT_DISABLE) {
-                handled = s_chokeController->handleButtonRelease(cmd);
-            }
-        } else if (cmd.targetEffect == EffectID::FREEZE && s_freezeController) {
-            if (cmd.type == CommandType::EFFECT_ENABLE || cmd.type == CommandType::EFFECT_TOGGLE) {
-                handled = s_freezeController->handleButtonPress(cmd);
-            } else if (cmd.type == CommandType::EFFECT_DISABLE) {
-                handled = s_freezeController->handleButtonRelease(cmd);
-            }
-        } else if (cmd.targetEffect == EffectID::STUTTER && s_stutterController) {
-            if (cmd.type == CommandType::EFFECT_ENABLE || cmd.type == CommandType::EFFECT_TOGGLE) {
-                handled = s_stutterController->handleButtonPress(cmd);
-            } else if (cmd.type == CommandType::EFFECT_DISABLE) {
-                handled = s_stutterController->handleButtonRelease(cmd);
-            }
-        } else if (cmd.targetEffect == EffectID::FUNC) {
-            // FUNC is handled by stutter controller (modifier button)
-            // Also notify preset controller for FUNC+preset combos
+        // FUNC is also a preset modifier (FUNC+preset combos); PresetController isn't an effect
+        if (cmd.targetEffect == EffectID::FUNC && s_presetController) {
             if (cmd.type == CommandType::EFFECT_ENABLE) {
-                if (s_stutterController) {
-                    handled = s_stutterController->handleButtonPress(cmd);
-                }
-                if (s_presetController) {
-                    s_presetController->handleFuncPress();
-                }
+                s_presetController->handleFuncPress();
             } else if (cmd.type == CommandType::EFFECT_DISABLE) {
-                if (s_stutterController) {
-                    handled = s_stutterController->handleButtonRelease(cmd);
-                }
-                if (s_presetController) {
-                    s_presetController->handleFuncRelease();
-                }
+                s_presetController->handleFuncRelease();
             }
         }
 
@@ -230,14 +201,9 @@ static void updateEncoders() {
  * Handles LED blinking and display updates for active effects
  */
 static void updateEffectHandlers() {
-    if (s_chokeController) {
-        s_chokeController->updateVisualFeedback();
-    }
-    if (s_freezeController) {
-        s_freezeController->updateVisualFeedback();
-    }
-    if (s_stutterController) {
-        s_stutterController->updateVisualFeedback();
+    EffectManager::updateControllers();
+    if (s_globalController) {
+        s_globalController->updateVisualFeedback();  // Live CPU page
     }
 }
 
@@ -297,10 +263,11 @@ static void processClockTicks() {
         // Update tick period estimate (EMA)
         if (s_lastTickMicros > 0) {
             uint32_t tickPeriod = clockMicros - s_lastTickMicros;
-            if (tickPeriod >= 10000 && tickPeriod <= 50000) {
-                s_avgTickPeriodUs = (s_avgTickPeriodUs * 9 + tickPeriod) / 10;
-                Timebase::syncToMIDIClock(s_avgTickPeriodUs);
-                TRACE(TRACE_TICK_PERIOD_UPDATE, s_avgTickPeriodUs / 10);
+            if (tickPeriod >= Timebase::MIN_TICK_PERIOD_US && tickPeriod <= Timebase::MAX_TICK_PERIOD_US) {
+                // EMA in Q8: keeps sub-microsecond precision (whole-us truncation biases tempo)
+                s_avgTickPeriodQ8 = (s_avgTickPeriodQ8 * 9 + (tickPeriod << Timebase::TICK_PERIOD_FRAC_BITS)) / 10;
+                Timebase::syncToMIDIClock(s_avgTickPeriodQ8);
+                TRACE(TRACE_TICK_PERIOD_UPDATE, (s_avgTickPeriodQ8 >> Timebase::TICK_PERIOD_FRAC_BITS) / 10);
             }
         }
         s_lastTickMicros = clockMicros;
@@ -332,7 +299,7 @@ static void updateBeatLed() {
 
 // ========== PUBLIC API ==========
 
-void App::begin() {
+void App::begin(EffectChain* chain) {
     // Configure LED pin
     pinMode(LED_PIN, OUTPUT);
     digitalWrite(LED_PIN, LOW);
@@ -370,8 +337,14 @@ void App::begin() {
     s_chokeController = new ChokeController(choke);
     s_freezeController = new FreezeController(freeze);
     s_stutterController = new StutterController(stutter);
-    s_globalController = new GlobalController();
-    s_presetController = new PresetController(stutter);
+    s_globalController = new GlobalController(chain);
+    s_presetController = new PresetController(stutter, choke, chain);
+
+    // Route button commands by EffectID (Stutter also owns the FUNC modifier)
+    EffectManager::registerController(EffectID::STUTTER, s_stutterController);
+    EffectManager::registerController(EffectID::FUNC, s_stutterController);
+    EffectManager::registerController(EffectID::FREEZE, s_freezeController);
+    EffectManager::registerController(EffectID::CHOKE, s_chokeController);
 
     // Initialize preset system (SD card)
     s_presetController->begin();
@@ -383,6 +356,11 @@ void App::begin() {
         }
     });
 
+    // Preset transfers own the loop buffer until they complete
+    s_stutterController->setLoopBufferBusyCallback([]() {
+        return s_presetController && s_presetController->isTransferBusy();
+    });
+
     // Create encoder handlers
     s_encoder1 = new EncoderHandler::Handler(0);  // STUTTER parameters
     s_encoder2 = new EncoderHandler::Handler(1);  // FREEZE parameters
@@ -448,8 +426,10 @@ void App::threadLoop() {
         // 7. Update beat indicator LED
         updateBeatLed();
 
-        // 8. Update preset LEDs (beat-synced for selected preset)
+        // 8. Update preset transfers and LEDs (beat-synced for selected preset)
         if (s_presetController) {
+            s_presetController->update();  // SD worker progress/completion callbacks
+
             // Get beat LED state (same logic as beat indicator)
             bool beatLedOn = (s_ledOffSample > 0 && Timebase::getSamplePosition() < s_ledOffSample);
             s_presetController->updateLEDs(beatLedOn);
@@ -3,8 +3,11 @@
 #include <Arduino.h>
 #include "EffectQuantization.h"  // For Quantization enum
 
+class EffectChain;
+
 namespace App {
-    void begin();
+    // chain: fused effect chain (runtime routing), nullptr for the per-node graph
+    void begin(EffectChain* chain);
 
     void threadLoop();
 
@@ -8,7 +8,8 @@
 ChokeController::ChokeController(ChokeAudio& effect)
     : m_effect(effect),
       m_currentParameter(Parameter::LENGTH),
-      m_wasEnabled(false) {
+      m_wasEnabled(false),
+      m_editStep(0) {
 }
 
 const char* ChokeController::lengthName(ChokeLength length) {
@@ -27,6 +28,52 @@ const char* ChokeController::onsetName(ChokeOnset onset) {
     }
 }
 
+const char* ChokeController::fadeName(ChokeFade fade) {
+    switch (fade) {
+        case ChokeFade::MS_1:  return "1ms";
+        case ChokeFade::MS_3:  return "3ms";
+        case ChokeFade::MS_5:  return "5ms";
+        case ChokeFade::MS_10: return "10ms";
+        case ChokeFade::MS_20: return "20ms";
+        case ChokeFade::MS_50: return "50ms";
+        default: return "3ms";
+    }
+}
+
+const char* ChokeController::curveName(FadeCurve curve) {
+    switch (curve) {
+        case FadeCurve::LINEAR:      return "Linear";
+        case FadeCurve::EXPONENTIAL: return "Exponential";
+        case FadeCurve::EQUAL_POWER: return "Equal Power";
+        default: return "Linear";
+    }
+}
+
+const char* ChokeController::modeName(ChokeMode mode) {
+    switch (mode) {
+        case ChokeMode::MUTE: return "Mute";
+        case ChokeMode::GATE: return "Gate";
+        default: return "Mute";
+    }
+}
+
+const char* ChokeController::levelName(uint8_t level) {
+    static const char* const names[GATE_LEVEL_MAX + 1] = {
+        "Off", "13%", "25%", "38%", "50%", "63%", "75%", "88%", "100%"
+    };
+    return names[level <= GATE_LEVEL_MAX ? level : GATE_LEVEL_MAX];
+}
+
+const char* ChokeController::shapeName(GateShape shape) {
+    switch (shape) {
+        case GateShape::GATE:  return "Gate";
+        case GateShape::SWELL: return "Swell";
+        case GateShape::PLUCK: return "Pluck";
+        case GateShape::SHORT: return "Short";
+        default: return "Gate";
+    }
+}
+
 bool ChokeController::handleButtonPress(const Command& cmd) {
     if (cmd.targetEffect != EffectID::CHOKE) {
         return false;  // Not our effect
@@ -205,16 +252,76 @@ static int8_t clampIndex(int8_t value, int8_t minValue, int8_t maxValue) {
     return value;
 }
 
+// ========== GATE PATTERN MENUS ==========
+
+void ChokeController::gateMenu(Parameter param, MenuDisplayData& menuData) {
+    // Menu strings must outlive this call (DisplayManager keeps the pointers)
+    static char s_stepText[12];
+    static char s_topText[20];
+
+    GateSequencer& gate = m_effect.getGate();
+    uint8_t step = m_editStep;
+
+    if (param == Parameter::STEPS) {
+        menuData.topText = "CHOKE->Steps";
+        menuData.middleText = (gate.getNumSteps() == 32) ? "32" : "16";
+        menuData.numOptions = 2;
+        menuData.selectedIndex = (gate.getNumSteps() == 32) ? 1 : 0;
+    } else if (param == Parameter::STEP) {
+        // Step number with its level; indicators show position within the beat
+        snprintf(s_stepText, sizeof(s_stepText), "%u: %s", step + 1, levelName(gate.getStepLevel(step)));
+        menuData.topText = "CHOKE->Step";
+        menuData.middleText = s_stepText;
+        menuData.numOptions = GateSequencer::STEPS_PER_BEAT;
+        menuData.selectedIndex = step % GateSequencer::STEPS_PER_BEAT;
+    } else if (param == Parameter::LEVEL) {
+        snprintf(s_topText, sizeof(s_topText), "CHOKE->Step %u Lvl", step + 1);
+        menuData.topText = s_topText;
+        menuData.middleText = levelName(gate.getStepLevel(step));
+        menuData.numOptions = GATE_LEVEL_MAX + 1;
+        menuData.selectedIndex = gate.getStepLevel(step);
+    } else {  // SHAPE
+        snprintf(s_topText, sizeof(s_topText), "CHOKE->Step %u Shp", step + 1);
+        menuData.topText = s_topText;
+        menuData.middleText = shapeName(gate.getStepShape(step));
+        menuData.numOptions = GATE_SHAPE_COUNT;
+        menuData.selectedIndex = static_cast<uint8_t>(gate.getStepShape(step));
+    }
+}
+
 // ========== ENCODER BINDING ==========
 
 void ChokeController::bindToEncoder(EncoderHandler::Handler& encoder,
                                     AnyEncoderTouchedFn anyTouchedExcept) {
-    // Button press: Cycle between LENGTH and ONSET parameters
+    // Button press: Cycle LENGTH → ONSET → FADE → CURVE → MODE
+    // (→ STEPS → STEP → LEVEL → SHAPE in GATE mode)
     encoder.onButtonPress([this]() {
         Parameter current = m_currentParameter;
+        bool gateMode = (m_effect.getMode() == ChokeMode::GATE);
         if (current == Parameter::LENGTH) {
             m_currentParameter = Parameter::ONSET;
             Serial.println("Choke Parameter: ONSET");
+        } else if (current == Parameter::ONSET) {
+            m_currentParameter = Parameter::FADE;
+            Serial.println("Choke Parameter: FADE");
+        } else if (current == Parameter::FADE) {
+            m_currentParameter = Parameter::CURVE;
+            Serial.println("Choke Parameter: CURVE");
+        } else if (current == Parameter::CURVE) {
+            m_currentParameter = Parameter::MODE;
+            Serial.println("Choke Parameter: MODE");
+        } else if (current == Parameter::MODE && gateMode) {
+            m_currentParameter = Parameter::STEPS;
+            Serial.println("Choke Parameter: STEPS");
+        } else if (current == Parameter::STEPS) {
+            m_currentParameter = Parameter::STEP;
+            Serial.println("Choke Parameter: STEP");
+        } else if (current == Parameter::STEP) {
+            m_currentParameter = Parameter::LEVEL;
+            Serial.println("Choke Parameter: LEVEL");
+        } else if (current == Parameter::LEVEL) {
+            m_currentParameter = Parameter::SHAPE;
+            Serial.println("Choke Parameter: SHAPE");
         } else {
             m_currentParameter = Parameter::LENGTH;
             Serial.println("Choke Parameter: LENGTH");
@@ -242,7 +349,7 @@ void ChokeController::bindToEncoder(EncoderHandler::Handler& encoder,
                 menuData.selectedIndex = newIndex;
                 DisplayManager::instance().showMenu(menuData);
             }
-        } else {  // ONSET parameter
+        } else if (param == Parameter::ONSET) {
             int8_t currentIndex = static_cast<int8_t>(m_effect.getOnsetMode());
             int8_t newIndex = clampIndex(currentIndex + delta, 0, 1);
             if (newIndex != currentIndex) {
@@ -258,6 +365,109 @@ void ChokeController::bindToEncoder(EncoderHandler::Handler& encoder,
                 menuData.selectedIndex = newIndex;
                 DisplayManager::instance().showMenu(menuData);
             }
+        } else if (param == Parameter::FADE) {
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getFade());
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, 5);
+            if (newIndex != currentIndex) {
+                ChokeFade newFade = static_cast<ChokeFade>(newIndex);
+                m_effect.setFade(newFade);
+                Serial.print("Choke Fade: ");
+                Serial.print(fadeName(newFade));
+                Serial.print(" (");
+                Serial.print(ChokeAudio::fadeToSamples(newFade));
+                Serial.println(" samples)");
+
+                MenuDisplayData menuData;
+                menuData.topText = "CHOKE->Fade";
+                menuData.middleText = fadeName(newFade);
+                menuData.numOptions = 6;
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
+        } else if (param == Parameter::CURVE) {
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getCurve());
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, FadeEnvelope::CURVE_COUNT - 1);
+            if (newIndex != currentIndex) {
+                FadeCurve newCurve = static_cast<FadeCurve>(newIndex);
+                m_effect.setCurve(newCurve);
+                Serial.print("Choke Curve: ");
+                Serial.println(curveName(newCurve));
+
+                MenuDisplayData menuData;
+                menuData.topText = "CHOKE->Curve";
+                menuData.middleText = curveName(newCurve);
+                menuData.numOptions = FadeEnvelope::CURVE_COUNT;
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
+        } else if (param == Parameter::MODE) {
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getMode());
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, 1);
+            if (newIndex != currentIndex) {
+                ChokeMode newMode = static_cast<ChokeMode>(newIndex);
+                m_effect.setMode(newMode);
+                Serial.print("Choke Mode: ");
+                Serial.println(modeName(newMode));
+
+                MenuDisplayData menuData;
+                menuData.topText = "CHOKE->Mode";
+                menuData.middleText = modeName(newMode);
+                menuData.numOptions = 2;
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
+        } else {  // Gate pattern parameters
+            GateSequencer& gate = m_effect.getGate();
+            bool changed = false;
+
+            if (param == Parameter::STEPS) {
+                int8_t currentIndex = (gate.getNumSteps() == 32) ? 1 : 0;
+                int8_t newIndex = clampIndex(currentIndex + delta, 0, 1);
+                if (newIndex != currentIndex) {
+                    gate.setNumSteps(newIndex ? 32 : 16);
+                    if (m_editStep >= gate.getNumSteps()) {
+                        m_editStep = gate.getNumSteps() - 1;
+                    }
+                    Serial.print("Choke Gate Steps: ");
+                    Serial.println(gate.getNumSteps());
+                    changed = true;
+                }
+            } else if (param == Parameter::STEP) {
+                int8_t newStep = clampIndex(static_cast<int8_t>(m_editStep) + delta, 0, gate.getNumSteps() - 1);
+                if (newStep != static_cast<int8_t>(m_editStep)) {
+                    m_editStep = static_cast<uint8_t>(newStep);
+                    changed = true;
+                }
+            } else if (param == Parameter::LEVEL) {
+                int8_t currentIndex = static_cast<int8_t>(gate.getStepLevel(m_editStep));
+                int8_t newIndex = clampIndex(currentIndex + delta, 0, GATE_LEVEL_MAX);
+                if (newIndex != currentIndex) {
+                    gate.setStepLevel(m_editStep, static_cast<uint8_t>(newIndex));
+                    Serial.print("Choke Gate Step ");
+                    Serial.print(m_editStep + 1);
+                    Serial.print(" Level: ");
+                    Serial.println(levelName(static_cast<uint8_t>(newIndex)));
+                    changed = true;
+                }
+            } else {  // SHAPE
+                int8_t currentIndex = static_cast<int8_t>(gate.getStepShape(m_editStep));
+                int8_t newIndex = clampIndex(currentIndex + delta, 0, GATE_SHAPE_COUNT - 1);
+                if (newIndex != currentIndex) {
+                    GateShape newShape = static_cast<GateShape>(newIndex);
+                    gate.setStepShape(m_editStep, newShape);
+                    Serial.print("Choke Gate Step ");
+                    Serial.print(m_editStep + 1);
+                    Serial.print(" Shape: ");
+                    Serial.println(shapeName(newShape));
+                    changed = true;
+                }
+            }
+
+            if (changed) {
+                MenuDisplayData menuData;
+                gateMenu(param, menuData);
+                DisplayManager::instance().showMenu(menuData);
+            }
         }
     });
 
@@ -272,10 +482,27 @@ void ChokeController::bindToEncoder(EncoderHandler::Handler& encoder,
                 menuData.topText = "CHOKE->Length";
                 menuData.middleText = lengthName(m_effect.getLengthMode());
                 menuData.selectedIndex = static_cast<uint8_t>(m_effect.getLengthMode());
-            } else {  // ONSET
+            } else if (param == Parameter::ONSET) {
                 menuData.topText = "CHOKE->Onset";
                 menuData.middleText = onsetName(m_effect.getOnsetMode());
                 menuData.selectedIndex = static_cast<uint8_t>(m_effect.getOnsetMode());
+            } else if (param == Parameter::FADE) {
+                menuData.topText = "CHOKE->Fade";
+                menuData.middleText = fadeName(m_effect.getFade());
+                menuData.numOptions = 6;
+                menuData.selectedIndex = static_cast<uint8_t>(m_effect.getFade());
+            } else if (param == Parameter::CURVE) {
+                menuData.topText = "CHOKE->Curve";
+                menuData.middleText = curveName(m_effect.getCurve());
+                menuData.numOptions = FadeEnvelope::CURVE_COUNT;
+                menuData.selectedIndex = static_cast<uint8_t>(m_effect.getCurve());
+            } else if (param == Parameter::MODE) {
+                menuData.topText = "CHOKE->Mode";
+                menuData.middleText = modeName(m_effect.getMode());
+                menuData.numOptions = 2;
+                menuData.selectedIndex = static_cast<uint8_t>(m_effect.getMode());
+            } else {  // Gate pattern parameters
+                gateMenu(param, menuData);
             }
             DisplayManager::instance().showMenu(menuData);
         } else {
@@ -8,7 +8,8 @@
  * DESIGN:
  * - Implements IEffectController interface
  * - Owns reference to ChokeAudio
- * - Manages parameter editing state (LENGTH, ONSET)
+ * - Manages parameter editing state (LENGTH, ONSET, FADE, CURVE, MODE)
+ * - Edits the gate pattern in GATE mode (STEPS, STEP cursor, LEVEL, SHAPE)
  * - Handles free/quantized onset and length modes
  *
  * USAGE:
@@ -49,7 +50,14 @@ public:
      */
     enum class Parameter : uint8_t {
         LENGTH = 0,  // Choke length (Free, Quantized)
-        ONSET = 1    // Choke onset timing (Free, Quantized)
+        ONSET = 1,   // Choke onset timing (Free, Quantized)
+        FADE = 2,    // Mute/unmute fade length (1ms-50ms)
+        CURVE = 3,   // Fade shape (Linear, Exponential, Equal Power)
+        MODE = 4,    // Choke mode (Mute, Gate)
+        STEPS = 5,   // Gate pattern length (16, 32) - GATE mode only
+        STEP = 6,    // Gate step being edited - GATE mode only
+        LEVEL = 7,   // Level of edited step (0-100%) - GATE mode only
+        SHAPE = 8    // Shape of edited step (Gate, Swell, Pluck, Short) - GATE mode only
     };
 
     /**
@@ -87,9 +95,20 @@ public:
     // Utility functions for name mapping
     static const char* lengthName(ChokeLength length);
     static const char* onsetName(ChokeOnset onset);
+    static const char* fadeName(ChokeFade fade);
+    static const char* curveName(FadeCurve curve);
+    static const char* modeName(ChokeMode mode);
+    static const char* levelName(uint8_t level);
+    static const char* shapeName(GateShape shape);
 
 private:
+    /**
+     * Fill menu for a gate parameter (STEPS, STEP, LEVEL, SHAPE)
+     */
+    void gateMenu(Parameter param, MenuDisplayData& menuData);
+
     ChokeAudio& m_effect;     // Reference to audio effect (DSP)
     Parameter m_currentParameter;   // Currently selected parameter for editing
     bool m_wasEnabled;              // Previous enabled state (for edge detection)
+    uint8_t m_editStep;             // Gate step under the STEP cursor (0-31)
 };
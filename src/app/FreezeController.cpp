@@ -4,6 +4,7 @@
 #include "Timebase.h"
 #include "EncoderHandler.h"
 #include <Arduino.h>
+#include <stdio.h>
 
 FreezeController::FreezeController(FreezeAudio& effect)
     : m_effect(effect),
@@ -27,6 +28,48 @@ const char* FreezeController::onsetName(FreezeOnset onset) {
     }
 }
 
+const char* FreezeController::grainCountName(uint8_t count) {
+    switch (count) {
+        case 2: return "2 Grains";
+        case 3: return "3 Grains";
+        case 4: return "4 Grains";
+        case 5: return "5 Grains";
+        case 6: return "6 Grains";
+        case 7: return "7 Grains";
+        case 8: return "8 Grains";
+        default: return "8 Grains";
+    }
+}
+
+const char* FreezeController::modeName(FreezeMode mode) {
+    switch (mode) {
+        case FreezeMode::GRAIN: return "Grain";
+        case FreezeMode::LOOP:  return "Loop";
+        case FreezeMode::SPECTRAL: return "Spectral";
+        default: return "Grain";
+    }
+}
+
+const char* FreezeController::sizeName(FreezeSize size) {
+    switch (size) {
+        case FreezeSize::MS_3:    return "3ms";
+        case FreezeSize::MS_10:   return "10ms";
+        case FreezeSize::MS_25:   return "25ms";
+        case FreezeSize::MS_50:   return "50ms";
+        case FreezeSize::MS_100:  return "100ms";
+        case FreezeSize::MS_250:  return "250ms";
+        case FreezeSize::MS_500:  return "500ms";
+        case FreezeSize::MS_1000: return "1s";
+        default: return "250ms";
+    }
+}
+
+const char* FreezeController::mixName(uint8_t percent) {
+    static char s_mixText[8];
+    snprintf(s_mixText, sizeof(s_mixText), "%u%%", percent);
+    return s_mixText;
+}
+
 bool FreezeController::handleButtonPress(const Command& cmd) {
     if (cmd.targetEffect != EffectID::FREEZE) {
         return false;  // Not our effect
@@ -193,12 +236,24 @@ static int8_t clampIndex(int8_t value, int8_t minValue, int8_t maxValue) {
 
 void FreezeController::bindToEncoder(EncoderHandler::Handler& encoder,
                                      AnyEncoderTouchedFn anyTouchedExcept) {
-    // Button press: Cycle between LENGTH and ONSET parameters
+    // Button press: Cycle between LENGTH → ONSET → GRAINS → MODE → SIZE → MIX parameters
     encoder.onButtonPress([this]() {
         Parameter current = m_currentParameter;
         if (current == Parameter::LENGTH) {
             m_currentParameter = Parameter::ONSET;
             Serial.println("Freeze Parameter: ONSET");
+        } else if (current == Parameter::ONSET) {
+            m_currentParameter = Parameter::GRAINS;
+            Serial.println("Freeze Parameter: GRAINS");
+        } else if (current == Parameter::GRAINS) {
+            m_currentParameter = Parameter::MODE;
+            Serial.println("Freeze Parameter: MODE");
+        } else if (current == Parameter::MODE) {
+            m_currentParameter = Parameter::SIZE;
+            Serial.println("Freeze Parameter: SIZE");
+        } else if (current == Parameter::SIZE) {
+            m_currentParameter = Parameter::MIX;
+            Serial.println("Freeze Parameter: MIX");
         } else {
             m_currentParameter = Parameter::LENGTH;
             Serial.println("Freeze Parameter: LENGTH");
@@ -226,7 +281,7 @@ void FreezeController::bindToEncoder(EncoderHandler::Handler& encoder,
                 menuData.selectedIndex = newIndex;
                 DisplayManager::instance().showMenu(menuData);
             }
-        } else {  // ONSET parameter
+        } else if (param == Parameter::ONSET) {
             int8_t currentIndex = static_cast<int8_t>(m_effect.getOnsetMode());
             int8_t newIndex = clampIndex(currentIndex + delta, 0, 1);
             if (newIndex != currentIndex) {
@@ -242,6 +297,76 @@ void FreezeController::bindToEncoder(EncoderHandler::Handler& encoder,
                 menuData.selectedIndex = newIndex;
                 DisplayManager::instance().showMenu(menuData);
             }
+        } else if (param == Parameter::GRAINS) {
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getGrainCount() - GrainEngine::MIN_GRAINS);
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, GrainEngine::MAX_GRAINS - GrainEngine::MIN_GRAINS);
+            if (newIndex != currentIndex) {
+                uint8_t newCount = static_cast<uint8_t>(newIndex + GrainEngine::MIN_GRAINS);
+                m_effect.setGrainCount(newCount);
+                Serial.print("Freeze Grains: ");
+                Serial.println(newCount);
+
+                MenuDisplayData menuData;
+                menuData.topText = "FREEZE->Grains";
+                menuData.middleText = grainCountName(newCount);
+                menuData.numOptions = GrainEngine::MAX_GRAINS - GrainEngine::MIN_GRAINS + 1;
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
+        } else if (param == Parameter::MODE) {
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getMode());
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, FreezeAudio::modeCount() - 1);
+            if (newIndex != currentIndex) {
+                FreezeMode newMode = static_cast<FreezeMode>(newIndex);
+                m_effect.setMode(newMode);
+                Serial.print("Freeze Mode: ");
+                Serial.println(modeName(newMode));
+
+                MenuDisplayData menuData;
+                menuData.topText = "FREEZE->Mode";
+                menuData.middleText = modeName(newMode);
+                menuData.numOptions = FreezeAudio::modeCount();
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
+        } else if (param == Parameter::MIX) {
+            // Audio ramps to the new mix (SmoothedParam), so detents don't zipper
+            const int8_t maxIndex = 100 / MIX_STEP_PERCENT;
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getMix() / MIX_STEP_PERCENT);
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, maxIndex);
+            if (newIndex != currentIndex) {
+                uint8_t newMix = static_cast<uint8_t>(newIndex * MIX_STEP_PERCENT);
+                m_effect.setMix(newMix);
+                Serial.print("Freeze Mix: ");
+                Serial.print(newMix);
+                Serial.println("%");
+
+                MenuDisplayData menuData;
+                menuData.topText = "FREEZE->Mix";
+                menuData.middleText = mixName(newMix);
+                menuData.numOptions = maxIndex + 1;
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
+        } else {  // SIZE parameter
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getSize());
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, 7);
+            if (newIndex != currentIndex) {
+                FreezeSize newSize = static_cast<FreezeSize>(newIndex);
+                m_effect.setSize(newSize);
+                Serial.print("Freeze Size: ");
+                Serial.print(sizeName(newSize));
+                Serial.print(" (");
+                Serial.print(FreezeAudio::sizeToSamples(newSize));
+                Serial.println(" samples)");
+
+                MenuDisplayData menuData;
+                menuData.topText = "FREEZE->Size";
+                menuData.middleText = sizeName(newSize);
+                menuData.numOptions = 8;
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
         }
     });
 
@@ -256,10 +381,30 @@ void FreezeController::bindToEncoder(EncoderHandler::Handler& encoder,
                 menuData.topText = "FREEZE->Length";
                 menuData.middleText = lengthName(m_effect.getLengthMode());
                 menuData.selectedIndex = static_cast<uint8_t>(m_effect.getLengthMode());
-            } else {  // ONSET
+            } else if (param == Parameter::ONSET) {
                 menuData.topText = "FREEZE->Onset";
                 menuData.middleText = onsetName(m_effect.getOnsetMode());
                 menuData.selectedIndex = static_cast<uint8_t>(m_effect.getOnsetMode());
+            } else if (param == Parameter::GRAINS) {
+                menuData.topText = "FREEZE->Grains";
+                menuData.middleText = grainCountName(m_effect.getGrainCount());
+                menuData.numOptions = GrainEngine::MAX_GRAINS - GrainEngine::MIN_GRAINS + 1;
+                menuData.selectedIndex = m_effect.getGrainCount() - GrainEngine::MIN_GRAINS;
+            } else if (param == Parameter::MODE) {
+                menuData.topText = "FREEZE->Mode";
+                menuData.middleText = modeName(m_effect.getMode());
+                menuData.numOptions = FreezeAudio::modeCount();
+                menuData.selectedIndex = static_cast<uint8_t>(m_effect.getMode());
+            } else if (param == Parameter::MIX) {
+                menuData.topText = "FREEZE->Mix";
+                menuData.middleText = mixName(m_effect.getMix());
+                menuData.numOptions = 100 / MIX_STEP_PERCENT + 1;
+                menuData.selectedIndex = m_effect.getMix() / MIX_STEP_PERCENT;
+            } else {  // SIZE
+                menuData.topText = "FREEZE->Size";
+                menuData.middleText = sizeName(m_effect.getSize());
+                menuData.numOptions = 8;
+                menuData.selectedIndex = static_cast<uint8_t>(m_effect.getSize());
             }
             DisplayManager::instance().showMenu(menuData);
         } else {
@@ -8,7 +8,7 @@
  * DESIGN:
  * - Implements IEffectController interface
  * - Owns reference to FreezeAudio
- * - Manages parameter editing state (LENGTH, ONSET)
+ * - Manages parameter editing state (LENGTH, ONSET, GRAINS, MODE, SIZE, MIX)
  * - Handles free/quantized onset and length modes
  *
  * USAGE:
@@ -49,9 +49,15 @@ public:
      */
     enum class Parameter : uint8_t {
         LENGTH = 0,  // Freeze length (Free, Quantized)
-        ONSET = 1    // Freeze onset timing (Free, Quantized)
+        ONSET = 1,   // Freeze onset timing (Free, Quantized)
+        GRAINS = 2,  // Overlapping grain count (2-8)
+        MODE = 3,    // Freeze playback (Grain, Loop, Spectral)
+        SIZE = 4,    // Freeze window size (3ms-1s)
+        MIX = 5      // Frozen vs live input (0-100%, smoothed)
     };
 
+    static constexpr uint8_t MIX_STEP_PERCENT = 10;  // Encoder detent (11 indicator positions)
+
     /**
      * Constructor
      *
@@ -87,6 +93,10 @@ public:
     // Utility functions for name mapping
     static const char* lengthName(FreezeLength length);
     static const char* onsetName(FreezeOnset onset);
+    static const char* grainCountName(uint8_t count);
+    static const char* modeName(FreezeMode mode);
+    static const char* sizeName(FreezeSize size);
+    static const char* mixName(uint8_t percent);  // Formats into a static buffer
 
 private:
     FreezeAudio& m_effect;    // Reference to audio effect (DSP)
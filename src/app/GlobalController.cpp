@@ -1,15 +1,25 @@
 #include "GlobalController.h"
 #include "DisplayManager.h"
 #include "EncoderHandler.h"
+#include "DspProfiler.h"
+#include "EffectChain.h"
 #include <Arduino.h>
+#include <stdio.h>
 
-GlobalController::GlobalController()
-    : m_currentParameter(Parameter::QUANTIZATION) {
+GlobalController::GlobalController(EffectChain* chain)
+    : m_chain(chain),
+      m_currentParameter(Parameter::QUANTIZATION),
+      m_cpuSlot(DspProfiler::TOTAL_SLOT),
+      m_encoder(nullptr),
+      m_anyTouchedExcept(nullptr),
+      m_lastCpuRefresh(0) {
 }
 
 const char* GlobalController::parameterName(Parameter param) {
     switch (param) {
         case Parameter::QUANTIZATION: return "Quantization";
+        case Parameter::CPU: return "CPU";
+        case Parameter::ROUTING: return "Routing";
         // Future parameters:
         // case Parameter::MASTER_VOLUME: return "Master Volume";
         // case Parameter::TEMPO_MULTIPLIER: return "Tempo Multiplier";
@@ -33,21 +43,91 @@ static int8_t clampIndex(int8_t value, int8_t minValue, int8_t maxValue) {
     return value;
 }
 
+// ========== CPU PAGE ==========
+
+void GlobalController::showCpuPage() {
+    // Static: MenuDisplayData holds pointers, the display thread reads them later
+    static char s_top[24];
+    static char s_middle[24];
+
+    DspProfiler::Stats stats;
+    if (!DspProfiler::getStats(m_cpuSlot, stats)) {
+        return;
+    }
+
+    // e.g. "CPU->Choke x0" (x = overruns), "12.5% pk 20.1%"
+    uint32_t avg = DspProfiler::toPermille(stats.avgTicks);
+    uint32_t peak = DspProfiler::toPermille(stats.maxTicks);
+    snprintf(s_top, sizeof(s_top), "CPU->%s x%lu", stats.name,
+             static_cast<unsigned long>(stats.overruns));
+    snprintf(s_middle, sizeof(s_middle), "%lu.%lu%% pk %lu.%lu%%",
+             static_cast<unsigned long>(avg / 10), static_cast<unsigned long>(avg % 10),
+             static_cast<unsigned long>(peak / 10), static_cast<unsigned long>(peak % 10));
+
+    MenuDisplayData menuData;
+    menuData.topText = s_top;
+    menuData.middleText = s_middle;
+    menuData.numOptions = DspProfiler::getNumSlots();
+    menuData.selectedIndex = m_cpuSlot;
+    DisplayManager::instance().showMenu(menuData);
+    m_lastCpuRefresh = millis();
+}
+
+void GlobalController::updateVisualFeedback() {
+    if (m_currentParameter != Parameter::CPU || !m_encoder) {
+        return;
+    }
+    // Only while our page is up (touched or in cooldown, no other encoder in front)
+    if (!m_encoder->isTouched() || m_anyTouchedExcept(m_encoder)) {
+        return;
+    }
+    if (millis() - m_lastCpuRefresh >= CPU_REFRESH_MS) {
+        showCpuPage();
+    }
+}
+
+// ========== ROUTING PAGE ==========
+
+void GlobalController::showRoutingPage() {
+    static char s_middle[24];
+
+    MenuDisplayData menuData;
+    menuData.topText = "GLOBAL->Routing";
+    if (m_chain) {
+        m_chain->formatRouting(m_chain->getRouting(), s_middle, sizeof(s_middle));
+        menuData.numOptions = m_chain->getRoutingOptionCount();
+        menuData.selectedIndex = m_chain->getRoutingOptionIndex();
+    } else {
+        snprintf(s_middle, sizeof(s_middle), "Fixed");
+        menuData.numOptions = 1;
+        menuData.selectedIndex = 0;
+    }
+    menuData.middleText = s_middle;
+    DisplayManager::instance().showMenu(menuData);
+}
+
 // ========== ENCODER BINDING ==========
 
 void GlobalController::bindToEncoder(EncoderHandler::Handler& encoder,
                                      AnyEncoderTouchedFn anyTouchedExcept) {
+    m_encoder = &encoder;
+    m_anyTouchedExcept = anyTouchedExcept;
+
     // Button press: Cycle between global parameters
     encoder.onButtonPress([this]() {
-        // For now, only one parameter (QUANTIZATION), but ready for future expansion
         Parameter current = m_currentParameter;
 
-        // Cycle through parameters (when more are added)
+        // Cycle through parameters
         switch (current) {
             case Parameter::QUANTIZATION:
-                // When we add more parameters, cycle to the next one:
-                // m_currentParameter = Parameter::MASTER_VOLUME;
-                // For now, just stay on QUANTIZATION
+                m_currentParameter = Parameter::CPU;
+                Serial.println("Global Parameter: CPU");
+                break;
+            case Parameter::CPU:
+                m_currentParameter = Parameter::ROUTING;
+                Serial.println("Global Parameter: ROUTING");
+                break;
+            case Parameter::ROUTING:
                 m_currentParameter = Parameter::QUANTIZATION;
                 Serial.println("Global Parameter: QUANTIZATION");
                 break;
@@ -83,6 +163,33 @@ void GlobalController::bindToEncoder(EncoderHandler::Handler& encoder,
                 menuData.selectedIndex = newIndex;
                 DisplayManager::instance().showMenu(menuData);
             }
+        } else if (param == Parameter::CPU) {
+            // Select Total or an effect's slot
+            int8_t maxSlot = static_cast<int8_t>(DspProfiler::getNumSlots()) - 1;
+            if (maxSlot < 0) {
+                return;
+            }
+            m_cpuSlot = static_cast<uint8_t>(clampIndex(static_cast<int8_t>(m_cpuSlot) + delta, 0, maxSlot));
+            showCpuPage();
+        } else if (param == Parameter::ROUTING) {
+            if (!m_chain) {
+                showRoutingPage();  // Fixed: nothing to change
+                return;
+            }
+            int8_t maxIndex = static_cast<int8_t>(m_chain->getRoutingOptionCount()) - 1;
+            int8_t currentIndex = static_cast<int8_t>(m_chain->getRoutingOptionIndex());
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, maxIndex);
+
+            if (newIndex != currentIndex) {
+                EffectRouting routing = m_chain->getRoutingOption(static_cast<uint8_t>(newIndex));
+                m_chain->setRouting(routing);
+
+                char label[16];
+                m_chain->formatRouting(routing, label, sizeof(label));
+                Serial.print("Global Routing: ");
+                Serial.println(label);
+            }
+            showRoutingPage();
         }
         // Future parameters:
         // else if (param == Parameter::MASTER_VOLUME) {
@@ -105,6 +212,10 @@ void GlobalController::bindToEncoder(EncoderHandler::Handler& encoder,
                 menuData.numOptions = 4;
                 menuData.selectedIndex = static_cast<uint8_t>(quant);
                 DisplayManager::instance().showMenu(menuData);
+            } else if (param == Parameter::CPU) {
+                showCpuPage();
+            } else if (param == Parameter::ROUTING) {
+                showRoutingPage();
             }
             // Future parameters:
             // else if (param == Parameter::MASTER_VOLUME) {
@@ -8,12 +8,16 @@
  *
  * DESIGN:
  * - Does NOT implement IEffectController (not tied to button commands)
- * - Manages parameter editing state (QUANTIZATION, future: MASTER_VOLUME, etc.)
+ * - Manages parameter editing state (QUANTIZATION, CPU, future: MASTER_VOLUME, etc.)
+ * - CPU page: read-only DspProfiler view (turn to select Total or an effect),
+ *   refreshed live while shown
+ * - Routing page: turn through EffectChain routing options (serial, custom
+ *   orders, parallel); shows "Fixed" with the per-node graph (no chain)
  * - Binds to encoder for parameter cycling and adjustment
  * - Uses "GLOBAL->Parameter" display format
  *
  * USAGE:
- *   GlobalController controller;
+ *   GlobalController controller(&chain);
  *   controller.bindToEncoder(*encoder4, anyEncoderTouchedExcept);
  */
 
@@ -22,6 +26,8 @@
 #include "EffectQuantization.h"
 #include "Ssd1306Display.h"
 
+class EffectChain;
+
 // Forward declaration
 namespace EncoderHandler {
     class Handler;
@@ -41,7 +47,9 @@ public:
      * Parameter selection for encoder editing
      */
     enum class Parameter : uint8_t {
-        QUANTIZATION = 0  // Global quantization grid (1/32, 1/16, 1/8, 1/4)
+        QUANTIZATION = 0, // Global quantization grid (1/32, 1/16, 1/8, 1/4)
+        CPU = 1,          // DSP load per effect (read-only)
+        ROUTING = 2       // Effect order / parallel routing
         // Future parameters can be added here:
         // MASTER_VOLUME = 1,
         // TEMPO_MULTIPLIER = 2,
@@ -51,8 +59,10 @@ public:
 
     /**
      * Constructor
+     *
+     * @param chain Fused effect chain for routing (nullptr = fixed per-node graph)
      */
-    GlobalController();
+    explicit GlobalController(EffectChain* chain);
 
     /**
      * Get current parameter being edited
@@ -73,9 +83,31 @@ public:
     void bindToEncoder(EncoderHandler::Handler& encoder,
                        AnyEncoderTouchedFn anyTouchedExcept);
 
+    /**
+     * Refresh the CPU page while it is showing (call from the app loop)
+     */
+    void updateVisualFeedback();
+
     // Utility function for parameter name mapping
     static const char* parameterName(Parameter param);
 
 private:
+    static constexpr uint32_t CPU_REFRESH_MS = 250;
+
+    /**
+     * Show the CPU page for the selected profiler slot
+     */
+    void showCpuPage();
+
+    /**
+     * Show the Routing page for the current routing
+     */
+    void showRoutingPage();
+
+    EffectChain* m_chain;          // nullptr: routing is fixed
     Parameter m_currentParameter;  // Currently selected parameter for editing
+    uint8_t m_cpuSlot;                         // DspProfiler slot shown on the CPU page
+    EncoderHandler::Handler* m_encoder;        // Bound encoder (for live refresh)
+    AnyEncoderTouchedFn m_anyTouchedExcept;    // Another encoder's menu has priority
+    uint32_t m_lastCpuRefresh;                 // millis() of last CPU page refresh
 };
@@ -2,18 +2,23 @@
 #include "SdCardStorage.h"
 #include "Timebase.h"
 #include <Arduino.h>
-#include <TeensyThreads.h>
 
 // Debug logging control - set to 0 for minimal output in production
 #define PRESET_DEBUG 0
 
 // Static member definitions
 constexpr uint8_t PresetController::PRESET_LED_PINS[4];
+constexpr PresetCodec PresetController::SLOT_CODECS[4];
 
-PresetController::PresetController(StutterAudio& stutter)
+PresetController::PresetController(StutterAudio& stutter, ChokeAudio& choke, EffectChain* chain)
     : m_stutter(stutter),
+      m_choke(choke),
+      m_chain(chain),
       m_sdCardPresent(false),
       m_selectedPreset(0),
+      m_transferSlot(0),
+      m_transferPercent(0),
+      m_loadReady(false),
       m_funcHeld(false),
       m_funcReleaseTime(0) {
     // Initialize preset existence array
@@ -53,6 +58,10 @@ bool PresetController::begin() {
     // No preset selected at startup
     m_selectedPreset = 0;
 
+    // Transfers run on the SD worker thread; results come back through update()
+    SdWorker::setCallbacks(onTransferProgress, onTransferComplete, this);
+    SdWorker::setReadyCallback(onTransferReady);
+
     Serial.println("PresetController: Initialized");
     return true;
 }
@@ -67,6 +76,14 @@ void PresetController::handleButtonPress(uint8_t slot) {
         return;
     }
 
+    // One transfer at a time
+    if (isTransferBusy()) {
+#if PRESET_DEBUG
+        Serial.println("PresetController: Action blocked - transfer in progress");
+#endif
+        return;
+    }
+
     // Check if stutter is in idle state (required for all preset actions)
     if (!isStutterIdle()) {
 #if PRESET_DEBUG
@@ -126,9 +143,16 @@ void PresetController::onCaptureComplete() {
     }
 }
 
+void PresetController::update() {
+    SdWorker::dispatchEvents();
+}
+
 void PresetController::updateLEDs(bool beatLedState) {
     for (uint8_t i = 0; i < 4; i++) {
-        if (!m_presetExists[i]) {
+        if (m_transferSlot == (i + 1)) {
+            // Transfer in progress - fast blink
+            digitalWrite(PRESET_LED_PINS[i], ((millis() / TRANSFER_BLINK_MS) & 1) ? HIGH : LOW);
+        } else if (!m_presetExists[i]) {
             // Empty preset - LED off
             digitalWrite(PRESET_LED_PINS[i], LOW);
         } else if (m_selectedPreset == (i + 1)) {
@@ -167,7 +191,8 @@ void PresetController::executeSave(uint8_t slot) {
         return;
     }
 
-    uint8_t index = slot - 1;
+    // Retroactive loop may still reference the history ring - finish moving it first
+    m_stutter.migrateHistoryLoop(StutterAudio::getMaxBufferSize());
 
     // Get buffer pointers and length from StutterAudio
     int16_t* bufferL = m_stutter.getBufferL();
@@ -179,23 +204,28 @@ void PresetController::executeSave(uint8_t slot) {
         return;
     }
 
-    // Stop threading for SD operation (prevents context switches during SD I/O)
-    int prevState = threads.stop();
-
-    // Execute synchronous save (no thread switches will occur during this)
-    SdCardStorage::SdResult result = SdCardStorage::saveSync(slot, bufferL, bufferR, length);
-
-    // Restart threading system
-    threads.start(prevState);
-
-    if (result == SdCardStorage::SdResult::SUCCESS) {
-        m_presetExists[index] = true;
-        m_selectedPreset = slot;  // Auto-select after save
-        Serial.print("PresetController: Saved preset ");
+    SdCardStorage::PresetInfo info;
+    info.captureSamplesPerBeat = m_stutter.getCaptureSamplesPerBeat();
+    info.hasGatePattern = true;
+    info.gatePattern = m_choke.getGate().getPattern();
+    info.hasRouting = (m_chain != nullptr);
+    if (m_chain) {
+        info.routing = m_chain->getRouting();
+    }
+    info.codec = SLOT_CODECS[slot - 1];
+
+    SdRequest request;
+    request.type = SdRequestType::SAVE;
+    request.slot = slot;
+    request.bufferL = bufferL;
+    request.bufferR = bufferR;
+    request.length = length;
+    request.info = info;
+    request.residentSamples = nullptr;
+    request.readHead = nullptr;
+    if (submitTransfer(request)) {
+        Serial.print("PresetController: Saving preset ");
         Serial.println(slot);
-    } else {
-        Serial.print("PresetController: Save failed - error ");
-        Serial.println(static_cast<int>(result));
     }
 }
 
@@ -213,52 +243,169 @@ void PresetController::executeLoad(uint8_t slot) {
         return;
     }
 
-    // Stop threading for SD operation
-    int prevState = threads.stop();
+    // Streamed: the old loop is dropped now, the new one becomes playable on READY
+    m_stutter.beginStreamingLoad();
+    m_loadReady = false;
+
+    SdRequest request;
+    request.type = SdRequestType::LOAD;
+    request.slot = slot;
+    request.bufferL = bufferL;
+    request.bufferR = bufferR;
+    request.length = 0;
+    request.residentSamples = m_stutter.getResidentCounter();
+    request.readHead = m_stutter.getReadHead();
+    if (submitTransfer(request)) {
+        Serial.print("PresetController: Loading preset ");
+        Serial.println(slot);
+    } else {
+        m_stutter.endStreamingLoad(false);
+    }
+}
 
-    // Execute synchronous load
-    uint32_t outLength = 0;
-    SdCardStorage::SdResult result = SdCardStorage::loadSync(slot, bufferL, bufferR, outLength);
+void PresetController::executeDelete(uint8_t slot) {
+    if (slot < 1 || slot > 4) {
+        return;
+    }
 
-    // Restart threading
-    threads.start(prevState);
+    SdRequest request;
+    request.type = SdRequestType::DELETE;
+    request.slot = slot;
+    request.bufferL = nullptr;
+    request.bufferR = nullptr;
+    request.length = 0;
+    request.residentSamples = nullptr;
+    request.readHead = nullptr;
+    submitTransfer(request);
+}
 
-    if (result == SdCardStorage::SdResult::SUCCESS && outLength > 0) {
-        // Update StutterAudio with loaded data
-        m_stutter.setCaptureLength(outLength);
-        m_stutter.setStateWithLoop();  // Transition to IDLE_WITH_LOOP
+bool PresetController::submitTransfer(const SdRequest& request) {
+    if (!SdWorker::submit(request)) {
+        Serial.println("PresetController: SD worker queue full");
+        return false;
+    }
+    m_transferSlot = request.slot;
+    m_transferPercent = 0;
+    return true;
+}
+
+// ========== SD WORKER CALLBACKS ==========
 
-        // Select this preset
-        m_selectedPreset = slot;
+void PresetController::onTransferProgress(void* context, const SdEvent& event) {
+    PresetController* self = static_cast<PresetController*>(context);
+    self->m_transferPercent = event.percent;
+#if PRESET_DEBUG
+    Serial.print("PresetController: Preset ");
+    Serial.print(event.slot);
+    Serial.print(" transfer ");
+    Serial.print(event.percent);
+    Serial.println("%");
+#endif
+}
+
+void PresetController::onTransferReady(void* context, const SdEvent& event) {
+    PresetController* self = static_cast<PresetController*>(context);
+    self->applyLoadedLoop(event);
+    Serial.print("PresetController: Preset ");
+    Serial.print(event.slot);
+    Serial.print(" playable at ");
+    Serial.print(event.percent);
+    Serial.println("% loaded");
+}
+
+void PresetController::onTransferComplete(void* context, const SdEvent& event) {
+    PresetController* self = static_cast<PresetController*>(context);
+    self->m_transferSlot = 0;
+    self->m_transferPercent = event.percent;
+
+    switch (event.request) {
+        case SdRequestType::SAVE:
+            self->finishSave(event);
+            break;
+        case SdRequestType::LOAD:
+            self->finishLoad(event);
+            break;
+        case SdRequestType::DELETE:
+            self->finishDelete(event);
+            break;
+    }
+}
+
+void PresetController::finishSave(const SdEvent& event) {
+    uint8_t slot = event.slot;
+    if (event.result == SdCardStorage::SdResult::SUCCESS) {
+        m_presetExists[slot - 1] = true;
+        m_selectedPreset = slot;  // Auto-select after save
+        Serial.print("PresetController: Saved preset ");
+        Serial.println(slot);
+    } else {
+        Serial.print("PresetController: Save failed - error ");
+        Serial.println(static_cast<int>(event.result));
+    }
+}
+
+void PresetController::applyLoadedLoop(const SdEvent& event) {
+    const SdCardStorage::PresetInfo& info = event.info;
+
+    // Update StutterAudio with the loop (still streaming in behind the read head)
+    m_stutter.setCaptureLength(event.length);
+    m_stutter.setCaptureSamplesPerBeat(info.captureSamplesPerBeat);  // Stretched to current tempo on playback
+    m_stutter.setStateWithLoop();  // Transition to IDLE_WITH_LOOP
+
+    // Restore gate pattern (older presets keep the current pattern)
+    if (info.hasGatePattern) {
+        m_choke.getGate().setPattern(info.gatePattern);
+    }
+
+    // Restore routing (older presets keep the current routing)
+    if (info.hasRouting && m_chain && !m_chain->setRouting(info.routing)) {
+        Serial.println("PresetController: Stored routing invalid - keeping current");
+    }
+
+    // Select this preset
+    m_selectedPreset = event.slot;
+    m_loadReady = true;
+}
+
+void PresetController::finishLoad(const SdEvent& event) {
+    uint8_t slot = event.slot;
+    uint32_t outLength = event.length;
+
+    if (event.result == SdCardStorage::SdResult::SUCCESS && outLength > 0) {
+        if (!m_loadReady) {
+            applyLoadedLoop(event);
+        }
+        m_stutter.endStreamingLoad(true);  // Whole loop resident
 
         Serial.print("PresetController: Loaded preset ");
         Serial.print(slot);
         Serial.print(" (");
         Serial.print(outLength);
         Serial.println(" samples)");
+
+        uint32_t underruns = m_stutter.takeStreamUnderruns();
+        if (underruns > 0) {
+            Serial.print("PresetController: Playback overtook the load in ");
+            Serial.print(underruns);
+            Serial.println(" blocks (played silence)");
+        }
     } else {
+        // A partly streamed loop is dropped
+        m_stutter.endStreamingLoad(false);
+        if (m_loadReady && m_selectedPreset == slot) {
+            deselectPreset();
+        }
         Serial.print("PresetController: Load failed - error ");
-        Serial.println(static_cast<int>(result));
+        Serial.println(static_cast<int>(event.result));
     }
+    m_loadReady = false;
 }
 
-void PresetController::executeDelete(uint8_t slot) {
-    if (slot < 1 || slot > 4) {
-        return;
-    }
-
+void PresetController::finishDelete(const SdEvent& event) {
+    uint8_t slot = event.slot;
     uint8_t index = slot - 1;
 
-    // Stop threading for SD operation
-    int prevState = threads.stop();
-
-    // Execute synchronous delete
-    SdCardStorage::SdResult result = SdCardStorage::deleteSync(slot);
-
-    // Restart threading
-    threads.start(prevState);
-
-    if (result == SdCardStorage::SdResult::SUCCESS) {
+    if (event.result == SdCardStorage::SdResult::SUCCESS) {
         m_presetExists[index] = false;
 
         // If this was the selected preset, deselect it
@@ -273,7 +420,7 @@ void PresetController::executeDelete(uint8_t slot) {
         Serial.println(slot);
     } else {
         Serial.print("PresetController: Delete failed - error ");
-        Serial.println(static_cast<int>(result));
+        Serial.println(static_cast<int>(event.result));
     }
 }
 
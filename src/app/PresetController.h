@@ -11,13 +11,21 @@
  *
  * DESIGN:
  * - Works with StutterAudio buffer via accessor methods
- * - Uses SdCardStorage HAL for synchronous file operations
+ * - Stores the ChokeAudio gate pattern with each preset (restored on load)
+ * - Loops are frame-coded per slot (SLOT_CODECS) to cut SD transfer time
+ * - Save/load/delete are queued on the SdWorker thread; results arrive through
+ *   its progress/completion callbacks (dispatched from update() on the App thread)
+ * - Loads stream: the loop (and its settings) is applied on the worker's READY
+ *   event, once the first blocks are resident, and can play while the rest loads
  * - Tracks FUNC button state with grace period for cross-bus timing
- * - LED states: OFF (empty), ON (written), beat-sync blink (selected)
- * - Operations are blocking (run in App thread)
+ * - LED states: OFF (empty), ON (written), beat-sync blink (selected),
+ *   fast blink (transfer in progress)
  *
  * CONSTRAINTS:
  * - All actions only allowed in IDLE states (IDLE_NO_LOOP or IDLE_WITH_LOOP)
+ * - One transfer at a time; the loop buffer is busy until it completes
+ *   (isTransferBusy() - StutterController ignores presses that would touch it,
+ *   except playback of a loop that is streaming in)
  * - Cannot overwrite preset - must delete first then write
  * - New capture while preset selected deselects that preset
  */
@@ -26,7 +34,10 @@
 
 #include <Arduino.h>
 #include "StutterAudio.h"
+#include "ChokeAudio.h"
+#include "EffectChain.h"
 #include "SdCardStorage.h"
+#include "SdWorker.h"
 
 class PresetController {
 public:
@@ -34,8 +45,10 @@ public:
      * Constructor
      *
      * @param stutter Reference to the stutter audio effect
+     * @param choke Reference to the choke audio effect (gate pattern)
+     * @param chain Fused effect chain (routing), nullptr for the fixed per-node graph
      */
-    explicit PresetController(StutterAudio& stutter);
+    PresetController(StutterAudio& stutter, ChokeAudio& choke, EffectChain* chain);
 
     /**
      * Initialize preset system
@@ -77,6 +90,16 @@ public:
      */
     void onCaptureComplete();
 
+    /**
+     * Deliver SD worker progress/completion (call from App::threadLoop)
+     */
+    void update();
+
+    /**
+     * A save/load/delete is queued or running (loop buffer in use)
+     */
+    bool isTransferBusy() const { return m_transferSlot != 0; }
+
     /**
      * Update LED states (call from App::threadLoop)
      * Handles beat-synced blinking for selected preset
@@ -102,6 +125,8 @@ public:
 
 private:
     StutterAudio& m_stutter;
+    ChokeAudio& m_choke;
+    EffectChain* m_chain;     // nullptr: routing not stored
 
     // SD card state
     bool m_sdCardPresent;
@@ -112,6 +137,12 @@ private:
     // Currently selected preset (0 = none, 1-4 = selected slot)
     uint8_t m_selectedPreset;
 
+    // SD transfer in flight (0 = none), and its progress
+    uint8_t m_transferSlot;
+    uint8_t m_transferPercent;
+    bool m_loadReady;         // Streaming load applied to the stutter (READY seen)
+    static constexpr uint32_t TRANSFER_BLINK_MS = 60;
+
     // FUNC button state with grace period
     bool m_funcHeld;
     uint32_t m_funcReleaseTime;
@@ -120,6 +151,12 @@ private:
     // LED pins (directly on Teensy)
     static constexpr uint8_t PRESET_LED_PINS[4] = {29, 30, 31, 32};
 
+    // How each slot stores its loop: LOSSLESS (bit-exact, ~2:1) or ADPCM (4:1, lossy -
+    // for scratch slots where load time matters more than fidelity)
+    static constexpr PresetCodec SLOT_CODECS[4] = {
+        PresetCodec::LOSSLESS, PresetCodec::LOSSLESS, PresetCodec::LOSSLESS, PresetCodec::LOSSLESS
+    };
+
     /**
      * Check if FUNC is effectively held (including grace period)
      */
@@ -131,20 +168,39 @@ private:
     bool isStutterIdle() const;
 
     /**
-     * Execute synchronous save of current loop to preset slot
+     * Queue save of current loop to preset slot
      */
     void executeSave(uint8_t slot);
 
     /**
-     * Execute synchronous load of preset into current loop buffer
+     * Queue load of preset into current loop buffer
      */
     void executeLoad(uint8_t slot);
 
     /**
-     * Execute synchronous delete of preset from SD card
+     * Queue delete of preset from SD card
      */
     void executeDelete(uint8_t slot);
 
+    /**
+     * Hand a request to the SD worker and mark the slot busy
+     */
+    bool submitTransfer(const SdRequest& request);
+
+    // ========== SD WORKER CALLBACKS (App thread) ==========
+    static void onTransferProgress(void* context, const SdEvent& event);
+    static void onTransferComplete(void* context, const SdEvent& event);
+    static void onTransferReady(void* context, const SdEvent& event);
+
+    /**
+     * Hand a loaded (or still loading) loop and its settings to the effects
+     */
+    void applyLoadedLoop(const SdEvent& event);
+
+    void finishSave(const SdEvent& event);
+    void finishLoad(const SdEvent& event);
+    void finishDelete(const SdEvent& event);
+
     /**
      * Deselect current preset (switch to "scratch" mode)
      */
@@ -4,12 +4,18 @@
 #include "Timebase.h"
 #include "EncoderHandler.h"
 #include <Arduino.h>
+#include <stdio.h>
 
 // ========== RGB LED PIN DEFINITIONS ==========
 static constexpr uint8_t RGB_LED_R_PIN = 28;  // Red (PWM capable)
 static constexpr uint8_t RGB_LED_G_PIN = 36;  // Green (PWM capable)
 static constexpr uint8_t RGB_LED_B_PIN = 37;  // Blue (PWM capable)
 
+// ========== RETRO LOOP MIGRATION ==========
+// Samples per channel copied from history ring to loop buffer per app loop pass
+// 4096 samples x 2 channels of PSRAM→PSRAM copy per pass keeps the app thread responsive
+static constexpr size_t MIGRATE_CHUNK_SAMPLES = 4096;
+
 // ========== GAMMA LOOKUP TABLE (γ=4.0) ==========
 // Pre-computed gamma curve for dramatic LED brightness ramp.
 // Input: linear progress 0-255, Output: gamma-corrected brightness 0-255
@@ -69,6 +75,7 @@ StutterController::StutterController(StutterAudio& effect)
       m_stutterHeld(false),
       m_wasEnabled(false),
       m_captureCompleteCallback(nullptr),
+      m_loopBufferBusyCallback(nullptr),
       m_lastState(StutterState::IDLE_NO_LOOP),
       m_captureInProgress(false) {
 }
@@ -103,6 +110,7 @@ const char* StutterController::captureStartName(StutterCaptureStart captureStart
     switch (captureStart) {
         case StutterCaptureStart::FREE:      return "Free";
         case StutterCaptureStart::QUANTIZED: return "Quantized";
+        case StutterCaptureStart::RETRO:     return "Retro";
         default: return "Free";
     }
 }
@@ -115,6 +123,30 @@ const char* StutterController::captureEndName(StutterCaptureEnd captureEnd) {
     }
 }
 
+const char* StutterController::captureBarsName(StutterCaptureBars captureBars) {
+    switch (captureBars) {
+        case StutterCaptureBars::BARS_1: return "1 Bar";
+        case StutterCaptureBars::BARS_2: return "2 Bars";
+        case StutterCaptureBars::BARS_4: return "4 Bars";
+        case StutterCaptureBars::BARS_8: return "8 Bars";
+        default: return "1 Bar";
+    }
+}
+
+const char* StutterController::modeName(StutterMode mode) {
+    switch (mode) {
+        case StutterMode::LOOP: return "Loop";
+        case StutterMode::ROLL: return "Roll";
+        default: return "Loop";
+    }
+}
+
+const char* StutterController::mixName(uint8_t percent) {
+    static char s_mixText[8];
+    snprintf(s_mixText, sizeof(s_mixText), "%u%%", percent);
+    return s_mixText;
+}
+
 // ========== BUTTON PRESS HANDLER ==========
 
 bool StutterController::handleButtonPress(const Command& cmd) {
@@ -133,13 +165,21 @@ bool StutterController::handleButtonPress(const Command& cmd) {
         return false;  // Not a press command
     }
 
+    // Preset save/load in progress: the SD worker owns the loop buffer
+    // (a loop streaming in may already play, it can't be recaptured)
+    if (m_loopBufferBusyCallback && m_loopBufferBusyCallback() &&
+        (m_funcHeld || (m_effect.getMode() != StutterMode::ROLL && !m_effect.isStreamingLoad()))) {
+        Serial.println("Stutter: Button press ignored (preset transfer in progress)");
+        return true;  // Command handled
+    }
+
     m_stutterHeld = true;  // Track that STUTTER is now held
     m_effect.setStutterHeld(true);  // Update audio effect's button state
 
     StutterState currentState = m_effect.getState();
 
     // ========== FUNC+STUTTER COMBO (CAPTURE MODE) ==========
-    if (m_funcHeld) {
+    if (m_funcHeld && currentState != StutterState::ROLLING) {
         // Valid FUNC+STUTTER combo (FUNC pressed first)
         // Start capture or delete existing loop
 
@@ -152,7 +192,24 @@ bool StutterController::handleButtonPress(const Command& cmd) {
         StutterCaptureEnd captureEndMode = m_effect.getCaptureEndMode();
         Quantization quant = EffectQuantization::getGlobalQuantization();
 
-        if (captureStartMode == StutterCaptureStart::FREE) {
+        if (captureStartMode == StutterCaptureStart::RETRO) {
+            // RETRO CAPTURE START: Loop the most recent complete grid period from history
+            // No CAPTURING phase - the audio was already recorded by the history ring
+            uint32_t quantPeriod = EffectQuantization::calculateQuantizedDuration(quant);
+            uint32_t samplesToNext = EffectQuantization::samplesToNextQuantizedBoundary(quant);
+            uint64_t now = Timebase::getSamplePosition();
+            uint64_t lastBoundary = now + samplesToNext - quantPeriod;  // samplesToNext is never 0
+
+            if (lastBoundary >= quantPeriod &&
+                m_effect.captureRetroactive(lastBoundary - quantPeriod, quantPeriod, m_stutterHeld)) {
+                m_captureInProgress = true;  // Fire capture-complete callback on return to idle
+                Serial.print("Stutter: RETRO capture (");
+                Serial.print(EffectQuantization::quantizationName(quant));
+                Serial.println(")");
+            } else {
+                Serial.println("Stutter: RETRO capture failed (not enough history)");
+            }
+        } else if (captureStartMode == StutterCaptureStart::FREE) {
             // FREE CAPTURE START: Start capturing immediately
             m_effect.startCapture();
             Serial.println("Stutter: CAPTURE started (Free)");
@@ -185,6 +242,26 @@ bool StutterController::handleButtonPress(const Command& cmd) {
         return true;  // Command handled
     }
 
+    // ========== STUTTER ONLY (ROLL MODE) ==========
+    if (m_effect.getMode() == StutterMode::ROLL &&
+        (currentState == StutterState::IDLE_NO_LOOP || currentState == StutterState::IDLE_WITH_LOOP)) {
+        Quantization quant = EffectQuantization::getGlobalQuantization();
+        uint64_t rollStartSample = Timebase::getSamplePosition();
+
+        if (m_effect.getOnsetMode() == StutterOnset::QUANTIZED) {
+            rollStartSample += EffectQuantization::samplesToNextQuantizedBoundary(quant);
+            Serial.print("Stutter: ROLL scheduled (");
+            Serial.print(EffectQuantization::quantizationName(quant));
+            Serial.println(")");
+        } else {
+            Serial.println("Stutter: ROLL started (Free onset)");
+        }
+        m_effect.startRoll(rollStartSample);
+
+        DisplayManager::instance().updateDisplay();
+        return true;  // Command handled
+    }
+
     // ========== STUTTER ONLY (PLAYBACK MODE) ==========
     // Check if we have a captured loop
     if (currentState == StutterState::IDLE_NO_LOOP) {
@@ -311,6 +388,25 @@ bool StutterController::handleButtonRelease(const Command& cmd) {
         return true;  // Command handled
     }
 
+    // ========== ROLL MODE RELEASES ==========
+
+    if (currentState == StutterState::ROLLING) {
+        if (m_effect.getLengthMode() == StutterLength::FREE) {
+            // FREE LENGTH: Crossfade back to live immediately
+            m_effect.stopRoll(0);
+            Serial.println("Stutter: ROLL stopped (Free length)");
+        } else {
+            // QUANTIZED LENGTH: Stop at next grid boundary (sample-accurate)
+            Quantization quant = EffectQuantization::getGlobalQuantization();
+            uint32_t samplesToNext = EffectQuantization::samplesToNextQuantizedBoundary(quant);
+            m_effect.stopRoll(Timebase::getSamplePosition() + samplesToNext);
+            Serial.print("Stutter: ROLL STOP scheduled (");
+            Serial.print(EffectQuantization::quantizationName(quant));
+            Serial.println(")");
+        }
+        return true;  // Command handled
+    }
+
     // ========== PLAYBACK MODE RELEASES ==========
 
     if (currentState == StutterState::WAIT_PLAYBACK_ONSET) {
@@ -354,6 +450,11 @@ bool StutterController::handleButtonRelease(const Command& cmd) {
 void StutterController::updateVisualFeedback() {
     StutterState currentState = m_effect.getState();
 
+    // ========== RETRO LOOP MIGRATION ==========
+    // Move a history-referenced loop into the loop buffer a chunk per pass,
+    // before the history ring wraps around onto it
+    m_effect.migrateHistoryLoop(MIGRATE_CHUNK_SAMPLES);
+
     // ========== RGB LED STATE-SPECIFIC CONTROL ==========
     switch (currentState) {
         case StutterState::IDLE_NO_LOOP:
@@ -436,6 +537,14 @@ void StutterController::updateVisualFeedback() {
             NeokeyInput::setLED(EffectID::STUTTER, true);
             break;
 
+        case StutterState::ROLLING:
+            // LED SOLID MAGENTA
+            analogWrite(RGB_LED_R_PIN, 255);
+            analogWrite(RGB_LED_G_PIN, 0);
+            analogWrite(RGB_LED_B_PIN, 255);
+            NeokeyInput::setLED(EffectID::STUTTER, true);
+            break;
+
         default:
             // Fallback: LED OFF
             analogWrite(RGB_LED_R_PIN, 0);
@@ -523,7 +632,7 @@ static int8_t clampIndex(int8_t value, int8_t minValue, int8_t maxValue) {
 
 void StutterController::bindToEncoder(EncoderHandler::Handler& encoder,
                                       AnyEncoderTouchedFn anyTouchedExcept) {
-    // Button press: Cycle between ONSET → LENGTH → CAPTURE_START → CAPTURE_END
+    // Button press: Cycle between ONSET → LENGTH → CAPTURE_START → CAPTURE_END → CAPTURE_BARS → MODE → MIX
     encoder.onButtonPress([this]() {
         Parameter current = m_currentParameter;
 
@@ -537,7 +646,16 @@ void StutterController::bindToEncoder(EncoderHandler::Handler& encoder,
         } else if (current == Parameter::CAPTURE_START) {
             m_currentParameter = Parameter::CAPTURE_END;
             Serial.println("Stutter Parameter: CAPTURE_END");
-        } else {  // CAPTURE_END
+        } else if (current == Parameter::CAPTURE_END) {
+            m_currentParameter = Parameter::CAPTURE_BARS;
+            Serial.println("Stutter Parameter: CAPTURE_BARS");
+        } else if (current == Parameter::CAPTURE_BARS) {
+            m_currentParameter = Parameter::MODE;
+            Serial.println("Stutter Parameter: MODE");
+        } else if (current == Parameter::MODE) {
+            m_currentParameter = Parameter::MIX;
+            Serial.println("Stutter Parameter: MIX");
+        } else {  // MIX
             m_currentParameter = Parameter::ONSET;
             Serial.println("Stutter Parameter: ONSET");
         }
@@ -582,7 +700,7 @@ void StutterController::bindToEncoder(EncoderHandler::Handler& encoder,
             }
         } else if (param == Parameter::CAPTURE_START) {
             int8_t currentIndex = static_cast<int8_t>(m_effect.getCaptureStartMode());
-            int8_t newIndex = clampIndex(currentIndex + delta, 0, 1);
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, 2);
             if (newIndex != currentIndex) {
                 StutterCaptureStart newCaptureStart = static_cast<StutterCaptureStart>(newIndex);
                 m_effect.setCaptureStartMode(newCaptureStart);
@@ -592,11 +710,11 @@ void StutterController::bindToEncoder(EncoderHandler::Handler& encoder,
                 MenuDisplayData menuData;
                 menuData.topText = "STUTTER->Cap. Start";
                 menuData.middleText = captureStartName(newCaptureStart);
-                menuData.numOptions = 2;
+                menuData.numOptions = 3;
                 menuData.selectedIndex = newIndex;
                 DisplayManager::instance().showMenu(menuData);
             }
-        } else {  // CAPTURE_END
+        } else if (param == Parameter::CAPTURE_END) {
             int8_t currentIndex = static_cast<int8_t>(m_effect.getCaptureEndMode());
             int8_t newIndex = clampIndex(currentIndex + delta, 0, 1);
             if (newIndex != currentIndex) {
@@ -612,6 +730,58 @@ void StutterController::bindToEncoder(EncoderHandler::Handler& encoder,
                 menuData.selectedIndex = newIndex;
                 DisplayManager::instance().showMenu(menuData);
             }
+        } else if (param == Parameter::CAPTURE_BARS) {
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getCaptureBars());
+            int8_t lastIndex = static_cast<int8_t>(StutterAudio::MAX_CAPTURE_BARS);
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, lastIndex);
+            if (newIndex != currentIndex) {
+                StutterCaptureBars newCaptureBars = static_cast<StutterCaptureBars>(newIndex);
+                m_effect.setCaptureBars(newCaptureBars);
+                Serial.print("Stutter Capture Bars: ");
+                Serial.println(captureBarsName(newCaptureBars));
+
+                MenuDisplayData menuData;
+                menuData.topText = "STUTTER->Cap. Bars";
+                menuData.middleText = captureBarsName(newCaptureBars);
+                menuData.numOptions = static_cast<uint8_t>(StutterAudio::MAX_CAPTURE_BARS) + 1;
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
+        } else if (param == Parameter::MIX) {
+            // Audio ramps to the new mix (SmoothedParam), so detents don't zipper
+            const int8_t maxIndex = 100 / MIX_STEP_PERCENT;
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getMix() / MIX_STEP_PERCENT);
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, maxIndex);
+            if (newIndex != currentIndex) {
+                uint8_t newMix = static_cast<uint8_t>(newIndex * MIX_STEP_PERCENT);
+                m_effect.setMix(newMix);
+                Serial.print("Stutter Mix: ");
+                Serial.print(newMix);
+                Serial.println("%");
+
+                MenuDisplayData menuData;
+                menuData.topText = "STUTTER->Mix";
+                menuData.middleText = mixName(newMix);
+                menuData.numOptions = maxIndex + 1;
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
+        } else {  // MODE
+            int8_t currentIndex = static_cast<int8_t>(m_effect.getMode());
+            int8_t newIndex = clampIndex(currentIndex + delta, 0, 1);
+            if (newIndex != currentIndex) {
+                StutterMode newMode = static_cast<StutterMode>(newIndex);
+                m_effect.setMode(newMode);
+                Serial.print("Stutter Mode: ");
+                Serial.println(modeName(newMode));
+
+                MenuDisplayData menuData;
+                menuData.topText = "STUTTER->Mode";
+                menuData.middleText = modeName(newMode);
+                menuData.numOptions = 2;
+                menuData.selectedIndex = newIndex;
+                DisplayManager::instance().showMenu(menuData);
+            }
         }
     });
 
@@ -633,11 +803,26 @@ void StutterController::bindToEncoder(EncoderHandler::Handler& encoder,
             } else if (param == Parameter::CAPTURE_START) {
                 menuData.topText = "STUTTER->Cap. Start";
                 menuData.middleText = captureStartName(m_effect.getCaptureStartMode());
+                menuData.numOptions = 3;
                 menuData.selectedIndex = static_cast<uint8_t>(m_effect.getCaptureStartMode());
-            } else {  // CAPTURE_END
+            } else if (param == Parameter::CAPTURE_END) {
                 menuData.topText = "STUTTER->Cap. End";
                 menuData.middleText = captureEndName(m_effect.getCaptureEndMode());
                 menuData.selectedIndex = static_cast<uint8_t>(m_effect.getCaptureEndMode());
+            } else if (param == Parameter::CAPTURE_BARS) {
+                menuData.topText = "STUTTER->Cap. Bars";
+                menuData.middleText = captureBarsName(m_effect.getCaptureBars());
+                menuData.numOptions = static_cast<uint8_t>(StutterAudio::MAX_CAPTURE_BARS) + 1;
+                menuData.selectedIndex = static_cast<uint8_t>(m_effect.getCaptureBars());
+            } else if (param == Parameter::MIX) {
+                menuData.topText = "STUTTER->Mix";
+                menuData.middleText = mixName(m_effect.getMix());
+                menuData.numOptions = 100 / MIX_STEP_PERCENT + 1;
+                menuData.selectedIndex = m_effect.getMix() / MIX_STEP_PERCENT;
+            } else {  // MODE
+                menuData.topText = "STUTTER->Mode";
+                menuData.middleText = modeName(m_effect.getMode());
+                menuData.selectedIndex = static_cast<uint8_t>(m_effect.getMode());
             }
             DisplayManager::instance().showMenu(menuData);
         } else {
@@ -9,9 +9,12 @@
  * DESIGN:
  * - Implements IEffectController interface
  * - Owns reference to StutterAudio
- * - Manages parameter editing state (ONSET, LENGTH, CAPTURE_START, CAPTURE_END)
+ * - Manages parameter editing state (ONSET, LENGTH, CAPTURE_START, CAPTURE_END, CAPTURE_BARS, MODE, MIX)
  * - Handles FUNC+STUTTER button order detection
  * - Handles free/quantized onset, length, capture start, and capture end modes
+ * - Handles retroactive capture (loop the last grid period from the history ring)
+ *   and migrates the referenced loop into the loop buffer in the background
+ * - Handles roll mode (STUTTER rolls live audio; onset/length modes apply to start/stop)
  * - Manages LED blinking for armed states
  *
  * USAGE:
@@ -42,6 +45,9 @@ typedef bool (*AnyEncoderTouchedFn)(const EncoderHandler::Handler* ignore);
 // Callback type for capture complete notification
 typedef void (*CaptureCompleteCallback)();
 
+// Callback type for checking if a preset transfer is using the loop buffer
+typedef bool (*LoopBufferBusyCallback)();
+
 /**
  * Stutter effect controller
  *
@@ -52,15 +58,20 @@ class StutterController : public IEffectController {
 public:
     /**
      * Parameter selection for encoder editing
-     * Cycle order: ONSET → LENGTH → CAPTURE_START → CAPTURE_END
+     * Cycle order: ONSET → LENGTH → CAPTURE_START → CAPTURE_END → CAPTURE_BARS → MODE → MIX
      */
     enum class Parameter : uint8_t {
         ONSET = 0,          // Playback onset timing (Free, Quantized)
         LENGTH = 1,         // Playback length (Free, Quantized)
-        CAPTURE_START = 2,  // Capture start timing (Free, Quantized)
-        CAPTURE_END = 3     // Capture end timing (Free, Quantized)
+        CAPTURE_START = 2,  // Capture start timing (Free, Quantized, Retro)
+        CAPTURE_END = 3,    // Capture end timing (Free, Quantized)
+        CAPTURE_BARS = 4,   // Capture length limit (1, 2, 4, 8 bars, up to StutterAudio::MAX_CAPTURE_BARS)
+        MODE = 5,           // STUTTER button behavior (Loop, Roll)
+        MIX = 6             // Loop/roll vs live input (0-100%, smoothed)
     };
 
+    static constexpr uint8_t MIX_STEP_PERCENT = 10;  // Encoder detent (11 indicator positions)
+
     /**
      * Constructor
      *
@@ -104,6 +115,17 @@ public:
         m_captureCompleteCallback = callback;
     }
 
+    /**
+     * Set callback reporting a preset save/load in progress
+     * While it returns true, presses that would capture into or play the loop
+     * buffer are ignored (roll only uses the history ring and stays available)
+     *
+     * @param callback Function returning true while the loop buffer is busy
+     */
+    void setLoopBufferBusyCallback(LoopBufferBusyCallback callback) {
+        m_loopBufferBusyCallback = callback;
+    }
+
     // Utility functions for bitmap/name mapping
     // TODO: Re-enable when stutter parameter bitmaps are added
     // static BitmapID onsetToBitmap(StutterOnset onset);
@@ -116,6 +138,9 @@ public:
     static const char* lengthName(StutterLength length);
     static const char* captureStartName(StutterCaptureStart captureStart);
     static const char* captureEndName(StutterCaptureEnd captureEnd);
+    static const char* captureBarsName(StutterCaptureBars captureBars);
+    static const char* modeName(StutterMode mode);
+    static const char* mixName(uint8_t percent);  // Formats into a static buffer
 
 private:
     StutterAudio& m_effect;   // Reference to audio effect (DSP)
@@ -131,6 +156,9 @@ private:
     // Capture complete callback (for PresetController notification)
     CaptureCompleteCallback m_captureCompleteCallback;
 
+    // Preset transfer in progress check (loop buffer owned by the SD worker)
+    LoopBufferBusyCallback m_loopBufferBusyCallback;
+
     // Track previous state for capture complete detection
     StutterState m_lastState;
 
@@ -81,6 +81,9 @@ enum class EffectID : uint8_t {
     FUNC = 4        // Function modifier button (no standalone effect)
 };
 
+// One past the highest EffectID (size of tables indexed by EffectID)
+static constexpr uint8_t EFFECT_ID_COUNT = static_cast<uint8_t>(EffectID::FUNC) + 1;
+
 /**
  * Command - Generic command structure
  *
@@ -0,0 +1,136 @@
+#include "DspProfiler.h"
+#include <string.h>
+
+DspProfiler::Slot DspProfiler::s_slots[DspProfiler::MAX_SLOTS];
+uint8_t DspProfiler::s_numSlots = 0;
+uint32_t DspProfiler::s_deadlineTicks = 0;
+uint32_t DspProfiler::s_blockTicks = 0;
+
+// ========== PLATFORM ==========
+
+#if defined(__ARM_ARCH_7EM__)
+static inline void lockStats() { noInterrupts(); }
+static inline void unlockStats() { interrupts(); }
+static inline uint32_t ticksPerSecond() { return F_CPU_ACTUAL; }
+#else
+// Host: single-threaded, nothing to lock
+static inline void lockStats() {}
+static inline void unlockStats() {}
+static inline uint32_t ticksPerSecond() { return 1000000000u; }
+#endif
+
+// ========== SETUP ==========
+
+void DspProfiler::begin(uint32_t blockSamples, uint32_t sampleRate) {
+    s_deadlineTicks = static_cast<uint32_t>(
+        (static_cast<uint64_t>(ticksPerSecond()) * blockSamples) / sampleRate);
+
+    if (s_numSlots == 0) {
+        registerSlot("Total");
+    }
+}
+
+uint8_t DspProfiler::registerSlot(const char* name) {
+    if (s_numSlots >= MAX_SLOTS) {
+        return INVALID_SLOT;
+    }
+    Slot& slot = s_slots[s_numSlots];
+    clearSlot(slot);
+    slot.name = name;
+    return s_numSlots++;  // Publish after the slot is initialised
+}
+
+void DspProfiler::clearSlot(Slot& slot) {
+    slot.count = 0;
+    slot.minTicks = UINT32_MAX;
+    slot.maxTicks = 0;
+    slot.sumTicks = 0;
+    slot.overruns = 0;
+    memset(slot.histogram, 0, sizeof(slot.histogram));
+}
+
+// ========== AUDIO ISR ==========
+
+void DspProfiler::recordSlot(Slot& slot, uint32_t ticks) {
+    slot.count++;
+    slot.sumTicks += ticks;
+    if (ticks < slot.minTicks) slot.minTicks = ticks;
+    if (ticks > slot.maxTicks) slot.maxTicks = ticks;
+    if (ticks > s_deadlineTicks) slot.overruns++;
+
+    // log2 bins: deadline/128, /64, ... /2, then open-ended
+    uint8_t bin = 0;
+    uint32_t edge = s_deadlineTicks >> (HIST_BINS - 1);
+    while (bin < HIST_BINS - 1 && ticks >= edge) {
+        bin++;
+        edge <<= 1;
+    }
+    slot.histogram[bin]++;
+}
+
+void DspProfiler::record(uint8_t slot, uint32_t ticks) {
+    if (slot >= s_numSlots || s_deadlineTicks == 0) {
+        return;
+    }
+    recordSlot(s_slots[slot], ticks);
+    s_blockTicks += ticks;
+}
+
+void DspProfiler::endBlock() {
+    endBlock(s_blockTicks);
+}
+
+void DspProfiler::endBlock(uint32_t blockTicks) {
+    s_blockTicks = 0;
+    if (s_numSlots == 0 || s_deadlineTicks == 0) {
+        return;
+    }
+    recordSlot(s_slots[TOTAL_SLOT], blockTicks);
+}
+
+// ========== APP THREAD ==========
+
+bool DspProfiler::getStats(uint8_t slot, Stats& out) {
+    if (slot >= s_numSlots) {
+        return false;
+    }
+
+    lockStats();
+    const Slot& s = s_slots[slot];
+    out.name = s.name;
+    out.count = s.count;
+    out.minTicks = (s.count > 0) ? s.minTicks : 0;
+    out.maxTicks = s.maxTicks;
+    out.avgTicks = (s.count > 0) ? static_cast<uint32_t>(s.sumTicks / s.count) : 0;
+    out.overruns = s.overruns;
+    memcpy(out.histogram, s.histogram, sizeof(out.histogram));
+    unlockStats();
+    return true;
+}
+
+void DspProfiler::reset() {
+    lockStats();
+    for (uint8_t i = 0; i < s_numSlots; i++) {
+        clearSlot(s_slots[i]);
+    }
+    s_blockTicks = 0;
+    unlockStats();
+}
+
+uint32_t DspProfiler::ticksToNanos(uint32_t ticks) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(ticks) * 1000000000u) / ticksPerSecond());
+}
+
+uint32_t DspProfiler::toPermille(uint32_t ticks) {
+    if (s_deadlineTicks == 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>((static_cast<uint64_t>(ticks) * 1000) / s_deadlineTicks);
+}
+
+uint32_t DspProfiler::binUpperPermille(uint8_t bin) {
+    if (bin >= HIST_BINS - 1) {
+        return 0;
+    }
+    return 1000u >> (HIST_BINS - 1 - bin);
+}
@@ -0,0 +1,166 @@
+/**
+ * DspProfiler.h - Per-effect DSP cycle profiler (min/avg/max, histogram, overruns)
+ *
+ * PURPOSE:
+ * Measures how long each effect's block processing takes in the audio ISR,
+ * so CPU headroom can be checked per effect instead of only as the Audio
+ * library's global AudioProcessorUsage() figure.
+ *
+ * DESIGN:
+ * - Named slots, registered once at startup (EffectManager registers every effect)
+ *   - Slot 0 is the per-block total ("Total"); its overruns = blocks over the deadline
+ * - Timestamps:
+ *   - Teensy (Cortex-M7): DWT cycle counter (ARM_DWT_CYCCNT), 1 tick = 1 CPU cycle
+ *   - Host build: std::chrono::steady_clock, 1 tick = 1 ns (same API)
+ * - Per slot: count, min, max, running sum (avg), overruns, log2 histogram
+ *   - Histogram bins are fractions of the block deadline:
+ *     <1/128, <1/64, <1/32, <1/16, <1/8, <1/4, <1/2, >=1/2
+ * - Deadline = one audio block period (128 samples @ 44.1kHz = 2.9ms, 32 samples = 0.73ms)
+ * - record() is wait-free (ISR only writer); getStats() copies under a
+ *   short interrupt lock so min/max/sum are consistent
+ *
+ * USAGE:
+ *   DspProfiler::begin(AUDIO_BLOCK_SAMPLES, Timebase::SAMPLE_RATE);
+ *   uint8_t slot = DspProfiler::registerSlot("Choke");   // Setup only
+ *
+ *   uint32_t start = DspProfiler::now();                  // Audio ISR
+ *   processBlock(dataL, dataR);
+ *   DspProfiler::record(slot, DspProfiler::now() - start);
+ *   DspProfiler::endBlock();                               // Once per audio block
+ *
+ *   DspProfiler::Stats stats;                              // App thread
+ *   if (DspProfiler::getStats(slot, stats)) { ... }
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__ARM_ARCH_7EM__)
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+class DspProfiler {
+public:
+    // ========== CONFIGURATION ==========
+    static constexpr uint8_t MAX_SLOTS = 6;
+    static constexpr uint8_t HIST_BINS = 8;
+    static constexpr uint8_t TOTAL_SLOT = 0;
+    static constexpr uint8_t INVALID_SLOT = 0xFF;
+
+    /**
+     * Snapshot of one slot (times in ticks - see ticksToNanos())
+     */
+    struct Stats {
+        const char* name;
+        uint32_t count;                  // Blocks measured
+        uint32_t minTicks;
+        uint32_t avgTicks;
+        uint32_t maxTicks;
+        uint32_t overruns;               // Measurements longer than the block deadline
+        uint32_t histogram[HIST_BINS];   // See binUpperPermille()
+    };
+
+    /**
+     * Set the block deadline and register the Total slot
+     * Call once during setup (re-calling only updates the deadline)
+     *
+     * @param blockSamples Samples per audio block
+     * @param sampleRate Audio sample rate (Hz)
+     */
+    static void begin(uint32_t blockSamples, uint32_t sampleRate);
+
+    /**
+     * Register a named slot (setup only, not thread-safe)
+     *
+     * @param name Static string (not copied)
+     * @return Slot index, or INVALID_SLOT if full
+     */
+    static uint8_t registerSlot(const char* name);
+
+    static uint8_t getNumSlots() { return s_numSlots; }
+
+    /**
+     * Current timestamp in ticks (wraps; only differences are meaningful)
+     */
+    static inline uint32_t now() {
+#if defined(__ARM_ARCH_7EM__)
+        return ARM_DWT_CYCCNT;
+#else
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /**
+     * Record one measurement (audio ISR)
+     * Also adds to the running block total. INVALID_SLOT is ignored.
+     */
+    static void record(uint8_t slot, uint32_t ticks);
+
+    /**
+     * Close the current audio block (audio ISR, once per block)
+     * Records the sum of this block's measurements into the Total slot.
+     */
+    static void endBlock();
+
+    /**
+     * Close the current audio block with an explicitly measured total
+     * (used when one node times the whole block itself)
+     */
+    static void endBlock(uint32_t blockTicks);
+
+    /**
+     * Copy one slot's statistics (app thread)
+     *
+     * @return false if slot is not registered
+     */
+    static bool getStats(uint8_t slot, Stats& out);
+
+    /**
+     * Clear all statistics (slots stay registered)
+     */
+    static void reset();
+
+    /**
+     * Block deadline in ticks
+     */
+    static uint32_t getDeadlineTicks() { return s_deadlineTicks; }
+
+    /**
+     * Convert ticks to nanoseconds (cycles at F_CPU_ACTUAL on Teensy)
+     */
+    static uint32_t ticksToNanos(uint32_t ticks);
+
+    /**
+     * Ticks as a fraction of the block deadline (1000 = whole deadline)
+     */
+    static uint32_t toPermille(uint32_t ticks);
+
+    /**
+     * Upper edge of a histogram bin in permille of the deadline
+     * (last bin is open-ended: returns 0)
+     */
+    static uint32_t binUpperPermille(uint8_t bin);
+
+private:
+    struct Slot {
+        const char* name;
+        uint32_t count;
+        uint32_t minTicks;
+        uint32_t maxTicks;
+        uint64_t sumTicks;
+        uint32_t overruns;
+        uint32_t histogram[HIST_BINS];
+    };
+
+    static void recordSlot(Slot& slot, uint32_t ticks);
+    static void clearSlot(Slot& slot);
+
+    static Slot s_slots[MAX_SLOTS];
+    static uint8_t s_numSlots;
+    static uint32_t s_deadlineTicks;
+    static uint32_t s_blockTicks;    // Sum of measurements in the current block (ISR only)
+};
@@ -5,11 +5,13 @@
 #include "Timebase.h"
 #include "Trace.h"
 
-// AUDIO_BLOCK_SAMPLES is defined by Teensy Audio Library as 128
+// AUDIO_BLOCK_SAMPLES comes from the core's AudioStream.h (set by the build: 32, 64 or 128)
 // We can't include <Audio.h> here due to SD card dependencies
-#ifndef AUDIO_BLOCK_SAMPLES
-#define AUDIO_BLOCK_SAMPLES 128
-#endif
+#include <AudioStream.h>
+
+// Grace period past a boundary that still counts as "on time" (app thread polling jitter)
+// 1/8 block: 16 samples (~0.36ms) at 128, 4 samples at 32
+static constexpr uint32_t BOUNDARY_GRACE_SAMPLES = AUDIO_BLOCK_SAMPLES / 8;
 
 // ========== STATIC MEMBER INITIALIZATION ==========
 
@@ -76,37 +78,31 @@ uint64_t Timebase::getSamplePosition() {
 
 // ========== MIDI TIMELINE ==========
 
-void Timebase::syncToMIDIClock(uint32_t tickPeriodUs) {
+void Timebase::syncToMIDIClock(uint32_t tickPeriodQ8) {
     /**
      * Convert MIDI tick period to samples per beat
      *
      * FORMULA:
      *   beatPeriodUs = tickPeriodUs * 24  (24 ticks per beat)
      *   samplesPerBeat = beatPeriodUs * (sampleRate / 1e6)
-     *                  = tickPeriodUs * 24 * (44100 / 1000000)
-     *                  = tickPeriodUs * 24 * 0.04410
-     *                  = tickPeriodUs * 1.0584
      *
-     * To avoid floating point, use integer math:
-     *   samplesPerBeat = (tickPeriodUs * 24 * SAMPLE_RATE) / 1000000
+     * To avoid floating point, use integer math (tick period in Q8 microseconds):
+     *   samplesPerBeat = (tickPeriodQ8 * 24 * SAMPLE_RATE + half) / (1000000 << 8)
      *
      * PRECISION:
-     *   At 120 BPM: tickPeriodUs = 20833µs
-     *   samplesPerBeat = (20833 * 24 * 44100) / 1000000
-     *                  = 22049.9... ≈ 22050 samples
+     *   At 120 BPM: tickPeriodQ8 = 5333333 (20833.33µs)
+     *   samplesPerBeat = 22050.0 @ 44.1kHz, 24000.0 @ 48kHz, 48000.0 @ 96kHz
+     *   (a whole-µs period of 20833 would give 22049 / 23999 / 47999 truncated)
      *
      * OVERFLOW PROTECTION:
-     *   tickPeriodUs: max ~50000 (60 BPM)
-     *   Intermediate: 50000 * 24 * 44100 = 52,920,000,000
+     *   tickPeriodQ8: max MAX_TICK_PERIOD_US << 8 (~83334 << 8, MIN_BPM)
+     *   Intermediate: 21,333,504 * 24 * 96000 = 4.9e13
      *   Fits in uint64_t (max 18 quintillion)
      */
-    uint64_t beatPeriodUs = (uint64_t)tickPeriodUs * MIDI_PPQN;
-    uint32_t spb = (beatPeriodUs * SAMPLE_RATE) / 1000000ULL;
+    uint32_t spb = samplesPerBeatFromTick(tickPeriodQ8);
 
-    // Sanity check: Reject absurd tempos (30-300 BPM range)
-    // At 30 BPM: samplesPerBeat = 88200
-    // At 300 BPM: samplesPerBeat = 8820
-    if (spb >= 8000 && spb <= 100000) {
+    // Sanity check: Reject absurd tempos (MIN_BPM-MAX_BPM range, derived from SAMPLE_RATE)
+    if (spb >= MIN_SAMPLES_PER_BEAT && spb <= MAX_SAMPLES_PER_BEAT) {
         __atomic_store_n(&s_samplesPerBeat, spb, __ATOMIC_RELAXED);
 
         // Trace sync event with BPM
@@ -215,7 +211,7 @@ uint32_t Timebase::samplesToNextBeat() {
      *   This avoids timing drift issues between MIDI beat tracking and audio samples.
      *
      * NEAR-BOUNDARY TOLERANCE (NEW):
-     *   If we're very close to a beat boundary (within 128 samples = 1 audio block),
+     *   If we're very close to a beat boundary (within 1 audio block),
      *   return 0 to fire immediately. This prevents "just missed it" latency where
      *   pressing exactly on the beat adds a full beat of delay.
      *
@@ -235,9 +231,9 @@ uint32_t Timebase::samplesToNextBeat() {
     uint32_t samplesToNext = spb - sampleWithinBeat;
 
     // TOLERANCE: Only fire immediately if we're AT or slightly PAST the boundary
-    // Grace period: If we're within 16 samples (~0.36ms) PAST the boundary, treat as "on time"
+    // Grace period: If we're within BOUNDARY_GRACE_SAMPLES PAST the boundary, treat as "on time"
     // This handles "just missed it by a few samples" without firing early
-    if (sampleWithinBeat <= 16) {
+    if (sampleWithinBeat <= BOUNDARY_GRACE_SAMPLES) {
         return 0;  // We're at or just past the boundary - fire now!
     }
 
@@ -267,8 +263,8 @@ uint32_t Timebase::samplesToNextSubdivision(uint32_t subdivision) {
 
     // Calculate how many samples we've progressed into current beat
     // based on MIDI tick position (not absolute sample position)
-    uint32_t samplesPerTick = spb / MIDI_PPQN;  // MIDI_PPQN = 24
-    uint32_t samplesElapsedInBeat = tickInBeat * samplesPerTick;
+    // Multiply before dividing: spb / 24 is fractional at most tempos and rates
+    uint32_t samplesElapsedInBeat = (tickInBeat * spb) / MIDI_PPQN;  // MIDI_PPQN = 24
 
     // For 1/4 note (full beat), just return samples remaining in beat
     if (subdivision >= spb) {
@@ -301,7 +297,7 @@ uint32_t Timebase::samplesToNextBar() {
      *   - NEW: Uses position % samplesPerBar (relative) → always accurate
      *
      * TOLERANCE:
-     *   Same as samplesToNextBeat() - fire immediately if within 128 samples
+     *   Same as samplesToNextBeat() - fire immediately if within BOUNDARY_GRACE_SAMPLES
      */
     uint64_t currentSample = getSamplePosition();
     uint32_t spb = getSamplesPerBeat();
@@ -314,8 +310,8 @@ uint32_t Timebase::samplesToNextBar() {
     uint32_t samplesToNext = samplesPerBar - sampleWithinBar;
 
     // TOLERANCE: Only fire immediately if AT or slightly PAST boundary
-    // Grace period: 16 samples (~0.36ms) past boundary
-    if (sampleWithinBar <= 16) {
+    // Grace period: BOUNDARY_GRACE_SAMPLES past boundary
+    if (sampleWithinBar <= BOUNDARY_GRACE_SAMPLES) {
         return 0;  // At or just past boundary - fire now!
     }
 
@@ -343,7 +339,7 @@ bool Timebase::isOnBeatBoundary() {
     /**
      * Check if current position is within one audio block of a beat boundary
      *
-     * TOLERANCE: ±AUDIO_BLOCK_SAMPLES (±128 samples ≈ ±2.9ms)
+     * TOLERANCE: +AUDIO_BLOCK_SAMPLES (one block: 2.9ms at 128, 0.73ms at 32)
      *
      * This accounts for:
      * - Audio block granularity (we can't start/stop mid-block)
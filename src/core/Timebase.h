@@ -3,7 +3,7 @@
  *
  * PURPOSE:
  * Single source of timing truth that bridges MIDI clock (24 PPQN) and audio
- * samples (44.1kHz). Essential for quantization, loop recording, and any
+ * samples (44.1, 48 or 96kHz - MICROLOOP_SAMPLE_RATE). Essential for quantization, loop recording, and any
  * feature that needs to know "what time is it?" in the audio world.
  *
  * DESIGN:
@@ -17,7 +17,7 @@
  *   Timebase::incrementSamples(AUDIO_BLOCK_SAMPLES);
  *
  *   // In app thread (when MIDI clock ticks):
- *   Timebase::syncToMIDIClock(avgTickPeriodUs);
+ *   Timebase::syncToMIDIClock(avgTickPeriodQ8);  // Microseconds, 8 fractional bits
  *
  *   // In any thread (query timing):
  *   uint64_t now = Timebase::getSamplePosition();
@@ -28,6 +28,8 @@
  * - Sample position: Absolute sample count since audio start (monotonic)
  * - Beat position: Musical beat number (0, 1, 2, 3...), synced to MIDI clock
  * - Samples per beat: Calibrated from MIDI clock period (handles tempo changes)
+ * - Sample rate: build-time constant; every rate-derived constant (tempo range,
+ *   default tempo, ms -> samples) is computed from SAMPLE_RATE
  * - Bar: 4 beats (assumes 4/4 time signature)
  *
  * THREAD SAFETY:
@@ -40,16 +42,62 @@
 
 #include <Arduino.h>
 
+// Set by the build (MICROLOOP_SAMPLE_RATE: 44100, 48000 or 96000)
+#ifndef MICROLOOP_SAMPLE_RATE
+#define MICROLOOP_SAMPLE_RATE 44100
+#endif
+
 class Timebase {
 public:
     // Audio configuration
-    static constexpr uint32_t SAMPLE_RATE = 44100;        // Hz
-    // Note: AUDIO_BLOCK_SAMPLES is defined by Teensy Audio Library (128)
+    static constexpr uint32_t SAMPLE_RATE = MICROLOOP_SAMPLE_RATE;  // Hz
+    // Note: AUDIO_BLOCK_SAMPLES is set by the build (MICROLOOP_BLOCK_SAMPLES: 32, 64 or 128)
     static constexpr uint32_t BEATS_PER_BAR = 4;          // 4/4 time signature
 
+    static_assert(SAMPLE_RATE == 44100 || SAMPLE_RATE == 48000 || SAMPLE_RATE == 96000,
+                  "Supported sample rates: 44100, 48000, 96000");
+
     // MIDI configuration
     static constexpr uint32_t MIDI_PPQN = 24;  // Pulses Per Quarter Note
 
+    // Tick periods carry 8 fractional bits (1/256 us) so tempo stays exact at any rate
+    static constexpr uint32_t TICK_PERIOD_FRAC_BITS = 8;
+
+    // Accepted tempo range (syncToMIDIClock ignores anything outside)
+    static constexpr uint32_t MIN_BPM = 30;
+    static constexpr uint32_t MAX_BPM = 300;
+    static constexpr uint32_t MIN_SAMPLES_PER_BEAT = (SAMPLE_RATE * 60) / MAX_BPM;  // 8820 @ 44.1kHz
+    static constexpr uint32_t MAX_SAMPLES_PER_BEAT = (SAMPLE_RATE * 60) / MIN_BPM;  // 88200 @ 44.1kHz
+    // MIDI clock tick periods spanning that range (us, rounded outward - syncToMIDIClock has the final say)
+    static constexpr uint32_t MIN_TICK_PERIOD_US = 60000000u / (MAX_BPM * MIDI_PPQN);  // 8333
+    static constexpr uint32_t MAX_TICK_PERIOD_US =
+        (60000000u + MIN_BPM * MIDI_PPQN - 1) / (MIN_BPM * MIDI_PPQN);                  // 83334
+
+    // ========== RATE CONVERSION (pure, usable in constant expressions) ==========
+
+    /**
+     * Samples per beat for a MIDI tick period, rounded to nearest
+     *
+     * FORMULA: (tickPeriodQ8 * 24 * sampleRate) / (1e6 * 256), 64-bit intermediate
+     * Exact (matches round(sampleRate * 60 / bpm)) for every integer BPM in range
+     *
+     * @param tickPeriodQ8 Microseconds between MIDI clock ticks, 8 fractional bits
+     * @param sampleRate Sample rate in Hz (defaults to the build's rate)
+     */
+    static constexpr uint32_t samplesPerBeatFromTick(uint32_t tickPeriodQ8,
+                                                     uint32_t sampleRate = SAMPLE_RATE) {
+        return static_cast<uint32_t>(
+            (static_cast<uint64_t>(tickPeriodQ8) * MIDI_PPQN * sampleRate + (500000ULL << TICK_PERIOD_FRAC_BITS)) /
+            (1000000ULL << TICK_PERIOD_FRAC_BITS));
+    }
+
+    /**
+     * Milliseconds to samples (truncating, like the original per-effect conversions)
+     */
+    static constexpr uint32_t msToSamples(uint32_t ms, uint32_t sampleRate = SAMPLE_RATE) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(ms) * sampleRate) / 1000);
+    }
+
     /**
      * Initialize timing system
      * Call once during setup(), before starting audio/MIDI
@@ -89,19 +137,21 @@ public:
      * Updates samples-per-beat based on MIDI clock period.
      * Uses exponential moving average for smooth tempo tracking.
      *
-     * FORMULA:
-     *   tickPeriodUs = time between MIDI clock ticks (microseconds)
+     * FORMULA: see samplesPerBeatFromTick()
      *   beatPeriodUs = tickPeriodUs * 24  (24 ticks per beat)
      *   samplesPerBeat = beatPeriodUs * (SAMPLE_RATE / 1e6)
      *
      * EXAMPLE:
-     *   At 120 BPM: tickPeriodUs ≈ 20833µs
-     *   beatPeriodUs = 20833 * 24 = 500000µs = 0.5s
-     *   samplesPerBeat = 500000 * (44100 / 1e6) = 22050 samples
+     *   At 120 BPM: tickPeriodUs = 20833.33µs (Q8: 5333333)
+     *   beatPeriodUs = 500000µs = 0.5s
+     *   samplesPerBeat = 22050 @ 44.1kHz, 24000 @ 48kHz, 48000 @ 96kHz
+     *
+     * WHY FRACTIONAL: a whole-microsecond tick period is off by up to 0.5µs,
+     * which is 24 * 0.5µs per beat - already ~1 sample at 96kHz
      *
-     * @param tickPeriodUs Microseconds between MIDI clock ticks (from EMA)
+     * @param tickPeriodQ8 Microseconds between MIDI clock ticks, 8 fractional bits (from EMA)
      */
-    static void syncToMIDIClock(uint32_t tickPeriodUs);
+    static void syncToMIDIClock(uint32_t tickPeriodQ8);
 
     /**
      * Manually set samples per beat (for testing or manual tempo)
@@ -219,7 +269,8 @@ public:
      * recording to align with the next beat?"
      *
      * TOLERANCE (NEW):
-     *   If within AUDIO_BLOCK_SAMPLES (128) of boundary, returns 0 to fire immediately.
+     *   If within a short grace period (1/8 audio block) past the boundary, returns 0
+     *   to fire immediately.
      *   This prevents "just missed it" latency where pressing exactly on beat adds
      *   a full beat of delay.
      *
@@ -239,10 +290,10 @@ public:
      *   - 1/4 note  = samplesPerBeat      (1 quarter note per beat)
      *
      * TOLERANCE:
-     *   Same as samplesToNextBeat() - returns 0 if within 128 samples of boundary
+     *   Same as samplesToNextBeat() - returns 0 if within the grace period
      *
      * BLOCK ROUNDING (NEW):
-     *   Result is rounded up to next AUDIO_BLOCK_SAMPLES (128) boundary.
+     *   Result is rounded up to next AUDIO_BLOCK_SAMPLES boundary.
      *   This prevents "just missed it by 50 samples" jitter from app thread polling.
      *
      * @param subdivision Subdivision size in samples (from calculateQuantizedDuration)
@@ -348,5 +399,5 @@ private:
 
     //avoid division by 0, set sensible defaults
     static constexpr uint32_t DEFAULT_BPM = 120;
-    static constexpr uint32_t DEFAULT_SAMPLES_PER_BEAT = (SAMPLE_RATE * 60) / DEFAULT_BPM;  // 22050 @ 120 BPM
+    static constexpr uint32_t DEFAULT_SAMPLES_PER_BEAT = (SAMPLE_RATE * 60) / DEFAULT_BPM;  // 22050 @ 120 BPM, 44.1kHz
 };
@@ -53,8 +53,10 @@ enum TraceEventId : uint16_t {
     TRACE_APP_EVENT_DRAIN = 202,    // Draining event queue (value = count drained)
 
     // Audio (300-399)
-    TRACE_AUDIO_CALLBACK = 300,     // Audio callback invoked
-    TRACE_AUDIO_UNDERRUN = 301,     // Audio buffer underrun
+    TRACE_AUDIO_CALLBACK = 300,         // Audio callback invoked
+    TRACE_AUDIO_UNDERRUN = 301,         // Block degraded (value = node tag << 8 | PoolFallback)
+    TRACE_AUDIO_POOL_HIGH_WATER = 302,  // New block pool peak (value = blocks in use)
+    TRACE_AUDIO_POOL_EXHAUSTED = 303,   // Pool peak reached its size (allocations can fail)
 
     // TimeKeeper (400-499)
     TRACE_TIMEKEEPER_SYNC = 400,         // TimeKeeper synced to MIDI (value = BPM)
@@ -175,6 +177,8 @@ public:
             case TRACE_APP_EVENT_DRAIN: return "APP_EVENT_DRAIN";
             case TRACE_AUDIO_CALLBACK: return "AUDIO_CALLBACK";
             case TRACE_AUDIO_UNDERRUN: return "AUDIO_UNDERRUN";
+            case TRACE_AUDIO_POOL_HIGH_WATER: return "AUDIO_POOL_HIGH_WATER";
+            case TRACE_AUDIO_POOL_EXHAUSTED: return "AUDIO_POOL_EXHAUSTED";
             case TRACE_TIMEKEEPER_SYNC: return "TIMEKEEPER_SYNC";
             case TRACE_TIMEKEEPER_TRANSPORT: return "TIMEKEEPER_TRANSPORT";
             case TRACE_TIMEKEEPER_BEAT_ADVANCE: return "TIMEKEEPER_BEAT_ADVANCE";
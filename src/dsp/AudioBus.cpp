@@ -0,0 +1,47 @@
+#include "AudioBus.h"
+
+namespace AudioBus {
+
+void widenBlock(const int16_t* src, int32_t* dst, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; i++) {
+        dst[i] = widen(src[i]);
+    }
+}
+
+void narrowBlock(const int32_t* src, int16_t* dst, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; i++) {
+        dst[i] = narrow(src[i]);
+    }
+}
+
+/**
+ * Triangular dither in bus units: u1 + u2 - 255, u1/u2 uniform in [0, 255]
+ * Range (-1, +1) int16 LSB, zero mean
+ */
+static inline int32_t tpdf(uint32_t bits) {
+    return static_cast<int32_t>(bits & 0xFF) + static_cast<int32_t>((bits >> 8) & 0xFF) - 255;
+}
+
+void narrowBlockDithered(const int32_t* src, int16_t* dst, size_t numSamples, uint32_t& rngState) {
+    static_assert(SHIFT == 8, "TPDF generator produces 8-bit uniforms");
+
+    uint32_t x = rngState;
+    size_t i = 0;
+    for (; i + 1 < numSamples; i += 2) {
+        // xorshift32: one word = two TPDF values
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        dst[i] = narrow(src[i] + tpdf(x));
+        dst[i + 1] = narrow(src[i + 1] + tpdf(x >> 16));
+    }
+    if (i < numSamples) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        dst[i] = narrow(src[i] + tpdf(x));
+    }
+    rngState = x;
+}
+
+}
@@ -0,0 +1,71 @@
+/**
+ * AudioBus.h - 32-bit internal processing bus and output dither
+ *
+ * PURPOSE:
+ * Gives the effect chain resolution and headroom between stages: effects
+ * process int32 frames, the chain converts from int16 once at input and
+ * back to int16 once at output with TPDF dither.
+ *
+ * DESIGN:
+ * - Bus sample = int16 sample << SHIFT (8 fractional bits below the 16-bit
+ *   LSB, 7 bits of headroom above 0 dBFS - intermediate overs are not clipped)
+ * - Input: exact (widen)
+ * - Storage (loop/history/capture rings stay int16): round + saturate (narrow)
+ * - Output: TPDF dither of +/-1 LSB (sum of two uniform 8-bit values from one
+ *   xorshift32 word per two samples), then round + saturate
+ * - Cortex-M7: SSAT with shift does round-then-saturate in one instruction
+ *
+ * USAGE:
+ *   AudioBus::widenBlock(blockL->data, busL, AUDIO_BLOCK_SAMPLES);
+ *   ... effects process busL/busR ...
+ *   AudioBus::narrowBlockDithered(busL, blockL->data, AUDIO_BLOCK_SAMPLES, rngState);
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__ARM_ARCH_7EM__)
+#include "utility/dspinst.h"
+#endif
+
+namespace AudioBus {
+
+// Fractional bits below the int16 LSB
+constexpr uint32_t SHIFT = 8;
+constexpr int32_t ROUND = 1 << (SHIFT - 1);
+
+/**
+ * int16 -> bus (exact)
+ */
+inline int32_t widen(int16_t sample) {
+    return static_cast<int32_t>(sample) << SHIFT;
+}
+
+/**
+ * bus -> int16, rounded and saturated (no dither - for storage)
+ */
+inline int16_t narrow(int32_t sample) {
+    // Avoid wrapping when rounding the largest bus values
+    int32_t x = (sample < INT32_MAX - ROUND) ? sample + ROUND : INT32_MAX;
+#if defined(__ARM_ARCH_7EM__)
+    return static_cast<int16_t>(signed_saturate_rshift(x, 16, SHIFT));
+#else
+    x >>= SHIFT;
+    return static_cast<int16_t>(x > 32767 ? 32767 : (x < -32768 ? -32768 : x));
+#endif
+}
+
+void widenBlock(const int16_t* src, int32_t* dst, size_t numSamples);
+
+void narrowBlock(const int32_t* src, int16_t* dst, size_t numSamples);
+
+/**
+ * bus -> int16 with TPDF dither (chain output)
+ *
+ * @param rngState xorshift32 state (never 0), advanced once per two samples
+ */
+void narrowBlockDithered(const int32_t* src, int16_t* dst, size_t numSamples, uint32_t& rngState);
+
+}
@@ -0,0 +1,47 @@
+#include "AudioPoolMonitor.h"
+#include "Trace.h"
+#include <AudioStream.h>
+
+uint16_t AudioPoolMonitor::s_poolBlocks = 0;
+volatile uint16_t AudioPoolMonitor::s_peakBlocks = 0;
+volatile uint32_t AudioPoolMonitor::s_fallbacks[POOL_FALLBACK_COUNT] = {};
+
+void AudioPoolMonitor::begin(uint16_t poolBlocks) {
+    s_poolBlocks = poolBlocks;
+}
+
+void AudioPoolMonitor::update() {
+    uint16_t used = AudioStream::memory_used_max;
+    if (used <= s_peakBlocks) {
+        return;
+    }
+    s_peakBlocks = used;
+    TRACE(TRACE_AUDIO_POOL_HIGH_WATER, used);
+    if (s_poolBlocks > 0 && used >= s_poolBlocks) {
+        TRACE(TRACE_AUDIO_POOL_EXHAUSTED, used);
+    }
+}
+
+void AudioPoolMonitor::recordFallback(uint8_t nodeTag, PoolFallback kind) {
+    uint8_t index = static_cast<uint8_t>(kind);
+    if (index >= POOL_FALLBACK_COUNT) {
+        return;
+    }
+    s_fallbacks[index] = s_fallbacks[index] + 1;
+    TRACE(TRACE_AUDIO_UNDERRUN, static_cast<uint16_t>((nodeTag << 8) | index));
+}
+
+uint32_t AudioPoolMonitor::getFallbackCount(PoolFallback kind) {
+    uint8_t index = static_cast<uint8_t>(kind);
+    return (index < POOL_FALLBACK_COUNT) ? s_fallbacks[index] : 0;
+}
+
+const char* AudioPoolMonitor::fallbackName(PoolFallback kind) {
+    switch (kind) {
+        case PoolFallback::HELD:        return "held";
+        case PoolFallback::PASSTHROUGH: return "pass";
+        case PoolFallback::MONO:        return "mono";
+        case PoolFallback::DROPPED:     return "drop";
+        default:                        return "?";
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * AudioPoolMonitor.h - Audio block pool high-water tracking and underrun accounting
+ *
+ * PURPOSE:
+ * The Audio library's pool (AudioMemory(n)) fails allocate() silently when it
+ * runs dry. This keeps a boot-long record of how close the pool came to that,
+ * and counts every block a node had to degrade (see GuardedStream).
+ *
+ * DESIGN:
+ * - update() once per audio block (ISR): folds AudioStream::memory_used_max
+ *   into a peak that the serial 'a' command's max reset does not clear
+ *   - New peak: TRACE_AUDIO_POOL_HIGH_WATER (value = blocks in use)
+ *   - Peak reaching the pool size: TRACE_AUDIO_POOL_EXHAUSTED (allocations can fail)
+ * - recordFallback() (ISR): global count per fallback kind,
+ *   TRACE_AUDIO_UNDERRUN (value = node tag << 8 | kind)
+ * - Counters are 32-bit words written only by the audio ISR
+ *
+ * USAGE:
+ *   AudioMemory(AUDIO_MEMORY_BLOCKS);
+ *   AudioPoolMonitor::begin(AUDIO_MEMORY_BLOCKS);
+ *
+ *   AudioPoolMonitor::update();                    // Audio ISR, once per block
+ *
+ *   Serial.print(AudioPoolMonitor::getPeakBlocks());  // App thread
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * How a node degraded one block (see GuardedStream)
+ */
+enum class PoolFallback : uint8_t {
+    HELD = 0,          // Input missing: replaced by the last input, faded out
+    PASSTHROUGH = 1,   // No block for copy-on-write: input sent on unprocessed
+    MONO = 2,          // One channel missing: the other sent on both outputs
+    DROPPED = 3        // Nothing to send: output dropout
+};
+
+static constexpr uint8_t POOL_FALLBACK_COUNT = 4;
+
+class AudioPoolMonitor {
+public:
+    /**
+     * Set the pool size (blocks passed to AudioMemory())
+     */
+    static void begin(uint16_t poolBlocks);
+
+    /**
+     * Track the pool high-water mark (audio ISR, once per block)
+     */
+    static void update();
+
+    /**
+     * Count and trace one degraded block (audio ISR)
+     *
+     * @param nodeTag Node identifier for the trace (EffectID, 0 = chain)
+     */
+    static void recordFallback(uint8_t nodeTag, PoolFallback kind);
+
+    static uint16_t getPoolBlocks() { return s_poolBlocks; }
+
+    /**
+     * Most blocks in use at once since boot
+     */
+    static uint16_t getPeakBlocks() { return s_peakBlocks; }
+
+    /**
+     * Blocks degraded by kind, all nodes, since boot
+     */
+    static uint32_t getFallbackCount(PoolFallback kind);
+
+    /**
+     * Short name for printing ("held", "pass", "mono", "drop")
+     */
+    static const char* fallbackName(PoolFallback kind);
+
+private:
+    static uint16_t s_poolBlocks;
+    static volatile uint16_t s_peakBlocks;
+    static volatile uint32_t s_fallbacks[POOL_FALLBACK_COUNT];
+};
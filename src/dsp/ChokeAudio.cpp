@@ -1,8 +1,17 @@
 #include "ChokeAudio.h"
 
+// Per-block ramp shared by both channels (internal RAM, word-aligned for packed loads)
+static int16_t s_rampGains[AUDIO_BLOCK_SAMPLES] __attribute__((aligned(4)));
+
+// Per-block gate pattern gains (GATE mode)
+static int16_t s_gateGains[AUDIO_BLOCK_SAMPLES] __attribute__((aligned(4)));
+
 ChokeAudio::ChokeAudio() : IEffectAudio(2) {  // Call base with 2 inputs (stereo)
-    m_targetGain = 1.0f;      // Start unmuted
-    m_currentGain = 1.0f;
+    m_targetGain = GainRamp::UNITY_Q15;  // Start unmuted (envelope starts settled at unity)
+    m_fade = ChokeFade::MS_3;            // Default: 3ms (tight feel for quantization)
+    m_curve = FadeCurve::LINEAR;
+    m_mode = ChokeMode::MUTE;            // Default: classic mute
+    m_gateRunning = false;
     m_state.store(ChokeState::IDLE, std::memory_order_relaxed);  // Start in IDLE state
     m_lengthMode = ChokeLength::FREE;  // Default: free mode
     m_onsetMode = ChokeOnset::FREE;    // Default: free mode
@@ -11,12 +20,12 @@ ChokeAudio::ChokeAudio() : IEffectAudio(2) {  // Call base with 2 inputs (stereo
 }
 
 void ChokeAudio::enable() {
-    m_targetGain = 0.0f;  // Mute
+    m_targetGain = 0;  // Mute
     m_state.store(ChokeState::ACTIVE, std::memory_order_release);
 }
 
 void ChokeAudio::disable() {
-    m_targetGain = 1.0f;  // Unmute
+    m_targetGain = GainRamp::UNITY_Q15;  // Unmute
     m_state.store(ChokeState::IDLE, std::memory_order_release);
 }
 
@@ -37,16 +46,45 @@ const char* ChokeAudio::getName() const {
     return "Choke";
 }
 
-void ChokeAudio::update() {
+uint32_t ChokeAudio::fadeToSamples(ChokeFade fade) {
+    uint32_t ms;
+    switch (fade) {
+        case ChokeFade::MS_1:  ms = 1; break;
+        case ChokeFade::MS_3:  ms = 3; break;
+        case ChokeFade::MS_5:  ms = 5; break;
+        case ChokeFade::MS_10: ms = 10; break;
+        case ChokeFade::MS_20: ms = 20; break;
+        case ChokeFade::MS_50: ms = 50; break;
+        default: ms = 3; break;
+    }
+    return Timebase::msToSamples(ms);  // 3ms = 132 samples @ 44.1kHz, 144 @ 48kHz
+}
+
+void ChokeAudio::processBlock(int32_t* dataL, int32_t* dataR) {
     uint64_t currentSample = Timebase::getSamplePosition();
     uint64_t blockEndSample = currentSample + AUDIO_BLOCK_SAMPLES;
 
+    // Gain events in this block, in sample order (offset within block, target gain)
+    struct GainEvent {
+        uint32_t offset;
+        int32_t target;
+    };
+    GainEvent events[3];
+    uint8_t numEvents = 0;
+
+    // Free onset/release from the thread (enable/disable) take effect at block start
+    int32_t threadTarget = m_targetGain;
+    if (threadTarget != m_envelope.getTarget()) {
+        events[numEvents++] = {0, threadTarget};
+    }
+
     // Check for scheduled onset (ISR-accurate quantized onset)
     // Fire if the scheduled sample falls within this audio block [currentSample, blockEndSample)
     if (m_onsetAtSample > 0 && m_onsetAtSample >= currentSample && m_onsetAtSample < blockEndSample) {
-        // Time to engage choke (block-accurate - best we can do in ISR)
+        // Sample-accurate: fade starts at the scheduled offset within this block
         // Transition: ARMED -> ACTIVE
-        m_targetGain = 0.0f;  // Mute
+        events[numEvents++] = {static_cast<uint32_t>(m_onsetAtSample - currentSample), 0};
+        m_targetGain = 0;  // Mute
         m_state.store(ChokeState::ACTIVE, std::memory_order_release);
         m_onsetAtSample = 0;  // Clear scheduled onset
     }
@@ -54,55 +92,83 @@ void ChokeAudio::update() {
     // Check for scheduled release (ISR-accurate quantized length)
     // Fire if the scheduled sample falls within this audio block [currentSample, blockEndSample)
     if (m_releaseAtSample > 0 && m_releaseAtSample >= currentSample && m_releaseAtSample < blockEndSample) {
-        // Time to auto-release (block-accurate)
+        // Sample-accurate: fade starts at the scheduled offset within this block
         // Transition: ACTIVE -> IDLE
-        m_targetGain = 1.0f;  // Unmute
+        events[numEvents++] = {static_cast<uint32_t>(m_releaseAtSample - currentSample), GainRamp::UNITY_Q15};
+        m_targetGain = GainRamp::UNITY_Q15;  // Unmute
         m_state.store(ChokeState::IDLE, std::memory_order_release);
         m_releaseAtSample = 0;  // Clear scheduled release
     }
 
-    // Receive input blocks (left and right channels)
-    audio_block_t* blockL = receiveWritable(0);
-    audio_block_t* blockR = receiveWritable(1);
-
-    // Calculate gain increment per sample for smooth fade
-    // Fade time: 10ms = 441 samples @ 44.1kHz
-    // Over 128-sample block, we traverse: 128/441 of the fade
-    const float gainIncrement = (m_targetGain - m_currentGain) / FADE_SAMPLES;
-
-    // Process left channel
-    if (blockL) {
-        applyGainRamp(blockL->data, AUDIO_BLOCK_SAMPLES, gainIncrement);
-        transmit(blockL, 0);
-        release(blockL);
+    // Onset and release may share a block (short quantized lengths) - keep sample order
+    if (numEvents == 3 && events[1].offset > events[2].offset) {
+        GainEvent tmp = events[1];
+        events[1] = events[2];
+        events[2] = tmp;
+    } else if (numEvents == 2 && events[0].offset > events[1].offset) {
+        GainEvent tmp = events[0];
+        events[0] = events[1];
+        events[1] = tmp;
     }
 
-    // Process right channel
-    if (blockR) {
-        applyGainRamp(blockR->data, AUDIO_BLOCK_SAMPLES, gainIncrement);
-        transmit(blockR, 1);
-        release(blockR);
+    bool gateMode = (m_mode == ChokeMode::GATE);
+    bool settled = (numEvents == 0 && m_envelope.isSettled());
+
+    if (settled && m_envelope.getGain() == GainRamp::UNITY_Q15) {
+        // Settled unmuted: pass through untouched (gate restarts on the grid next time)
+        m_gateRunning = false;
+    } else if (settled && !gateMode) {
+        // Settled muted: silence
+        m_gateRunning = false;
+        memset(dataL, 0, AUDIO_BLOCK_SAMPLES * sizeof(int32_t));
+        memset(dataR, 0, AUDIO_BLOCK_SAMPLES * sizeof(int32_t));
+    } else if (settled) {
+        // Settled gating: pattern gains only
+        if (!m_gateRunning) {
+            m_gate.sync();
+            m_gateRunning = true;
+        }
+        m_gate.render(s_gateGains, AUDIO_BLOCK_SAMPLES);
+        GainRamp::applyBus(dataL, s_gateGains, AUDIO_BLOCK_SAMPLES);
+        GainRamp::applyBus(dataR, s_gateGains, AUDIO_BLOCK_SAMPLES);
+    } else {
+        // Render one envelope for the block (events start fades mid-block), shared by both channels
+        uint32_t fadeSamples = fadeToSamples(m_fade);
+        FadeCurve curve = m_curve;
+        uint32_t pos = 0;
+        for (uint8_t e = 0; e < numEvents; e++) {
+            m_envelope.render(&s_rampGains[pos], events[e].offset - pos);
+            pos = events[e].offset;
+            m_envelope.start(events[e].target, fadeSamples, curve);
+        }
+        m_envelope.render(&s_rampGains[pos], AUDIO_BLOCK_SAMPLES - pos);
+
+        if (gateMode) {
+            // Envelope is the dry amount: gain = gate + (unity - gate) * env
+            if (!m_gateRunning) {
+                m_gate.sync();
+                m_gateRunning = true;
+            }
+            m_gate.render(s_gateGains, AUDIO_BLOCK_SAMPLES);
+            for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+                int32_t gate = s_gateGains[i];
+                s_rampGains[i] = static_cast<int16_t>(gate + (((GainRamp::UNITY_Q15 - gate) * s_rampGains[i]) >> 15));
+            }
+        } else {
+            m_gateRunning = false;
+        }
+
+        GainRamp::applyBus(dataL, s_rampGains, AUDIO_BLOCK_SAMPLES);
+        GainRamp::applyBus(dataR, s_rampGains, AUDIO_BLOCK_SAMPLES);
     }
 }
 
-void ChokeAudio::applyGainRamp(int16_t* data, size_t numSamples, float gainIncrement) {
-    for (size_t i = 0; i < numSamples; i++) {
-        // Update current gain (linear interpolation)
-        m_currentGain += gainIncrement;
-
-        // Clamp gain to [0.0, 1.0] to prevent overshoot
-        if (m_currentGain < 0.0f) m_currentGain = 0.0f;
-        if (m_currentGain > 1.0f) m_currentGain = 1.0f;
-
-        // Apply gain to sample
-        // Note: int16_t range is -32768 to 32767
-        // We multiply by gain, then clamp to prevent overflow
-        int32_t sample = static_cast<int32_t>(data[i]) * m_currentGain;
-
-        // Clamp to int16_t range (shouldn't overflow with gain ≤ 1.0, but safe practice)
-        if (sample > 32767) sample = 32767;
-        if (sample < -32768) sample = -32768;
-
-        data[i] = static_cast<int16_t>(sample);
-    }
+bool ChokeAudio::needsProcessing() const {
+    // Idle passthrough: unmuted, settled, nothing scheduled, gate not waiting to be reset
+    return m_targetGain != GainRamp::UNITY_Q15 ||
+           m_onsetAtSample != 0 ||
+           m_releaseAtSample != 0 ||
+           m_gateRunning ||
+           !m_envelope.isSettled() ||
+           m_envelope.getTarget() != GainRamp::UNITY_Q15;
 }
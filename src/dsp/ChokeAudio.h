@@ -2,6 +2,9 @@
 
 #include "IEffectAudio.h"
 #include "Timebase.h"
+#include "GainRamp.h"
+#include "FadeEnvelope.h"
+#include "GateSequencer.h"
 #include <atomic>
 
 enum class ChokeLength : uint8_t {
@@ -14,6 +17,20 @@ enum class ChokeOnset : uint8_t {
     QUANTIZED = 1   // Quantize onset to next beat/subdivision
 };
 
+enum class ChokeFade : uint8_t {
+    MS_1 = 0,       // 44 samples
+    MS_3 = 1,       // 132 samples (default)
+    MS_5 = 2,
+    MS_10 = 3,
+    MS_20 = 4,
+    MS_50 = 5       // 2205 samples
+};
+
+enum class ChokeMode : uint8_t {
+    MUTE = 0,   // Choke mutes audio (default)
+    GATE = 1    // Choke plays the tempo-synced gate pattern
+};
+
 /**
  * Choke State Machine
  *
@@ -64,23 +81,56 @@ public:
     void setOnsetMode(ChokeOnset mode) { m_onsetMode = mode; }
     ChokeOnset getOnsetMode() const { return m_onsetMode; }
 
+    /**
+     * Fade length and curve for mute/unmute (applied to the next fade)
+     * The fade takes exactly fadeToSamples(fade) samples from wherever the gain is.
+     */
+    void setFade(ChokeFade fade) { m_fade = fade; }
+    ChokeFade getFade() const { return m_fade; }
+    void setCurve(FadeCurve curve) { m_curve = curve; }
+    FadeCurve getCurve() const { return m_curve; }
+
+    /**
+     * Convert fade setting to samples @ Timebase::SAMPLE_RATE
+     */
+    static uint32_t fadeToSamples(ChokeFade fade);
+
+    // ========== GATE SEQUENCER ==========
+
+    /**
+     * MUTE: choke silences audio. GATE: choke chops audio with the gate pattern
+     * (the choke fade crossfades between dry and gated audio)
+     */
+    void setMode(ChokeMode mode) { m_mode = mode; }
+    ChokeMode getMode() const { return m_mode; }
+
+    /**
+     * Gate pattern (edited from the App thread, stored with presets)
+     */
+    GateSequencer& getGate() { return m_gate; }
+    const GateSequencer& getGate() const { return m_gate; }
+
     // Legacy interface (for backwards compatibility)
     void engage() { enable(); }
     void releaseChoke() { disable(); }
     bool isChoked() const { return isEnabled(); }
 
-    virtual void update() override;
+    void processBlock(int32_t* dataL, int32_t* dataR) override;
+    bool needsProcessing() const override;
 
 private:
-    void applyGainRamp(int16_t* data, size_t numSamples, float gainIncrement);
-
     // Fade parameters
-    static constexpr float FADE_TIME_MS = 3.0f;  // 3ms crossfade (tighter feel for quantization)
-    static constexpr float FADE_SAMPLES = (FADE_TIME_MS / 1000.0f) * 44100.0f;  // 132 samples
+    ChokeFade m_fade;         // Fade length (menu setting)
+    FadeCurve m_curve;        // Fade shape (menu setting)
+
+    // Gate sequencer
+    ChokeMode m_mode;         // MUTE or GATE (menu setting)
+    GateSequencer m_gate;     // Pattern and step position (audio ISR renders)
+    bool m_gateRunning;       // Gate aligned to grid and rendering (audio ISR only)
 
-    // Gain state (modified in audio ISR)
-    float m_currentGain;  // Current gain (ramped smoothly)
-    float m_targetGain;   // Target gain (0.0 = mute, 1.0 = full volume)
+    // Gain state (Q15)
+    FadeEnvelope m_envelope;  // Current gain and fade in progress (audio ISR only)
+    int32_t m_targetGain;     // Requested gain (0 = mute, GainRamp::UNITY_Q15 = full volume)
 
     // ========== STATE MACHINE ==========
     // State is atomic for lock-free cross-thread access
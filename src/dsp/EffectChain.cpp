@@ -0,0 +1,260 @@
+#include "EffectChain.h"
+#include "Timebase.h"
+
+// 32-bit bus frames (internal RAM, the chain is the only user)
+static int32_t s_busL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_busR[AUDIO_BLOCK_SAMPLES];
+
+// Parallel routing: dry input and running sum of stage outputs
+static int32_t s_dryL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_dryR[AUDIO_BLOCK_SAMPLES];
+static int32_t s_sumL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_sumR[AUDIO_BLOCK_SAMPLES];
+
+EffectChain::EffectChain() : GuardedStream(2, inputQueueArray) {
+    for (uint8_t i = 0; i < MAX_STAGES; i++) {
+        m_stages[i] = nullptr;
+    }
+    m_numStages = 0;
+    m_ditherState = 0x6C8E9CF5u;
+
+    m_routing = EffectRouting::serial();
+    m_plans[0].numSteps = 0;
+    m_plans[1].numSteps = 0;
+    m_activePlan = 0;
+}
+
+bool EffectChain::addStage(IEffectAudio* effect) {
+    if (!effect || m_numStages >= MAX_STAGES) {
+        return false;
+    }
+    m_stages[m_numStages++] = effect;
+
+    // Recompile for the new stage count (a custom order no longer covers every stage)
+    if (!setRouting(m_routing)) {
+        setRouting(EffectRouting::serial());
+    }
+    return true;
+}
+
+// ========== ROUTING ==========
+
+bool EffectChain::setRouting(const EffectRouting& routing) {
+    if (routing.mode == RoutingMode::CUSTOM) {
+        // Every stage exactly once
+        uint8_t seen = 0;
+        for (uint8_t i = 0; i < m_numStages; i++) {
+            uint8_t stage = routing.order[i];
+            if (stage >= m_numStages || (seen & (1u << stage))) {
+                return false;
+            }
+            seen |= static_cast<uint8_t>(1u << stage);
+        }
+    } else if (static_cast<uint8_t>(routing.mode) >= ROUTING_MODE_COUNT) {
+        return false;
+    }
+
+    // Build in the idle buffer, then publish (single store, picked up next block)
+    uint8_t staging = m_activePlan ^ 1;
+    compilePlan(routing, m_plans[staging]);
+    m_routing = routing;
+    m_activePlan = staging;
+    return true;
+}
+
+void EffectChain::compilePlan(const EffectRouting& routing, ExecutionPlan& plan) const {
+    uint8_t n = 0;
+
+    switch (routing.mode) {
+        case RoutingMode::SERIAL:
+            for (uint8_t i = 0; i < m_numStages; i++) {
+                plan.steps[n++] = {PlanOp::PROCESS, i};
+            }
+            break;
+
+        case RoutingMode::CUSTOM:
+            for (uint8_t i = 0; i < m_numStages; i++) {
+                plan.steps[n++] = {PlanOp::PROCESS, routing.order[i]};
+            }
+            break;
+
+        case RoutingMode::PARALLEL:
+            plan.steps[n++] = {PlanOp::SPLIT, 0};
+            for (uint8_t i = 0; i < m_numStages; i++) {
+                if (i > 0) {
+                    plan.steps[n++] = {PlanOp::RESTORE, 0};
+                }
+                plan.steps[n++] = {PlanOp::PROCESS, i};
+                plan.steps[n++] = {PlanOp::MIX, 0};
+            }
+            plan.steps[n++] = {PlanOp::MERGE, 0};
+            break;
+    }
+
+    plan.numSteps = n;
+}
+
+void EffectChain::permutation(uint8_t index, uint8_t* order) const {
+    // Factorial number system: digit i picks among the stages not used yet
+    uint8_t remaining[MAX_STAGES];
+    uint8_t factorial = 1;
+    for (uint8_t i = 0; i < m_numStages; i++) {
+        remaining[i] = i;
+        if (i > 0) factorial *= i;   // (n-1)! after the loop
+    }
+
+    uint8_t count = m_numStages;
+    for (uint8_t i = 0; i < m_numStages; i++) {
+        uint8_t pick = index / factorial;
+        index %= factorial;
+        order[i] = remaining[pick];
+        for (uint8_t j = pick; j + 1 < count; j++) {
+            remaining[j] = remaining[j + 1];
+        }
+        count--;
+        if (count > 0) factorial /= count;
+    }
+}
+
+uint8_t EffectChain::getRoutingOptionCount() const {
+    uint8_t orders = 1;
+    for (uint8_t i = 2; i <= m_numStages; i++) {
+        orders *= i;
+    }
+    // Parallel only differs from serial with two or more stages
+    return (m_numStages > 1) ? orders + 1 : orders;
+}
+
+EffectRouting EffectChain::getRoutingOption(uint8_t index) const {
+    EffectRouting routing = EffectRouting::serial();
+    uint8_t count = getRoutingOptionCount();
+    if (index >= count) {
+        return routing;
+    }
+    if (m_numStages > 1 && index == count - 1) {
+        routing.mode = RoutingMode::PARALLEL;
+    } else if (index > 0) {
+        routing.mode = RoutingMode::CUSTOM;
+        permutation(index, routing.order);
+    }
+    return routing;
+}
+
+uint8_t EffectChain::getRoutingOptionIndex() const {
+    uint8_t count = getRoutingOptionCount();
+    if (m_routing.mode == RoutingMode::PARALLEL && m_numStages > 1) {
+        return count - 1;
+    }
+    if (m_routing.mode == RoutingMode::CUSTOM) {
+        uint8_t orders = (m_numStages > 1) ? count - 1 : count;
+        for (uint8_t index = 0; index < orders; index++) {
+            uint8_t order[MAX_STAGES];
+            permutation(index, order);
+            if (memcmp(order, m_routing.order, m_numStages) == 0) {
+                return index;
+            }
+        }
+    }
+    return 0;
+}
+
+void EffectChain::formatRouting(const EffectRouting& routing, char* buffer, size_t size) const {
+    if (size == 0) {
+        return;
+    }
+
+    char separator = (routing.mode == RoutingMode::PARALLEL) ? '|' : '>';
+    size_t pos = 0;
+    for (uint8_t i = 0; i < m_numStages && pos + 2 < size; i++) {
+        uint8_t stage = (routing.mode == RoutingMode::CUSTOM) ? routing.order[i] : i;
+        const char* name = (stage < m_numStages) ? m_stages[stage]->getName() : "?";
+        if (i > 0) {
+            buffer[pos++] = separator;
+        }
+        buffer[pos++] = name[0];
+    }
+    buffer[pos] = '\0';
+}
+
+// ========== AUDIO ISR ==========
+
+void EffectChain::update() {
+    uint32_t blockStart = DspProfiler::now();
+
+    // Advance sample counter first (same order as TimebaseAudio in the per-node graph)
+    Timebase::incrementSamples(AUDIO_BLOCK_SAMPLES);
+
+    AudioPoolMonitor::update();
+
+    // Never skips the block: a pool shortage degrades the output, the plan still runs
+    StereoBlocks io;
+    receiveStereo(io);
+
+    // One conversion in, all stages at bus resolution, one dithered conversion out
+    widenStereo(io, s_busL, s_busR);
+
+    // Walk the precompiled plan (no graph traversal in the ISR)
+    const ExecutionPlan& plan = m_plans[m_activePlan];
+    bool stageRan = false;
+    for (uint8_t i = 0; i < plan.numSteps; i++) {
+        const PlanStep& step = plan.steps[i];
+        switch (step.op) {
+            case PlanOp::PROCESS: {
+                IEffectAudio* stage = m_stages[step.stage];
+                stageRan = stage->needsProcessing();
+                if (stageRan) {
+                    uint32_t start = DspProfiler::now();
+                    stage->processBlock(s_busL, s_busR);
+                    DspProfiler::record(stage->getProfileSlot(), DspProfiler::now() - start);
+                }
+                break;
+            }
+
+            case PlanOp::SPLIT:
+                memcpy(s_dryL, s_busL, sizeof(s_busL));
+                memcpy(s_dryR, s_busR, sizeof(s_busR));
+                memcpy(s_sumL, s_busL, sizeof(s_busL));
+                memcpy(s_sumR, s_busR, sizeof(s_busR));
+                break;
+
+            case PlanOp::MIX:
+                // Skipped stages are exact passthrough: difference is zero
+                if (stageRan) {
+                    for (uint32_t n = 0; n < AUDIO_BLOCK_SAMPLES; n++) {
+                        s_sumL[n] += s_busL[n] - s_dryL[n];
+                        s_sumR[n] += s_busR[n] - s_dryR[n];
+                    }
+                }
+                break;
+
+            case PlanOp::RESTORE:
+                if (stageRan) {
+                    memcpy(s_busL, s_dryL, sizeof(s_busL));
+                    memcpy(s_busR, s_dryR, sizeof(s_busR));
+                }
+                break;
+
+            case PlanOp::MERGE:
+                memcpy(s_busL, s_sumL, sizeof(s_busL));
+                memcpy(s_busR, s_sumR, sizeof(s_busR));
+                break;
+        }
+    }
+
+    // Last stage: hold the output under the ceiling instead of clipping in the conversion
+    uint32_t limiterStart = DspProfiler::now();
+    m_limiter.process(s_busL, s_busR);
+    DspProfiler::record(m_limiter.getProfileSlot(), DspProfiler::now() - limiterStart);
+
+    if (io.writable[0]) {
+        AudioBus::narrowBlockDithered(s_busL, io.block[0]->data, AUDIO_BLOCK_SAMPLES, m_ditherState);
+    }
+    if (io.writable[1]) {
+        AudioBus::narrowBlockDithered(s_busR, io.block[1]->data, AUDIO_BLOCK_SAMPLES, m_ditherState);
+    }
+
+    transmitStereo(io);
+
+    // Total includes bus conversions and block handling, not just the stages
+    DspProfiler::endBlock(DspProfiler::now() - blockStart);
+}
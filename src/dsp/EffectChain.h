@@ -0,0 +1,145 @@
+/**
+ * EffectChain.h - Fused single-pass effect chain (one AudioStream node)
+ *
+ * PURPOSE:
+ * Runs Timebase → Stutter → Freeze → Choke in one update() on a single
+ * stereo block pair, instead of one AudioStream node per effect.
+ * The effect order and topology (serial, parallel, custom) can be changed
+ * at runtime.
+ *
+ * DESIGN:
+ * - Receives the input blocks once (receiveWritable), widens them onto the
+ *   32-bit AudioBus, each stage processes the bus frames in place via
+ *   IEffectAudio::processBlock(), then one TPDF-dithered conversion back to
+ *   int16 and one transmit
+ *   - One receive/transmit/release cycle per channel per block instead of four
+ *   - No per-stage block copies or allocations: pool usage is the I2S blocks only
+ *   - Stages always run in chain order within the same block (no extra
+ *     block of latency from AudioStream update ordering)
+ * - Stages report needsProcessing(); inactive stages (exact passthrough) are skipped
+ * - LookaheadLimiter runs after the plan, before the dithered conversion
+ *   (bus overs are limited instead of clipped; adds DELAY_SAMPLES of latency)
+ * - Also advances Timebase (replaces TimebaseAudio in the fused graph)
+ * - Each stage is timed into its DspProfiler slot; the whole update() is the
+ *   block total
+ * - Block pool shortages degrade per GuardedStream (held input, passthrough,
+ *   mono) instead of dropping the block; the plan runs every block regardless
+ * - Samples the pool high-water mark once per block (AudioPoolMonitor)
+ * - Stages are registered once at startup, before audio starts
+ * - Routing (EffectRouting) compiles to a flat execution plan whenever it
+ *   changes (app thread); update() just walks the plan array
+ *   - Double-buffered: the new plan is built in the idle buffer, then
+ *     published with one index store (the ISR never sees a partial plan)
+ *   - Parallel: dry copy and difference sum in two extra bus buffer pairs
+ *   - Routing options for the UI: serial, every custom order, parallel
+ *
+ * USAGE:
+ *   EffectChain chain;
+ *   AudioConnection c1(i2s_in, 0, chain, 0);
+ *   AudioConnection c2(i2s_in, 1, chain, 1);
+ *   chain.addStage(&stutter);   // Processing order = registration order
+ *   chain.addStage(&freeze);
+ *   chain.addStage(&choke);
+ *   chain.setRouting(routing);  // Any time after the stages are added
+ */
+
+#pragma once
+
+#include <Audio.h>
+#include "IEffectAudio.h"
+#include "EffectRouting.h"
+#include "LookaheadLimiter.h"
+
+class EffectChain : public GuardedStream {
+public:
+    static constexpr uint8_t MAX_STAGES = ROUTING_MAX_STAGES;
+
+    EffectChain();
+
+    /**
+     * Append an effect to the chain (call from setup, before audio starts)
+     *
+     * @return false if the chain is full or effect is null
+     */
+    bool addStage(IEffectAudio* effect);
+
+    uint8_t getNumStages() const { return m_numStages; }
+
+    /**
+     * Output limiter (last stage, always runs)
+     */
+    LookaheadLimiter& getLimiter() { return m_limiter; }
+
+    IEffectAudio* getStage(uint8_t index) const {
+        return (index < m_numStages) ? m_stages[index] : nullptr;
+    }
+
+    // ========== ROUTING (app thread) ==========
+
+    /**
+     * Change the routing and compile its execution plan
+     * Takes effect from the next audio block.
+     *
+     * @return false if a CUSTOM order is not a permutation of the stages (routing unchanged)
+     */
+    bool setRouting(const EffectRouting& routing);
+
+    const EffectRouting& getRouting() const { return m_routing; }
+
+    /**
+     * Routing options for a selector: 0 = serial, then every other
+     * custom order (numStages! - 1), last = parallel
+     */
+    uint8_t getRoutingOptionCount() const;
+    EffectRouting getRoutingOption(uint8_t index) const;
+    uint8_t getRoutingOptionIndex() const;
+
+    /**
+     * Short routing label from stage initials, e.g. "S>F>C" or "S|F|C"
+     */
+    void formatRouting(const EffectRouting& routing, char* buffer, size_t size) const;
+
+    virtual void update() override;
+
+private:
+    enum class PlanOp : uint8_t {
+        PROCESS = 0,   // Run stage on the bus
+        SPLIT = 1,     // Parallel: keep dry copy, start sum at dry
+        RESTORE = 2,   // Parallel: bus = dry (only if the previous stage ran)
+        MIX = 3,       // Parallel: sum += bus - dry (only if the previous stage ran)
+        MERGE = 4      // Parallel: bus = sum
+    };
+
+    struct PlanStep {
+        PlanOp op;
+        uint8_t stage;
+    };
+
+    static constexpr uint8_t MAX_PLAN_STEPS = 2 + 3 * MAX_STAGES;
+
+    struct ExecutionPlan {
+        PlanStep steps[MAX_PLAN_STEPS];
+        uint8_t numSteps;
+    };
+
+    /**
+     * Compile routing into plan (no validation)
+     */
+    void compilePlan(const EffectRouting& routing, ExecutionPlan& plan) const;
+
+    /**
+     * Stage order for routing option index (lexicographic permutation)
+     */
+    void permutation(uint8_t index, uint8_t* order) const;
+
+    audio_block_t* inputQueueArray[2];  // Input queue storage (required by AudioStream)
+
+    IEffectAudio* m_stages[MAX_STAGES];
+    uint8_t m_numStages;
+    uint32_t m_ditherState;   // Output TPDF dither PRNG (xorshift32, never 0)
+    LookaheadLimiter m_limiter;  // Output ceiling before the int16 conversion
+
+    EffectRouting m_routing;
+    ExecutionPlan m_plans[2];           // Active + staging
+    volatile uint8_t m_activePlan;      // Index into m_plans read by update()
+};
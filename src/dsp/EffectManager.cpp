@@ -1,7 +1,8 @@
 #include "EffectManager.h"
+#include "IEffectController.h"
 #include <Arduino.h>  // For Serial debug output
 
-EffectManager::EffectEntry EffectManager::s_effects[MAX_EFFECTS] = {};
+EffectManager::EffectEntry EffectManager::s_effects[EFFECT_ID_COUNT] = {};
 
 uint8_t EffectManager::s_numEffects = 0;
 
@@ -17,29 +18,32 @@ bool EffectManager::registerEffect(EffectID id, IEffectAudio* effect) {
         return false;
     }
 
-    // Check if registry is full
-    if (s_numEffects >= MAX_EFFECTS) {
-        Serial.print("ERROR: EffectManager::registerEffect() - registry full (max ");
-        Serial.print(MAX_EFFECTS);
-        Serial.println(" effects)");
+    uint8_t index = static_cast<uint8_t>(id);
+    if (index >= EFFECT_ID_COUNT) {
+        Serial.print("ERROR: EffectManager::registerEffect() - ID ");
+        Serial.print(index);
+        Serial.println(" out of range");
         return false;
     }
 
     // Check for duplicate ID
-    for (uint8_t i = 0; i < s_numEffects; i++) {
-        if (s_effects[i].id == id) {
-            Serial.print("ERROR: EffectManager::registerEffect() - ID ");
-            Serial.print(static_cast<uint8_t>(id));
-            Serial.println(" already registered");
-            return false;
-        }
+    if (s_effects[index].effect != nullptr) {
+        Serial.print("ERROR: EffectManager::registerEffect() - ID ");
+        Serial.print(index);
+        Serial.println(" already registered");
+        return false;
     }
 
     // Add to registry
-    s_effects[s_numEffects].id = id;
-    s_effects[s_numEffects].effect = effect;
+    s_effects[index].effect = effect;
     s_numEffects++;
 
+    // Time this effect's block processing under its own name
+    effect->setProfileSlot(DspProfiler::registerSlot(effect->getName()));
+
+    // Tag its pool fallback traces with the effect ID (0 is the fused chain)
+    effect->setPoolTag(static_cast<uint8_t>(id));
+
     // Success - log registration
     Serial.print("EffectManager: Registered effect '");
     Serial.print(effect->getName());
@@ -52,6 +56,54 @@ bool EffectManager::registerEffect(EffectID id, IEffectAudio* effect) {
     return true;
 }
 
+bool EffectManager::registerController(EffectID id, IEffectController* controller) {
+    uint8_t index = static_cast<uint8_t>(id);
+    if (controller == nullptr || id == EffectID::NONE || index >= EFFECT_ID_COUNT) {
+        Serial.print("ERROR: EffectManager::registerController() - invalid controller for ID ");
+        Serial.println(index);
+        return false;
+    }
+
+    if (s_effects[index].controller != nullptr) {
+        Serial.print("ERROR: EffectManager::registerController() - ID ");
+        Serial.print(index);
+        Serial.println(" already has a controller");
+        return false;
+    }
+
+    s_effects[index].controller = controller;
+    return true;
+}
+
+bool EffectManager::dispatchToController(const Command& cmd) {
+    IEffectController* controller = getController(cmd.targetEffect);
+    if (controller == nullptr) {
+        return false;
+    }
+
+    switch (cmd.type) {
+        case CommandType::EFFECT_ENABLE:
+        case CommandType::EFFECT_TOGGLE:
+            return controller->handleButtonPress(cmd);
+
+        case CommandType::EFFECT_DISABLE:
+            return controller->handleButtonRelease(cmd);
+
+        default:
+            return false;
+    }
+}
+
+void EffectManager::updateControllers() {
+    for (uint8_t i = 0; i < EFFECT_ID_COUNT; i++) {
+        IEffectController* controller = s_effects[i].controller;
+        // Skip modifier aliases (e.g. FUNC -> Stutter) so each controller updates once
+        if (controller && static_cast<uint8_t>(controller->getEffectID()) == i) {
+            controller->updateVisualFeedback();
+        }
+    }
+}
+
 bool EffectManager::executeCommand(const Command& cmd) {
     // Special case: NONE command is a no-op (used for disabled buttons)
     if (cmd.type == CommandType::NONE) {
@@ -95,18 +147,6 @@ bool EffectManager::executeCommand(const Command& cmd) {
     }
 }
 
-IEffectAudio* EffectManager::getEffect(EffectID id) {
-    // Linear search (fast for small N, cache-friendly)
-    for (uint8_t i = 0; i < s_numEffects; i++) {
-        if (s_effects[i].id == id) {
-            return s_effects[i].effect;
-        }
-    }
-
-    // Not found
-    return nullptr;
-}
-
 // uint32_t EffectManager::getEnabledEffectsMask() {
 //     uint32_t mask = 0;
 
@@ -1,18 +1,70 @@
+/**
+ * EffectManager.h - Effect registry indexed by EffectID
+ *
+ * PURPOSE:
+ * Maps each EffectID to its audio node (IEffectAudio) and its controller
+ * (IEffectController), so a button command reaches its handler with one
+ * table index instead of a search or a per-effect branch.
+ *
+ * DESIGN:
+ * - Fixed table of EFFECT_ID_COUNT slots, indexed by the EffectID value
+ *   (constant-initialised, no allocation; lookups are O(1))
+ * - Audio nodes register from main.cpp, controllers from App::begin()
+ * - A controller may also be registered under a modifier ID it handles
+ *   (Stutter owns FUNC); updateControllers() visits each controller once
+ * - Adding an effect = new EffectID + registerEffect()/registerController(),
+ *   no dispatch code to edit
+ *
+ * USAGE:
+ *   EffectManager::registerEffect(EffectID::CHOKE, &choke);         // setup()
+ *   EffectManager::registerController(EffectID::CHOKE, controller); // App::begin()
+ *   if (!EffectManager::dispatchToController(cmd)) {
+ *       EffectManager::executeCommand(cmd);                         // Default handling
+ *   }
+ */
+
 #pragma once
 
 #include "IEffectAudio.h"
 #include "Command.h"
 #include <stdint.h>
 
+class IEffectController;
+
 class EffectManager {
 public:
-    static constexpr uint8_t MAX_EFFECTS = 4;
+    static constexpr uint8_t MAX_EFFECTS = EFFECT_ID_COUNT;
 
     static bool registerEffect(EffectID id, IEffectAudio* effect);
 
+    /**
+     * Attach the controller that intercepts button commands for id
+     */
+    static bool registerController(EffectID id, IEffectController* controller);
+
     static bool executeCommand(const Command& cmd);
 
-    static IEffectAudio* getEffect(EffectID id);
+    /**
+     * Hand a button command to its effect's controller
+     *
+     * @return true if the controller handled it (skip executeCommand())
+     */
+    static bool dispatchToController(const Command& cmd);
+
+    /**
+     * Update visual feedback of every registered controller (once each)
+     */
+    static void updateControllers();
+
+    static IEffectAudio* getEffect(EffectID id) {
+        uint8_t index = static_cast<uint8_t>(id);
+        return (index < EFFECT_ID_COUNT) ? s_effects[index].effect : nullptr;
+    }
+
+    static IEffectController* getController(EffectID id) {
+        uint8_t index = static_cast<uint8_t>(id);
+        return (index < EFFECT_ID_COUNT) ? s_effects[index].controller : nullptr;
+    }
 
     //static uint32_t getEnabledEffectsMask();
 
@@ -22,14 +74,11 @@ public:
 
 private:
     struct EffectEntry {
-        EffectID id;                // Effect identifier
-        IEffectAudio* effect;    // Non-owning pointer to effect object
-
-        // Default constructor (for static array initialization)
-        EffectEntry() : id(EffectID::NONE), effect(nullptr) {}
+        IEffectAudio* effect;            // Non-owning pointer to effect object
+        IEffectController* controller;   // Non-owning, nullptr = default handling
     };
 
-    static EffectEntry s_effects[MAX_EFFECTS];
+    static EffectEntry s_effects[EFFECT_ID_COUNT];   // Indexed by EffectID
 
     static uint8_t s_numEffects;
 };
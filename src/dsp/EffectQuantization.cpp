@@ -6,9 +6,11 @@ namespace EffectQuantization {
 // Global quantization state (default: 1/16 note)
 static Quantization globalQuantization = Quantization::QUANT_16;
 
-// Lookahead offset for quantized onset (default: 128 samples = ~3ms @ 44.1kHz)
+// Lookahead offset for quantized onset (default: one audio block, 2.9ms at 128 samples)
 // Fires onset slightly early to catch external audio transients (e.g., kick from Digitakt)
-static uint32_t lookaheadOffset = 128;
+// The sample position runs one block ahead of the audio being processed, so this
+// scales with the block size
+static uint32_t lookaheadOffset = AUDIO_BLOCK_SAMPLES;
 
 uint32_t calculateQuantizedDuration(Quantization quant) {
     uint32_t samplesPerBeat = Timebase::getSamplesPerBeat();
@@ -69,7 +71,7 @@ uint32_t getLookaheadOffset() {
 
 void initialize() {
     globalQuantization = Quantization::QUANT_16;
-    lookaheadOffset = 128;  // Default: 128 samples (~3ms)
+    lookaheadOffset = AUDIO_BLOCK_SAMPLES;  // Default: one audio block
 }
 
 }
\ No newline at end of file
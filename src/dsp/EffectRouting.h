@@ -0,0 +1,67 @@
+/**
+ * EffectRouting.h - Effect routing description (order and topology)
+ *
+ * PURPOSE:
+ * Describes how EffectChain connects its stages, independent of the
+ * execution plan it compiles to. Plain data, so presets can store it.
+ *
+ * DESIGN:
+ * - SERIAL: stages in registration order (Stutter → Freeze → Choke)
+ * - CUSTOM: stages in series, in the order given by order[]
+ * - PARALLEL: every stage processes the same input; outputs are summed as
+ *   differences from the dry signal (out = dry + sum(stage(dry) - dry)),
+ *   so idle stages add nothing and levels stay at unity
+ * - order[] holds stage indices (registration order); must be a permutation
+ *   of 0..numStages-1 for CUSTOM, ignored otherwise
+ * - pack()/unpack(): 2 bits per position for preset storage (one byte)
+ *
+ * USAGE:
+ *   EffectRouting routing = EffectRouting::serial();
+ *   routing.mode = RoutingMode::CUSTOM;
+ *   routing.order[0] = 2; routing.order[1] = 0; routing.order[2] = 1;
+ *   chain.setRouting(routing);
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum class RoutingMode : uint8_t {
+    SERIAL = 0,     // Registration order
+    PARALLEL = 1,   // All stages on the dry input, differences summed
+    CUSTOM = 2      // Series in order[] order
+};
+
+static constexpr uint8_t ROUTING_MODE_COUNT = 3;
+static constexpr uint8_t ROUTING_MAX_STAGES = 4;   // Fits pack() (2 bits per stage)
+
+struct EffectRouting {
+    RoutingMode mode;
+    uint8_t order[ROUTING_MAX_STAGES];
+
+    static EffectRouting serial() {
+        EffectRouting routing;
+        routing.mode = RoutingMode::SERIAL;
+        for (uint8_t i = 0; i < ROUTING_MAX_STAGES; i++) {
+            routing.order[i] = i;
+        }
+        return routing;
+    }
+
+    /**
+     * Pack order[] into one byte (2 bits per position, position 0 in the low bits)
+     */
+    uint8_t packOrder() const {
+        uint8_t packed = 0;
+        for (uint8_t i = 0; i < ROUTING_MAX_STAGES; i++) {
+            packed |= static_cast<uint8_t>((order[i] & 0x03) << (2 * i));
+        }
+        return packed;
+    }
+
+    void unpackOrder(uint8_t packed) {
+        for (uint8_t i = 0; i < ROUTING_MAX_STAGES; i++) {
+            order[i] = (packed >> (2 * i)) & 0x03;
+        }
+    }
+};
@@ -0,0 +1,93 @@
+#include "FadeEnvelope.h"
+#include "GainRamp.h"
+#include <math.h>
+
+uint16_t FadeEnvelope::s_curves[FadeEnvelope::CURVE_COUNT][FadeEnvelope::CURVE_TABLE_SIZE + 1];
+bool FadeEnvelope::s_tablesReady = false;
+
+void FadeEnvelope::buildTables() {
+    const float k = 5.0f;  // Exponential steepness
+    const float expNorm = 1.0f / (expf(k) - 1.0f);
+    for (uint32_t i = 0; i <= CURVE_TABLE_SIZE; i++) {
+        float x = static_cast<float>(i) / CURVE_TABLE_SIZE;
+        float shapes[CURVE_COUNT] = {
+            x,
+            (expf(k * x) - 1.0f) * expNorm,
+            sinf(x * static_cast<float>(M_PI) * 0.5f)
+        };
+        for (uint32_t c = 0; c < CURVE_COUNT; c++) {
+            s_curves[c][i] = static_cast<uint16_t>(lroundf(shapes[c] * GainRamp::UNITY_Q15));
+        }
+    }
+    s_tablesReady = true;
+}
+
+FadeEnvelope::FadeEnvelope() {
+    if (!s_tablesReady) {
+        buildTables();
+    }
+    m_curve = FadeCurve::LINEAR;
+    reset(GainRamp::UNITY_Q15);
+}
+
+void FadeEnvelope::reset(int32_t gain) {
+    m_gain = gain;
+    m_target = gain;
+    m_base = gain;
+    m_span = 0;
+    m_rising = true;
+    m_phase = 0;
+    m_phaseInc = 0;
+    m_remaining = 0;
+}
+
+void FadeEnvelope::start(int32_t target, uint32_t lengthSamples, FadeCurve curve) {
+    if (lengthSamples == 0 || target == m_gain) {
+        reset(target);
+        return;
+    }
+
+    // Restart from wherever the gain is now - length stays exact
+    m_rising = (target > m_gain);
+    m_base = m_rising ? m_gain : target;
+    m_span = m_rising ? (target - m_gain) : (m_gain - target);
+    m_target = target;
+    m_curve = curve;
+    m_phase = 0;
+    m_phaseInc = PHASE_END / lengthSamples;
+    m_remaining = lengthSamples;
+}
+
+int32_t FadeEnvelope::shapeAt(FadeCurve curve, uint32_t phase) {
+    if (phase >= PHASE_END) {
+        return s_curves[static_cast<uint8_t>(curve)][CURVE_TABLE_SIZE];
+    }
+    const uint16_t* table = s_curves[static_cast<uint8_t>(curve)];
+    uint32_t idx = phase >> 16;
+    int32_t frac = static_cast<int32_t>((phase >> 1) & 0x7FFF);  // Q15
+    int32_t a = table[idx];
+    int32_t b = table[idx + 1];
+    return a + (((b - a) * frac) >> 15);
+}
+
+void FadeEnvelope::render(int16_t* gains, size_t numSamples) {
+    size_t i = 0;
+
+    // Fading portion
+    while (i < numSamples && m_remaining > 0) {
+        m_phase += m_phaseInc;
+        m_remaining--;
+        if (m_remaining == 0) {
+            m_gain = m_target;  // Land exactly on target (no rounding residue)
+        } else {
+            uint32_t u = m_rising ? m_phase : (PHASE_END - m_phase);
+            m_gain = m_base + ((m_span * shapeAt(m_curve, u)) >> 15);
+        }
+        gains[i++] = static_cast<int16_t>(m_gain);
+    }
+
+    // Settled portion
+    for (; i < numSamples; i++) {
+        gains[i] = static_cast<int16_t>(m_gain);
+    }
+}
@@ -0,0 +1,94 @@
+/**
+ * FadeEnvelope.h - Table-driven gain envelope with deterministic fade length
+ *
+ * PURPOSE:
+ * Generates per-sample Q15 gain ramps for mutes, gates and crossfades.
+ * A fade always takes exactly the requested number of samples, whatever
+ * gain it starts from, and can start at any sample offset within a block.
+ *
+ * DESIGN:
+ * - Curve shapes from Q15 lookup tables (CURVE_TABLE_SIZE + 1 entries,
+ *   computed once), linearly interpolated
+ *   - LINEAR: x
+ *   - EXPONENTIAL: (e^(k*x) - 1) / (e^k - 1), k = 5 (slow start, fast finish)
+ *   - EQUAL_POWER: sin(x * pi/2) (fade-out mirrors to cos)
+ * - Falling fades mirror the rising shape in time, so an exponential fade-out
+ *   drops fast then tails off, and equal-power in/out pairs sum to constant power
+ * - Phase accumulator in 8.16 fixed point; the only division is the phase
+ *   increment, computed once per fade in start()
+ * - Output feeds GainRamp::applyBus() (one rendered ramp shared by all channels)
+ *
+ * USAGE:
+ *   FadeEnvelope env;                          // Starts settled at UNITY_Q15
+ *   env.start(0, 132, FadeCurve::EQUAL_POWER); // Fade to mute over 132 samples
+ *   env.render(gains, offset);                 // Samples before the event
+ *   env.render(gains + offset, n - offset);    // Remaining samples
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum class FadeCurve : uint8_t {
+    LINEAR = 0,       // Constant slope (default)
+    EXPONENTIAL = 1,  // Perceptually smoother tails
+    EQUAL_POWER = 2   // Sine/cosine (constant power crossfades)
+};
+
+class FadeEnvelope {
+public:
+    // ========== CONFIGURATION ==========
+    static constexpr uint32_t CURVE_TABLE_BITS = 8;
+    static constexpr uint32_t CURVE_TABLE_SIZE = 1u << CURVE_TABLE_BITS;  // Segments (table has +1 guard entry)
+    static constexpr uint32_t PHASE_END = CURVE_TABLE_SIZE << 16;       // Phase at x = 1.0 (8.16)
+    static constexpr uint8_t CURVE_COUNT = 3;
+
+    FadeEnvelope();
+
+    /**
+     * Start a fade from the current gain
+     *
+     * @param target Target gain (Q15, 0..GainRamp::UNITY_Q15)
+     * @param lengthSamples Exact fade length (0 = jump immediately)
+     * @param curve Fade shape
+     */
+    void start(int32_t target, uint32_t lengthSamples, FadeCurve curve);
+
+    /**
+     * Jump to a gain immediately (no fade)
+     */
+    void reset(int32_t gain);
+
+    /**
+     * Render numSamples gain values (Q15) and advance the envelope
+     */
+    void render(int16_t* gains, size_t numSamples);
+
+    int32_t getGain() const { return m_gain; }
+    int32_t getTarget() const { return m_target; }
+    bool isSettled() const { return m_remaining == 0; }
+
+    /**
+     * Curve shape at table position (8.16 phase, 0..PHASE_END), Q15
+     */
+    static int32_t shapeAt(FadeCurve curve, uint32_t phase);
+
+private:
+    static void buildTables();
+
+    // ========== TABLES (shared, computed once) ==========
+    static uint16_t s_curves[CURVE_COUNT][CURVE_TABLE_SIZE + 1];
+    static bool s_tablesReady;
+
+    // ========== STATE ==========
+    int32_t m_gain;          // Current gain (Q15)
+    int32_t m_target;        // Gain at end of fade (Q15)
+    int32_t m_base;          // Gain at shape = 0 (start if rising, target if falling)
+    int32_t m_span;          // |target - start| (Q15)
+    bool m_rising;           // Rising fades read the shape forwards, falling backwards
+    FadeCurve m_curve;
+    uint32_t m_phase;        // Shape position (8.16)
+    uint32_t m_phaseInc;     // Phase advance per sample (PHASE_END / length)
+    uint32_t m_remaining;    // Samples left in the fade (0 = settled)
+};
@@ -1,23 +1,223 @@
 #include "FreezeAudio.h"
 
-FreezeAudio::FreezeAudio() : IEffectAudio(2) {  // Call base with 2 inputs (stereo)
+#if defined(__ARM_ARCH_7EM__)
+#include "utility/dspinst.h"
+#endif
+
+// Define static EXTMEM capture buffers (word-aligned for packed loads)
+EXTMEM int16_t FreezeAudio::m_captureBufferL[FreezeAudio::CAPTURE_SAMPLES] __attribute__((aligned(4)));
+EXTMEM int16_t FreezeAudio::m_captureBufferR[FreezeAudio::CAPTURE_SAMPLES] __attribute__((aligned(4)));
+
+// Frozen output staging (internal RAM): 16-bit renderers, widened onto the bus
+static int16_t s_frozenL[AUDIO_BLOCK_SAMPLES];
+static int16_t s_frozenR[AUDIO_BLOCK_SAMPLES];
+
+// Frozen output on the bus when it is mixed with the live input (MIX < 100%)
+static int32_t s_wetL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_wetR[AUDIO_BLOCK_SAMPLES];
+
+FreezeAudio::FreezeAudio()
+    : IEffectAudio(2),  // Call base with 2 inputs (stereo)
+      m_params{SmoothedParam(100.0f, 100.0f)} {  // MIX: percent, default fully frozen
+    bindParameters(m_params, PARAM_COUNT);
     m_writePos = 0;
-    m_readPos = 0;
+    m_grainCount = GrainEngine::MAX_GRAINS;  // Default: densest texture
+    m_mode = FreezeMode::GRAIN;              // Default: granular hold
+    m_size = FreezeSize::MS_250;
+    m_activeMode = FreezeMode::GRAIN;
+    m_wasFrozen = false;
+    m_loopStart = 0;
+    m_loopLength = 0;
+    m_loopPos = 0;
     m_state.store(FreezeState::IDLE, std::memory_order_relaxed);  // Start in IDLE state
     m_lengthMode = FreezeLength::FREE;  // Default: free mode
     m_onsetMode = FreezeOnset::FREE;    // Default: free mode
     m_releaseAtSample = 0;  // No scheduled release
     m_onsetAtSample = 0;    // No scheduled onset
 
-    // Initialize buffers to silence
-    memset(m_freezeBufferL, 0, sizeof(m_freezeBufferL));
-    memset(m_freezeBufferR, 0, sizeof(m_freezeBufferR));
+    // Initialize buffers to silence (EXTMEM is not zeroed at startup)
+    memset(m_captureBufferL, 0, sizeof(m_captureBufferL));
+    memset(m_captureBufferR, 0, sizeof(m_captureBufferR));
+}
+
+/**
+ * Keep the sign change between two mono samples if it is the nearest crossing so far
+ *
+ * offset is the index of cur from the start of the search; the crossing sits
+ * at cur. slope filters as in findZeroCrossing (0 accepts either).
+ */
+static inline void considerCrossing(int32_t prev, int32_t cur, uint32_t offset, uint32_t radius,
+                                    int8_t slope, uint32_t& bestDistance, uint32_t& bestOffset,
+                                    int8_t& bestSlope) {
+    // Sign change: exactly one of prev/cur is negative
+    if ((prev ^ cur) >= 0) return;
+    int8_t s = (cur >= 0) ? 1 : -1;
+    if (slope != 0 && s != slope) return;
+    uint32_t distance = (offset > radius) ? (offset - radius) : (radius - offset);
+    if (distance < bestDistance) {
+        bestDistance = distance;
+        bestOffset = offset;
+        bestSlope = s;
+    }
+}
+
+uint32_t FreezeAudio::sizeToSamples(FreezeSize size) {
+    uint32_t ms;
+    switch (size) {
+        case FreezeSize::MS_3:    ms = 3; break;
+        case FreezeSize::MS_10:   ms = 10; break;
+        case FreezeSize::MS_25:   ms = 25; break;
+        case FreezeSize::MS_50:   ms = 50; break;
+        case FreezeSize::MS_100:  ms = 100; break;
+        case FreezeSize::MS_250:  ms = 250; break;
+        case FreezeSize::MS_500:  ms = 500; break;
+        case FreezeSize::MS_1000: ms = 1000; break;
+        default: ms = 250; break;
+    }
+    return Timebase::msToSamples(ms);  // 3ms = 132 samples, 1s = SAMPLE_RATE samples
+}
+
+bool FreezeAudio::findZeroCrossing(uint32_t center, uint32_t radius, int8_t slope,
+                                   uint32_t& outIndex, int8_t& outSlope) {
+    // Walk the ring in contiguous runs (no per-sample masking), carrying the
+    // previous mono sample across the wrap. Keep the crossing nearest to center.
+    uint32_t first = (center - radius) & CAPTURE_MASK;
+    uint32_t remaining = 2 * radius + 1;
+    uint32_t prevIdx = (first - 1) & CAPTURE_MASK;
+    int32_t prev = static_cast<int32_t>(m_captureBufferL[prevIdx]) + m_captureBufferR[prevIdx];
+
+    uint32_t bestDistance = UINT32_MAX;
+    uint32_t bestOffset = 0;
+    int8_t bestSlope = 0;
+    uint32_t idx = first;
+    uint32_t distanceBase = 0;  // Offset of idx from first
+
+    while (remaining > 0) {
+        uint32_t run = CAPTURE_SAMPLES - idx;
+        if (run > remaining) run = remaining;
+
+        const int16_t* l = &m_captureBufferL[idx];
+        const int16_t* r = &m_captureBufferR[idx];
+        uint32_t i = 0;
+#if defined(__ARM_ARCH_7EM__)
+        // Packed pairs: SHADD16 forms two mono samples ((L+R)/2 keeps the sign of
+        // L+R) per instruction, and a pair is only unpacked when a lane's sign bit
+        // differs from the previous sample's. Pairs start on an even ring index.
+        if (idx & 1) {
+            int32_t cur = static_cast<int32_t>(l[0]) + r[0];
+            considerCrossing(prev, cur, distanceBase, radius, slope,
+                             bestDistance, bestOffset, bestSlope);
+            prev = cur;
+            i = 1;
+        }
+        const uint32_t* pl = reinterpret_cast<const uint32_t*>(l + i);
+        const uint32_t* pr = reinterpret_cast<const uint32_t*>(r + i);
+        for (; i + 2 <= run; i += 2) {
+            int32_t mono = signed_halving_add_16_and_16(*pl++, *pr++);
+            uint32_t prevSigns = (prev < 0) ? 0x80008000u : 0u;
+            if ((static_cast<uint32_t>(mono) & 0x80008000u) != prevSigns) {
+                int32_t lo = static_cast<int16_t>(mono);
+                int32_t hi = mono >> 16;
+                considerCrossing(prev, lo, distanceBase + i, radius, slope,
+                                 bestDistance, bestOffset, bestSlope);
+                considerCrossing(lo, hi, distanceBase + i + 1, radius, slope,
+                                 bestDistance, bestOffset, bestSlope);
+            }
+            prev = mono >> 16;  // High lane is the later sample
+        }
+#endif
+        for (; i < run; i++) {
+            int32_t cur = static_cast<int32_t>(l[i]) + r[i];
+            considerCrossing(prev, cur, distanceBase + i, radius, slope,
+                             bestDistance, bestOffset, bestSlope);
+            prev = cur;
+        }
+
+        remaining -= run;
+        distanceBase += run;
+        idx = (idx + run) & CAPTURE_MASK;
+    }
+
+    if (bestDistance == UINT32_MAX) {
+        return false;
+    }
+    outIndex = (first + bestOffset) & CAPTURE_MASK;
+    outSlope = bestSlope;
+    return true;
+}
+
+void FreezeAudio::engage() {
+    uint32_t window = sizeToSamples(m_size);
+    m_activeMode = m_mode;
+
+    if (m_activeMode == FreezeMode::SPECTRAL) {
+        // Analyze the newest frame; falls through to grains if not built in
+#if MICROLOOP_SPECTRAL_FREEZE
+        if (m_spectral.start(m_captureBufferL, m_captureBufferR, CAPTURE_MASK,
+                             (m_writePos - 1) & CAPTURE_MASK)) {
+            return;
+        }
+#endif
+        m_activeMode = FreezeMode::GRAIN;
+    }
+
+    if (m_activeMode == FreezeMode::GRAIN) {
+        // Grains need at least one grain length of source
+        if (window < GrainEngine::GRAIN_SAMPLES) window = GrainEngine::GRAIN_SAMPLES;
+        m_grains.start(m_captureBufferL, m_captureBufferR, CAPTURE_MASK,
+                       (m_writePos - window) & CAPTURE_MASK, window, m_grainCount);
+        return;
+    }
+
+    // LOOP: start at the crossing (either slope) nearest the nominal start, then end at
+    // the crossing of the same slope nearest start + window. The wrap from end-1 back
+    // to start repeats the same sign transition, so the seam lands on a zero crossing.
+    // End radius <= window / 2 keeps the loop at least half the requested size.
+    uint32_t endRadius = window / 2;
+    if (endRadius > ZERO_CROSS_RADIUS) endRadius = ZERO_CROSS_RADIUS;
+
+    // Back off far enough that the end search never reads past the newest sample
+    uint32_t nominalStart = (m_writePos - 1 - endRadius - window - ZERO_CROSS_RADIUS) & CAPTURE_MASK;
+
+    uint32_t start = nominalStart;
+    int8_t slope = 0;
+    findZeroCrossing(nominalStart, ZERO_CROSS_RADIUS, 0, start, slope);  // Keeps nominal if none (DC)
+
+    uint32_t end = (start + window) & CAPTURE_MASK;
+    if (slope != 0) {
+        int8_t endSlope = 0;
+        findZeroCrossing(end, endRadius, slope, end, endSlope);  // Keeps nominal if none
+    }
+
+    m_loopStart = start;
+    m_loopLength = (end - start) & CAPTURE_MASK;  // >= window / 2
+    m_loopPos = 0;
+}
+
+void FreezeAudio::processLoop(int16_t* outL, int16_t* outR) {
+    uint32_t n = 0;
+    while (n < AUDIO_BLOCK_SAMPLES) {
+        // Contiguous run: until block end, loop end, or ring wraparound
+        uint32_t idx = (m_loopStart + m_loopPos) & CAPTURE_MASK;
+        uint32_t run = AUDIO_BLOCK_SAMPLES - n;
+        uint32_t toLoopEnd = m_loopLength - m_loopPos;
+        uint32_t toRingEnd = CAPTURE_SAMPLES - idx;
+        if (run > toLoopEnd) run = toLoopEnd;
+        if (run > toRingEnd) run = toRingEnd;
+
+        memcpy(&outL[n], &m_captureBufferL[idx], run * sizeof(int16_t));
+        memcpy(&outR[n], &m_captureBufferR[idx], run * sizeof(int16_t));
+
+        n += run;
+        m_loopPos += run;
+        if (m_loopPos >= m_loopLength) {
+            m_loopPos = 0;
+        }
+    }
 }
 
 void FreezeAudio::enable() {
-    // Set read position to current write position
-    // This captures the most recent audio in the buffer
-    m_readPos = m_writePos;
+    // Grains are started by the ISR on the next block (captures the most recent audio)
     m_state.store(FreezeState::ACTIVE, std::memory_order_release);
 }
 
@@ -42,7 +242,7 @@ const char* FreezeAudio::getName() const {
     return "Freeze";
 }
 
-void FreezeAudio::update() {
+void FreezeAudio::processBlock(int32_t* dataL, int32_t* dataR) {
     uint64_t currentSample = Timebase::getSamplePosition();
     uint64_t blockEndSample = currentSample + AUDIO_BLOCK_SAMPLES;
 
@@ -50,8 +250,7 @@ void FreezeAudio::update() {
     // Fire if the scheduled sample falls within this audio block [currentSample, blockEndSample)
     if (m_onsetAtSample > 0 && m_onsetAtSample >= currentSample && m_onsetAtSample < blockEndSample) {
         // Time to engage freeze (block-accurate - best we can do in ISR)
-        // Transition: ARMED -> ACTIVE
-        m_readPos = m_writePos;  // Capture current buffer position
+        // Transition: ARMED -> ACTIVE (grains start below)
         m_state.store(FreezeState::ACTIVE, std::memory_order_release);
         m_onsetAtSample = 0;  // Clear scheduled onset
     }
@@ -70,63 +269,47 @@ void FreezeAudio::update() {
     bool frozen = (currentState == FreezeState::ACTIVE);
 
     if (!frozen) {
-        // PASSTHROUGH MODE: Record to buffer and pass through
-        audio_block_t* blockL = receiveWritable(0);
-        audio_block_t* blockR = receiveWritable(1);
-
-        if (blockL && blockR) {
-            // Write to circular buffer (continuously recording)
-            for (size_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
-                m_freezeBufferL[m_writePos] = blockL->data[i];
-                m_freezeBufferR[m_writePos] = blockR->data[i];
-
-                // Advance write position (circular)
-                m_writePos++;
-                if (m_writePos >= FREEZE_BUFFER_SAMPLES) {
-                    m_writePos = 0;
-                }
-            }
-
-            // Pass through unmodified
-            transmit(blockL, 0);
-            transmit(blockR, 1);
-        }
-
-        // Release blocks (if allocated)
-        if (blockL) release(blockL);
-        if (blockR) release(blockR);
+        m_wasFrozen = false;
+        m_params[PARAM_MIX].settle();  // Not heard: next freeze starts at the set mix
 
+        // PASSTHROUGH MODE: Record to capture window (int16), audio unchanged
+        // AUDIO_BLOCK_SAMPLES divides CAPTURE_SAMPLES, so a block never wraps
+        AudioBus::narrowBlock(dataL, &m_captureBufferL[m_writePos], AUDIO_BLOCK_SAMPLES);
+        AudioBus::narrowBlock(dataR, &m_captureBufferR[m_writePos], AUDIO_BLOCK_SAMPLES);
+        m_writePos = (m_writePos + AUDIO_BLOCK_SAMPLES) & CAPTURE_MASK;
     } else {
-        // FROZEN MODE: Read from buffer and loop
-        audio_block_t* outL = allocate();
-        audio_block_t* outR = allocate();
-
-        if (outL && outR) {
-            // Read from circular buffer
-            for (size_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
-                outL->data[i] = m_freezeBufferL[m_readPos];
-                outR->data[i] = m_freezeBufferR[m_readPos];
-
-                // Advance read position (circular)
-                m_readPos++;
-                if (m_readPos >= FREEZE_BUFFER_SAMPLES) {
-                    m_readPos = 0;  // Loop back to start
-                }
-            }
-
-            // Transmit frozen audio
-            transmit(outL, 0);
-            transmit(outR, 1);
+        if (!m_wasFrozen) {
+            // Engage: newest window of the capture ring becomes the freeze source
+            engage();
+            m_wasFrozen = true;
         }
 
-        // Release output blocks
-        if (outL) release(outL);
-        if (outR) release(outR);
+        // FROZEN MODE: Grains, aligned loop, or spectral resynthesis from the capture window
+        // Renderers are 16-bit (they read the int16 capture ring) - widen onto the bus
+        if (m_activeMode == FreezeMode::LOOP) {
+            processLoop(s_frozenL, s_frozenR);
+#if MICROLOOP_SPECTRAL_FREEZE
+        } else if (m_activeMode == FreezeMode::SPECTRAL) {
+            // Input is only heard while spectral freeze prepares its first frame
+            AudioBus::narrowBlock(dataL, s_frozenL, AUDIO_BLOCK_SAMPLES);
+            AudioBus::narrowBlock(dataR, s_frozenR, AUDIO_BLOCK_SAMPLES);
+            m_spectral.process(s_frozenL, s_frozenR, s_frozenL, s_frozenR);
+#endif
+        } else {
+            m_grains.process(s_frozenL, s_frozenR);
+        }
 
-        // Consume and discard input blocks (we're not using them)
-        audio_block_t* blockL = receiveReadOnly(0);
-        audio_block_t* blockR = receiveReadOnly(1);
-        if (blockL) release(blockL);
-        if (blockR) release(blockR);
+        SmoothedParam& mix = m_params[PARAM_MIX];
+        const int16_t* mixGains = mix.render();
+        if (mix.isSettledAt(GainRamp::UNITY_Q15)) {
+            AudioBus::widenBlock(s_frozenL, dataL, AUDIO_BLOCK_SAMPLES);
+            AudioBus::widenBlock(s_frozenR, dataR, AUDIO_BLOCK_SAMPLES);
+        } else {
+            // Live input is still on the bus: crossfade the frozen sound into it
+            AudioBus::widenBlock(s_frozenL, s_wetL, AUDIO_BLOCK_SAMPLES);
+            AudioBus::widenBlock(s_frozenR, s_wetR, AUDIO_BLOCK_SAMPLES);
+            GainRamp::mixBus(dataL, s_wetL, mixGains, AUDIO_BLOCK_SAMPLES);
+            GainRamp::mixBus(dataR, s_wetR, mixGains, AUDIO_BLOCK_SAMPLES);
+        }
     }
 }
@@ -2,9 +2,19 @@
 
 #include "IEffectAudio.h"
 #include "Timebase.h"
+#include "GrainEngine.h"
 #include <atomic>
 #include <Arduino.h>
 
+// Spectral freeze (set with the CMSIS-DSP library by CMakeLists.txt): without it, no
+// spectral state, tables or code are built into FreezeAudio (~28 KB)
+#ifndef MICROLOOP_SPECTRAL_FREEZE
+#define MICROLOOP_SPECTRAL_FREEZE 0
+#endif
+#if MICROLOOP_SPECTRAL_FREEZE
+#include "SpectralFreeze.h"
+#endif
+
 enum class FreezeLength : uint8_t {
     FREE = 0,       // Release immediately when button released (default)
     QUANTIZED = 1   // Auto-release after global quantization duration
@@ -15,18 +25,35 @@ enum class FreezeOnset : uint8_t {
     QUANTIZED = 1   // Quantize onset to next beat/subdivision
 };
 
+enum class FreezeMode : uint8_t {
+    GRAIN = 0,      // Overlapping windowed grains from the freeze window (default)
+    LOOP = 1,       // Seamless loop of the freeze window (zero-crossing aligned)
+    SPECTRAL = 2    // Random-phase resynthesis of one captured spectrum (if built in)
+};
+
+enum class FreezeSize : uint8_t {
+    MS_3 = 0,       // ~132 samples (shortest loop, pitched buzz)
+    MS_10 = 1,
+    MS_25 = 2,
+    MS_50 = 3,
+    MS_100 = 4,
+    MS_250 = 5,     // Default
+    MS_500 = 6,
+    MS_1000 = 7     // SAMPLE_RATE samples (longest window)
+};
+
 /**
  * Freeze State Machine
  *
  * State transitions:
  * - IDLE: Not active, audio passes through unfrozen
  * - ARMED: Button pressed with quantized onset, waiting for grid boundary (LED: YELLOW)
- * - ACTIVE: Freeze engaged, looping circular buffer (LED: WHITE)
+ * - ACTIVE: Freeze engaged, grains sustain the captured window (LED: WHITE)
  */
 enum class FreezeState : uint8_t {
     IDLE = 0,    // Not active (LED: OFF)
     ARMED = 1,   // Waiting for quantized onset (LED: YELLOW blinking)
-    ACTIVE = 2   // Freeze engaged, looping buffer (LED: WHITE solid)
+    ACTIVE = 2   // Freeze engaged, grains playing (LED: WHITE solid)
 };
 
 class FreezeAudio : public IEffectAudio {
@@ -64,32 +91,123 @@ public:
     void setOnsetMode(FreezeOnset mode) { m_onsetMode = mode; }
     FreezeOnset getOnsetMode() const { return m_onsetMode; }
 
-    virtual void update() override;
+    /**
+     * Number of overlapping grains (2-8), applied at next engage
+     * More grains = smoother, denser texture
+     */
+    void setGrainCount(uint8_t count) { m_grainCount = count; }
+    uint8_t getGrainCount() const { return m_grainCount; }
+
+    /**
+     * Freeze playback mode (GRAIN, LOOP or SPECTRAL), applied at next engage
+     * SPECTRAL falls back to GRAIN when spectral freeze is not built in.
+     */
+    void setMode(FreezeMode mode) { m_mode = mode; }
+    FreezeMode getMode() const { return m_mode; }
+
+    /**
+     * Number of selectable modes (SPECTRAL only when built in)
+     */
+    static constexpr uint8_t modeCount() { return MICROLOOP_SPECTRAL_FREEZE ? 3 : 2; }
+
+    /**
+     * Freeze window size (3ms-1s), applied at next engage
+     * LOOP: loop length (before zero-crossing alignment)
+     * GRAIN: window grains are drawn from (at least one grain long)
+     * SPECTRAL: ignored (fixed 1024-sample analysis frame)
+     */
+    void setSize(FreezeSize size) { m_size = size; }
+    FreezeSize getSize() const { return m_size; }
+
+    /**
+     * Convert size setting to samples @ Timebase::SAMPLE_RATE
+     */
+    static uint32_t sizeToSamples(FreezeSize size);
+
+    // ========== CONTINUOUS PARAMETERS (setParameter index) ==========
+    static constexpr uint8_t PARAM_MIX = 0;    // Frozen vs live input while frozen (percent)
+    static constexpr uint8_t PARAM_COUNT = 1;
+
+    /**
+     * Wet/dry mix while frozen (0-100%, default 100 = frozen sound only)
+     * Takes effect immediately, smoothed over SmoothedParam::DEFAULT_TIME_MS
+     */
+    void setMix(uint8_t percent) { setParameter(PARAM_MIX, percent); }
+    uint8_t getMix() const { return static_cast<uint8_t>(getParameter(PARAM_MIX) + 0.5f); }
+
+    void processBlock(int32_t* dataL, int32_t* dataR) override;
 
 private:
     /**
-     * - 3ms:   Very harsh buzz (333 Hz fundamental) - similar to single-block repeat
-     * - 10ms:  Medium harshness (100 Hz fundamental)
-     * - 25ms:  Balanced (40 Hz fundamental)
-     * - 50ms:  Textured freeze (20 Hz fundamental)
-     * - 100ms: Loop-like, more musical (10 Hz fundamental)
-     * - 200ms: Clearly recognizable frozen phrase (5 Hz fundamental)
+     * Capture ring (power of 2 for mask wrap):
+     *   65536 samples = ~1.49s @ 44.1kHz, ~1.37s @ 48kHz; 131072 = ~1.37s @ 96kHz
+     * Holds the longest freeze window plus the zero-crossing search margin.
+     * Continuously recorded while not frozen; read-only while frozen.
+     * EXTMEM (PSRAM), like the stutter buffers: 256KB for both channels
+     * (512KB at 96kHz) would take half of OCRAM. Writes are one block per
+     * callback and grain/loop reads are short runs through the data cache.
      */
-    static constexpr uint32_t FREEZE_BUFFER_MS = 3;
+    static constexpr uint32_t CAPTURE_SAMPLES = (Timebase::SAMPLE_RATE > 48000) ? 131072 : 65536;
+    static constexpr uint32_t CAPTURE_MASK = CAPTURE_SAMPLES - 1;
 
     /**
-     * Calculate buffer size in samples (compile-time constant)
-     *
-     * Formula: (milliseconds × 44100 samples/sec) / 1000
-     * Example: 50ms = (50 × 44100) / 1000 = 2205 samples
+     * Zero-crossing search: +/- radius around the nominal loop start
+     * (end search uses min(radius, window / 2)). Bounded scan cost at engage.
+     */
+    static constexpr uint32_t ZERO_CROSS_RADIUS = 256;
+
+    static_assert(Timebase::SAMPLE_RATE + 3 * ZERO_CROSS_RADIUS + 2 < CAPTURE_SAMPLES,
+                  "Capture ring must hold a 1s window plus search margin");
+
+    static EXTMEM int16_t m_captureBufferL[CAPTURE_SAMPLES];
+    static EXTMEM int16_t m_captureBufferR[CAPTURE_SAMPLES];
+
+    /**
+     * Engage freeze (ISR): set up grains or an aligned loop over the newest window
      */
-    static constexpr size_t FREEZE_BUFFER_SAMPLES = (FREEZE_BUFFER_MS * Timebase::SAMPLE_RATE) / 1000;
+    void engage();
 
-    int16_t m_freezeBufferL[FREEZE_BUFFER_SAMPLES];
-    int16_t m_freezeBufferR[FREEZE_BUFFER_SAMPLES];
+    /**
+     * Find the zero crossing nearest to a ring position (ISR, bounded)
+     *
+     * Scans the mono sum (L+R) over [center - radius, center + radius],
+     * two samples per packed step on Cortex-M7.
+     * A crossing at index i means sample i-1 and sample i differ in sign;
+     * slope is +1 for rising (negative -> non-negative), -1 for falling.
+     *
+     * @param center Nominal ring index
+     * @param radius Search radius (samples)
+     * @param slope Required slope (+1/-1), or 0 to accept either
+     * @param outIndex Ring index of crossing (sample i), unchanged if none found
+     * @param outSlope Slope of the crossing found, unchanged if none found
+     * @return true if a crossing was found
+     */
+    static bool findZeroCrossing(uint32_t center, uint32_t radius, int8_t slope,
+                                 uint32_t& outIndex, int8_t& outSlope);
 
-    size_t m_writePos;
-    size_t m_readPos;
+    /**
+     * Render one block of the aligned loop (ISR)
+     */
+    void processLoop(int16_t* outL, int16_t* outR);
+
+    SmoothedParam m_params[PARAM_COUNT];  // Continuous parameters (bound to setParameter)
+
+    GrainEngine m_grains;   // Grain player (started by ISR on engage)
+#if MICROLOOP_SPECTRAL_FREEZE
+    SpectralFreeze m_spectral;  // Spectral resynthesis (started by ISR on engage)
+#endif
+    uint8_t m_grainCount;   // Grains used at next engage
+    FreezeMode m_mode;      // Playback mode used at next engage
+    FreezeSize m_size;      // Window size used at next engage
+    FreezeMode m_activeMode;  // Playback mode of the current freeze (ISR)
+    bool m_wasFrozen;       // ISR edge detection for engage
+
+    uint32_t m_writePos;    // Next capture index (oldest sample once buffer is full)
+
+    // ========== LOOP MODE ==========
+    uint32_t m_loopStart;   // Ring index of first loop sample (zero crossing)
+    uint32_t m_loopLength;  // Loop length in samples (crossing to crossing)
+    uint32_t m_loopPos;     // Read offset within loop (0..m_loopLength-1)
 
     // ========== STATE MACHINE ==========
     // State is atomic for lock-free cross-thread access
@@ -0,0 +1,51 @@
+#include "GainRamp.h"
+
+#if defined(__ARM_ARCH_7EM__)
+#include "utility/dspinst.h"
+#endif
+
+namespace GainRamp {
+
+void applyBus(int32_t* data, const int16_t* gains, size_t numSamples) {
+#if defined(__ARM_ARCH_7EM__)
+    for (size_t i = 0; i < numSamples; i++) {
+        // SMULWB: (bus * Q15) >> 16, one cycle; << 1 restores the Q15 scale
+        data[i] = signed_multiply_32x16b(data[i], static_cast<uint16_t>(gains[i])) << 1;
+    }
+#else
+    applyBusReference(data, gains, numSamples);
+#endif
+}
+
+void applyBusReference(int32_t* data, const int16_t* gains, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; i++) {
+        int32_t product = static_cast<int32_t>((static_cast<int64_t>(data[i]) * gains[i]) >> 16);
+        data[i] = static_cast<int32_t>(static_cast<uint32_t>(product) << 1);
+    }
+}
+
+void mixBus(int32_t* dry, const int32_t* wet, const int16_t* gains, size_t numSamples) {
+#if defined(__ARM_ARCH_7EM__)
+    for (size_t i = 0; i < numSamples; i++) {
+        uint32_t g = static_cast<uint16_t>(gains[i]);
+        uint32_t inv = static_cast<uint16_t>(UNITY_Q15 - gains[i]);
+        // SMULWB then SMLAWB: both terms at (bus * Q15) >> 16, one cycle each
+        int32_t sum = signed_multiply_32x16b(dry[i], inv);
+        sum = signed_multiply_accumulate_32x16b(sum, wet[i], g);
+        dry[i] = sum << 1;
+    }
+#else
+    mixBusReference(dry, wet, gains, numSamples);
+#endif
+}
+
+void mixBusReference(int32_t* dry, const int32_t* wet, const int16_t* gains, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; i++) {
+        int32_t g = gains[i];
+        int32_t dryPart = static_cast<int32_t>((static_cast<int64_t>(dry[i]) * (UNITY_Q15 - g)) >> 16);
+        int32_t wetPart = static_cast<int32_t>((static_cast<int64_t>(wet[i]) * g) >> 16);
+        dry[i] = static_cast<int32_t>(static_cast<uint32_t>(dryPart + wetPart) << 1);
+    }
+}
+
+}
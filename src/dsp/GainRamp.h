@@ -0,0 +1,57 @@
+/**
+ * GainRamp.h - Fixed-point gain kernels for the 32-bit AudioBus (Q15 gains)
+ *
+ * PURPOSE:
+ * Applies short click-free gain fades (e.g. choke mute/unmute) and wet/dry
+ * crossfades with integer arithmetic only, sharing one precomputed ramp
+ * between both stereo channels.
+ *
+ * DESIGN:
+ * - Gain is Q15 in [0, UNITY_Q15] (32767 ~= 1.0, fits a signed 16-bit lane)
+ * - Ramps come from FadeEnvelope::render() or SmoothedParam::render()
+ * - applyBus(): gain on 32-bit bus frames (SMULWB, 32x16 -> top 32)
+ * - mixBus(): wet/dry crossfade on bus frames, dry * (1 - g) + wet * g
+ *   (SMULWB + SMLAWB; no wet - dry difference, so no overflow at full bus range)
+ * - Portable: the *Reference() functions are the bit-exact specifications
+ *
+ * USAGE:
+ *   static int16_t gains[AUDIO_BLOCK_SAMPLES];
+ *   envelope.render(gains, AUDIO_BLOCK_SAMPLES);
+ *   GainRamp::applyBus(busL, gains, AUDIO_BLOCK_SAMPLES);
+ *   GainRamp::applyBus(busR, gains, AUDIO_BLOCK_SAMPLES);
+ *   GainRamp::mixBus(dryL, wetL, gains, AUDIO_BLOCK_SAMPLES); // dryL becomes the mix
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace GainRamp {
+
+// Q15 unity gain (largest value that fits a signed 16-bit lane)
+constexpr int32_t UNITY_Q15 = 32767;
+
+/**
+ * Apply a precomputed ramp in place to 32-bit bus samples:
+ * data[i] = ((data[i] * gains[i]) >> 16) << 1  (Q15 gain, bus resolution kept)
+ */
+void applyBus(int32_t* data, const int16_t* gains, size_t numSamples);
+
+/**
+ * Portable reference for applyBus() (bit-exact)
+ */
+void applyBusReference(int32_t* data, const int16_t* gains, size_t numSamples);
+
+/**
+ * Crossfade 32-bit bus samples in place (gains = wet amount, Q15):
+ * dry[i] = (((dry[i] * (UNITY_Q15 - gains[i])) >> 16) + ((wet[i] * gains[i]) >> 16)) << 1
+ */
+void mixBus(int32_t* dry, const int32_t* wet, const int16_t* gains, size_t numSamples);
+
+/**
+ * Portable reference for mixBus() (bit-exact)
+ */
+void mixBusReference(int32_t* dry, const int32_t* wet, const int16_t* gains, size_t numSamples);
+
+}
@@ -0,0 +1,145 @@
+#include "GateSequencer.h"
+#include "GainRamp.h"
+#include "Timebase.h"
+#include <string.h>
+#include <math.h>
+
+uint16_t GateSequencer::s_shapes[GATE_SHAPE_COUNT][GateSequencer::SHAPE_TABLE_SIZE + 1];
+bool GateSequencer::s_tablesReady = false;
+
+// Anti-click edge length as a fraction of the step (~2ms at 120 BPM 1/16)
+static constexpr float EDGE = 0.02f;
+
+/**
+ * Raised-cosine edge: 0 at x = 0, 1 at x = width
+ */
+static float edgeRise(float x, float width) {
+    if (x >= width) return 1.0f;
+    if (x <= 0.0f) return 0.0f;
+    return 0.5f - 0.5f * cosf(static_cast<float>(M_PI) * x / width);
+}
+
+void GateSequencer::buildTables() {
+    for (uint32_t i = 0; i <= SHAPE_TABLE_SIZE; i++) {
+        float x = static_cast<float>(i) / SHAPE_TABLE_SIZE;
+        float release = edgeRise(1.0f - x, EDGE);  // Every shape is silent at the step boundary
+
+        float shapes[GATE_SHAPE_COUNT] = {
+            edgeRise(x, EDGE) * release,                          // GATE
+            x * release,                                          // SWELL
+            edgeRise(x, EDGE) * expf(-4.0f * x) * release,        // PLUCK
+            edgeRise(x, EDGE) * edgeRise(0.5f - x, EDGE)          // SHORT
+        };
+        for (uint32_t s = 0; s < GATE_SHAPE_COUNT; s++) {
+            s_shapes[s][i] = static_cast<uint16_t>(lroundf(shapes[s] * GainRamp::UNITY_Q15));
+        }
+    }
+    s_tablesReady = true;
+}
+
+void GateSequencer::defaultPattern(GatePattern& pattern) {
+    // Classic 1/16 trance gate: x.xx .xx. x.xx .xxx
+    static const uint8_t levels[16] = {8, 0, 8, 8, 0, 8, 8, 0, 8, 0, 8, 8, 0, 8, 8, 8};
+    pattern.numSteps = 16;
+    for (uint8_t i = 0; i < GATE_MAX_STEPS; i++) {
+        pattern.levels[i] = levels[i % 16];
+        pattern.shapes[i] = static_cast<uint8_t>(GateShape::GATE);
+    }
+}
+
+GateSequencer::GateSequencer() {
+    if (!s_tablesReady) {
+        buildTables();
+    }
+    defaultPattern(m_pattern);
+    m_step = 0;
+    m_samplesToStep = 0;
+    m_phase = 0;
+    m_phaseInc = 0;
+    m_stepInBeat = 0;
+    m_levelQ15 = 0;
+    m_shape = s_shapes[0];
+}
+
+void GateSequencer::setPattern(const GatePattern& pattern) {
+    GatePattern copy = pattern;
+    if (copy.numSteps != 16 && copy.numSteps != 32) copy.numSteps = 16;
+    for (uint8_t i = 0; i < GATE_MAX_STEPS; i++) {
+        if (copy.levels[i] > GATE_LEVEL_MAX) copy.levels[i] = GATE_LEVEL_MAX;
+        if (copy.shapes[i] >= GATE_SHAPE_COUNT) copy.shapes[i] = static_cast<uint8_t>(GateShape::GATE);
+    }
+    memcpy(&m_pattern, &copy, sizeof(GatePattern));
+}
+
+void GateSequencer::setNumSteps(uint8_t numSteps) {
+    m_pattern.numSteps = (numSteps == 32) ? 32 : 16;
+}
+
+void GateSequencer::setStepLevel(uint8_t step, uint8_t level) {
+    if (step >= GATE_MAX_STEPS) return;
+    m_pattern.levels[step] = (level > GATE_LEVEL_MAX) ? GATE_LEVEL_MAX : level;
+}
+
+void GateSequencer::setStepShape(uint8_t step, GateShape shape) {
+    if (step >= GATE_MAX_STEPS || static_cast<uint8_t>(shape) >= GATE_SHAPE_COUNT) return;
+    m_pattern.shapes[step] = static_cast<uint8_t>(shape);
+}
+
+void GateSequencer::locateStep(uint64_t position) {
+    // Steps end on floor(k * spb / 4) within the beat: lengths differ by at most a
+    // sample, and every beat ends exactly on the Timebase beat grid
+    uint32_t spb = Timebase::getSamplesPerBeat();
+    if (spb < STEPS_PER_BEAT) spb = STEPS_PER_BEAT;
+    uint32_t withinBeat = static_cast<uint32_t>(position % spb);
+    uint32_t stepInBeat = (withinBeat * STEPS_PER_BEAT + STEPS_PER_BEAT - 1) / spb;
+    if (stepInBeat >= STEPS_PER_BEAT) stepInBeat = STEPS_PER_BEAT - 1;
+    uint32_t stepStart = (stepInBeat * spb) / STEPS_PER_BEAT;
+    uint32_t stepEnd = ((stepInBeat + 1) * spb) / STEPS_PER_BEAT;
+
+    m_stepInBeat = static_cast<uint8_t>(stepInBeat);
+    m_samplesToStep = stepEnd - withinBeat;
+    m_phaseInc = PHASE_END / (stepEnd - stepStart);
+    m_phase = (withinBeat - stepStart) * m_phaseInc;
+}
+
+void GateSequencer::beginStep() {
+    uint8_t step = m_step;
+    // Level 0..8 -> Q15 without division (8 = unity)
+    m_levelQ15 = (static_cast<int32_t>(m_pattern.levels[step]) * GainRamp::UNITY_Q15) >> 3;
+    uint8_t shape = m_pattern.shapes[step];
+    m_shape = s_shapes[shape < GATE_SHAPE_COUNT ? shape : 0];
+}
+
+void GateSequencer::sync() {
+    // Current 1/16 from the sample position on the beat grid (block start)
+    uint64_t position = Timebase::getSamplePosition();
+    locateStep(position);
+    uint64_t beat = position / Timebase::getSamplesPerBeat();
+    m_step = static_cast<uint8_t>((beat * STEPS_PER_BEAT + m_stepInBeat) % m_pattern.numSteps);
+    beginStep();
+}
+
+void GateSequencer::render(int16_t* gains, size_t numSamples) {
+    uint64_t blockStart = Timebase::getSamplePosition();
+    for (size_t i = 0; i < numSamples; i++) {
+        if (m_samplesToStep == 0) {
+            // Step boundary: advance pattern, next boundary from the Timebase grid
+            // (follows tempo changes, never accumulates rounding)
+            uint8_t next = m_step + 1;
+            m_step = (next >= m_pattern.numSteps) ? 0 : next;
+            locateStep(blockStart + i);
+            beginStep();
+        }
+
+        uint32_t phase = (m_phase < PHASE_END) ? m_phase : PHASE_END - 1;
+        uint32_t idx = phase >> 16;
+        int32_t frac = static_cast<int32_t>((phase >> 1) & 0x7FFF);
+        int32_t a = m_shape[idx];
+        int32_t b = m_shape[idx + 1];
+        int32_t shape = a + (((b - a) * frac) >> 15);
+        gains[i] = static_cast<int16_t>((m_levelQ15 * shape) >> 15);
+
+        m_phase += m_phaseInc;
+        m_samplesToStep--;
+    }
+}
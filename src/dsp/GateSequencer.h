@@ -0,0 +1,123 @@
+/**
+ * GateSequencer.h - Tempo-synced rhythmic gate pattern (trance gate)
+ *
+ * PURPOSE:
+ * Renders a 16 or 32-step gain pattern locked to the Timebase 1/16 grid,
+ * used by ChokeAudio's GATE mode to chop audio rhythmically instead of muting.
+ *
+ * DESIGN:
+ * - One step per 1/16 note (16 steps = 1 bar, 32 steps = 2 bars)
+ * - Each step: level (0-8 eighths of unity) and shape (GATE, SWELL, PLUCK, SHORT)
+ * - Step envelopes from precomputed Q15 shape tables (built once), linearly
+ *   interpolated with an 8.16 phase accumulator
+ * - All integer: divisions happen once per step (locating the next boundary),
+ *   never per sample
+ * - Every step boundary comes from the Timebase sample position on the beat grid
+ *   (step k of a beat ends at floor((k + 1) * spb / 4)), so the pattern never
+ *   drifts off the 1/16 grid and follows tempo changes at the next boundary
+ * - Pattern is a POD (GatePattern) so it can be stored with presets; edits from
+ *   the App thread are single-byte writes read by the ISR once per step
+ *
+ * USAGE:
+ *   GateSequencer gate;
+ *   gate.sync();                  // Audio ISR, when the gate starts
+ *   gate.render(gains, AUDIO_BLOCK_SAMPLES);  // Audio ISR, each block (Q15 gains)
+ *   gate.setStepLevel(3, 4);      // App thread: step 4 at 50%
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+enum class GateShape : uint8_t {
+    GATE = 0,    // Full step with short anti-click edges (default)
+    SWELL = 1,   // Rises across the step, quick release
+    PLUCK = 2,   // Quick attack, exponential decay
+    SHORT = 3    // Half-step gate
+};
+
+// ========== PATTERN ==========
+static constexpr uint8_t GATE_MAX_STEPS = 32;
+static constexpr uint8_t GATE_LEVEL_MAX = 8;      // Level 8 = unity, 4 = 50%, 0 = silent
+static constexpr uint8_t GATE_SHAPE_COUNT = 4;
+
+struct GatePattern {
+    uint8_t numSteps;                  // 16 or 32
+    uint8_t levels[GATE_MAX_STEPS];    // 0..GATE_LEVEL_MAX
+    uint8_t shapes[GATE_MAX_STEPS];    // GateShape
+};
+
+class GateSequencer {
+public:
+    // ========== CONFIGURATION ==========
+    static constexpr uint32_t STEPS_PER_BEAT = 4;   // 1/16 notes
+    static constexpr uint32_t SHAPE_TABLE_BITS = 8;
+    static constexpr uint32_t SHAPE_TABLE_SIZE = 1u << SHAPE_TABLE_BITS;
+    static constexpr uint32_t PHASE_END = SHAPE_TABLE_SIZE << 16;  // Phase at end of step (8.16)
+
+    GateSequencer();
+
+    // ========== AUDIO ISR ==========
+
+    /**
+     * Align step position to the Timebase 1/16 grid
+     */
+    void sync();
+
+    /**
+     * Render numSamples pattern gains (Q15) and advance
+     */
+    void render(int16_t* gains, size_t numSamples);
+
+    // ========== PATTERN EDITING (App thread) ==========
+
+    const GatePattern& getPattern() const { return m_pattern; }
+    void setPattern(const GatePattern& pattern);
+
+    uint8_t getNumSteps() const { return m_pattern.numSteps; }
+    void setNumSteps(uint8_t numSteps);
+
+    uint8_t getStepLevel(uint8_t step) const { return m_pattern.levels[step % GATE_MAX_STEPS]; }
+    void setStepLevel(uint8_t step, uint8_t level);
+
+    GateShape getStepShape(uint8_t step) const { return static_cast<GateShape>(m_pattern.shapes[step % GATE_MAX_STEPS]); }
+    void setStepShape(uint8_t step, GateShape shape);
+
+    /**
+     * Step currently playing (for display)
+     */
+    uint8_t getCurrentStep() const { return m_step; }
+
+    /**
+     * Default trance gate pattern (16 steps, repeated in steps 17-32)
+     */
+    static void defaultPattern(GatePattern& pattern);
+
+private:
+    static void buildTables();
+
+    /**
+     * Place the step containing position on the 1/16 grid: step in beat, samples
+     * to its end, phase and phase increment
+     */
+    void locateStep(uint64_t position);
+
+    /**
+     * Latch level and shape of the current step
+     */
+    void beginStep();
+
+    // ========== TABLES (shared, computed once) ==========
+    static uint16_t s_shapes[GATE_SHAPE_COUNT][SHAPE_TABLE_SIZE + 1];
+    static bool s_tablesReady;
+
+    // ========== STATE ==========
+    GatePattern m_pattern;
+    volatile uint8_t m_step;    // Current step index (ISR writes, thread reads)
+    uint32_t m_samplesToStep;   // Samples until next step boundary
+    uint32_t m_phase;           // Position in step shape (8.16)
+    uint32_t m_phaseInc;        // PHASE_END / step length
+    uint8_t m_stepInBeat;       // 1/16 within the beat (0-3) of the current step
+    int32_t m_levelQ15;         // Latched level of current step
+    const uint16_t* m_shape;    // Latched shape table of current step
+};
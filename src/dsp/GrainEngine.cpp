@@ -0,0 +1,124 @@
+#include "GrainEngine.h"
+#include <math.h>
+
+uint16_t GrainEngine::s_window[GrainEngine::GRAIN_SAMPLES];
+bool GrainEngine::s_windowReady = false;
+
+// Block accumulators (internal RAM, one engine renders at a time from the audio ISR)
+static int32_t s_accL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_accR[AUDIO_BLOCK_SAMPLES];
+
+GrainEngine::GrainEngine() {
+    if (!s_windowReady) {
+        // Periodic Hann: w[i] = 0.5 - 0.5 * cos(2*pi*i / GRAIN_SAMPLES)
+        for (uint32_t i = 0; i < GRAIN_SAMPLES; i++) {
+            float w = 0.5f - 0.5f * cosf(2.0f * static_cast<float>(M_PI) * i / GRAIN_SAMPLES);
+            s_window[i] = static_cast<uint16_t>(lroundf(w * 32768.0f));
+        }
+        s_windowReady = true;
+    }
+
+    m_srcL = nullptr;
+    m_srcR = nullptr;
+    m_srcMask = 0;
+    m_windowStart = 0;
+    m_windowRange = 1;
+    memset(m_grains, 0, sizeof(m_grains));
+    m_numGrains = 0;  // Silent until start()
+    m_gainQ15 = 0;
+    m_rngState = 0x9E3779B9u;
+}
+
+uint32_t GrainEngine::nextRandom() {
+    uint32_t x = m_rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m_rngState = x;
+    return x;
+}
+
+uint32_t GrainEngine::randomStart() {
+    // Scale 32-bit random into [0, range) with multiply-high (no division)
+    uint32_t offset = static_cast<uint32_t>((static_cast<uint64_t>(nextRandom()) * m_windowRange) >> 32);
+    return m_windowStart + offset;
+}
+
+void GrainEngine::start(const int16_t* srcL, const int16_t* srcR, uint32_t srcMask,
+                        uint32_t windowStart, uint32_t windowLength, uint8_t numGrains) {
+    if (numGrains < MIN_GRAINS) numGrains = MIN_GRAINS;
+    if (numGrains > MAX_GRAINS) numGrains = MAX_GRAINS;
+    if (windowLength < GRAIN_SAMPLES) windowLength = GRAIN_SAMPLES;
+
+    m_srcL = srcL;
+    m_srcR = srcR;
+    m_srcMask = srcMask;
+    m_windowStart = windowStart;
+    m_windowRange = windowLength - GRAIN_SAMPLES + 1;
+    m_numGrains = numGrains;
+    m_gainQ15 = static_cast<int32_t>(65536 / numGrains);  // 2/N in Q15
+
+    // Stagger grains evenly across one grain length so the windows sum to N/2
+    for (uint8_t g = 0; g < numGrains; g++) {
+        uint32_t phase = (GRAIN_SAMPLES * g) / numGrains;
+        m_grains[g].phase = phase;
+        m_grains[g].srcPos = randomStart() + phase;
+    }
+}
+
+void GrainEngine::process(int16_t* outL, int16_t* outR) {
+    if (m_numGrains == 0) {
+        memset(outL, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+        memset(outR, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+        return;
+    }
+
+    memset(s_accL, 0, sizeof(s_accL));
+    memset(s_accR, 0, sizeof(s_accR));
+
+    const uint32_t srcSize = m_srcMask + 1;
+
+    for (uint8_t g = 0; g < m_numGrains; g++) {
+        Grain& grain = m_grains[g];
+        uint32_t n = 0;
+
+        while (n < AUDIO_BLOCK_SAMPLES) {
+            // Contiguous run: until block end, grain end, or source wraparound
+            uint32_t srcIdx = grain.srcPos & m_srcMask;
+            uint32_t run = AUDIO_BLOCK_SAMPLES - n;
+            uint32_t toGrainEnd = GRAIN_SAMPLES - grain.phase;
+            uint32_t toSrcEnd = srcSize - srcIdx;
+            if (run > toGrainEnd) run = toGrainEnd;
+            if (run > toSrcEnd) run = toSrcEnd;
+
+            const int16_t* sL = &m_srcL[srcIdx];
+            const int16_t* sR = &m_srcR[srcIdx];
+            const uint16_t* w = &s_window[grain.phase];
+            int32_t* aL = &s_accL[n];
+            int32_t* aR = &s_accR[n];
+            for (uint32_t i = 0; i < run; i++) {
+                int32_t win = w[i];
+                aL[i] += (sL[i] * win) >> 15;
+                aR[i] += (sR[i] * win) >> 15;
+            }
+
+            n += run;
+            grain.phase += run;
+            grain.srcPos += run;
+
+            if (grain.phase >= GRAIN_SAMPLES) {
+                // Grain finished - respawn at a new random offset
+                grain.phase = 0;
+                grain.srcPos = randomStart();
+            }
+        }
+    }
+
+    // Normalize overlap (N/2 windows) and saturate to 16-bit
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        int32_t l = (s_accL[i] * m_gainQ15) >> 15;
+        int32_t r = (s_accR[i] * m_gainQ15) >> 15;
+        outL[i] = static_cast<int16_t>(l > 32767 ? 32767 : (l < -32768 ? -32768 : l));
+        outR[i] = static_cast<int16_t>(r > 32767 ? 32767 : (r < -32768 ? -32768 : r));
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * GrainEngine.h - Windowed multi-grain player for granular freeze
+ *
+ * PURPOSE:
+ * Sustains a frozen moment of audio without the buzz and seam clicks of a
+ * short hard loop, by overlapping Hann-windowed grains read from random
+ * offsets inside a longer captured window.
+ *
+ * DESIGN:
+ * - 2-8 grains, GRAIN_SAMPLES long, evenly staggered (constant overlap)
+ *   - Sum of N staggered Hann windows = N/2, normalized by a Q15 gain of 2/N
+ * - Window from a Q15 lookup table (computed once, shared by all instances)
+ * - Grain start offsets from a xorshift32 PRNG (no division: multiply-high)
+ * - Block-vectorised mixing: each grain renders contiguous runs into a
+ *   block accumulator (split only at grain end and source wraparound),
+ *   instead of visiting every grain for every sample
+ * - Source is a power-of-2 circular buffer owned by the caller (read-only)
+ *
+ * USAGE:
+ *   GrainEngine grains;
+ *   grains.start(bufL, bufR, BUFFER_MASK, windowStart, windowLength, 8);
+ *   grains.process(outL, outR);  // Each audio block (AUDIO_BLOCK_SAMPLES)
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <AudioStream.h>
+#include "Timebase.h"
+
+class GrainEngine {
+public:
+    // ========== CONFIGURATION ==========
+    static constexpr uint8_t MIN_GRAINS = 2;
+    static constexpr uint8_t MAX_GRAINS = 8;
+    // ~43-46ms whatever the sample rate (power of 2): 2048 @ 44.1/48kHz, 4096 @ 96kHz
+    static constexpr uint32_t GRAIN_SAMPLES = (Timebase::SAMPLE_RATE > 48000) ? 4096 : 2048;
+
+    GrainEngine();
+
+    /**
+     * Start grains over a frozen window of a circular source buffer
+     *
+     * @param srcL Left channel source (circular, power-of-2 size)
+     * @param srcR Right channel source (circular, power-of-2 size)
+     * @param srcMask Source size - 1
+     * @param windowStart Index of oldest sample of the frozen window
+     * @param windowLength Frozen window length (>= GRAIN_SAMPLES)
+     * @param numGrains Number of overlapping grains (MIN_GRAINS..MAX_GRAINS)
+     */
+    void start(const int16_t* srcL, const int16_t* srcR, uint32_t srcMask,
+               uint32_t windowStart, uint32_t windowLength, uint8_t numGrains);
+
+    /**
+     * Render one block (AUDIO_BLOCK_SAMPLES) of grain output
+     */
+    void process(int16_t* outL, int16_t* outR);
+
+private:
+    struct Grain {
+        uint32_t srcPos;   // Current source index (unmasked, wraps via mask)
+        uint32_t phase;    // Position within grain window (0..GRAIN_SAMPLES-1)
+    };
+
+    /**
+     * xorshift32 PRNG
+     */
+    uint32_t nextRandom();
+
+    /**
+     * Random grain start index inside the frozen window
+     */
+    uint32_t randomStart();
+
+    // ========== WINDOW ==========
+    static uint16_t s_window[GRAIN_SAMPLES];  // Periodic Hann, Q15 (32768 = 1.0)
+    static bool s_windowReady;
+
+    // ========== SOURCE ==========
+    const int16_t* m_srcL;
+    const int16_t* m_srcR;
+    uint32_t m_srcMask;
+    uint32_t m_windowStart;
+    uint32_t m_windowRange;   // Valid grain start range (windowLength - GRAIN_SAMPLES + 1)
+
+    // ========== GRAINS ==========
+    Grain m_grains[MAX_GRAINS];
+    uint8_t m_numGrains;
+    int32_t m_gainQ15;        // 2 / numGrains (Q15)
+    uint32_t m_rngState;      // xorshift32 state (never 0)
+};
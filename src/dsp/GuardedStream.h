@@ -0,0 +1,183 @@
+/**
+ * GuardedStream.h - AudioStream base that degrades instead of dropping blocks
+ *
+ * PURPOSE:
+ * receiveWritable() returns nullptr when an input block is missing or when
+ * copy-on-write can't get a block from the pool, and skipping the block is an
+ * audible dropout with no record. Stereo nodes deriving from GuardedStream
+ * receive and transmit through a fallback policy instead, and count every
+ * degraded block per node (AudioPoolMonitor keeps the totals and traces).
+ *
+ * DESIGN:
+ * - receiveStereo() classifies each channel:
+ *   - Writable: exclusive input, or shared input copied into a new block
+ *   - HELD: input missing, replacement block filled from the last good input
+ *     (time-reversed so it continues from the last sample, faded to zero over
+ *     the block; later consecutive misses are silent)
+ *   - PASSTHROUGH: shared input and no block to copy into - kept read-only
+ *   - Missing: no input and no block to replace it
+ * - The node always processes its bus (widenStereo() fills a missing channel
+ *   from the other one, or silence), so effect state never skips a block;
+ *   only what is sent on degrades (transmitStereo()):
+ *   - Read-only channel: sent on unprocessed
+ *   - MONO: one channel missing, the other is sent on both outputs
+ *   - DROPPED: both missing, nothing to send
+ * - Counters are written by the audio ISR only (32-bit reads from the app thread)
+ *
+ * USAGE:
+ *   void update() override {
+ *       StereoBlocks io;
+ *       receiveStereo(io);
+ *       widenStereo(io, busL, busR);
+ *       ... process busL/busR ...
+ *       if (io.writable[0]) AudioBus::narrowBlock(busL, io.block[0]->data, AUDIO_BLOCK_SAMPLES);
+ *       if (io.writable[1]) AudioBus::narrowBlock(busR, io.block[1]->data, AUDIO_BLOCK_SAMPLES);
+ *       transmitStereo(io);
+ *   }
+ */
+
+#pragma once
+
+#include <Audio.h>
+#include <string.h>
+#include "AudioBus.h"
+#include "AudioPoolMonitor.h"
+
+class GuardedStream : public AudioStream {
+public:
+    GuardedStream(unsigned char numInputs, audio_block_t** inputQueue)
+        : AudioStream(numInputs, inputQueue), m_missStreak{0, 0}, m_poolTag(0) {
+        memset(m_hold, 0, sizeof(m_hold));
+        for (uint8_t i = 0; i < POOL_FALLBACK_COUNT; i++) {
+            m_fallbacks[i] = 0;
+        }
+    }
+
+    /**
+     * Node identifier for AudioPoolMonitor traces (EffectID for effects, 0 = chain)
+     */
+    void setPoolTag(uint8_t tag) { m_poolTag = tag; }
+    uint8_t getPoolTag() const { return m_poolTag; }
+
+    /**
+     * Blocks this node degraded, by kind, since boot
+     */
+    uint32_t getFallbackCount(PoolFallback kind) const {
+        uint8_t index = static_cast<uint8_t>(kind);
+        return (index < POOL_FALLBACK_COUNT) ? m_fallbacks[index] : 0;
+    }
+
+protected:
+    struct StereoBlocks {
+        audio_block_t* block[2];   // nullptr = channel missing
+        bool writable[2];          // false = shared input, send on unchanged
+    };
+
+    /**
+     * Receive inputs 0 and 1 through the fallback policy (audio ISR)
+     */
+    void receiveStereo(StereoBlocks& io) {
+        receiveChannel(io, 0);
+        receiveChannel(io, 1);
+    }
+
+    /**
+     * Widen the received blocks onto the bus
+     * A missing channel gets the other channel's input (mono), or silence
+     */
+    static void widenStereo(const StereoBlocks& io, int32_t* busL, int32_t* busR) {
+        const audio_block_t* srcL = io.block[0] ? io.block[0] : io.block[1];
+        const audio_block_t* srcR = io.block[1] ? io.block[1] : io.block[0];
+        if (srcL) {
+            AudioBus::widenBlock(srcL->data, busL, AUDIO_BLOCK_SAMPLES);
+        } else {
+            memset(busL, 0, AUDIO_BLOCK_SAMPLES * sizeof(int32_t));
+        }
+        if (srcR) {
+            AudioBus::widenBlock(srcR->data, busR, AUDIO_BLOCK_SAMPLES);
+        } else {
+            memset(busR, 0, AUDIO_BLOCK_SAMPLES * sizeof(int32_t));
+        }
+    }
+
+    /**
+     * Send the blocks on (caller has narrowed into the writable ones), then release
+     */
+    void transmitStereo(StereoBlocks& io) {
+        audio_block_t* blockL = io.block[0];
+        audio_block_t* blockR = io.block[1];
+
+        if (blockL && blockR) {
+            transmit(blockL, 0);
+            transmit(blockR, 1);
+        } else if (blockL || blockR) {
+            audio_block_t* block = blockL ? blockL : blockR;
+            transmit(block, 0);
+            transmit(block, 1);
+            recordFallback(PoolFallback::MONO);
+        } else {
+            recordFallback(PoolFallback::DROPPED);
+        }
+
+        if (blockL) release(blockL);
+        if (blockR) release(blockR);
+    }
+
+private:
+    void receiveChannel(StereoBlocks& io, uint8_t ch) {
+        audio_block_t* in = receiveReadOnly(ch);
+        io.block[ch] = nullptr;
+        io.writable[ch] = false;
+
+        if (in) {
+            if (in->ref_count > 1) {
+                // Copy-on-write (what receiveWritable() does, minus dropping the input on failure)
+                audio_block_t* copy = allocate();
+                if (!copy) {
+                    io.block[ch] = in;
+                    recordFallback(PoolFallback::PASSTHROUGH);
+                    return;
+                }
+                memcpy(copy->data, in->data, sizeof(copy->data));
+                release(in);
+                in = copy;
+            }
+            memcpy(m_hold[ch], in->data, sizeof(m_hold[ch]));
+            m_missStreak[ch] = 0;
+            io.block[ch] = in;
+            io.writable[ch] = true;
+            return;
+        }
+
+        // Input missing: hold the last input if the pool can spare a block
+        audio_block_t* held = allocate();
+        if (!held) {
+            return;  // Counted as MONO/DROPPED when transmitting
+        }
+        if (m_missStreak[ch] == 0) {
+            const int16_t* last = m_hold[ch];
+            for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+                int32_t sample = last[AUDIO_BLOCK_SAMPLES - 1 - i];
+                held->data[i] = static_cast<int16_t>((sample * static_cast<int32_t>(AUDIO_BLOCK_SAMPLES - i)) /
+                                                     static_cast<int32_t>(AUDIO_BLOCK_SAMPLES));
+            }
+        } else {
+            memset(held->data, 0, sizeof(held->data));
+        }
+        if (m_missStreak[ch] < 0xFF) m_missStreak[ch]++;
+        io.block[ch] = held;
+        io.writable[ch] = true;
+        recordFallback(PoolFallback::HELD);
+    }
+
+    void recordFallback(PoolFallback kind) {
+        uint8_t index = static_cast<uint8_t>(kind);
+        m_fallbacks[index] = m_fallbacks[index] + 1;
+        AudioPoolMonitor::recordFallback(m_poolTag, kind);
+    }
+
+    int16_t m_hold[2][AUDIO_BLOCK_SAMPLES];    // Last good input per channel
+    uint8_t m_missStreak[2];                   // Consecutive missing inputs (saturating)
+    uint8_t m_poolTag;
+    volatile uint32_t m_fallbacks[POOL_FALLBACK_COUNT];
+};
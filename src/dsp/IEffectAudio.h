@@ -1,11 +1,16 @@
 #pragma once
 
 #include <Audio.h>
+#include "AudioBus.h"
+#include "DspProfiler.h"
+#include "GuardedStream.h"
+#include "SmoothedParam.h"
 
-class IEffectAudio : public AudioStream {
+class IEffectAudio : public GuardedStream {
 public:
     IEffectAudio(uint8_t numInputs)
-        : AudioStream(numInputs, inputQueueArray) {}
+        : GuardedStream(numInputs, inputQueueArray), m_params(nullptr), m_numParams(0),
+          m_profileSlot(DspProfiler::INVALID_SLOT) {}
 
     virtual ~IEffectAudio() = default;
 
@@ -19,18 +24,93 @@ public:
 
     virtual const char* getName() const = 0;
 
+    // ========== PARAMETERS ==========
+
+    /**
+     * Set a continuous parameter's target (app thread, wait-free)
+     * Default: the SmoothedParam table bound by the effect; the audio ISR
+     * ramps to the new value over the following block(s).
+     *
+     * @param paramIndex Index into the effect's parameter table (out of range: ignored)
+     * @param value Parameter units (clamped to the parameter's range)
+     */
     virtual void setParameter(uint8_t paramIndex, float value) {
-        // Default: no parameters
-        (void)paramIndex;  // Suppress unused warning
-        (void)value;
+        if (paramIndex < m_numParams) {
+            m_params[paramIndex].setTarget(value);
+        }
     }
 
+    /**
+     * Target of a continuous parameter (0 if out of range)
+     */
     virtual float getParameter(uint8_t paramIndex) const {
-        // Default: no parameters
-        (void)paramIndex;  // Suppress unused warning
-        return 0.0f;
+        return (paramIndex < m_numParams) ? m_params[paramIndex].getTarget() : 0.0f;
+    }
+
+    uint8_t getParameterCount() const { return m_numParams; }
+
+    // ========== PROFILING ==========
+
+    /**
+     * DspProfiler slot timing this effect's processBlock() (assigned at registration)
+     */
+    void setProfileSlot(uint8_t slot) { m_profileSlot = slot; }
+    uint8_t getProfileSlot() const { return m_profileSlot; }
+
+    // ========== BLOCK PROCESSING (audio ISR) ==========
+
+    /**
+     * Process one stereo block (AUDIO_BLOCK_SAMPLES) of 32-bit AudioBus frames in place
+     * Called by update() when patched as its own AudioStream node,
+     * or directly by EffectChain when running fused.
+     */
+    virtual void processBlock(int32_t* dataL, int32_t* dataR) = 0;
+
+    /**
+     * Whether processBlock() would do anything this block
+     * (not AudioStream::isActive(), which means "connected")
+     * false = exact passthrough with no pending state changes; the fused
+     * chain skips the call entirely. Default: always process.
+     */
+    virtual bool needsProcessing() const { return true; }
+
+    /**
+     * Standalone AudioStream path: process this node's own blocks
+     * (int16 between nodes, so each node widens and narrows - no dither)
+     * Pool shortages degrade per GuardedStream; processBlock() runs every block.
+     */
+    void update() override {
+        // Shared by all nodes (updates run one at a time in the audio ISR)
+        static int32_t s_busL[AUDIO_BLOCK_SAMPLES];
+        static int32_t s_busR[AUDIO_BLOCK_SAMPLES];
+
+        StereoBlocks io;
+        receiveStereo(io);
+        widenStereo(io, s_busL, s_busR);
+
+        uint32_t start = DspProfiler::now();
+        processBlock(s_busL, s_busR);
+        DspProfiler::record(m_profileSlot, DspProfiler::now() - start);
+
+        if (io.writable[0]) AudioBus::narrowBlock(s_busL, io.block[0]->data, AUDIO_BLOCK_SAMPLES);
+        if (io.writable[1]) AudioBus::narrowBlock(s_busR, io.block[1]->data, AUDIO_BLOCK_SAMPLES);
+        transmitStereo(io);
     }
 
 protected:
+    /**
+     * Expose the effect's smoothed parameters through setParameter()/getParameter()
+     * (call once from the effect's constructor; the array must outlive the effect)
+     */
+    void bindParameters(SmoothedParam* params, uint8_t count) {
+        m_params = params;
+        m_numParams = count;
+    }
+
     audio_block_t* inputQueueArray[2];
+
+private:
+    SmoothedParam* m_params;
+    uint8_t m_numParams;
+    uint8_t m_profileSlot;
 };
@@ -0,0 +1,54 @@
+/**
+ * LimiterAudio.h - Output limiter as its own AudioStream node (per-node graph)
+ *
+ * PURPOSE:
+ * The fused EffectChain runs its LookaheadLimiter on the bus before the
+ * final conversion. The per-node graph has no shared bus, so this node sits
+ * between the last effect and AudioOutputI2S instead.
+ *
+ * DESIGN:
+ * - Same LookaheadLimiter, on the int16 blocks widened onto a local bus
+ * - In this graph each node narrows to int16, so overs are already clipped
+ *   upstream; here the limiter holds the ceiling and catches inter-sample peaks
+ * - Pool shortages degrade per GuardedStream like the effect nodes
+ *
+ * USAGE:
+ *   LimiterAudio limiter;
+ *   AudioConnection c1(choke, 0, limiter, 0);
+ *   AudioConnection c2(limiter, 0, i2s_out, 0);
+ */
+
+#pragma once
+
+#include <Audio.h>
+#include "GuardedStream.h"
+#include "LookaheadLimiter.h"
+#include "DspProfiler.h"
+
+class LimiterAudio : public GuardedStream {
+public:
+    LimiterAudio() : GuardedStream(2, inputQueueArray) {}
+
+    LookaheadLimiter& getLimiter() { return m_limiter; }
+
+    virtual void update() override {
+        static int32_t s_busL[AUDIO_BLOCK_SAMPLES];
+        static int32_t s_busR[AUDIO_BLOCK_SAMPLES];
+
+        StereoBlocks io;
+        receiveStereo(io);
+        widenStereo(io, s_busL, s_busR);
+
+        uint32_t start = DspProfiler::now();
+        m_limiter.process(s_busL, s_busR);
+        DspProfiler::record(m_limiter.getProfileSlot(), DspProfiler::now() - start);
+
+        if (io.writable[0]) AudioBus::narrowBlock(s_busL, io.block[0]->data, AUDIO_BLOCK_SAMPLES);
+        if (io.writable[1]) AudioBus::narrowBlock(s_busR, io.block[1]->data, AUDIO_BLOCK_SAMPLES);
+        transmitStereo(io);
+    }
+
+private:
+    audio_block_t* inputQueueArray[2];  // Input queue storage (required by AudioStream)
+    LookaheadLimiter m_limiter;
+};
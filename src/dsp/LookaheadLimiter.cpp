@@ -0,0 +1,155 @@
+#include "LookaheadLimiter.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__ARM_ARCH_7EM__)
+#include "utility/dspinst.h"
+#endif
+
+/**
+ * (a * b) >> 31 for Q31 gains (SMMUL on Cortex-M7)
+ */
+static inline int32_t mulQ31(int32_t a, int32_t b) {
+#if defined(__ARM_ARCH_7EM__)
+    return multiply_32x32_rshift32(a, b) << 1;
+#else
+    return static_cast<int32_t>((static_cast<int64_t>(a) * b) >> 32) << 1;
+#endif
+}
+
+LookaheadLimiter::LookaheadLimiter() : m_profileSlot(DspProfiler::INVALID_SLOT) {
+    // Computed once here, never in the ISR
+    float samples = static_cast<float>(Timebase::msToSamples(RELEASE_MS));
+    float coeff = 1.0f - expf(-1.0f / samples);
+    m_releaseCoeff = static_cast<int32_t>(coeff * 2147483648.0f);
+    if (m_releaseCoeff < 1) m_releaseCoeff = 1;
+
+    reset();
+}
+
+void LookaheadLimiter::reset() {
+    memset(m_delayL, 0, sizeof(m_delayL));
+    memset(m_delayR, 0, sizeof(m_delayR));
+    memset(m_histL, 0, sizeof(m_histL));
+    memset(m_histR, 0, sizeof(m_histR));
+    m_time = 0;
+    m_dequeHead = 0;
+    m_dequeTail = 0;
+    m_gain = UNITY_Q31;
+    m_targetPeak = 0;
+    m_target = UNITY_Q31;
+    m_attackStep = 0;
+    m_minGain = UNITY_Q31;
+}
+
+int32_t LookaheadLimiter::takeMinGain() {
+    // Telemetry only: an ISR update between the two accesses is lost, not torn
+    int32_t value = m_minGain;
+    m_minGain = UNITY_Q31;
+    return value;
+}
+
+uint32_t LookaheadLimiter::peakOf(int32_t a, int32_t b) {
+    uint32_t absA = (a < 0) ? 0u - static_cast<uint32_t>(a) : static_cast<uint32_t>(a);
+    uint32_t absB = (b < 0) ? 0u - static_cast<uint32_t>(b) : static_cast<uint32_t>(b);
+    return (absA > absB) ? absA : absB;
+}
+
+uint32_t LookaheadLimiter::halfSamplePeak(int32_t a, int32_t b, int32_t c, int32_t d) {
+    // In units of bus/32: 9 * 2^27 + 2^27 < 2^31, so the sum can't overflow
+    int32_t sum = 9 * ((b >> 5) + (c >> 5)) - ((a >> 5) + (d >> 5));
+    // (sum / 16) * 32 = sum * 2, as unsigned magnitude (up to 2.5 * 2^30)
+    uint32_t magnitude = (sum < 0) ? 0u - static_cast<uint32_t>(sum) : static_cast<uint32_t>(sum);
+    return magnitude << 1;
+}
+
+int32_t LookaheadLimiter::requiredGain(uint32_t peak) {
+    if (peak <= static_cast<uint32_t>(CEILING)) {
+        return UNITY_Q31;
+    }
+    // 32-bit UDIV: CEILING << 8 < 2^31; divisor rounded up so the gain rounds down
+    uint32_t quotient = (static_cast<uint32_t>(CEILING) << 8) / ((peak >> 8) + 1);  // Q16, < 1.0
+    return static_cast<int32_t>(quotient << 15);
+}
+
+void LookaheadLimiter::process(int32_t* dataL, int32_t* dataR, size_t numSamples) {
+    int32_t gain = m_gain;
+    int32_t minGain = m_minGain;
+
+    for (size_t i = 0; i < numSamples; i++) {
+        const uint32_t t = m_time++;
+        const int32_t inL = dataL[i];
+        const int32_t inR = dataR[i];
+
+        // ========== DETECTOR: sample peak + half-sample point before the previous sample ==========
+        uint32_t peak = peakOf(inL, inR);
+        uint32_t midL = halfSamplePeak(m_histL[0], m_histL[1], m_histL[2], inL);
+        uint32_t midR = halfSamplePeak(m_histR[0], m_histR[1], m_histR[2], inR);
+        if (midL > peak) peak = midL;
+        if (midR > peak) peak = midR;
+        m_histL[0] = m_histL[1];
+        m_histL[1] = m_histL[2];
+        m_histL[2] = inL;
+        m_histR[0] = m_histR[1];
+        m_histR[1] = m_histR[2];
+        m_histR[2] = inR;
+
+        // ========== SLIDING WINDOW MAX (monotonic deque over [t - DELAY, t]) ==========
+        while (m_dequeTail != m_dequeHead && m_dequeValue[(m_dequeTail - 1) & RING_MASK] <= peak) {
+            m_dequeTail--;
+        }
+        m_dequeValue[m_dequeTail & RING_MASK] = peak;
+        m_dequeTime[m_dequeTail & RING_MASK] = t;
+        m_dequeTail++;
+        if (t - m_dequeTime[m_dequeHead & RING_MASK] > DELAY_SAMPLES) {
+            m_dequeHead++;  // One entry per sample, so at most one expires
+        }
+        uint32_t windowMax = m_dequeValue[m_dequeHead & RING_MASK];
+
+        // ========== GAIN ==========
+        if (windowMax != m_targetPeak) {
+            m_targetPeak = windowMax;
+            m_target = requiredGain(windowMax);
+            if (m_target < gain) {
+                // Newest peak leaves the delay line in LOOKAHEAD_SAMPLES: get there by then
+                int32_t step = static_cast<int32_t>(
+                    (static_cast<uint32_t>(gain - m_target) + LOOKAHEAD_SAMPLES - 1) / LOOKAHEAD_SAMPLES);
+                if (step > m_attackStep) m_attackStep = step;
+            }
+        }
+
+        const int32_t target = m_target;
+        if (gain > target) {
+            if (m_attackStep == 0) {
+                m_attackStep = static_cast<int32_t>(
+                    (static_cast<uint32_t>(gain - target) + LOOKAHEAD_SAMPLES - 1) / LOOKAHEAD_SAMPLES);
+            }
+            gain -= m_attackStep;
+            if (gain <= target) {
+                gain = target;
+                m_attackStep = 0;
+            }
+        } else if (gain < target) {
+            m_attackStep = 0;
+            int32_t move = mulQ31(target - gain, m_releaseCoeff);
+            gain = (move > 0) ? gain + move : target;
+        }
+        if (gain < minGain) minGain = gain;
+
+        // ========== DELAY + APPLY ==========
+        const uint32_t in = t & RING_MASK;
+        const uint32_t out = (t - DELAY_SAMPLES) & RING_MASK;
+        m_delayL[in] = inL;
+        m_delayR[in] = inR;
+        if (gain == UNITY_Q31) {
+            dataL[i] = m_delayL[out];
+            dataR[i] = m_delayR[out];
+        } else {
+            dataL[i] = mulQ31(m_delayL[out], gain);
+            dataR[i] = mulQ31(m_delayR[out], gain);
+        }
+    }
+
+    m_gain = gain;
+    m_minGain = minGain;
+}
@@ -0,0 +1,120 @@
+/**
+ * LookaheadLimiter.h - Stereo lookahead peak limiter on the 32-bit bus (fixed point)
+ *
+ * PURPOSE:
+ * Overdubbed stutters, resonant rolls and dense grain overlap can go over
+ * 0 dBFS on the bus. Narrowing to int16 then hard-clips. The limiter is the
+ * last stage before the output: it delays the audio by a short lookahead and
+ * pulls the gain down before each peak arrives, so the output stays under the
+ * ceiling without clipping.
+ *
+ * DESIGN:
+ * - Lookahead 1.5ms (67 samples @ 44.1kHz, 144 @ 96kHz); the output is
+ *   delayed by that plus the two samples the true-peak estimate looks back
+ * - Stereo-linked detector: one gain for both channels (keeps the image)
+ * - True-peak estimate: each input also yields the half-sample point between
+ *   the two previous samples (4-tap cubic, (-a + 9b + 9c - d) / 16), so
+ *   inter-sample overs are caught, not only sample peaks
+ * - Sliding-window max over the lookahead via a monotonic deque:
+ *   each detector value is pushed once and popped at most once (O(1) amortised)
+ * - Gain in Q31:
+ *   - Required gain = CEILING / window max (32-bit UDIV, only while over)
+ *   - Attack: linear, reaches the required gain exactly when the peak leaves
+ *     the delay line (the step only ever steepens, so earlier peaks stay covered)
+ *   - Release: one-pole toward unity (RELEASE_MS time constant)
+ * - Nothing over the ceiling and gain at unity: plain delay, no multiply
+ * - Worst case min gain is kept for telemetry (app thread reads and resets)
+ *
+ * USAGE:
+ *   LookaheadLimiter limiter;
+ *   limiter.process(busL, busR);   // Audio ISR, last stage before narrowing to int16
+ */
+
+#pragma once
+
+#include <AudioStream.h>
+#include <stdint.h>
+#include "AudioBus.h"
+#include "Timebase.h"
+#include "DspProfiler.h"
+
+class LookaheadLimiter {
+public:
+    // ========== CONFIGURATION ==========
+    static constexpr uint32_t LOOKAHEAD_MS_X10 = 15;                 // 1.5ms
+    static constexpr uint32_t LOOKAHEAD_SAMPLES =
+        (LOOKAHEAD_MS_X10 * Timebase::SAMPLE_RATE + 9999) / 10000;   // Rounded up
+    static constexpr uint32_t DELAY_SAMPLES = LOOKAHEAD_SAMPLES + 2;  // Output latency
+    static constexpr uint32_t RELEASE_MS = 60;
+    static constexpr int32_t CEILING_Q15 = 31653;                    // -0.3 dBFS (dither + DAC margin)
+    static constexpr int32_t CEILING = CEILING_Q15 << AudioBus::SHIFT;
+    static constexpr int32_t UNITY_Q31 = INT32_MAX;
+
+    // Delay line and deque share one power-of-2 ring size (window = DELAY_SAMPLES + 1 entries)
+    static constexpr uint32_t RING_SIZE = 256;
+    static constexpr uint32_t RING_MASK = RING_SIZE - 1;
+    static_assert(DELAY_SAMPLES + 1 < RING_SIZE, "Lookahead must fit the ring");
+
+    LookaheadLimiter();
+
+    /**
+     * Limit one stereo block of bus frames in place (output delayed by DELAY_SAMPLES)
+     */
+    void process(int32_t* dataL, int32_t* dataR, size_t numSamples = AUDIO_BLOCK_SAMPLES);
+
+    /**
+     * Clear the delay line and return to unity gain
+     */
+    void reset();
+
+    int32_t getGain() const { return m_gain; }
+
+    /**
+     * Lowest gain applied since the last call (Q31), then start a new window (app thread)
+     */
+    int32_t takeMinGain();
+
+    // ========== PROFILING ==========
+    void setProfileSlot(uint8_t slot) { m_profileSlot = slot; }
+    uint8_t getProfileSlot() const { return m_profileSlot; }
+
+    /**
+     * Detector value: larger of |a| and |b| (saturating for INT32_MIN)
+     */
+    static uint32_t peakOf(int32_t a, int32_t b);
+
+    /**
+     * |Half-sample point between b and c| (4-tap cubic), bus units
+     * Inputs are pre-shifted so the full int32 bus range can't overflow.
+     */
+    static uint32_t halfSamplePeak(int32_t a, int32_t b, int32_t c, int32_t d);
+
+    /**
+     * Gain (Q31) that brings peak down to CEILING (UNITY_Q31 if already under)
+     * Rounded down, so the result never exceeds the ceiling.
+     */
+    static int32_t requiredGain(uint32_t peak);
+
+private:
+    // ========== DELAY LINE ==========
+    int32_t m_delayL[RING_SIZE];
+    int32_t m_delayR[RING_SIZE];
+    int32_t m_histL[3];               // Previous three inputs, oldest first (half-sample estimate)
+    int32_t m_histR[3];
+    uint32_t m_time;                  // Input sample counter (ring index = time & mask)
+
+    // ========== MONOTONIC DEQUE (decreasing detector values) ==========
+    uint32_t m_dequeValue[RING_SIZE];
+    uint32_t m_dequeTime[RING_SIZE];
+    uint32_t m_dequeHead;             // Oldest entry (window max)
+    uint32_t m_dequeTail;             // One past the newest entry
+
+    // ========== GAIN (Q31) ==========
+    int32_t m_gain;                   // Gain applied to the delayed sample
+    uint32_t m_targetPeak;            // Window max the target below was computed for
+    int32_t m_target;                 // requiredGain(m_targetPeak)
+    int32_t m_attackStep;             // Per-sample decrease while attacking (0 = not attacking)
+    int32_t m_releaseCoeff;           // One-pole release coefficient (Q31)
+    volatile int32_t m_minGain;       // Lowest gain since takeMinGain()
+    uint8_t m_profileSlot;
+};
@@ -0,0 +1,471 @@
+#include "PresetCodec.h"
+#include <string.h>
+
+// ========== FRAME TYPES AND LIMITS ==========
+
+enum FrameType : uint8_t {
+    FRAME_VERBATIM = 0,
+    FRAME_RICE = 1,
+    FRAME_ADPCM = 2
+};
+
+static constexpr uint32_t MAX_ORDER = 2;
+static constexpr int32_t MAX_SIDE = 65535;            // |L - R|
+static constexpr uint32_t RICE_PARAMS_BYTES = 4;
+static constexpr uint32_t RICE_MAX_K = 19;
+static constexpr uint32_t RICE_ESCAPE_Q = 16;      // Quotients from here on are escaped
+// |side| <= MAX_SIDE, so an order-2 residual stays under 4 * MAX_SIDE and zigzags below 2^20
+static constexpr uint32_t RICE_ESCAPE_BITS = 20;
+static constexpr uint32_t ADPCM_PARAMS_BYTES = 8;
+static constexpr int32_t ADPCM_MAX_INDEX = 88;
+
+static const int16_t ADPCM_STEPS[ADPCM_MAX_INDEX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+static const int8_t ADPCM_INDEX_STEP[8] = {-1, -1, -1, -1, 2, 4, 6, 8};  // By code magnitude
+
+// ========== HELPERS ==========
+
+static inline int32_t predict(uint32_t order, int32_t prev1, int32_t prev2) {
+    switch (order) {
+        case 0:  return 0;
+        case 1:  return prev1;
+        default: return 2 * prev1 - prev2;
+    }
+}
+
+static inline uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+static inline int32_t clamp16(int32_t value) {
+    return (value > INT16_MAX) ? INT16_MAX : ((value < INT16_MIN) ? INT16_MIN : value);
+}
+
+static void writeFrameHeader(uint8_t* out, size_t payloadBytes, FrameType type) {
+    out[0] = static_cast<uint8_t>(payloadBytes);
+    out[1] = static_cast<uint8_t>(payloadBytes >> 8);
+    out[2] = type;
+    out[3] = 0;
+}
+
+/**
+ * Bits of one Rice-coded residual (escape included)
+ */
+static inline uint32_t riceLength(uint32_t value, uint32_t k) {
+    uint32_t quotient = value >> k;
+    return (quotient < RICE_ESCAPE_Q) ? quotient + 1 + k : RICE_ESCAPE_Q + RICE_ESCAPE_BITS;
+}
+
+/**
+ * Predictor order with the smallest residual sum (x[0], x[1] = history)
+ */
+static uint32_t chooseOrder(const int32_t* x, uint32_t numSamples) {
+    uint32_t sums[MAX_ORDER + 1] = {0, 0, 0};
+    for (uint32_t i = 2; i < numSamples + 2; i++) {
+        int32_t delta1 = x[i] - x[i - 1];
+        int32_t delta2 = delta1 - (x[i - 1] - x[i - 2]);
+        sums[0] += (x[i] < 0) ? -x[i] : x[i];
+        sums[1] += (delta1 < 0) ? -delta1 : delta1;
+        sums[2] += (delta2 < 0) ? -delta2 : delta2;
+    }
+    uint32_t best = 0;
+    for (uint32_t order = 1; order <= MAX_ORDER; order++) {
+        if (sums[order] < sums[best]) {
+            best = order;
+        }
+    }
+    return best;
+}
+
+/**
+ * Rice parameter for one channel: estimate from the mean residual, then
+ * keep the cheapest of its neighbours (exact bit counts)
+ */
+static uint32_t chooseRiceParameter(const int32_t* x, uint32_t numSamples, uint32_t order, uint32_t& outBits) {
+    uint32_t sum = 0;
+    for (uint32_t i = 2; i < numSamples + 2; i++) {
+        sum += zigzag(x[i] - predict(order, x[i - 1], x[i - 2]));
+    }
+    uint32_t mean = sum / numSamples;
+    uint32_t estimate = (mean > 0) ? 31 - __builtin_clz(mean) : 0;
+
+    uint32_t first = (estimate > 0) ? estimate - 1 : 0;
+    uint32_t last = (estimate < RICE_MAX_K) ? estimate + 1 : RICE_MAX_K;
+    uint32_t bestK = first;
+    outBits = UINT32_MAX;
+    for (uint32_t k = first; k <= last; k++) {
+        uint32_t bits = 0;
+        for (uint32_t i = 2; i < numSamples + 2; i++) {
+            bits += riceLength(zigzag(x[i] - predict(order, x[i - 1], x[i - 2])), k);
+        }
+        if (bits < outBits) {
+            outBits = bits;
+            bestK = k;
+        }
+    }
+    return bestK;
+}
+
+/**
+ * MSB-first bit packer (encoder side)
+ */
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* out) : m_out(out) {}
+
+    void put(uint32_t value, uint32_t bits) {   // bits <= 32
+        m_acc = (m_acc << bits) | value;
+        m_count += bits;
+        while (m_count >= 8) {
+            m_count -= 8;
+            *m_out++ = static_cast<uint8_t>(m_acc >> m_count);
+        }
+    }
+
+    void putRice(uint32_t value, uint32_t k) {
+        uint32_t quotient = value >> k;
+        if (quotient >= RICE_ESCAPE_Q) {
+            put(0, RICE_ESCAPE_Q);
+            put(value, RICE_ESCAPE_BITS);
+            return;
+        }
+        put(1, quotient + 1);                        // Unary: quotient zeros, then a one
+        put(value & ((1u << k) - 1), k);
+    }
+
+    void flush() {
+        if (m_count > 0) {
+            *m_out++ = static_cast<uint8_t>(m_acc << (8 - m_count));
+            m_count = 0;
+        }
+    }
+
+private:
+    uint8_t* m_out;
+    uint64_t m_acc = 0;
+    uint32_t m_count = 0;
+};
+
+/**
+ * MSB-first bit reader (decoder side); reads past the end see zeros and are
+ * reported by overrun()
+ */
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t bytes) : m_next(data), m_end(data + bytes) {}
+
+    uint32_t readBits(uint32_t bits) {   // 1..24
+        refill();
+        uint32_t value = m_cache >> (32 - bits);
+        consume(bits);
+        return value;
+    }
+
+    uint32_t readRice(uint32_t k) {
+        refill();
+        if ((m_cache >> (32 - RICE_ESCAPE_Q)) == 0) {
+            consume(RICE_ESCAPE_Q);
+            return readBits(RICE_ESCAPE_BITS);
+        }
+        uint32_t quotient = __builtin_clz(m_cache);
+        consume(quotient + 1);
+        return (k == 0) ? quotient : ((quotient << k) | readBits(k));
+    }
+
+    bool overrun() const { return m_padBytes * 8 > m_count; }
+
+private:
+    void refill() {
+        while (m_count <= 24) {
+            uint32_t byte = 0;
+            if (m_next < m_end) {
+                byte = *m_next++;
+            } else {
+                m_padBytes++;
+            }
+            m_cache |= byte << (24 - m_count);
+            m_count += 8;
+        }
+    }
+
+    void consume(uint32_t bits) {
+        m_cache <<= bits;
+        m_count -= bits;
+    }
+
+    const uint8_t* m_next;
+    const uint8_t* m_end;
+    uint32_t m_cache = 0;      // Left-aligned
+    uint32_t m_count = 0;      // Valid bits in m_cache
+    uint32_t m_padBytes = 0;   // Zero bytes fed past the end
+};
+
+/**
+ * One IMA-ADPCM step (shared by both sides, so the encoder tracks the decoder exactly)
+ */
+static inline int32_t adpcmDecodeSample(uint32_t code, int32_t& predictor, int32_t& index) {
+    int32_t step = ADPCM_STEPS[index];
+    int32_t delta = step >> 3;
+    if (code & 4) delta += step;
+    if (code & 2) delta += step >> 1;
+    if (code & 1) delta += step >> 2;
+    predictor = clamp16((code & 8) ? predictor - delta : predictor + delta);
+    index += ADPCM_INDEX_STEP[code & 7];
+    index = (index < 0) ? 0 : ((index > ADPCM_MAX_INDEX) ? ADPCM_MAX_INDEX : index);
+    return predictor;
+}
+
+static inline uint32_t adpcmEncodeSample(int32_t sample, int32_t& predictor, int32_t& index) {
+    int32_t diff = sample - predictor;
+    uint32_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    int32_t step = ADPCM_STEPS[index];
+    if (diff >= step) { code |= 4; diff -= step; }
+    step >>= 1;
+    if (diff >= step) { code |= 2; diff -= step; }
+    step >>= 1;
+    if (diff >= step) { code |= 1; }
+    adpcmDecodeSample(code, predictor, index);
+    return code;
+}
+
+static inline size_t adpcmPayloadBytes(uint32_t numSamples) {
+    return ADPCM_PARAMS_BYTES + 2 * (numSamples / 2);   // (n - 1) codes per channel, rounded up to a byte
+}
+
+// ========== ENCODER ==========
+
+void PresetEncoder::begin(PresetCodec codec) {
+    m_codec = codec;
+    m_mid[0] = m_mid[1] = 0;
+    m_side[0] = m_side[1] = 0;
+    m_adpcmIndex[0] = m_adpcmIndex[1] = 0;
+}
+
+size_t PresetEncoder::encodeFrame(const int16_t* left, const int16_t* right, uint32_t numSamples, uint8_t* out) {
+    if (m_codec == PresetCodec::ADPCM) {
+        return encodeAdpcm(left, right, numSamples, out);
+    }
+    return encodeLossless(left, right, numSamples, out);   // PCM: verbatim frames
+}
+
+size_t PresetEncoder::encodeLossless(const int16_t* left, const int16_t* right, uint32_t numSamples, uint8_t* out) {
+    for (uint32_t i = 0; i < numSamples; i++) {
+        m_mid[i + 2] = (static_cast<int32_t>(left[i]) + right[i]) >> 1;
+        m_side[i + 2] = static_cast<int32_t>(left[i]) - right[i];
+    }
+
+    size_t verbatimBytes = numSamples * 2 * sizeof(int16_t);
+    size_t payloadBytes = verbatimBytes;
+    if (m_codec == PresetCodec::LOSSLESS) {
+        uint32_t orderMid = chooseOrder(m_mid, numSamples);
+        uint32_t orderSide = chooseOrder(m_side, numSamples);
+        uint32_t bitsMid = 0;
+        uint32_t bitsSide = 0;
+        uint32_t kMid = chooseRiceParameter(m_mid, numSamples, orderMid, bitsMid);
+        uint32_t kSide = chooseRiceParameter(m_side, numSamples, orderSide, bitsSide);
+        payloadBytes = RICE_PARAMS_BYTES + (bitsMid + bitsSide + 7) / 8;
+
+        if (payloadBytes < verbatimBytes) {
+            uint8_t* params = out + PRESET_FRAME_HEADER_BYTES;
+            params[0] = static_cast<uint8_t>(orderMid);
+            params[1] = static_cast<uint8_t>(orderSide);
+            params[2] = static_cast<uint8_t>(kMid);
+            params[3] = static_cast<uint8_t>(kSide);
+
+            BitWriter writer(params + RICE_PARAMS_BYTES);
+            for (uint32_t i = 2; i < numSamples + 2; i++) {
+                writer.putRice(zigzag(m_mid[i] - predict(orderMid, m_mid[i - 1], m_mid[i - 2])), kMid);
+            }
+            for (uint32_t i = 2; i < numSamples + 2; i++) {
+                writer.putRice(zigzag(m_side[i] - predict(orderSide, m_side[i - 1], m_side[i - 2])), kSide);
+            }
+            writer.flush();
+            writeFrameHeader(out, payloadBytes, FRAME_RICE);
+        }
+    }
+
+    if (payloadBytes >= verbatimBytes) {
+        // Noise-like frame: stored as is
+        payloadBytes = verbatimBytes;
+        memcpy(out + PRESET_FRAME_HEADER_BYTES, left, numSamples * sizeof(int16_t));
+        memcpy(out + PRESET_FRAME_HEADER_BYTES + numSamples * sizeof(int16_t), right, numSamples * sizeof(int16_t));
+        writeFrameHeader(out, payloadBytes, FRAME_VERBATIM);
+    }
+
+    // Last two samples predict the next frame
+    m_mid[0] = m_mid[numSamples];
+    m_mid[1] = m_mid[numSamples + 1];
+    m_side[0] = m_side[numSamples];
+    m_side[1] = m_side[numSamples + 1];
+    return PRESET_FRAME_HEADER_BYTES + payloadBytes;
+}
+
+size_t PresetEncoder::encodeAdpcm(const int16_t* left, const int16_t* right, uint32_t numSamples, uint8_t* out) {
+    size_t payloadBytes = adpcmPayloadBytes(numSamples);
+    size_t codeBytes = numSamples / 2;
+    uint8_t* params = out + PRESET_FRAME_HEADER_BYTES;
+    uint8_t* codes = params + ADPCM_PARAMS_BYTES;
+    memset(params, 0, payloadBytes);
+
+    const int16_t* channels[2] = {left, right};
+    for (uint32_t channel = 0; channel < 2; channel++) {
+        const int16_t* input = channels[channel];
+        int32_t predictor = input[0];   // Exact first sample
+        int32_t index = m_adpcmIndex[channel];
+        memcpy(params + channel * sizeof(int16_t), &input[0], sizeof(int16_t));
+        params[4 + channel] = static_cast<uint8_t>(index);
+
+        uint8_t* channelCodes = codes + channel * codeBytes;
+        for (uint32_t i = 1; i < numSamples; i++) {
+            uint32_t code = adpcmEncodeSample(input[i], predictor, index);
+            channelCodes[(i - 1) >> 1] |= static_cast<uint8_t>(code << (((i - 1) & 1) * 4));
+        }
+        m_adpcmIndex[channel] = static_cast<uint8_t>(index);
+    }
+
+    writeFrameHeader(out, payloadBytes, FRAME_ADPCM);
+    return PRESET_FRAME_HEADER_BYTES + payloadBytes;
+}
+
+// ========== DECODER ==========
+
+void PresetDecoder::begin(PresetCodec codec) {
+    m_codec = codec;
+    m_midHistory[0] = m_midHistory[1] = 0;
+    m_sideHistory[0] = m_sideHistory[1] = 0;
+}
+
+size_t PresetDecoder::frameBytes(const uint8_t* in, size_t available) {
+    if (available < PRESET_FRAME_HEADER_BYTES) {
+        return 0;
+    }
+    return PRESET_FRAME_HEADER_BYTES + (static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8));
+}
+
+bool PresetDecoder::decodeFrame(const uint8_t* in, size_t frameSize, int16_t* left, int16_t* right, uint32_t numSamples) {
+    if (frameSize < PRESET_FRAME_HEADER_BYTES || frameSize != frameBytes(in, frameSize) ||
+        numSamples == 0 || numSamples > PRESET_FRAME_SAMPLES) {
+        return false;
+    }
+    const uint8_t* payload = in + PRESET_FRAME_HEADER_BYTES;
+    size_t payloadBytes = frameSize - PRESET_FRAME_HEADER_BYTES;
+
+    switch (in[2]) {
+        case FRAME_VERBATIM:
+            if (m_codec == PresetCodec::ADPCM || payloadBytes != numSamples * 2 * sizeof(int16_t)) {
+                return false;
+            }
+            memcpy(left, payload, numSamples * sizeof(int16_t));
+            memcpy(right, payload + numSamples * sizeof(int16_t), numSamples * sizeof(int16_t));
+            setHistory(left, right, numSamples);
+            return true;
+
+        case FRAME_RICE:
+            return m_codec == PresetCodec::LOSSLESS && decodeRice(payload, payloadBytes, left, right, numSamples);
+
+        case FRAME_ADPCM:
+            return m_codec == PresetCodec::ADPCM && decodeAdpcm(payload, payloadBytes, left, right, numSamples);
+
+        default:
+            return false;
+    }
+}
+
+bool PresetDecoder::decodeRice(const uint8_t* payload, size_t payloadBytes, int16_t* left, int16_t* right, uint32_t numSamples) {
+    if (payloadBytes < RICE_PARAMS_BYTES) {
+        return false;
+    }
+    uint32_t orderMid = payload[0];
+    uint32_t orderSide = payload[1];
+    uint32_t kMid = payload[2];
+    uint32_t kSide = payload[3];
+    if (orderMid > MAX_ORDER || orderSide > MAX_ORDER || kMid > RICE_MAX_K || kSide > RICE_MAX_K) {
+        return false;
+    }
+    BitReader reader(payload + RICE_PARAMS_BYTES, payloadBytes - RICE_PARAMS_BYTES);
+
+    // Mid first (kept until side arrives)
+    int32_t prev2 = m_midHistory[0];
+    int32_t prev1 = m_midHistory[1];
+    for (uint32_t i = 0; i < numSamples; i++) {
+        int32_t mid = unzigzag(reader.readRice(kMid)) + predict(orderMid, prev1, prev2);
+        if (mid < INT16_MIN || mid > INT16_MAX) {
+            return false;   // Also keeps the predictor far from overflow
+        }
+        m_mid[i] = static_cast<int16_t>(mid);
+        prev2 = prev1;
+        prev1 = mid;
+    }
+    m_midHistory[0] = prev2;
+    m_midHistory[1] = prev1;
+
+    // Side, rebuilding L/R as it goes
+    prev2 = m_sideHistory[0];
+    prev1 = m_sideHistory[1];
+    for (uint32_t i = 0; i < numSamples; i++) {
+        int32_t side = unzigzag(reader.readRice(kSide)) + predict(orderSide, prev1, prev2);
+        if (side < -MAX_SIDE || side > MAX_SIDE) {
+            return false;
+        }
+        int32_t mid = (static_cast<int32_t>(m_mid[i]) * 2) | (side & 1);
+        left[i] = static_cast<int16_t>((mid + side) >> 1);
+        right[i] = static_cast<int16_t>((mid - side) >> 1);
+        prev2 = prev1;
+        prev1 = side;
+    }
+    m_sideHistory[0] = prev2;
+    m_sideHistory[1] = prev1;
+    return !reader.overrun();
+}
+
+bool PresetDecoder::decodeAdpcm(const uint8_t* payload, size_t payloadBytes, int16_t* left, int16_t* right, uint32_t numSamples) {
+    if (payloadBytes != adpcmPayloadBytes(numSamples)) {
+        return false;
+    }
+    size_t codeBytes = numSamples / 2;
+    const uint8_t* codes = payload + ADPCM_PARAMS_BYTES;
+
+    int16_t* channels[2] = {left, right};
+    for (uint32_t channel = 0; channel < 2; channel++) {
+        int16_t* output = channels[channel];
+        int16_t first;
+        memcpy(&first, payload + channel * sizeof(int16_t), sizeof(int16_t));
+        int32_t predictor = first;
+        int32_t index = payload[4 + channel];
+        if (index > ADPCM_MAX_INDEX) {
+            return false;
+        }
+
+        output[0] = first;
+        const uint8_t* channelCodes = codes + channel * codeBytes;
+        for (uint32_t i = 1; i < numSamples; i++) {
+            uint32_t code = (channelCodes[(i - 1) >> 1] >> (((i - 1) & 1) * 4)) & 0x0F;
+            output[i] = static_cast<int16_t>(adpcmDecodeSample(code, predictor, index));
+        }
+    }
+    return true;
+}
+
+void PresetDecoder::setHistory(const int16_t* left, const int16_t* right, uint32_t numSamples) {
+    // Same mid/side the encoder kept from this frame's last two samples
+    for (uint32_t i = (numSamples >= 2) ? numSamples - 2 : 0; i < numSamples; i++) {
+        m_midHistory[0] = m_midHistory[1];
+        m_midHistory[1] = (static_cast<int32_t>(left[i]) + right[i]) >> 1;
+        m_sideHistory[0] = m_sideHistory[1];
+        m_sideHistory[1] = static_cast<int32_t>(left[i]) - right[i];
+    }
+}
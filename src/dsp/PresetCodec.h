@@ -0,0 +1,123 @@
+/**
+ * PresetCodec.h - Frame codecs for preset audio on the SD card (lossless and IMA-ADPCM)
+ *
+ * PURPOSE:
+ * A full-length preset is megabytes of 16-bit PCM, and save/load time is set by
+ * how many bytes cross the SD bus. Coding the loop before it goes to the card
+ * cuts that by the compression ratio, as long as decoding keeps up with the
+ * stream (loads play while they load).
+ *
+ * DESIGN:
+ * - Stereo frames of PRESET_FRAME_SAMPLES per channel, stored back to back; each
+ *   starts with a 4-byte header (payload bytes, type), so a reader finds frame
+ *   boundaries without an index and decodes while the file streams in
+ * - LOSSLESS:
+ *   - Mid/side decorrelation: mid = (L + R) >> 1, side = L - R (the bit mid drops
+ *     is the low bit of side, so L/R come back exactly)
+ *   - Fixed polynomial predictor per channel and frame (order 0, 1 or 2 - the
+ *     smallest residual sum wins), history carried across frames
+ *   - Rice-coded residuals (zigzag, parameter k per channel and frame); quotients
+ *     of RICE_ESCAPE_Q or more are stored as a raw RICE_ESCAPE_BITS value, so a
+ *     transient costs a bounded number of bits (and decode time)
+ *   - A frame that would not get smaller is stored verbatim (worst case: PCM plus
+ *     the frame header)
+ * - ADPCM: IMA-ADPCM, 4 bits a sample (~3.9:1 with headers). Each frame stores its
+ *   first sample and step index per channel. Lossy - meant for scratch slots
+ * - Decode: 32-bit bit cache read MSB first, unary quotients by CLZ, no divisions
+ *
+ * FRAME LAYOUT (little-endian):
+ * - Header: uint16 payload bytes, uint8 type (FrameType), uint8 reserved
+ * - VERBATIM: int16 L[n], int16 R[n]
+ * - RICE: uint8 order mid, uint8 order side, uint8 k mid, uint8 k side,
+ *         mid residuals then side residuals (bitstream, zero-padded to a byte)
+ * - ADPCM: int16 first L, int16 first R, uint8 index L, uint8 index R, 2 reserved,
+ *          L codes then R codes for samples 1..n-1 (two per byte, low nibble first)
+ * - n is not stored: PRESET_FRAME_SAMPLES, except for the last frame of a loop
+ *
+ * USAGE:
+ *   PresetEncoder encoder;
+ *   encoder.begin(PresetCodec::LOSSLESS);
+ *   size_t bytes = encoder.encodeFrame(left, right, n, out);   // out: PRESET_MAX_FRAME_BYTES
+ *
+ *   PresetDecoder decoder;
+ *   decoder.begin(PresetCodec::LOSSLESS);
+ *   size_t bytes = PresetDecoder::frameBytes(in, available);    // 0 = header not in yet
+ *   bool ok = decoder.decodeFrame(in, bytes, left, right, n);   // false = corrupt frame
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum class PresetCodec : uint8_t {
+    PCM = 0,        // Uncoded 16-bit (v1-v3 files)
+    LOSSLESS = 1,   // Mid/side + fixed predictor + Rice
+    ADPCM = 2       // IMA-ADPCM 4:1 (lossy)
+};
+
+// ========== FRAME FORMAT ==========
+static constexpr uint32_t PRESET_FRAME_SAMPLES = 512;     // Per channel
+static constexpr uint32_t PRESET_FRAME_HEADER_BYTES = 4;
+static constexpr uint32_t PRESET_MAX_FRAME_BYTES =        // Verbatim frame
+    PRESET_FRAME_HEADER_BYTES + PRESET_FRAME_SAMPLES * 2 * sizeof(int16_t);
+
+class PresetEncoder {
+public:
+    /**
+     * Start a loop (clears predictor history and ADPCM state)
+     */
+    void begin(PresetCodec codec);
+
+    /**
+     * Code one stereo frame
+     *
+     * @param numSamples Samples per channel (1..PRESET_FRAME_SAMPLES, less only for the last frame)
+     * @param out Frame output, room for PRESET_MAX_FRAME_BYTES
+     * @return Frame size in bytes (header included)
+     */
+    size_t encodeFrame(const int16_t* left, const int16_t* right, uint32_t numSamples, uint8_t* out);
+
+private:
+    size_t encodeLossless(const int16_t* left, const int16_t* right, uint32_t numSamples, uint8_t* out);
+    size_t encodeAdpcm(const int16_t* left, const int16_t* right, uint32_t numSamples, uint8_t* out);
+
+    PresetCodec m_codec = PresetCodec::LOSSLESS;
+    // Mid and side with two samples of history in front ([0] = x[-2], [1] = x[-1])
+    int32_t m_mid[PRESET_FRAME_SAMPLES + 2];
+    int32_t m_side[PRESET_FRAME_SAMPLES + 2];
+    uint8_t m_adpcmIndex[2] = {0, 0};   // Step index carried into the next frame (L, R)
+};
+
+class PresetDecoder {
+public:
+    /**
+     * Start a loop (must match the encoder's codec)
+     */
+    void begin(PresetCodec codec);
+
+    /**
+     * Size of the frame at in (header included), 0 if fewer than
+     * PRESET_FRAME_HEADER_BYTES are available
+     */
+    static size_t frameBytes(const uint8_t* in, size_t available);
+
+    /**
+     * Decode one whole frame into left/right
+     *
+     * @param frameSize From frameBytes()
+     * @param numSamples Samples per channel the frame holds
+     * @return false if the frame is malformed (nothing to trust in left/right)
+     */
+    bool decodeFrame(const uint8_t* in, size_t frameSize, int16_t* left, int16_t* right, uint32_t numSamples);
+
+private:
+    bool decodeRice(const uint8_t* payload, size_t payloadBytes, int16_t* left, int16_t* right, uint32_t numSamples);
+    bool decodeAdpcm(const uint8_t* payload, size_t payloadBytes, int16_t* left, int16_t* right, uint32_t numSamples);
+    void setHistory(const int16_t* left, const int16_t* right, uint32_t numSamples);
+
+    PresetCodec m_codec = PresetCodec::LOSSLESS;
+    int16_t m_mid[PRESET_FRAME_SAMPLES];   // Decoded mid, waiting for side
+    int32_t m_midHistory[2] = {0, 0};      // x[-2], x[-1]
+    int32_t m_sideHistory[2] = {0, 0};
+};
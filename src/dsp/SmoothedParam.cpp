@@ -0,0 +1,116 @@
+#include "SmoothedParam.h"
+#include "Timebase.h"
+#include <math.h>
+
+SmoothedParam::SmoothedParam(float fullScale, float initial, SmoothingMode mode, uint32_t timeMs)
+    : m_target(0),
+      m_fullScale(fullScale > 0.0f ? fullScale : 1.0f),
+      m_mode(mode),
+      m_rampSamples(Timebase::msToSamples(timeMs)),
+      m_coeffQ16(1 << FRAC_BITS),
+      m_current(0),
+      m_targetQ15(0),
+      m_step(0),
+      m_constantFilled(false) {
+    if (m_rampSamples > 0) {
+        // Computed once here, never in the ISR
+        float coeff = 1.0f - expf(-1.0f / static_cast<float>(m_rampSamples));
+        m_coeffQ16 = static_cast<int32_t>(coeff * (1 << FRAC_BITS) + 0.5f);
+        if (m_coeffQ16 < 1) m_coeffQ16 = 1;
+    }
+
+    setTarget(initial);
+    m_targetQ15 = m_target.load(std::memory_order_relaxed);
+    m_current = m_targetQ15 << FRAC_BITS;
+    fillConstant();
+}
+
+void SmoothedParam::setTarget(float value) {
+    if (value < 0.0f) value = 0.0f;
+    if (value > m_fullScale) value = m_fullScale;
+    int32_t q15 = static_cast<int32_t>(value * GainRamp::UNITY_Q15 / m_fullScale + 0.5f);
+    m_target.store(q15, std::memory_order_relaxed);
+}
+
+float SmoothedParam::getTarget() const {
+    return static_cast<float>(m_target.load(std::memory_order_relaxed)) * m_fullScale / GainRamp::UNITY_Q15;
+}
+
+void SmoothedParam::settle() {
+    m_targetQ15 = m_target.load(std::memory_order_relaxed);
+    if (m_current != (m_targetQ15 << FRAC_BITS)) {
+        m_current = m_targetQ15 << FRAC_BITS;
+        m_constantFilled = false;
+    }
+    m_step = 0;
+}
+
+void SmoothedParam::fillConstant() {
+    int16_t value = static_cast<int16_t>(m_current >> FRAC_BITS);
+    for (size_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        m_ramp[i] = value;
+    }
+    m_constantFilled = true;
+}
+
+const int16_t* SmoothedParam::render(size_t numSamples) {
+    if (numSamples > AUDIO_BLOCK_SAMPLES) numSamples = AUDIO_BLOCK_SAMPLES;
+
+    int32_t target = m_target.load(std::memory_order_relaxed);
+    if (target != m_targetQ15) {
+        m_targetQ15 = target;
+        if (m_mode == SmoothingMode::LINEAR && m_rampSamples > 0) {
+            // Same length for every change: one division per new target
+            int32_t delta = (target << FRAC_BITS) - m_current;
+            m_step = delta / static_cast<int32_t>(m_rampSamples);
+            if (m_step == 0) m_step = (delta > 0) ? 1 : -1;
+        }
+    }
+
+    const int32_t end = m_targetQ15 << FRAC_BITS;
+    if (m_current == end) {
+        if (!m_constantFilled) fillConstant();
+        return m_ramp;
+    }
+
+    m_constantFilled = false;
+    int32_t current = m_current;
+
+    if (m_rampSamples == 0) {
+        current = end;  // No smoothing: jump at block start
+        for (size_t i = 0; i < numSamples; i++) {
+            m_ramp[i] = static_cast<int16_t>(current >> FRAC_BITS);
+        }
+    } else if (m_mode == SmoothingMode::LINEAR) {
+        const int32_t step = m_step;
+        if (step > 0) {
+            for (size_t i = 0; i < numSamples; i++) {
+                current += step;
+                if (current > end) current = end;
+                m_ramp[i] = static_cast<int16_t>(current >> FRAC_BITS);
+            }
+        } else {
+            for (size_t i = 0; i < numSamples; i++) {
+                current += step;
+                if (current < end) current = end;
+                m_ramp[i] = static_cast<int16_t>(current >> FRAC_BITS);
+            }
+        }
+    } else {
+        // One-pole: |end - current| < 2^31, coefficient <= 2^16 -> 64-bit product (SMULL)
+        const int32_t coeff = m_coeffQ16;
+        const int32_t oneLsb = 1 << FRAC_BITS;
+        for (size_t i = 0; i < numSamples; i++) {
+            int32_t diff = end - current;
+            if (diff < oneLsb && diff > -oneLsb) {
+                current = end;  // Within one output LSB: land exactly
+            } else {
+                current += static_cast<int32_t>((static_cast<int64_t>(diff) * coeff) >> FRAC_BITS);
+            }
+            m_ramp[i] = static_cast<int16_t>(current >> FRAC_BITS);
+        }
+    }
+
+    m_current = current;
+    return m_ramp;
+}
@@ -0,0 +1,123 @@
+/**
+ * SmoothedParam.h - Block-rate smoothed effect parameter (Q15 ramp per block)
+ *
+ * PURPOSE:
+ * Encoder steps change parameters in jumps; applied as-is they step the gain
+ * once per block (zipper noise). A SmoothedParam holds the target set by the
+ * app thread and renders a per-sample ramp toward it once per block, which
+ * the GainRamp kernels consume directly.
+ *
+ * DESIGN:
+ * - Value is Q15 in [0, UNITY_Q15], set in parameter units (0..fullScale,
+ *   e.g. percent) and scaled on the app thread
+ * - Target is a std::atomic<int32_t>: setTarget() is a single store (wait-free),
+ *   the audio ISR picks it up at the next render()
+ * - Smoothing modes:
+ *   - LINEAR: every change takes exactly the smoothing time, whatever its size
+ *     (step recomputed once per new target - the only division)
+ *   - ONE_POLE: y += (target - y) * coeff per sample, time = time constant
+ *     (63%); snaps to the target once within one output LSB
+ * - Internal value is Q15.16 so short ramps over small changes keep their length
+ * - Settled: the ramp array already holds the constant and render() returns
+ *   without touching it; kernels can also test isSettled()/getCurrent() to
+ *   take a constant-gain path
+ * - settle() jumps to the target (for blocks where the parameter isn't heard)
+ *
+ * USAGE:
+ *   SmoothedParam mix(100.0f, 100.0f, SmoothingMode::LINEAR, 20);  // Percent, 20ms
+ *   mix.setTarget(50.0f);                                // App thread
+ *   const int16_t* gains = mix.render();                 // Audio ISR, once per block
+ *   GainRamp::mixBus(dryL, wetL, gains, AUDIO_BLOCK_SAMPLES);
+ */
+
+#pragma once
+
+#include <AudioStream.h>
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+#include "GainRamp.h"
+
+enum class SmoothingMode : uint8_t {
+    LINEAR = 0,    // Fixed-length linear ramp (default)
+    ONE_POLE = 1   // Exponential approach (fast start, soft landing)
+};
+
+class SmoothedParam {
+public:
+    // ========== CONFIGURATION ==========
+    static constexpr uint32_t FRAC_BITS = 16;                    // Q15.16 internal value
+    static constexpr uint32_t DEFAULT_TIME_MS = 20;
+
+    /**
+     * @param fullScale Parameter value that maps to UNITY_Q15 (e.g. 100 for percent)
+     * @param initial Starting value (parameter units, settled)
+     * @param mode Smoothing curve
+     * @param timeMs LINEAR: ramp length, ONE_POLE: time constant (0 = no smoothing)
+     */
+    SmoothedParam(float fullScale = 1.0f, float initial = 0.0f,
+                  SmoothingMode mode = SmoothingMode::LINEAR, uint32_t timeMs = DEFAULT_TIME_MS);
+
+    // ========== APP THREAD ==========
+
+    /**
+     * Set a new target (parameter units, clamped to 0..fullScale) - wait-free
+     */
+    void setTarget(float value);
+
+    /**
+     * Current target in parameter units
+     */
+    float getTarget() const;
+
+    // ========== AUDIO ISR ==========
+
+    /**
+     * Render numSamples ramp values (Q15) toward the target
+     *
+     * @return Ramp array (AUDIO_BLOCK_SAMPLES entries, 4-byte aligned, valid until next render)
+     */
+    const int16_t* render(size_t numSamples = AUDIO_BLOCK_SAMPLES);
+
+    /**
+     * Jump to the target without ramping
+     */
+    void settle();
+
+    /**
+     * Value after the last rendered sample (Q15)
+     */
+    int32_t getCurrent() const { return m_current >> FRAC_BITS; }
+
+    /**
+     * No ramp pending: the last render() was constant at getCurrent()
+     */
+    bool isSettled() const {
+        return m_current == (m_targetQ15 << FRAC_BITS) &&
+               m_targetQ15 == m_target.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Settled at exactly this value (Q15) - e.g. a mix at unity needs no mixing
+     */
+    bool isSettledAt(int32_t valueQ15) const { return isSettled() && getCurrent() == valueQ15; }
+
+private:
+    /**
+     * Fill the ramp array with the (settled) current value, once per settle
+     */
+    void fillConstant();
+
+    std::atomic<int32_t> m_target;   // Target (Q15), written by the app thread
+    float m_fullScale;               // Parameter units at UNITY_Q15
+    SmoothingMode m_mode;
+    uint32_t m_rampSamples;          // LINEAR ramp length (0 = jump)
+    int32_t m_coeffQ16;              // ONE_POLE coefficient 1 - e^(-1/(tau*fs)), Q16
+
+    // ========== ISR STATE ==========
+    int32_t m_current;               // Value (Q15.16)
+    int32_t m_targetQ15;             // Target the current ramp heads for
+    int32_t m_step;                  // LINEAR step per sample (Q15.16, signed)
+    bool m_constantFilled;           // m_ramp holds getCurrent() throughout
+    int16_t m_ramp[AUDIO_BLOCK_SAMPLES] __attribute__((aligned(4)));
+};
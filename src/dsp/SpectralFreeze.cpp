@@ -0,0 +1,210 @@
+#include "SpectralFreeze.h"
+#include <math.h>
+
+float SpectralFreeze::s_window[SpectralFreeze::FFT_SIZE];
+float SpectralFreeze::s_sine[SpectralFreeze::FFT_SIZE];
+bool SpectralFreeze::s_tablesReady = false;
+
+/**
+ * Output gain for random-phase overlap-add
+ * Hann analysis keeps 3/8 of the frame power, Hann synthesis at 75% overlap
+ * sums squared windows to 1.5 -> 0.5625 overall, so scale amplitude by 4/3.
+ */
+static constexpr float SYNTHESIS_GAIN = 4.0f / 3.0f;
+
+SpectralFreeze::SpectralFreeze() {
+    if (!s_tablesReady) {
+        for (uint32_t i = 0; i < FFT_SIZE; i++) {
+            float phase = 2.0f * static_cast<float>(M_PI) * i / FFT_SIZE;
+            s_window[i] = 0.5f - 0.5f * cosf(phase);  // Periodic Hann
+            s_sine[i] = sinf(phase);
+        }
+        s_tablesReady = true;
+    }
+
+#if MICROLOOP_SPECTRAL_FREEZE
+    arm_cfft_radix4_init_f32(&m_forward, FFT_SIZE, 0, 1);
+    arm_cfft_radix4_init_f32(&m_inverse, FFT_SIZE, 1, 1);  // Inverse includes 1/N scaling
+#endif
+
+    memset(m_fft, 0, sizeof(m_fft));
+    memset(m_magL, 0, sizeof(m_magL));
+    memset(m_magR, 0, sizeof(m_magR));
+    memset(m_olaL, 0, sizeof(m_olaL));
+    memset(m_olaR, 0, sizeof(m_olaR));
+    m_olaPos = 0;
+    m_stage = Stage::ANALYZE_FFT;
+    m_blockInHop = 0;
+    m_active = false;
+    m_dryRemaining = 0;
+    m_rngState = 0x2545F491u;
+}
+
+uint32_t SpectralFreeze::nextRandom() {
+    uint32_t x = m_rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m_rngState = x;
+    return x;
+}
+
+bool SpectralFreeze::start(const int16_t* srcL, const int16_t* srcR, uint32_t srcMask, uint32_t newestIndex) {
+    if (!AVAILABLE) {
+        return false;
+    }
+
+    // Stage the windowed frame (packed stereo: L real, R imaginary); FFT runs next block
+    uint32_t idx = (newestIndex - (FFT_SIZE - 1)) & srcMask;
+    for (uint32_t i = 0; i < FFT_SIZE; i++) {
+        m_fft[2 * i] = srcL[idx] * s_window[i];
+        m_fft[2 * i + 1] = srcR[idx] * s_window[i];
+        idx = (idx + 1) & srcMask;
+    }
+
+    memset(m_olaL, 0, sizeof(m_olaL));
+    memset(m_olaR, 0, sizeof(m_olaR));
+    m_olaPos = 0;
+    m_stage = Stage::ANALYZE_FFT;
+    m_blockInHop = 0;
+    m_dryRemaining = DRY_FADE_SAMPLES;
+    m_active = true;
+    return true;
+}
+
+void SpectralFreeze::buildSpectrum() {
+    const uint32_t quarter = FFT_SIZE / 4;
+
+    // DC and Nyquist carry no useful drone content - leave them silent
+    m_fft[0] = 0.0f;
+    m_fft[1] = 0.0f;
+    m_fft[FFT_SIZE] = 0.0f;
+    m_fft[FFT_SIZE + 1] = 0.0f;
+
+    // Shared phase per bin: Z[k] = e^(j*phi) * (A_L + j*A_R), Z[N-k] = e^(-j*phi) * (A_L + j*A_R)
+    // IFFT(Z) = left + j*right, both real
+    for (uint32_t k = 1; k < FFT_SIZE / 2; k++) {
+        uint32_t phaseIdx = nextRandom() >> 22;  // 10 bits -> [0, FFT_SIZE)
+        float s = s_sine[phaseIdx];
+        float c = s_sine[(phaseIdx + quarter) & (FFT_SIZE - 1)];
+        float aL = m_magL[k];
+        float aR = m_magR[k];
+
+        float* zk = &m_fft[2 * k];
+        float* zn = &m_fft[2 * (FFT_SIZE - k)];
+        zk[0] = aL * c - aR * s;
+        zk[1] = aL * s + aR * c;
+        zn[0] = aL * c + aR * s;
+        zn[1] = aR * c - aL * s;
+    }
+}
+
+void SpectralFreeze::synthesizeFrame() {
+#if MICROLOOP_SPECTRAL_FREEZE
+    arm_cfft_radix4_f32(&m_inverse, m_fft);
+#endif
+    for (uint32_t i = 0; i < FFT_SIZE; i++) {
+        float w = s_window[i] * SYNTHESIS_GAIN;
+        m_fft[2 * i] *= w;
+        m_fft[2 * i + 1] *= w;
+    }
+}
+
+void SpectralFreeze::overlapAdd() {
+    uint32_t pos = m_olaPos;
+    for (uint32_t i = 0; i < FFT_SIZE; i++) {
+        m_olaL[pos] += m_fft[2 * i];
+        m_olaR[pos] += m_fft[2 * i + 1];
+        pos = (pos + 1) & (FFT_SIZE - 1);
+    }
+}
+
+void SpectralFreeze::emitBlock(const int16_t* dryL, const int16_t* dryR, int16_t* outL, int16_t* outR) {
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        float l = m_olaL[m_olaPos];
+        float r = m_olaR[m_olaPos];
+        m_olaL[m_olaPos] = 0.0f;  // Slot is reused by a later frame
+        m_olaR[m_olaPos] = 0.0f;
+        m_olaPos = (m_olaPos + 1) & (FFT_SIZE - 1);
+
+        if (m_dryRemaining > 0) {
+            // Linear dry fade-out while the overlap-add ramps up
+            float dryGain = static_cast<float>(m_dryRemaining) / DRY_FADE_SAMPLES;
+            if (dryL) l += dryL[i] * dryGain;
+            if (dryR) r += dryR[i] * dryGain;
+            m_dryRemaining--;
+        }
+
+        int32_t li = static_cast<int32_t>(l);
+        int32_t ri = static_cast<int32_t>(r);
+        outL[i] = static_cast<int16_t>(li > 32767 ? 32767 : (li < -32768 ? -32768 : li));
+        outR[i] = static_cast<int16_t>(ri > 32767 ? 32767 : (ri < -32768 ? -32768 : ri));
+    }
+}
+
+void SpectralFreeze::process(const int16_t* dryL, const int16_t* dryR, int16_t* outL, int16_t* outR) {
+    if (!m_active) {
+        memset(outL, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+        memset(outR, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+        return;
+    }
+
+    switch (m_stage) {
+        case Stage::ANALYZE_FFT:
+#if MICROLOOP_SPECTRAL_FREEZE
+            arm_cfft_radix4_f32(&m_forward, m_fft);
+#endif
+            m_stage = Stage::ANALYZE_MAG;
+            break;
+
+        case Stage::ANALYZE_MAG:
+            // Separate packed stereo: X_L = (Z[k] + conj(Z[N-k])) / 2, X_R = (Z[k] - conj(Z[N-k])) / 2j
+            for (uint32_t k = 1; k < FFT_SIZE / 2; k++) {
+                float a = m_fft[2 * k];
+                float b = m_fft[2 * k + 1];
+                float c = m_fft[2 * (FFT_SIZE - k)];
+                float d = m_fft[2 * (FFT_SIZE - k) + 1];
+                m_magL[k] = 0.5f * sqrtf((a + c) * (a + c) + (b - d) * (b - d));
+                m_magR[k] = 0.5f * sqrtf((a - c) * (a - c) + (b + d) * (b + d));
+            }
+            m_magL[0] = 0.0f;
+            m_magR[0] = 0.0f;
+            buildSpectrum();
+            m_stage = Stage::PRIME_IFFT;
+            break;
+
+        case Stage::PRIME_IFFT:
+            synthesizeFrame();
+            m_stage = Stage::RUNNING;
+            m_blockInHop = 0;
+            break;
+
+        case Stage::RUNNING:
+            if (m_blockInHop == 0) {
+                overlapAdd();      // Frame synthesized during the previous hop
+                emitBlock(dryL, dryR, outL, outR);
+                buildSpectrum();   // Next frame's phases
+            } else if (m_blockInHop == 1) {
+                emitBlock(dryL, dryR, outL, outR);
+                synthesizeFrame();
+            } else {
+                emitBlock(dryL, dryR, outL, outR);  // Smaller blocks: nothing left to do this hop
+            }
+            if (++m_blockInHop >= BLOCKS_PER_HOP) {
+                m_blockInHop = 0;
+            }
+            return;
+    }
+
+    // Still preparing the first frame - pass dry input through (already there when in place)
+    if (!dryL) {
+        memset(outL, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+    } else if (dryL != outL) {
+        memcpy(outL, dryL, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+    }
+    if (!dryR) {
+        memset(outR, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+    } else if (dryR != outR) {
+        memcpy(outR, dryR, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+    }
+}
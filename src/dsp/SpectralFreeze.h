@@ -0,0 +1,139 @@
+/**
+ * SpectralFreeze.h - FFT spectral freeze with random-phase overlap-add resynthesis
+ *
+ * PURPOSE:
+ * Sustains the timbre of a captured moment as a smooth, seamless drone:
+ * one 1024-point magnitude spectrum is captured on engage and resynthesised
+ * forever with fresh random phases, so there is no loop seam and no grain rhythm.
+ *
+ * DESIGN:
+ * - CMSIS radix-4 float FFT (arm_cfft_radix4_f32), same library family as the
+ *   Audio library's analyze_fft1024 (which uses the q15 variant)
+ * - Stereo in one transform: left in the real part, right in the imaginary part
+ *   - Analysis: spectra separated via Hermitian symmetry (Z[k] +/- conj(Z[N-k]))
+ *   - Synthesis: both channels share each bin's random phase (keeps the stereo image)
+ * - Hop = 256 (75% overlap), periodic Hann synthesis window, constant gain correction
+ * - Work is spread so no single audio block runs more than one FFT:
+ *   - Engage: block 0 forward FFT, block 1 magnitudes + first spectrum, block 2 first IFFT
+ *   - Running (HOP / AUDIO_BLOCK_SAMPLES blocks per hop: 2 at 128, 8 at 32):
+ *     block 0 overlap-add + next spectrum, block 1 IFFT, remaining blocks emit only
+ * - Dry input passes through while the first frame is prepared, then fades out
+ *   as the overlap-add builds up (no gap at engage)
+ * - Random phases: xorshift32 index into a sine table (no sinf/cosf in the ISR)
+ *
+ * BUILD:
+ * Requires the CMSIS-DSP library (libarm_cortexM7lfsp_math.a). CMakeLists.txt
+ * defines MICROLOOP_SPECTRAL_FREEZE=1 when it is found; otherwise AVAILABLE is
+ * false and start() refuses, so callers fall back to another freeze mode.
+ *
+ * USAGE:
+ *   SpectralFreeze spectral;
+ *   if (spectral.start(ringL, ringR, RING_MASK, newestIndex)) { ... }
+ *   spectral.process(dryL, dryR, outL, outR);  // Each audio block (dry may be nullptr)
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <AudioStream.h>
+
+#ifndef MICROLOOP_SPECTRAL_FREEZE
+#define MICROLOOP_SPECTRAL_FREEZE 0
+#endif
+
+#if MICROLOOP_SPECTRAL_FREEZE
+#include <arm_math.h>
+#endif
+
+class SpectralFreeze {
+public:
+    // ========== CONFIGURATION ==========
+    static constexpr bool AVAILABLE = (MICROLOOP_SPECTRAL_FREEZE != 0);
+    static constexpr uint32_t FFT_SIZE = 1024;
+    static constexpr uint32_t HOP = 256;                            // 75% overlap
+    static constexpr uint32_t BLOCKS_PER_HOP = HOP / AUDIO_BLOCK_SAMPLES;
+    static constexpr uint32_t DRY_FADE_SAMPLES = FFT_SIZE - HOP;    // Overlap-add ramp-up
+
+    static_assert(HOP % AUDIO_BLOCK_SAMPLES == 0, "Hop must be a whole number of audio blocks");
+    static_assert(BLOCKS_PER_HOP >= 2, "Work split needs at least two blocks per hop");
+
+    SpectralFreeze();
+
+    /**
+     * Capture the spectrum of the FFT_SIZE samples ending at newestIndex
+     * Analysis runs over the next blocks; dry audio passes through meanwhile.
+     *
+     * @param srcL Left channel source (circular, power-of-2 size)
+     * @param srcR Right channel source (circular, power-of-2 size)
+     * @param srcMask Source size - 1
+     * @param newestIndex Ring index of the most recent sample
+     * @return false if spectral freeze is not compiled in
+     */
+    bool start(const int16_t* srcL, const int16_t* srcR, uint32_t srcMask, uint32_t newestIndex);
+
+    /**
+     * Render one block (AUDIO_BLOCK_SAMPLES)
+     *
+     * @param dryL Live left input (nullptr = silence), used while the first frame is prepared
+     * @param dryR Live right input (nullptr = silence)
+     * @param outL Left output (may alias dryL - processed in place)
+     * @param outR Right output (may alias dryR)
+     */
+    void process(const int16_t* dryL, const int16_t* dryR, int16_t* outL, int16_t* outR);
+
+private:
+    enum class Stage : uint8_t {
+        ANALYZE_FFT = 0,   // Forward FFT of captured frame
+        ANALYZE_MAG = 1,   // Extract magnitudes, build first spectrum
+        PRIME_IFFT = 2,    // First inverse FFT
+        RUNNING = 3        // Steady-state overlap-add (BLOCKS_PER_HOP blocks per hop)
+    };
+
+    /**
+     * xorshift32 PRNG
+     */
+    uint32_t nextRandom();
+
+    /**
+     * Fill m_fft with the captured magnitudes at fresh random phases (packed stereo)
+     */
+    void buildSpectrum();
+
+    /**
+     * Inverse FFT of m_fft, then apply synthesis window and gain in place
+     */
+    void synthesizeFrame();
+
+    /**
+     * Add the windowed frame in m_fft into the overlap-add accumulators
+     */
+    void overlapAdd();
+
+    /**
+     * Emit AUDIO_BLOCK_SAMPLES from the accumulators (clearing them), mixing the dry fade
+     */
+    void emitBlock(const int16_t* dryL, const int16_t* dryR, int16_t* outL, int16_t* outR);
+
+    // ========== TABLES (shared, computed once) ==========
+    static float s_window[FFT_SIZE];   // Periodic Hann
+    static float s_sine[FFT_SIZE];     // One sine period (cos = quarter-period offset)
+    static bool s_tablesReady;
+
+#if MICROLOOP_SPECTRAL_FREEZE
+    arm_cfft_radix4_instance_f32 m_forward;
+    arm_cfft_radix4_instance_f32 m_inverse;
+#endif
+
+    // ========== STATE ==========
+    float m_fft[2 * FFT_SIZE];         // Interleaved complex work buffer (in place)
+    float m_magL[FFT_SIZE / 2];        // Captured magnitudes, bins 0..N/2-1
+    float m_magR[FFT_SIZE / 2];
+    float m_olaL[FFT_SIZE];            // Overlap-add accumulators (circular)
+    float m_olaR[FFT_SIZE];
+    uint32_t m_olaPos;                 // Next output index in accumulators
+    Stage m_stage;
+    uint8_t m_blockInHop;              // 0..BLOCKS_PER_HOP-1 while RUNNING
+    bool m_active;                     // start() succeeded
+    uint32_t m_dryRemaining;           // Samples left in the dry fade-out
+    uint32_t m_rngState;               // xorshift32 state (never 0)
+};
@@ -3,26 +3,75 @@
 // Define static EXTMEM buffers
 EXTMEM int16_t StutterAudio::m_stutterBufferL[StutterAudio::STUTTER_BUFFER_SAMPLES];
 EXTMEM int16_t StutterAudio::m_stutterBufferR[StutterAudio::STUTTER_BUFFER_SAMPLES];
-
-StutterAudio::StutterAudio() : IEffectAudio(2) {  // Call base with 2 inputs (stereo)
+EXTMEM int16_t StutterAudio::m_historyL[StutterAudio::HISTORY_SAMPLES];
+EXTMEM int16_t StutterAudio::m_historyR[StutterAudio::HISTORY_SAMPLES];
+EXTMEM int16_t StutterAudio::m_rollBufferL[StutterAudio::MAX_BEAT_SAMPLES];
+EXTMEM int16_t StutterAudio::m_rollBufferR[StutterAudio::MAX_BEAT_SAMPLES];
+
+// Loop output staging (internal RAM): the retroactive history read must finish
+// before the in-place input block is appended to the ring; the stretch read
+// head renders 16-bit output that is widened onto the bus
+static int32_t s_playL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_playR[AUDIO_BLOCK_SAMPLES];
+static int16_t s_stretchL[AUDIO_BLOCK_SAMPLES];
+static int16_t s_stretchR[AUDIO_BLOCK_SAMPLES];
+
+// Live input kept for the wet/dry mix (loop and roll output replace the block in place)
+static int32_t s_dryL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_dryR[AUDIO_BLOCK_SAMPLES];
+
+StutterAudio::StutterAudio()
+    : IEffectAudio(2),  // Call base with 2 inputs (stereo)
+      m_params{SmoothedParam(100.0f, 100.0f)} {  // MIX: percent, default loop only
+    bindParameters(m_params, PARAM_COUNT);
     m_writePos = 0;
     m_readPos = 0;
     m_captureLength = 0;  // No captured loop yet
+    m_loopCapacity = STUTTER_BUFFER_SAMPLES;
+    m_captureSpb = 0;       // Capture tempo unknown until first capture
+    m_stretchActive = false;
+    m_ratioQ16 = TimeStretch::RATIO_UNITY_Q16;
+    m_ratioSpb = 0;         // Forces a ratio update on first playback
+    m_ratioCaptureSpb = 0;
     m_state = StutterState::IDLE_NO_LOOP;
     m_lengthMode = StutterLength::FREE;  // Default: free mode
     m_onsetMode = StutterOnset::FREE;    // Default: free mode
     m_captureStartMode = StutterCaptureStart::FREE;    // Default: free mode
     m_captureEndMode = StutterCaptureEnd::FREE;    // Default: free mode
+    m_captureBars = StutterCaptureBars::BARS_1;    // Default: 1 bar
+    m_mode = StutterMode::LOOP;                    // Default: loop playback
     m_captureStartAtSample = 0;   // No scheduled capture start
     m_captureEndAtSample = 0;     // No scheduled capture end
     m_playbackOnsetAtSample = 0;  // No scheduled playback onset
     m_playbackLengthAtSample = 0; // No scheduled playback length
     m_stutterHeld = false;        // Track if STUTTER button held (set by controller)
     m_waitStartSample = 0;        // No wait in progress
-
-    // Initialize buffers to silence
-    memset(m_stutterBufferL, 0, sizeof(m_stutterBufferL));
-    memset(m_stutterBufferR, 0, sizeof(m_stutterBufferR));
+    m_historyWriteIdx = 0;
+    m_historyFill = 0;            // Nothing recorded yet
+    m_historyHeadSample = 0;
+    m_loopInHistory = false;
+    m_historyLoopStart = 0;
+    m_migratePos = 0;
+    m_residentSamples = RESIDENT_ALL;
+    m_streamReadHead = 0;
+    m_streamUnderruns = 0;
+    m_rollReturnState = StutterState::IDLE_NO_LOOP;
+    m_rollStartAtSample = 0;
+    m_rollStopAtSample = 0;
+    m_rollStopNow = false;
+    m_rollStarted = false;
+    m_rollSpb = 0;                // Forces slice table computation on first roll block
+    memset(m_rollSliceLen, 0, sizeof(m_rollSliceLen));
+    m_rollLevel = 0;
+    m_rollPhase = 0;
+    m_rollRecorded = 0;
+    m_rollSamplesToStep = 0;
+    m_rollXfadeRemaining = 0;
+    m_rollXfadeFromPos = 0;
+    m_rollFadeOutRemaining = 0;
+
+    // Buffers are not cleared (4MB loop budget + history ring would stall boot):
+    // playback never reads past m_captureLength, history never past m_historyFill
 }
 
 void StutterAudio::enable() {
@@ -33,6 +82,7 @@ void StutterAudio::enable() {
 
 void StutterAudio::disable() {
     // Stop playback and clear loop
+    m_loopInHistory = false;
     m_state = StutterState::IDLE_NO_LOOP;
     m_captureLength = 0;
     m_writePos = 0;
@@ -58,12 +108,16 @@ const char* StutterAudio::getName() const {
 }
 
 void StutterAudio::startCapture() {
+    m_loopInHistory = false;  // Abandon any pending migration (buffer is about to be overwritten)
     m_writePos = 0;  // Reset write position
     m_captureLength = 0;  // Clear previous capture
+    m_loopCapacity = computeLoopCapacity();  // Size capture for current tempo
+    m_captureSpb = Timebase::getSamplesPerBeat();
     m_state = StutterState::CAPTURING;
 }
 
 void StutterAudio::scheduleCaptureStart(uint64_t sample) {
+    m_loopInHistory = false;  // Abandon any pending migration (buffer is about to be overwritten)
     m_captureStartAtSample = sample;
     m_waitStartSample = Timebase::getSamplePosition();  // Record when wait began
     m_state = StutterState::WAIT_CAPTURE_START;
@@ -125,7 +179,314 @@ void StutterAudio::schedulePlaybackLength(uint64_t sample) {
     }
 }
 
-void StutterAudio::update() {
+void StutterAudio::startRoll(uint64_t startSample) {
+    noInterrupts();
+    if (m_state == StutterState::IDLE_NO_LOOP || m_state == StutterState::IDLE_WITH_LOOP) {
+        m_rollReturnState = m_state;  // Captured loop survives the roll
+    }
+    m_rollStartAtSample = startSample;
+    m_rollStopAtSample = 0;
+    m_rollStopNow = false;
+    m_rollStarted = false;
+    m_rollFadeOutRemaining = 0;
+    m_state = StutterState::ROLLING;
+    interrupts();
+}
+
+void StutterAudio::stopRoll(uint64_t stopSample) {
+    noInterrupts();
+    if (m_state == StutterState::ROLLING) {
+        if (stopSample == 0) {
+            m_rollStopNow = true;
+        } else {
+            m_rollStopAtSample = stopSample;
+        }
+    }
+    interrupts();
+}
+
+bool StutterAudio::captureRetroactive(uint64_t startSample, uint32_t length, bool stutterHeld) {
+    if (length == 0 || length > MAX_BEAT_SAMPLES) {
+        return false;
+    }
+
+    // Ring state is owned by the ISR - validate and switch atomically
+    bool ok = false;
+    noInterrupts();
+    uint64_t endSample = startSample + length;
+    if (endSample <= m_historyHeadSample) {
+        uint64_t age = m_historyHeadSample - startSample;  // Samples between region start and head
+        if (age <= m_historyFill) {
+            m_historyLoopStart = (m_historyWriteIdx - static_cast<uint32_t>(age)) & HISTORY_MASK;
+            m_migratePos = 0;
+            m_loopInHistory = true;
+            m_captureLength = length;
+            m_captureSpb = Timebase::getSamplesPerBeat();
+            m_stretchActive = false;
+            m_writePos = length;
+            m_readPos = 0;
+            m_captureStartAtSample = 0;
+            m_captureEndAtSample = 0;
+            m_state = stutterHeld ? StutterState::PLAYING : StutterState::IDLE_WITH_LOOP;
+            ok = true;
+        }
+    }
+    interrupts();
+    return ok;
+}
+
+bool StutterAudio::migrateHistoryLoop(size_t maxSamples) {
+    if (!m_loopInHistory) {
+        return true;  // Already resident
+    }
+
+    // Region is stable: the ring needs (HISTORY_SAMPLES - age) more samples to reach it,
+    // which is seconds away, while this copy finishes within a few app loop passes.
+    size_t end = m_migratePos + maxSamples;
+    if (end > m_captureLength) {
+        end = m_captureLength;
+    }
+    for (size_t i = m_migratePos; i < end; i++) {
+        uint32_t idx = (m_historyLoopStart + i) & HISTORY_MASK;
+        m_stutterBufferL[i] = m_historyL[idx];
+        m_stutterBufferR[i] = m_historyR[idx];
+    }
+    m_migratePos = end;
+
+    if (m_migratePos < m_captureLength) {
+        return false;
+    }
+
+    // Copy complete - ISR reads the loop buffer from the next block on
+    m_loopInHistory = false;
+    return true;
+}
+
+void StutterAudio::beginStreamingLoad() {
+    noInterrupts();
+    m_loopInHistory = false;
+    m_state = StutterState::IDLE_NO_LOOP;  // Old loop is gone once the first chunk lands
+    m_captureLength = 0;
+    m_residentSamples = 0;
+    m_streamReadHead = 0;
+    m_streamUnderruns = 0;
+    interrupts();
+}
+
+void StutterAudio::endStreamingLoad(bool success) {
+    noInterrupts();
+    if (!success) {
+        m_state = StutterState::IDLE_NO_LOOP;  // Partial loop is not worth keeping
+        m_captureLength = 0;
+        m_stretchActive = false;
+    }
+    m_residentSamples = RESIDENT_ALL;
+    interrupts();
+}
+
+uint32_t StutterAudio::takeStreamUnderruns() {
+    noInterrupts();
+    uint32_t underruns = m_streamUnderruns;
+    m_streamUnderruns = 0;
+    interrupts();
+    return underruns;
+}
+
+size_t StutterAudio::computeLoopCapacity() const {
+    uint64_t samples = static_cast<uint64_t>(Timebase::getSamplesPerBeat()) *
+                       Timebase::BEATS_PER_BAR * barsFor(m_captureBars);
+    if (samples > STUTTER_BUFFER_SAMPLES) {
+        samples = STUTTER_BUFFER_SAMPLES;  // Guard only: MAX_CAPTURE_BARS fits at MIN_BPM
+    }
+    return static_cast<size_t>(samples);
+}
+
+uint32_t StutterAudio::updateStretchRatio() {
+    uint32_t spb = Timebase::getSamplesPerBeat();
+    if (spb != m_ratioSpb || m_captureSpb != m_ratioCaptureSpb) {
+        // Tempo or loop changed: the only division on this path
+        m_ratioQ16 = TimeStretch::ratioFromTempo(m_captureSpb, spb);
+        m_ratioSpb = spb;
+        m_ratioCaptureSpb = m_captureSpb;
+    }
+    return m_ratioQ16;
+}
+
+bool StutterAudio::updateRollSlices() {
+    uint32_t spb = Timebase::getSamplesPerBeat();
+    if (spb == m_rollSpb) {
+        return false;  // Tempo unchanged - table still valid
+    }
+    m_rollSpb = spb;
+
+    uint32_t beat = (spb > MAX_BEAT_SAMPLES) ? MAX_BEAT_SAMPLES : spb;
+    for (uint8_t level = 0; level < ROLL_LEVELS; level++) {
+        m_rollSliceLen[level] = beat >> level;  // 1/4, 1/8, 1/16, 1/32 note
+    }
+    return true;
+}
+
+uint32_t StutterAudio::rollSamplesToBeat(uint64_t sample) const {
+    // Same beat grid as Timebase::samplesToNextBeat(); on a boundary, a whole beat
+    return m_rollSpb - static_cast<uint32_t>(sample % m_rollSpb);
+}
+
+int32_t StutterAudio::rollCrossfade(int32_t from, int32_t to, int32_t k) {
+    // 64-bit products: bus frames may use all 31 bits
+    int32_t n = static_cast<int32_t>(ROLL_XFADE_SAMPLES);
+    return static_cast<int32_t>((static_cast<int64_t>(from) * (n - k) + static_cast<int64_t>(to) * k) >> ROLL_XFADE_SHIFT);
+}
+
+void StutterAudio::processRoll(int32_t* dataL, int32_t* dataR, uint64_t blockStartSample) {
+    if (updateRollSlices() && m_rollStarted) {
+        m_rollSamplesToStep = rollSamplesToBeat(blockStartSample);  // Next step on the new beat grid
+    }
+
+    if (m_rollStopNow) {
+        m_rollStopNow = false;
+        if (!m_rollStarted) {
+            // Released before the start boundary - output never left live audio
+            m_state = m_rollReturnState;
+            return;
+        }
+        if (m_rollFadeOutRemaining == 0) {
+            m_rollFadeOutRemaining = ROLL_XFADE_SAMPLES;
+        }
+    }
+
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        uint64_t sample = blockStartSample + i;
+
+        // ===== Start (sample-accurate) =====
+        if (!m_rollStarted) {
+            if (sample < m_rollStartAtSample) {
+                continue;  // Still live
+            }
+            m_rollStarted = true;
+            m_rollLevel = 0;
+            m_rollPhase = 0;
+            m_rollRecorded = 0;
+            // First step on the next beat; a start within a 1/32 of it holds 1/4 through it
+            m_rollSamplesToStep = rollSamplesToBeat(sample);
+            if (m_rollSamplesToStep < m_rollSliceLen[ROLL_LEVELS - 1]) {
+                m_rollSamplesToStep += m_rollSpb;
+            }
+            m_rollXfadeRemaining = 0;
+        }
+
+        // ===== Scheduled stop (sample-accurate) =====
+        if (m_rollStopAtSample != 0 && sample >= m_rollStopAtSample) {
+            m_rollStopAtSample = 0;
+            if (m_rollFadeOutRemaining == 0) {
+                m_rollFadeOutRemaining = ROLL_XFADE_SAMPLES;
+            }
+        }
+
+        int32_t liveL = dataL[i];
+        int32_t liveR = dataR[i];
+
+        // ===== Step / retrigger =====
+        // Level 0 slice may still be recording; shorter slices never exceed what was recorded
+        uint32_t sliceLen = m_rollSliceLen[m_rollLevel];
+        if (m_rollLevel > 0 && sliceLen > m_rollRecorded) {
+            sliceLen = m_rollRecorded;
+        }
+        bool retrigger = false;
+        if (m_rollSamplesToStep == 0) {
+            // Beat boundary: shrink slice (stays at 1/32 once reached)
+            if (m_rollLevel < ROLL_LEVELS - 1) {
+                m_rollLevel++;
+            }
+            m_rollSamplesToStep = rollSamplesToBeat(sample);
+            retrigger = true;
+        } else if (m_rollPhase >= sliceLen) {
+            retrigger = true;
+        }
+        if (retrigger) {
+            if (m_rollPhase > 0) {
+                // Fade out the continuation of the old read head
+                m_rollXfadeFromPos = m_rollPhase;
+                m_rollXfadeRemaining = ROLL_XFADE_SAMPLES;
+            }
+            m_rollPhase = 0;
+        }
+
+        // ===== Read (first pass records the live slice) =====
+        int32_t outL;
+        int32_t outR;
+        if (m_rollPhase == m_rollRecorded && m_rollRecorded < m_rollSliceLen[0]) {
+            m_rollBufferL[m_rollRecorded] = AudioBus::narrow(liveL);
+            m_rollBufferR[m_rollRecorded] = AudioBus::narrow(liveR);
+            m_rollRecorded++;
+            outL = liveL;
+            outR = liveR;
+        } else {
+            outL = AudioBus::widen(m_rollBufferL[m_rollPhase]);
+            outR = AudioBus::widen(m_rollBufferR[m_rollPhase]);
+        }
+
+        // ===== Retrigger crossfade (old head → new head) =====
+        if (m_rollXfadeRemaining > 0) {
+            int32_t k = ROLL_XFADE_SAMPLES - m_rollXfadeRemaining;
+            int32_t oldL;
+            int32_t oldR;
+            if (m_rollXfadeFromPos < m_rollRecorded) {
+                oldL = AudioBus::widen(m_rollBufferL[m_rollXfadeFromPos]);
+                oldR = AudioBus::widen(m_rollBufferR[m_rollXfadeFromPos]);
+            } else {
+                oldL = liveL;  // Old head was the live first pass
+                oldR = liveR;
+            }
+            outL = rollCrossfade(oldL, outL, k);
+            outR = rollCrossfade(oldR, outR, k);
+            m_rollXfadeFromPos++;
+            m_rollXfadeRemaining--;
+        }
+
+        // ===== Stop crossfade (roll → live) =====
+        bool stopped = false;
+        if (m_rollFadeOutRemaining > 0) {
+            int32_t k = ROLL_XFADE_SAMPLES - m_rollFadeOutRemaining;
+            outL = rollCrossfade(outL, liveL, k);
+            outR = rollCrossfade(outR, liveR, k);
+            m_rollFadeOutRemaining--;
+            stopped = (m_rollFadeOutRemaining == 0);
+        }
+
+        dataL[i] = outL;
+        dataR[i] = outR;
+
+        m_rollPhase++;
+        m_rollSamplesToStep--;
+
+        if (stopped) {
+            // Rest of block is already live input (processed in place)
+            m_rollStarted = false;
+            m_state = m_rollReturnState;
+            break;
+        }
+    }
+}
+
+void StutterAudio::writeHistory(const int32_t* dataL, const int32_t* dataR, uint64_t blockStartSample) {
+    if (blockStartSample != m_historyHeadSample) {
+        // Timeline discontinuity: older ring contents no longer map to sample positions
+        m_historyFill = 0;
+        m_historyHeadSample = blockStartSample;
+    }
+
+    // AUDIO_BLOCK_SAMPLES divides HISTORY_SAMPLES and writes stay block-aligned, so no wrap mid-block
+    AudioBus::narrowBlock(dataL, &m_historyL[m_historyWriteIdx], AUDIO_BLOCK_SAMPLES);
+    AudioBus::narrowBlock(dataR, &m_historyR[m_historyWriteIdx], AUDIO_BLOCK_SAMPLES);
+
+    m_historyWriteIdx = (m_historyWriteIdx + AUDIO_BLOCK_SAMPLES) & HISTORY_MASK;
+    m_historyHeadSample += AUDIO_BLOCK_SAMPLES;
+    if (m_historyFill < HISTORY_SAMPLES) {
+        m_historyFill += AUDIO_BLOCK_SAMPLES;
+    }
+}
+
+void StutterAudio::processBlock(int32_t* dataL, int32_t* dataR) {
     uint64_t currentSample = Timebase::getSamplePosition();
     uint64_t blockEndSample = currentSample + AUDIO_BLOCK_SAMPLES;
 
@@ -135,6 +496,8 @@ void StutterAudio::update() {
     if (m_captureStartAtSample > 0 && currentSample >= m_captureStartAtSample && currentSample < blockEndSample) {
         m_writePos = 0;
         m_captureLength = 0;
+        m_loopCapacity = computeLoopCapacity();  // Tempo at the boundary, not at scheduling
+        m_captureSpb = Timebase::getSamplesPerBeat();
         m_state = StutterState::CAPTURING;
         m_captureStartAtSample = 0;
     }
@@ -168,75 +531,122 @@ void StutterAudio::update() {
         m_playbackLengthAtSample = 0;
     }
 
+    // ========== WET/DRY MIX ==========
+
+    StutterState playState = m_state;
+    bool replacesInput = (playState == StutterState::ROLLING ||
+                          playState == StutterState::PLAYING ||
+                          playState == StutterState::WAIT_PLAYBACK_LENGTH);
+    SmoothedParam& mix = m_params[PARAM_MIX];
+    const int16_t* mixGains = nullptr;
+    if (!replacesInput) {
+        mix.settle();  // Not heard: next playback starts at the set mix
+    } else {
+        const int16_t* gains = mix.render();
+        if (!mix.isSettledAt(GainRamp::UNITY_Q15)) {
+            mixGains = gains;
+            memcpy(s_dryL, dataL, sizeof(s_dryL));
+            memcpy(s_dryR, dataR, sizeof(s_dryR));
+        }
+    }
+
     // ========== STATE MACHINE AUDIO PROCESSING ==========
 
     switch (m_state) {
         case StutterState::IDLE_NO_LOOP:
         case StutterState::IDLE_WITH_LOOP:
         case StutterState::WAIT_CAPTURE_START:
-        case StutterState::WAIT_PLAYBACK_ONSET: {
-            // PASSTHROUGH: Just pass audio through unchanged
-            audio_block_t* blockL = receiveWritable(0);
-            audio_block_t* blockR = receiveWritable(1);
-
-            if (blockL && blockR) {
-                transmit(blockL, 0);
-                transmit(blockR, 1);
-            }
-
-            if (blockL) release(blockL);
-            if (blockR) release(blockR);
+        case StutterState::WAIT_PLAYBACK_ONSET:
+            // PASSTHROUGH: Audio unchanged, keep recording history
+            m_stretchActive = false;  // Next playback starts a fresh stretch read head
+            writeHistory(dataL, dataR, currentSample);
             break;
-        }
 
         case StutterState::CAPTURING:
-        case StutterState::WAIT_CAPTURE_END: {
+        case StutterState::WAIT_CAPTURE_END:
             // CAPTURING: Write to buffer (non-circular) and pass through
-            audio_block_t* blockL = receiveWritable(0);
-            audio_block_t* blockR = receiveWritable(1);
-
-            if (blockL && blockR) {
-                // Write to buffer if space available
-                for (size_t i = 0; i < AUDIO_BLOCK_SAMPLES && m_writePos < STUTTER_BUFFER_SAMPLES; i++) {
-                    m_stutterBufferL[m_writePos] = blockL->data[i];
-                    m_stutterBufferR[m_writePos] = blockR->data[i];
-                    m_writePos++;
-                }
+            m_stretchActive = false;
+            writeHistory(dataL, dataR, currentSample);
+
+            // Write to buffer if space available
+            for (size_t i = 0; i < AUDIO_BLOCK_SAMPLES && m_writePos < m_loopCapacity; i++) {
+                m_stutterBufferL[m_writePos] = AudioBus::narrow(dataL[i]);
+                m_stutterBufferR[m_writePos] = AudioBus::narrow(dataR[i]);
+                m_writePos++;
+            }
 
-                // Check if buffer is full (auto-transition, overrides quantization)
-                if (m_writePos >= STUTTER_BUFFER_SAMPLES) {
-                    m_captureLength = m_writePos;
-                    if (m_stutterHeld) {
-                        m_readPos = 0;
-                        m_state = StutterState::PLAYING;
-                    } else {
-                        m_state = StutterState::IDLE_WITH_LOOP;
-                    }
-                    // Cancel any scheduled capture end
-                    m_captureEndAtSample = 0;
+            // Check if capture is full (auto-transition, overrides quantization)
+            if (m_writePos >= m_loopCapacity) {
+                m_captureLength = m_writePos;
+                if (m_stutterHeld) {
+                    m_readPos = 0;
+                    m_state = StutterState::PLAYING;
+                } else {
+                    m_state = StutterState::IDLE_WITH_LOOP;
                 }
-
-                // Pass through unmodified
-                transmit(blockL, 0);
-                transmit(blockR, 1);
+                // Cancel any scheduled capture end
+                m_captureEndAtSample = 0;
             }
+            break;
 
-            if (blockL) release(blockL);
-            if (blockR) release(blockR);
+        case StutterState::ROLLING:
+            // ROLLING: Live slice repeats, processed in place
+            writeHistory(dataL, dataR, currentSample);
+            processRoll(dataL, dataR, currentSample);
             break;
-        }
 
         case StutterState::PLAYING:
         case StutterState::WAIT_PLAYBACK_LENGTH: {
-            // PLAYING: Read from buffer and loop
-            audio_block_t* outL = allocate();
-            audio_block_t* outR = allocate();
+            // Loop stays locked to current tempo: speed = capture tempo / current tempo
+            uint32_t ratioQ16 = updateStretchRatio();
+
+            if (m_loopInHistory) {
+                // Retroactive loop: read in place from the history ring, before this
+                // block's input is appended to it (staged so the output can overwrite the input)
+                for (size_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+                    uint32_t idx = (m_historyLoopStart + m_readPos) & HISTORY_MASK;
+                    s_playL[i] = AudioBus::widen(m_historyL[idx]);
+                    s_playR[i] = AudioBus::widen(m_historyR[idx]);
+
+                    m_readPos++;
+                    if (m_readPos >= m_captureLength) {
+                        m_readPos = 0;  // Loop back to start
+                    }
+                }
+                writeHistory(dataL, dataR, currentSample);
+                memcpy(dataL, s_playL, sizeof(s_playL));
+                memcpy(dataR, s_playR, sizeof(s_playR));
+                break;
+            }
+
+            // Not using live audio, but keep recording history
+            writeHistory(dataL, dataR, currentSample);
+
+            // Streaming preset load: the SD worker stores the data before it raises the
+            // count (same core, program order), so everything below resident is valid
+            uint32_t resident = m_residentSamples;
+            bool fullyResident = (resident >= m_captureLength);
+
+            if (ratioQ16 != TimeStretch::RATIO_UNITY_Q16 &&
+                m_captureLength >= TimeStretch::MIN_LOOP_LENGTH &&
+                (fullyResident || m_readPos + STREAM_STRETCH_LOOKAHEAD <= resident)) {
+                // Tempo changed since capture: pitch-preserving WSOLA read head
+                if (!m_stretchActive) {
+                    m_stretch.reset(m_stutterBufferL, m_stutterBufferR, m_captureLength, m_readPos);
+                    m_stretchActive = true;
+                }
+                m_stretch.process(m_stutterBufferL, m_stutterBufferR, m_captureLength,
+                                  ratioQ16, s_stretchL, s_stretchR);
+                AudioBus::widenBlock(s_stretchL, dataL, AUDIO_BLOCK_SAMPLES);
+                AudioBus::widenBlock(s_stretchR, dataR, AUDIO_BLOCK_SAMPLES);
+                m_readPos = m_stretch.getPosition();
+            } else if (fullyResident) {
+                m_stretchActive = false;
 
-            if (outL && outR) {
                 // Read from captured buffer
                 for (size_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
-                    outL->data[i] = m_stutterBufferL[m_readPos];
-                    outR->data[i] = m_stutterBufferR[m_readPos];
+                    dataL[i] = AudioBus::widen(m_stutterBufferL[m_readPos]);
+                    dataR[i] = AudioBus::widen(m_stutterBufferR[m_readPos]);
 
                     // Advance read position (loop when reaching end)
                     m_readPos++;
@@ -244,22 +654,41 @@ void StutterAudio::update() {
                         m_readPos = 0;  // Loop back to start
                     }
                 }
+            } else {
+                // Loop still loading: unity-speed read, silence where the load hasn't
+                // reached yet (stretch re-primes once its window is resident)
+                m_stretchActive = false;
+                bool underrun = false;
+                for (size_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+                    if (m_readPos < resident) {
+                        dataL[i] = AudioBus::widen(m_stutterBufferL[m_readPos]);
+                        dataR[i] = AudioBus::widen(m_stutterBufferR[m_readPos]);
+                    } else {
+                        dataL[i] = 0;
+                        dataR[i] = 0;
+                        underrun = true;
+                    }
 
-                transmit(outL, 0);
-                transmit(outR, 1);
+                    m_readPos++;
+                    if (m_readPos >= m_captureLength) {
+                        m_readPos = 0;  // Loop back to start
+                    }
+                }
+                if (underrun) {
+                    m_streamUnderruns = m_streamUnderruns + 1;
+                }
             }
-
-            if (outL) release(outL);
-            if (outR) release(outR);
-
-            // Consume and discard input blocks (not using live audio)
-            audio_block_t* blockL = receiveReadOnly(0);
-            audio_block_t* blockR = receiveReadOnly(1);
-            if (blockL) release(blockL);
-            if (blockR) release(blockR);
+            m_streamReadHead = m_readPos;
             break;
         }
     }
+
+    if (mixGains) {
+        GainRamp::mixBus(s_dryL, dataL, mixGains, AUDIO_BLOCK_SAMPLES);
+        GainRamp::mixBus(s_dryR, dataR, mixGains, AUDIO_BLOCK_SAMPLES);
+        memcpy(dataL, s_dryL, sizeof(s_dryL));
+        memcpy(dataR, s_dryR, sizeof(s_dryR));
+    }
 }
 
 uint64_t StutterAudio::getScheduledSample() const {
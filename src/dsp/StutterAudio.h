@@ -2,6 +2,7 @@
 
 #include "IEffectAudio.h"
 #include "Timebase.h"
+#include "TimeStretch.h"
 #include <atomic>
 #include <Arduino.h>
 
@@ -17,7 +18,8 @@ enum class StutterOnset : uint8_t {
 
 enum class StutterCaptureStart : uint8_t {
     FREE = 0,       // Start capture immediately when FUNC+STUTTER pressed (default)
-    QUANTIZED = 1   // Start capture at next grid boundary
+    QUANTIZED = 1,  // Start capture at next grid boundary
+    RETRO = 2       // Take the last grid-aligned period from the history ring (no CAPTURING phase)
 };
 
 enum class StutterCaptureEnd : uint8_t {
@@ -25,8 +27,20 @@ enum class StutterCaptureEnd : uint8_t {
     QUANTIZED = 1   // End capture at next grid boundary after release
 };
 
+enum class StutterMode : uint8_t {
+    LOOP = 0,       // STUTTER plays the captured loop (default)
+    ROLL = 1        // STUTTER rolls live audio: slice shrinks 1/4 → 1/8 → 1/16 → 1/32 each beat
+};
+
+enum class StutterCaptureBars : uint8_t {
+    BARS_1 = 0,     // Capture up to 1 bar at current tempo (default)
+    BARS_2 = 1,     // Capture up to 2 bars
+    BARS_4 = 2,     // Capture up to 4 bars
+    BARS_8 = 3      // Capture up to 8 bars (44.1/48kHz builds, see StutterAudio::MAX_CAPTURE_BARS)
+};
+
 /**
- * Stutter State Machine (8 states)
+ * Stutter State Machine (9 states)
  *
  * State transitions:
  * - idleWithNoLoop: No loop captured, passthrough audio
@@ -37,6 +51,7 @@ enum class StutterCaptureEnd : uint8_t {
  * - waitForPlaybackOnset: Waiting for quantized playback start boundary
  * - Playing: Actively playing captured loop
  * - waitForPlaybackLength: Waiting for quantized playback stop boundary
+ * - Rolling: Roll mode active (live slice repeats, independent of captured loop)
  */
 enum class StutterState : uint8_t {
     IDLE_NO_LOOP = 0,           // No loop captured (LED: OFF)
@@ -46,7 +61,8 @@ enum class StutterState : uint8_t {
     WAIT_CAPTURE_END = 4,       // Waiting for capture end grid (LED: RED solid)
     WAIT_PLAYBACK_ONSET = 5,    // Waiting for playback start grid (LED: BLUE blinking)
     PLAYING = 6,                // Playing captured loop (LED: BLUE solid)
-    WAIT_PLAYBACK_LENGTH = 7    // Waiting for playback stop grid (LED: BLUE solid)
+    WAIT_PLAYBACK_LENGTH = 7,   // Waiting for playback stop grid (LED: BLUE solid)
+    ROLLING = 8                 // Roll mode, incl. pending start/stop (LED: MAGENTA solid)
 };
 
 class StutterAudio : public IEffectAudio {
@@ -114,6 +130,58 @@ public:
      */
     void schedulePlaybackLength(uint64_t sample);
 
+    /**
+     * Start a roll (Mode=Roll, STUTTER pressed)
+     * Output stays live until startSample, then the slice starting there repeats.
+     * Slice length steps 1/4 → 1/8 → 1/16 → 1/32 note on each Timebase beat boundary
+     * after the start (tempo changes move the next step onto the new grid).
+     * Captured loop (if any) is untouched - state returns to idle on stop.
+     *
+     * @param startSample Absolute sample position of the roll start (sample-accurate)
+     */
+    void startRoll(uint64_t startSample);
+
+    /**
+     * Stop a roll (Mode=Roll, STUTTER released)
+     * Crossfades back to live audio starting at stopSample.
+     *
+     * @param stopSample Absolute sample position to stop at (0 = immediately)
+     */
+    void stopRoll(uint64_t stopSample);
+
+    /**
+     * Retroactive capture (CaptureStart=Retro)
+     *
+     * Turns an already-heard region of the history ring into the current loop.
+     * The loop is referenced in place (O(1), no copy in the ISR) and migrated
+     * into the loop buffer later by migrateHistoryLoop() on the app thread.
+     *
+     * Transitions to PLAYING if STUTTER held, else IDLE_WITH_LOOP.
+     *
+     * @param startSample Absolute sample position of the region start
+     * @param length Region length in samples (1..getMaxBufferSize())
+     * @param stutterHeld Is STUTTER held?
+     * @return false if the region is not (or no longer) in the history ring
+     */
+    bool captureRetroactive(uint64_t startSample, uint32_t length, bool stutterHeld);
+
+    /**
+     * Copy part of a history-referenced loop into the loop buffer (app thread)
+     *
+     * Copies at most maxSamples per call so the app thread stays responsive.
+     * When the copy completes, playback switches over to the loop buffer.
+     *
+     * @param maxSamples Maximum samples (per channel) to copy in this call
+     * @return true if the loop is resident in the loop buffer (nothing left to do)
+     */
+    bool migrateHistoryLoop(size_t maxSamples);
+
+    /**
+     * Is the current loop resident in the loop buffer?
+     * False while a retroactive loop still references the history ring.
+     */
+    bool isLoopResident() const { return !m_loopInHistory; }
+
     // ========== PARAMETER CONTROL ==========
 
     void setStutterHeld(bool held) { m_stutterHeld = held; }
@@ -142,20 +210,93 @@ public:
      */
     void setCaptureLength(uint32_t length) { m_captureLength = length; }
 
+    /**
+     * Get tempo the loop was captured at (samples per beat, 0 = unknown)
+     * Playback is time-stretched to the current tempo when this differs
+     */
+    uint32_t getCaptureSamplesPerBeat() const { return m_captureSpb; }
+
+    /**
+     * Set capture tempo (used when loading preset, 0 = unknown / no stretch)
+     */
+    void setCaptureSamplesPerBeat(uint32_t samplesPerBeat) { m_captureSpb = samplesPerBeat; }
+
     /**
      * Transition to IDLE_WITH_LOOP state (used after loading preset)
      */
     void setStateWithLoop() {
+        m_loopInHistory = false;  // Loaded loop lives in the loop buffer
         m_state = StutterState::IDLE_WITH_LOOP;
         m_readPos = 0;
+        m_streamReadHead = 0;
         m_writePos = m_captureLength;
     }
 
+    // ========== STREAMING PRESET LOAD ==========
+    // The SD worker fills the loop buffer from the start while the loop may
+    // already play: samples past the resident count play as silence (the read
+    // head keeps moving, playback never waits for the card).
+
+    static constexpr uint32_t RESIDENT_ALL = 0xFFFFFFFF;  // Not streaming: whole loop resident
+
+    /**
+     * Drop the current loop and start counting resident samples from 0 (app thread)
+     * The loop buffer is about to be overwritten by a preset load.
+     */
+    void beginStreamingLoad();
+
+    /**
+     * End a streaming load (app thread)
+     *
+     * @param success true: loop fully resident, playback continues untouched;
+     *                false: the partial loop is dropped (IDLE_NO_LOOP)
+     */
+    void endStreamingLoad(bool success);
+
+    /**
+     * Loop is playable but still being loaded (samples past the resident count are silent)
+     */
+    bool isStreamingLoad() const { return m_captureLength > 0 && m_residentSamples < m_captureLength; }
+
+    /**
+     * Samples at the start of the loop buffer loaded so far (written by the SD worker)
+     */
+    volatile uint32_t* getResidentCounter() { return &m_residentSamples; }
+
+    /**
+     * Playback position in the loop, published once per block (read by the SD worker)
+     */
+    const volatile uint32_t* getReadHead() const { return &m_streamReadHead; }
+
     /**
-     * Get maximum buffer size in samples
+     * Blocks that played (partly) silent because the load fell behind, then reset (app thread)
+     */
+    uint32_t takeStreamUnderruns();
+
+    /**
+     * Get maximum buffer size in samples (PSRAM loop budget per channel)
+     * Upper bound for any capture or loaded preset, independent of tempo
      */
     static constexpr size_t getMaxBufferSize() { return STUTTER_BUFFER_SAMPLES; }
 
+    /**
+     * Longest capture offered: fits the loop budget at any tempo down to Timebase::MIN_BPM
+     * 8 bars at 44.1/48kHz; 2 bars above 48kHz (8 bars at 30 BPM would need ~25MB of PSRAM)
+     */
+    static constexpr StutterCaptureBars MAX_CAPTURE_BARS =
+        (Timebase::SAMPLE_RATE > 48000) ? StutterCaptureBars::BARS_2 : StutterCaptureBars::BARS_8;
+
+    /**
+     * Bars captured for a capture length setting (1, 2, 4, 8)
+     */
+    static constexpr uint32_t barsFor(StutterCaptureBars bars) { return 1u << static_cast<uint8_t>(bars); }
+
+    /**
+     * Get capacity of the current/next capture in samples
+     * Set when capture starts: capture bars x samples per bar, clamped to budget
+     */
+    size_t getLoopCapacity() const { return m_loopCapacity; }
+
     void setLengthMode(StutterLength mode) { m_lengthMode = mode; }
     StutterLength getLengthMode() const { return m_lengthMode; }
 
@@ -168,6 +309,23 @@ public:
     void setCaptureEndMode(StutterCaptureEnd mode) { m_captureEndMode = mode; }
     StutterCaptureEnd getCaptureEndMode() const { return m_captureEndMode; }
 
+    void setCaptureBars(StutterCaptureBars bars) { m_captureBars = (bars > MAX_CAPTURE_BARS) ? MAX_CAPTURE_BARS : bars; }
+    StutterCaptureBars getCaptureBars() const { return m_captureBars; }
+
+    void setMode(StutterMode mode) { m_mode = mode; }
+    StutterMode getMode() const { return m_mode; }
+
+    // ========== CONTINUOUS PARAMETERS (setParameter index) ==========
+    static constexpr uint8_t PARAM_MIX = 0;    // Loop/roll vs live input while playing (percent)
+    static constexpr uint8_t PARAM_COUNT = 1;
+
+    /**
+     * Wet/dry mix while the loop or a roll plays (0-100%, default 100 = loop only)
+     * Takes effect immediately, smoothed over SmoothedParam::DEFAULT_TIME_MS
+     */
+    void setMix(uint8_t percent) { setParameter(PARAM_MIX, percent); }
+    uint8_t getMix() const { return static_cast<uint8_t>(getParameter(PARAM_MIX) + 0.5f); }
+
     // ========== WAIT TIMING ACCESS (for LED brightness ramp) ==========
 
     /**
@@ -182,24 +340,134 @@ public:
      */
     uint64_t getScheduledSample() const;
 
-    virtual void update() override;
+    void processBlock(int32_t* dataL, int32_t* dataR) override;
 
 private:
     // ========== BUFFER CONFIGURATION ==========
-    // Buffer size: 1 bar @ 70 BPM (min tempo) = ~590KB total (295KB per channel)
-    static constexpr uint8_t MIN_TEMPO = 70;
-    static constexpr size_t STUTTER_BUFFER_SAMPLES = static_cast<size_t>((1 / (MIN_TEMPO / 60.0)) * Timebase::SAMPLE_RATE) * 4;
+    // PSRAM loop budget: MAX_CAPTURE_BARS at the slowest tempo (spb = Timebase::MAX_SAMPLES_PER_BEAT)
+    //   8 bars @ 30 BPM = 2822400 samples @ 44.1kHz (~11.3MB total), 3072000 @ 48kHz (~12.3MB total)
+    //   2 bars @ 30 BPM = 1536000 samples @ 96kHz (~6.1MB total)
+    // Capture capacity is sized at runtime from tempo and capture bars, so every
+    // offered capture length is held in full at any supported tempo.
+    // App's MIDI clock filter (Timebase::MAX_TICK_PERIOD_US) admits tempos down to
+    // MIN_BPM, so the whole budget is reachable - keep the two floors together.
+    static constexpr size_t STUTTER_BUFFER_SAMPLES =
+        (static_cast<size_t>(Timebase::MAX_SAMPLES_PER_BEAT) * Timebase::BEATS_PER_BAR)
+        << static_cast<uint8_t>(MAX_CAPTURE_BARS);  // x barsFor(MAX_CAPTURE_BARS)
+    static_assert(Timebase::samplesPerBeatFromTick(Timebase::MAX_TICK_PERIOD_US << Timebase::TICK_PERIOD_FRAC_BITS) >=
+                      Timebase::MAX_SAMPLES_PER_BEAT,
+                  "Loop budget is sized for a tempo the MIDI clock filter rejects");
+
+    /**
+     * Compute capture capacity from current tempo and capture bars (ISR-safe)
+     */
+    size_t computeLoopCapacity() const;
 
-    // Audio buffers (non-circular during capture)
+    // Audio buffers (non-circular during capture, only first m_loopCapacity samples used)
     // EXTMEM places these in external PSRAM (16MB) instead of DTCM (512KB)
     // Static to allow EXTMEM usage (only one stutter instance exists)
     static EXTMEM int16_t m_stutterBufferL[STUTTER_BUFFER_SAMPLES];
     static EXTMEM int16_t m_stutterBufferR[STUTTER_BUFFER_SAMPLES];
 
+    // ========== HISTORY RING CONFIGURATION ==========
+    // Always-on record of the input: 2^19 samples = ~11.9s @ 44.1kHz (~1MB per channel),
+    // 2^20 samples = ~10.9s @ 96kHz (~2MB per channel)
+    // Power of 2 so ring indices wrap with a mask. Must hold the longest retro region
+    // plus enough headroom for the app thread to migrate it before it is overwritten.
+    static constexpr uint32_t HISTORY_SAMPLES = (Timebase::SAMPLE_RATE > 48000) ? (1u << 20) : (1u << 19);
+    static constexpr uint32_t HISTORY_MASK = HISTORY_SAMPLES - 1;
+    // Longest 1/4 note at the slowest MIDI-synced tempo (88200 @ 44.1kHz, 192000 @ 96kHz)
+    // Bounds retro regions and roll slices
+    static constexpr uint32_t MAX_BEAT_SAMPLES = Timebase::MAX_SAMPLES_PER_BEAT;
+    static_assert(HISTORY_SAMPLES >= 4 * MAX_BEAT_SAMPLES, "History ring too small for retro capture");
+    // Loop, history and roll buffers share the 16MB PSRAM with the freeze capture ring
+    static_assert(2 * (STUTTER_BUFFER_SAMPLES + HISTORY_SAMPLES + MAX_BEAT_SAMPLES) * sizeof(int16_t) <= (15u << 20),
+                  "Stutter buffers must leave PSRAM for the freeze capture ring");
+
+    static EXTMEM int16_t m_historyL[HISTORY_SAMPLES];
+    static EXTMEM int16_t m_historyR[HISTORY_SAMPLES];
+
+    // ========== ROLL CONFIGURATION ==========
+    // Roll slice is recorded while it plays live (first beat), then repeated from here.
+    // Separate from the history ring so long rolls never see their slice overwritten.
+    static constexpr uint8_t ROLL_LEVELS = 4;               // 1/4, 1/8, 1/16, 1/32
+    static constexpr uint32_t ROLL_XFADE_SHIFT = (Timebase::SAMPLE_RATE > 48000) ? 7 : 6;
+    static constexpr uint32_t ROLL_XFADE_SAMPLES = 1u << ROLL_XFADE_SHIFT;  // Retrigger/stop crossfade (~1.3-1.5ms)
+    static EXTMEM int16_t m_rollBufferL[MAX_BEAT_SAMPLES];
+    static EXTMEM int16_t m_rollBufferR[MAX_BEAT_SAMPLES];
+
+    /**
+     * Render one block of roll output in place (ISR)
+     * Sample-accurate start/step/retrigger/stop inside the block
+     */
+    void processRoll(int32_t* dataL, int32_t* dataR, uint64_t blockStartSample);
+
+    /**
+     * Linear roll crossfade on bus frames: from * (1 - k/N) + to * k/N, N = ROLL_XFADE_SAMPLES
+     */
+    static int32_t rollCrossfade(int32_t from, int32_t to, int32_t k);
+
+    /**
+     * Recompute roll slice lengths (only when tempo changed)
+     *
+     * @return true if the tempo changed
+     */
+    bool updateRollSlices();
+
+    /**
+     * Samples from sample to the next Timebase beat boundary (a whole beat on a boundary)
+     */
+    uint32_t rollSamplesToBeat(uint64_t sample) const;
+
+    /**
+     * Playback ratio for the current and capture tempo (recomputed only when either changed)
+     */
+    uint32_t updateStretchRatio();
+
+    /**
+     * Append one input block (bus frames, stored as int16) to the history ring (ISR)
+     * Resets the valid window if the timeline jumped (missed block, Timebase reset)
+     */
+    void writeHistory(const int32_t* dataL, const int32_t* dataR, uint64_t blockStartSample);
+
     // ========== BUFFER POSITION STATE ==========
     size_t m_writePos;       // Current write position during capture
     size_t m_readPos;        // Current read position during playback
     size_t m_captureLength;  // Length of captured loop (0 = no loop)
+    size_t m_loopCapacity;   // Capacity of current capture (auto-end when reached)
+
+    // ========== TEMPO SYNC ==========
+    uint32_t m_captureSpb;    // Samples per beat when loop was captured (0 = unknown)
+    SmoothedParam m_params[PARAM_COUNT];  // Continuous parameters (bound to setParameter)
+    TimeStretch m_stretch;    // WSOLA read head (used when tempo differs from capture tempo)
+    bool m_stretchActive;     // Stretch read head primed for current playback
+    uint32_t m_ratioQ16;          // Cached TimeStretch::ratioFromTempo() result
+    uint32_t m_ratioSpb;          // Current tempo m_ratioQ16 was computed for
+    uint32_t m_ratioCaptureSpb;   // Capture tempo m_ratioQ16 was computed for
+
+    // ========== HISTORY RING STATE ==========
+    uint32_t m_historyWriteIdx;     // Next ring index to write (wraps with HISTORY_MASK)
+    uint32_t m_historyFill;         // Valid samples behind the write index (saturates at HISTORY_SAMPLES)
+    uint64_t m_historyHeadSample;   // Absolute sample position of m_historyWriteIdx
+
+    // ========== RETROACTIVE LOOP REFERENCE ==========
+    volatile bool m_loopInHistory;  // Loop is read from the history ring (not yet migrated)
+    uint32_t m_historyLoopStart;    // Ring index of loop start (valid while m_loopInHistory)
+    size_t m_migratePos;            // Samples already copied into the loop buffer
+
+    // ========== STREAMING LOAD STATE ==========
+    // Samples the stretch read head may touch past m_readPos in one block
+    // (analysis hop at MAX_RATIO_Q16 + frame + search); less resident = unity-speed read
+    static constexpr uint32_t STREAM_STRETCH_LOOKAHEAD =
+        ((TimeStretch::MAX_RATIO_Q16 * TimeStretch::HOP + 0xFFFF) >> 16) +
+        TimeStretch::FRAME + TimeStretch::SEARCH_RADIUS;
+    static_assert(((static_cast<uint64_t>(TimeStretch::MAX_RATIO_Q16) * TimeStretch::HOP + 0xFFFF) >> 16) <=
+                      STREAM_STRETCH_LOOKAHEAD - TimeStretch::FRAME - TimeStretch::SEARCH_RADIUS,
+                  "Stream lookahead must cover one analysis hop at TimeStretch::MAX_RATIO_Q16");
+
+    volatile uint32_t m_residentSamples;   // Loaded samples from loop start (RESIDENT_ALL = whole loop)
+    volatile uint32_t m_streamReadHead;    // m_readPos as of the last played block
+    volatile uint32_t m_streamUnderruns;   // Blocks with silence past the resident samples
 
     // ========== STATE MACHINE ==========
     StutterState m_state;
@@ -209,6 +477,8 @@ private:
     StutterLength m_lengthMode;              // Playback length mode (FREE or QUANTIZED)
     StutterCaptureStart m_captureStartMode;  // Capture start mode (FREE or QUANTIZED)
     StutterCaptureEnd m_captureEndMode;      // Capture end mode (FREE or QUANTIZED)
+    StutterCaptureBars m_captureBars;        // Capture length limit in bars (1, 2, 4, 8)
+    StutterMode m_mode;                      // Loop playback or roll
 
     // ========== SCHEDULED SAMPLE POSITIONS ==========
     uint64_t m_captureStartAtSample;    // Scheduled capture start (0 = none)
@@ -216,6 +486,22 @@ private:
     uint64_t m_playbackOnsetAtSample;   // Scheduled playback onset (0 = none)
     uint64_t m_playbackLengthAtSample;  // Scheduled playback stop (0 = none)
 
+    // ========== ROLL STATE ==========
+    StutterState m_rollReturnState;        // Idle state to return to when roll ends
+    uint64_t m_rollStartAtSample;          // Roll start position (sample-accurate)
+    uint64_t m_rollStopAtSample;           // Scheduled roll stop (0 = none)
+    volatile bool m_rollStopNow;           // Stop requested at next block (free length)
+    bool m_rollStarted;                    // Start sample reached, slice recording/repeating
+    uint32_t m_rollSpb;                    // Tempo the slice table was computed for
+    uint32_t m_rollSliceLen[ROLL_LEVELS];  // Slice length per level (precomputed per tempo)
+    uint8_t m_rollLevel;                   // Current level (0 = 1/4 ... 3 = 1/32)
+    uint32_t m_rollPhase;                  // Read position within slice
+    uint32_t m_rollRecorded;               // Samples of slice recorded so far
+    uint32_t m_rollSamplesToStep;          // Samples until next Timebase beat (level step)
+    uint32_t m_rollXfadeRemaining;         // Retrigger crossfade samples left (0 = none)
+    uint32_t m_rollXfadeFromPos;           // Old read position faded out during retrigger
+    uint32_t m_rollFadeOutRemaining;       // Stop crossfade samples left (0 = not stopping)
+
     // ========== BUTTON STATE TRACKING ==========
     bool m_stutterHeld;  // Is STUTTER button held? (set by controller)
 
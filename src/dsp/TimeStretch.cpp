@@ -0,0 +1,194 @@
+#include "TimeStretch.h"
+#include <math.h>
+
+#if defined(__ARM_ARCH_7EM__)
+#include "utility/dspinst.h"
+#endif
+
+uint16_t TimeStretch::s_window[TimeStretch::FRAME];
+bool TimeStretch::s_windowReady = false;
+
+// ========== SEARCH SCRATCH (internal RAM) ==========
+// Loop buffer lives in PSRAM - stage mono copies once per frame so the
+// correlation loop only touches fast memory. Word-aligned for packed loads.
+static int16_t s_reference[TimeStretch::HOP] __attribute__((aligned(4)));
+static int16_t s_search[TimeStretch::SEARCH_LENGTH] __attribute__((aligned(4)));
+
+/**
+ * Wrap a (possibly negative) loop position into [0, length)
+ */
+static inline uint32_t wrapPosition(int32_t pos, uint32_t length) {
+    while (pos < 0) {
+        pos += length;
+    }
+    while (static_cast<uint32_t>(pos) >= length) {
+        pos -= length;
+    }
+    return static_cast<uint32_t>(pos);
+}
+
+/**
+ * Dot product of two word-aligned int16 arrays (count must be even)
+ * SMLALD processes two sample pairs per instruction on Cortex-M7
+ */
+static inline int64_t dotProduct(const int16_t* a, const int16_t* b, uint32_t count) {
+    int64_t acc = 0;
+#if defined(__ARM_ARCH_7EM__)
+    const uint32_t* pa = reinterpret_cast<const uint32_t*>(a);
+    const uint32_t* pb = reinterpret_cast<const uint32_t*>(b);
+    for (uint32_t i = 0; i < count / 2; i++) {
+        acc = multiply_accumulate_16tx16t_add_16bx16b(acc, pa[i], pb[i]);
+    }
+#else
+    for (uint32_t i = 0; i < count; i++) {
+        acc += static_cast<int32_t>(a[i]) * b[i];
+    }
+#endif
+    return acc;
+}
+
+TimeStretch::TimeStretch() {
+    if (!s_windowReady) {
+        // Periodic Hann: w[i] = 0.5 - 0.5 * cos(2*pi*i / FRAME)
+        for (uint32_t i = 0; i < HOP; i++) {
+            float w = 0.5f - 0.5f * cosf(2.0f * static_cast<float>(M_PI) * i / FRAME);
+            uint16_t q = static_cast<uint16_t>(lroundf(w * 32768.0f));
+            s_window[i] = q;
+            s_window[i + HOP] = static_cast<uint16_t>(32768 - q);  // Exact unity overlap
+        }
+        s_windowReady = true;
+    }
+
+    m_analysisPos = 0;
+    m_analysisFrac = 0;
+    m_prevStart = 0;
+    m_length = 0;
+    memset(m_tailL, 0, sizeof(m_tailL));
+    memset(m_tailR, 0, sizeof(m_tailR));
+    memset(m_outL, 0, sizeof(m_outL));
+    memset(m_outR, 0, sizeof(m_outR));
+    m_outPos = 0;
+}
+
+uint32_t TimeStretch::ratioFromTempo(uint32_t captureSamplesPerBeat, uint32_t currentSamplesPerBeat) {
+    if (captureSamplesPerBeat == 0 || currentSamplesPerBeat == 0) {
+        return RATIO_UNITY_Q16;
+    }
+    uint64_t ratio = (static_cast<uint64_t>(captureSamplesPerBeat) << 16) / currentSamplesPerBeat;
+    return (ratio > MAX_RATIO_Q16) ? MAX_RATIO_Q16 : static_cast<uint32_t>(ratio);
+}
+
+void TimeStretch::reset(const int16_t* bufL, const int16_t* bufR, uint32_t length, uint32_t position) {
+    m_analysisPos = position % length;
+    m_analysisFrac = 0;
+    m_length = length;
+    m_outPos = 0;  // First block renders a frame
+
+    // Pretend the previous frame started one hop earlier: its windowed second half
+    // is exactly the audio at the current position, so output continues without a dip
+    m_prevStart = wrapPosition(static_cast<int32_t>(m_analysisPos) - static_cast<int32_t>(HOP), length);
+    uint32_t pos = m_analysisPos;
+    for (uint32_t i = 0; i < HOP; i++) {
+        m_tailL[i] = (static_cast<int32_t>(bufL[pos]) * s_window[HOP + i]) >> 15;
+        m_tailR[i] = (static_cast<int32_t>(bufR[pos]) * s_window[HOP + i]) >> 15;
+        if (++pos >= length) pos = 0;
+    }
+}
+
+uint32_t TimeStretch::findBestStart(const int16_t* bufL, const int16_t* bufR, uint32_t length) const {
+    // Reference: natural continuation of the previous frame (mono)
+    uint32_t pos = wrapPosition(static_cast<int32_t>(m_prevStart + HOP), length);
+    for (uint32_t i = 0; i < HOP; i++) {
+        s_reference[i] = static_cast<int16_t>((static_cast<int32_t>(bufL[pos]) + bufR[pos]) >> 1);
+        if (++pos >= length) pos = 0;
+    }
+
+    // Search region: [nominal - radius, nominal + radius + hop) (mono)
+    uint32_t searchStart = wrapPosition(static_cast<int32_t>(m_analysisPos) - static_cast<int32_t>(SEARCH_RADIUS), length);
+    pos = searchStart;
+    for (uint32_t i = 0; i < SEARCH_LENGTH; i++) {
+        s_search[i] = static_cast<int16_t>((static_cast<int32_t>(bufL[pos]) + bufR[pos]) >> 1);
+        if (++pos >= length) pos = 0;
+    }
+
+    // Maximize normalized cross-correlation c / sqrt(E) (E = candidate energy, the
+    // reference energy is the same for every candidate), so a loud segment can't win
+    // on level alone. Compared as c * |c| / E by cross-multiplying: no division.
+    // Fixed candidate count = bounded cost; energy slides by the stride.
+    int64_t energy = dotProduct(s_search, s_search, HOP);
+    float bestSigned = 0.0f;   // c * |c| of the best candidate
+    float bestEnergy = 1.0f;
+    uint32_t bestOffset = SEARCH_RADIUS;  // Nominal position
+    for (uint32_t offset = 0; offset <= 2 * SEARCH_RADIUS; offset += SEARCH_STRIDE) {
+        float c = static_cast<float>(dotProduct(s_reference, &s_search[offset], HOP));
+        float signedSquare = c * fabsf(c);
+        float e = (energy > 0) ? static_cast<float>(energy) : 1.0f;
+        if (offset == 0 || signedSquare * bestEnergy > bestSigned * e) {
+            bestSigned = signedSquare;
+            bestEnergy = e;
+            bestOffset = offset;
+        }
+        if (offset + SEARCH_STRIDE <= 2 * SEARCH_RADIUS) {
+            for (uint32_t i = 0; i < SEARCH_STRIDE; i++) {
+                int32_t out = s_search[offset + i];
+                int32_t in = s_search[offset + HOP + i];
+                energy += in * in - out * out;
+            }
+        }
+    }
+
+    return wrapPosition(static_cast<int32_t>(searchStart + bestOffset), length);
+}
+
+void TimeStretch::process(const int16_t* bufL, const int16_t* bufR, uint32_t length,
+                          uint32_t ratioQ16, int16_t* outL, int16_t* outR) {
+    m_length = length;
+    if (m_outPos == 0) {
+        renderFrame(bufL, bufR, length, ratioQ16);
+    }
+
+    memcpy(outL, &m_outL[m_outPos], AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+    memcpy(outR, &m_outR[m_outPos], AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+    m_outPos += AUDIO_BLOCK_SAMPLES;
+    if (m_outPos >= HOP) {
+        m_outPos = 0;
+    }
+}
+
+uint32_t TimeStretch::getPosition() const {
+    if (m_outPos == 0 || m_length == 0) {
+        return m_analysisPos;
+    }
+    // Mid-hop: output sample i of the current frame was read from m_prevStart + i
+    return wrapPosition(static_cast<int32_t>(m_prevStart + m_outPos), m_length);
+}
+
+void TimeStretch::renderFrame(const int16_t* bufL, const int16_t* bufR, uint32_t length, uint32_t ratioQ16) {
+    uint32_t start = findBestStart(bufL, bufR, length);
+
+    // Overlap-add: previous tail + first half of new frame; keep second half as new tail
+    uint32_t pos = start;
+    for (uint32_t i = 0; i < HOP; i++) {
+        int32_t l = m_tailL[i] + ((static_cast<int32_t>(bufL[pos]) * s_window[i]) >> 15);
+        int32_t r = m_tailR[i] + ((static_cast<int32_t>(bufR[pos]) * s_window[i]) >> 15);
+        m_outL[i] = static_cast<int16_t>(l > 32767 ? 32767 : (l < -32768 ? -32768 : l));
+        m_outR[i] = static_cast<int16_t>(r > 32767 ? 32767 : (r < -32768 ? -32768 : r));
+        if (++pos >= length) pos = 0;
+    }
+    for (uint32_t i = 0; i < HOP; i++) {
+        m_tailL[i] = (static_cast<int32_t>(bufL[pos]) * s_window[HOP + i]) >> 15;
+        m_tailR[i] = (static_cast<int32_t>(bufR[pos]) * s_window[HOP + i]) >> 15;
+        if (++pos >= length) pos = 0;
+    }
+    m_prevStart = start;
+
+    // Advance nominal analysis position by hop x ratio (Q16 accumulator)
+    if (ratioQ16 > MAX_RATIO_Q16) ratioQ16 = MAX_RATIO_Q16;
+    uint64_t advance = static_cast<uint64_t>(HOP) * ratioQ16 + m_analysisFrac;
+    m_analysisFrac = static_cast<uint32_t>(advance & 0xFFFF);
+    // Ratio <= MAX_RATIO_Q16 and length >= MIN_LOOP_LENGTH bound the wraps (no division)
+    m_analysisPos += static_cast<uint32_t>(advance >> 16);
+    while (m_analysisPos >= length) {
+        m_analysisPos -= length;
+    }
+}
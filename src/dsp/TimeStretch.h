@@ -0,0 +1,136 @@
+/**
+ * TimeStretch.h - WSOLA time-stretch read head for tempo-synced loops
+ *
+ * PURPOSE:
+ * Plays a stereo loop buffer at a different speed without changing its pitch,
+ * so a loop captured at one tempo stays locked to the current Timebase tempo.
+ *
+ * DESIGN:
+ * - WSOLA (Waveform Similarity Overlap-Add)
+ *   - Synthesis hop = ~2.9ms (128 samples, 256 at 96kHz) regardless of the audio
+ *     block size (a shorter frame at 32/64-sample blocks would add modulation artifacts)
+ *   - One frame is rendered into an output FIFO every HOP samples; each block
+ *     drains AUDIO_BLOCK_SAMPLES from it (HOP is a whole number of blocks)
+ *   - Frame = 2 x hop, periodic Hann window (Q15, precomputed once)
+ *   - Analysis hop = synthesis hop x ratio (ratio in Q16, > 1.0 = faster)
+ * - Similarity search around the nominal analysis position:
+ *   - Mono (L+R)/2 staged into internal RAM, +/-SEARCH_RADIUS samples
+ *   - Stride scales with the hop, so the candidate count is the same at every sample rate
+ *   - Packed 16-bit dot products (SMLALD on Cortex-M7), 64-bit accumulation
+ *   - Normalized cross-correlation (candidate energy slides with the stride), so
+ *     the best match wins rather than the loudest segment
+ * - Bounded cost per block: fixed number of candidates, no allocation, no division
+ *   (ratioFromTempo() divides - callers recompute it only when a tempo changes)
+ * - Loop wraparound handled by indexing modulo loop length
+ *
+ * USAGE:
+ *   TimeStretch stretch;
+ *   stretch.reset(bufL, bufR, length, readPos);           // Entering stretched playback
+ *   stretch.process(bufL, bufR, length, ratioQ16, outL, outR);  // Each audio block
+ *   readPos = stretch.getPosition();                       // Leaving stretched playback
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <AudioStream.h>
+#include "Timebase.h"
+
+class TimeStretch {
+public:
+    // ========== CONFIGURATION ==========
+    // Synthesis hop (output samples per frame): ~2.7-2.9ms, 128 @ 44.1/48kHz, 256 @ 96kHz
+    static constexpr uint32_t HOP = (Timebase::SAMPLE_RATE > 48000) ? 256 : 128;
+    static constexpr uint32_t FRAME = 2 * HOP;               // Frame length (50% overlap)
+    static constexpr uint32_t SEARCH_RADIUS = HOP / 2;       // Max offset from nominal position (samples)
+    static constexpr uint32_t SEARCH_STRIDE = HOP / 64;      // Candidate spacing (even: keeps 32-bit alignment)
+    static constexpr uint32_t SEARCH_LENGTH = HOP + 2 * SEARCH_RADIUS;
+
+    // Loops shorter than this cannot hold a frame plus search window - caller bypasses
+    static constexpr uint32_t MIN_LOOP_LENGTH = FRAME + 2 * SEARCH_RADIUS;
+
+    // Unity ratio in Q16 (analysis hop == synthesis hop)
+    static constexpr uint32_t RATIO_UNITY_Q16 = 1u << 16;
+
+    // Fastest ratio: a loop captured at Timebase::MIN_BPM played at MAX_BPM (10x).
+    // ratioFromTempo() clamps to it, bounding how far one analysis hop reads ahead.
+    static constexpr uint32_t MAX_RATIO_Q16 = (Timebase::MAX_BPM << 16) / Timebase::MIN_BPM;
+
+    static_assert(HOP % AUDIO_BLOCK_SAMPLES == 0, "Hop must be a whole number of audio blocks");
+    static_assert((static_cast<uint64_t>(MAX_RATIO_Q16) * HOP >> 16) / MIN_LOOP_LENGTH <= 4,
+                  "Analysis hop wrap must stay a few conditional subtracts");
+    static_assert(SEARCH_STRIDE % 2 == 0, "Search stride must keep 32-bit alignment");
+
+    TimeStretch();
+
+    /**
+     * Start stretched playback at a loop position
+     * Primes the overlap tail so the first output block continues seamlessly
+     *
+     * @param bufL Left channel loop buffer
+     * @param bufR Right channel loop buffer
+     * @param length Loop length in samples (>= MIN_LOOP_LENGTH)
+     * @param position Current read position in the loop
+     */
+    void reset(const int16_t* bufL, const int16_t* bufR, uint32_t length, uint32_t position);
+
+    /**
+     * Render one block (AUDIO_BLOCK_SAMPLES) of stretched output
+     * Runs the similarity search and overlap-add once every HOP samples.
+     *
+     * @param bufL Left channel loop buffer
+     * @param bufR Right channel loop buffer
+     * @param length Loop length in samples (>= MIN_LOOP_LENGTH)
+     * @param ratioQ16 Playback speed in Q16 (captureSamplesPerBeat / currentSamplesPerBeat, up to MAX_RATIO_Q16)
+     * @param outL Left output (AUDIO_BLOCK_SAMPLES)
+     * @param outR Right output (AUDIO_BLOCK_SAMPLES)
+     */
+    void process(const int16_t* bufL, const int16_t* bufR, uint32_t length,
+                 uint32_t ratioQ16, int16_t* outL, int16_t* outR);
+
+    /**
+     * Get loop read position equivalent of the next output sample
+     * (nominal analysis position on a hop boundary, else inside the current frame)
+     */
+    uint32_t getPosition() const;
+
+    /**
+     * Compute playback ratio from capture and current tempo (Q16)
+     * Returns RATIO_UNITY_Q16 if either tempo is unknown (0); clamped to MAX_RATIO_Q16
+     */
+    static uint32_t ratioFromTempo(uint32_t captureSamplesPerBeat, uint32_t currentSamplesPerBeat);
+
+private:
+    /**
+     * Find candidate frame start most similar to the natural continuation
+     * of the previous frame (returns loop position)
+     */
+    uint32_t findBestStart(const int16_t* bufL, const int16_t* bufR, uint32_t length) const;
+
+    /**
+     * Search, overlap-add and advance by one hop into the output FIFO
+     */
+    void renderFrame(const int16_t* bufL, const int16_t* bufR, uint32_t length, uint32_t ratioQ16);
+
+    // ========== WINDOW ==========
+    // Periodic Hann, Q15 (32768 = 1.0). w[i] + w[i + HOP] == 32768 exactly,
+    // so overlapping frames sum to unity gain.
+    static uint16_t s_window[FRAME];
+    static bool s_windowReady;
+
+    // ========== STATE ==========
+    uint32_t m_analysisPos;    // Nominal analysis position (integer part, < length)
+    uint32_t m_analysisFrac;   // Fractional analysis position (Q16)
+    uint32_t m_prevStart;      // Start of previous output frame in the loop
+
+    uint32_t m_length;         // Loop length of the last reset/process
+
+    // Second half of previous windowed frame (overlap-add tail)
+    int32_t m_tailL[HOP];
+    int32_t m_tailR[HOP];
+
+    // Output FIFO: one rendered hop, drained one block at a time
+    int16_t m_outL[HOP];
+    int16_t m_outR[HOP];
+    uint32_t m_outPos;         // Next FIFO sample to emit (0 = render a new frame)
+};
@@ -3,6 +3,8 @@
 #include <Audio.h>
 #include "Timebase.h"
 #include "Trace.h"
+#include "DspProfiler.h"
+#include "AudioPoolMonitor.h"
 
 class TimebaseAudio : public AudioStream {
 public:
@@ -12,6 +14,12 @@ public:
         // Increment sample counter (lock-free atomic operation)
         Timebase::incrementSamples(AUDIO_BLOCK_SAMPLES);
 
+        // Per-node graph: effect nodes update after this one, so this closes the previous block
+        DspProfiler::endBlock();
+
+        // Pool high-water mark, sampled once per block
+        AudioPoolMonitor::update();
+
         // Optional: Trace audio callback (disabled by default - too noisy)
         // TRACE(TRACE_AUDIO_CALLBACK);
 
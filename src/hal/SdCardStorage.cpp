@@ -2,27 +2,115 @@
 #include <SD.h>
 #include <SPI.h>
 #include "../dsp/StutterAudio.h"
+#include "Timebase.h"
 
 // Debug logging control - set to 0 for minimal output in production
 #define SD_DEBUG 0
 
+// SDIO transfer mode: 0 = FIFO (the SD library default - the CPU moves each FIFO word
+// through the cache, coherent with no maintenance), 1 = DMA (the controller reads and
+// writes memory itself; readSectors()/writeSectors() below keep the cache coherent)
+#define SD_SDIO_DMA 0
+
 namespace SdCardStorage {
 
 // ========== CONFIGURATION ==========
 
-// Chunk size for SD card writes/reads
-// SD cards prefer 512-byte aligned transfers for optimal performance
-static constexpr size_t CHUNK_SIZE_BYTES = 512;
-
-// Maximum samples that can be stored in a preset - MUST match StutterAudio buffer size
+// Maximum samples that can be stored in a preset - follows the StutterAudio PSRAM loop budget
+// (tempo-independent, so multi-bar loops captured at any tempo can be saved and reloaded)
 // This prevents buffer overflows when loading presets with corrupt/invalid lengths
 static constexpr size_t MAX_PRESET_SAMPLES = StutterAudio::getMaxBufferSize();
 
+// ========== FILE HEADER ==========
+// v3 header - v1 files start directly with the uint32 length (always < PRESET_MAGIC)
+static constexpr uint32_t PRESET_MAGIC = 0x52504C4D;  // "MLPR" little-endian
+static constexpr uint16_t PRESET_VERSION = 3;
+static constexpr uint16_t PRESET_VERSION_V2 = 2;        // No gate pattern
+static constexpr uint16_t PRESET_VERSION_CODED = 4;     // v3 + PresetCodedHeader, coded frames
+static constexpr uint16_t HEADER_SIZE_V2 = 16;
+
+struct PresetHeader {
+    uint32_t magic;                   // PRESET_MAGIC
+    uint16_t version;                 // PRESET_VERSION
+    uint16_t headerSize;              // sizeof(PresetHeader) (allows future fields)
+    uint32_t length;                  // Samples per channel
+    uint32_t captureSamplesPerBeat;   // Capture tempo (0 = unknown)
+    // v3: choke gate pattern
+    uint8_t gateSteps;                // 16 or 32
+    uint8_t routingMode;              // RoutingMode + 1 (0 = not stored)
+    uint8_t routingOrder;             // EffectRouting::packOrder()
+    uint8_t sampleRateCode;           // See sampleRateToCode() (0 = written before rates were stored)
+    uint8_t gateLevels[GATE_MAX_STEPS];
+    uint8_t gateShapes[GATE_MAX_STEPS];
+};
+static_assert(sizeof(PresetHeader) == 84, "PresetHeader must be packed to 84 bytes");
+
+// v4: follows PresetHeader
+struct PresetCodedHeader {
+    uint8_t codec;                    // PresetCodec (LOSSLESS or ADPCM)
+    uint8_t reserved[3];
+    uint32_t codedBytes;              // Frame bytes after the header
+};
+static_assert(sizeof(PresetCodedHeader) == 8, "PresetCodedHeader must be packed to 8 bytes");
+
+// ========== SLOT FILES ==========
+// Each slot is preallocated once as a contiguous file big enough for the longest loop:
+// [header sector][L][R] or [header sector][coded frames]. The header is padded to a whole sector (headerSize = SECTOR_SIZE,
+// so any v3 reader skips the padding) and written last, so an interrupted save leaves
+// the slot empty. Delete zeroes the header sector - no FAT changes after boot.
+// Slots preallocated before coded presets (PCM_SLOT_FILE_BYTES) or for a smaller loop
+// budget keep saving PCM (while it fits - longer loops go to a FAT file) until they are
+// empty, then are reallocated at SLOT_FILE_BYTES.
+static constexpr uint32_t SECTOR_SIZE = 512;
+static constexpr uint32_t CHUNK_SECTORS = CHUNK_SIZE_BYTES / SECTOR_SIZE;
+static constexpr uint32_t DIRECT_CHUNK_SECTORS = DIRECT_CHUNK_BYTES / SECTOR_SIZE;
+// Room for PCM, or for coded frames in the worst case (every frame verbatim: PCM + frame headers)
+static constexpr uint32_t MAX_PRESET_FRAMES = (MAX_PRESET_SAMPLES + PRESET_FRAME_SAMPLES - 1) / PRESET_FRAME_SAMPLES;
+static constexpr uint32_t FRAME_HEADER_SECTORS =
+    (MAX_PRESET_FRAMES * PRESET_FRAME_HEADER_BYTES + SECTOR_SIZE - 1) / SECTOR_SIZE;
+static constexpr uint64_t PCM_SLOT_FILE_BYTES = SECTOR_SIZE + 2ull * MAX_PRESET_SAMPLES * sizeof(int16_t);
+static constexpr uint64_t SLOT_FILE_BYTES = PCM_SLOT_FILE_BYTES + FRAME_HEADER_SECTORS * SECTOR_SIZE;
+static_assert(CHUNK_SIZE_BYTES % SECTOR_SIZE == 0, "Chunks must be whole sectors");
+static_assert(DIRECT_CHUNK_BYTES % SECTOR_SIZE == 0, "Chunks must be whole sectors");
+
+/**
+ * Sample rate <-> header code (every file written before the code existed is 44.1kHz)
+ */
+static uint8_t sampleRateToCode(uint32_t sampleRate) {
+    switch (sampleRate) {
+        case 48000: return 2;
+        case 96000: return 3;
+        default:    return 1;  // 44100
+    }
+}
+
+static uint32_t codeToSampleRate(uint8_t code) {
+    switch (code) {
+        case 2:  return 48000;
+        case 3:  return 96000;
+        default: return 44100;  // 0 (not stored) or 1
+    }
+}
+
 // ========== SCRATCH BUFFER ==========
 // DMAMEM places this in internal RAM (not EXTMEM/PSRAM)
-// SD library may have issues with direct EXTMEM pointers, so we stage all I/O
-// through this scratch buffer and memcpy to/from the actual target buffers
-DMAMEM static uint8_t s_sdScratch[CHUNK_SIZE_BYTES];
+// Bounce buffer for what can't go straight to/from the loop buffers: headers, FAT
+// file I/O, and raw chunks that don't start on a sector or a word boundary
+// One sector more than a chunk: a chunk that doesn't start on a sector spans one more
+DMAMEM static uint8_t s_sdScratch[CHUNK_SIZE_BYTES + SECTOR_SIZE];
+
+// Coded transfers: a DIRECT_CHUNK_BYTES chunk of frames (same card transfer size as PCM)
+// plus what's left of a frame that straddled the last chunk. Card transfers start on a
+// cache line: saves write from the start of the buffer, loads read to CODED_LOAD_OFFSET
+// with the unfinished frame moved to just in front of it
+static constexpr uint32_t CACHE_LINE_BYTES = 32;
+static constexpr uint32_t CODED_LOAD_OFFSET =
+    ((PRESET_MAX_FRAME_BYTES + CACHE_LINE_BYTES - 1) / CACHE_LINE_BYTES) * CACHE_LINE_BYTES;
+static constexpr uint32_t CODED_BUFFER_BYTES =
+    ((CODED_LOAD_OFFSET + DIRECT_CHUNK_BYTES + SECTOR_SIZE - 1) / SECTOR_SIZE) * SECTOR_SIZE;
+DMAMEM static uint8_t s_codedBuffer[CODED_BUFFER_BYTES] __attribute__((aligned(32)));
+static PresetEncoder s_encoder;
+static PresetDecoder s_decoder;
 
 // ========== STATE ==========
 
@@ -31,6 +119,15 @@ static bool s_cardInitialized = false;
 // Preset existence state - updated after SD operations
 static bool s_slotHasPreset[5] = {false, false, false, false, false};  // indices 1-4 used
 
+// Where each slot's file lives (indices 1-4 used)
+struct SlotFile {
+    bool contiguous;        // Preallocated: raw sector transfers from firstSector
+    uint32_t firstSector;   // Card sector holding the file's first byte
+    bool codedRoom;         // Sized for coded frames (smaller slots save PCM)
+    uint64_t fileBytes;     // Preallocated size
+};
+static SlotFile s_slotFiles[5];
+
 // File name buffer (preset1.bin, preset2.bin, etc.)
 static char s_fileNameBuffer[16];
 
@@ -45,60 +142,629 @@ static const char* getFileName(uint8_t slot) {
 }
 
 /**
- * Write buffer to file in chunks via scratch buffer
- * Source data may be in EXTMEM - we copy to internal RAM scratch buffer first
+ * Raw multi-sector transfers; dst/src may be the scratch buffer or a loop buffer in EXTMEM
+ * (word aligned - see isWordAligned())
  */
-static bool writeChunked(File& file, const uint8_t* data, size_t totalBytes) {
-    size_t bytesWritten = 0;
+static bool readSectors(uint32_t sector, uint8_t* dst, size_t count) {
+#if SD_SDIO_DMA
+    // No dirty line may be evicted over the incoming data (also writes back
+    // the neighbours sharing the first and last lines)
+    arm_dcache_flush_delete(dst, count * SECTOR_SIZE);
+#endif
+    bool ok = SD.sdfs.card()->readSectors(sector, dst, count);
+#if SD_SDIO_DMA
+    // Drop lines the playback ISR pulled in while the transfer ran (it only reads)
+    arm_dcache_delete(dst, count * SECTOR_SIZE);
+#endif
+    return ok;
+}
+
+static bool writeSectors(uint32_t sector, const uint8_t* src, size_t count) {
+#if SD_SDIO_DMA
+    arm_dcache_flush(const_cast<uint8_t*>(src), count * SECTOR_SIZE);  // Controller reads memory
+#endif
+    return SD.sdfs.card()->writeSectors(sector, src, count);
+}
+
+static bool isWordAligned(const uint8_t* address) {
+    return (reinterpret_cast<uintptr_t>(address) & 3) == 0;  // SDIO moves 32-bit words
+}
 
-    while (bytesWritten < totalBytes) {
-        size_t chunkSize = min(CHUNK_SIZE_BYTES, totalBytes - bytesWritten);
+/**
+ * Fill a header from the loop length and stored settings
+ */
+static void buildHeader(PresetHeader& header, uint32_t length, const PresetInfo& info, uint16_t headerSize) {
+    memset(&header, 0, sizeof(PresetHeader));
+    header.magic = PRESET_MAGIC;
+    header.version = PRESET_VERSION;
+    header.headerSize = headerSize;
+    header.length = length;
+    header.captureSamplesPerBeat = info.captureSamplesPerBeat;
+    header.gateSteps = info.gatePattern.numSteps;
+    if (info.hasRouting) {
+        header.routingMode = static_cast<uint8_t>(info.routing.mode) + 1;
+        header.routingOrder = info.routing.packOrder();
+    }
+    header.sampleRateCode = sampleRateToCode(Timebase::SAMPLE_RATE);
+    memcpy(header.gateLevels, info.gatePattern.levels, GATE_MAX_STEPS);
+    memcpy(header.gateShapes, info.gatePattern.shapes, GATE_MAX_STEPS);
+}
 
-        // Copy from source (possibly EXTMEM) to internal RAM scratch buffer
-        memcpy(s_sdScratch, data + bytesWritten, chunkSize);
+/**
+ * Parse and validate the header at the start of a preset file (v1, v2 or v3)
+ *
+ * @param bytes First bytes of the file
+ * @param available Number of valid bytes at bytes
+ * @param outDataOffset File offset of the left channel data (first frame if coded)
+ * @param outCodedBytes Frame bytes for coded files (outInfo.codec != PCM)
+ */
+static SdResult parseHeader(const uint8_t* bytes, uint32_t available, uint32_t& outLength,
+                            PresetInfo& outInfo, uint32_t& outDataOffset, uint32_t& outCodedBytes) {
+    uint32_t captureLength = 0;
+    uint32_t captureSamplesPerBeat = 0;
+    uint32_t fileSampleRate = 44100;   // v1/v2 files predate other rates
+    uint32_t dataOffset = sizeof(uint32_t);
+    bool hasGatePattern = false;
+    PresetHeader header;
+    PresetCodedHeader coded;
+    memset(&coded, 0, sizeof(coded));   // codec 0 = PCM
+
+    if (available < sizeof(uint32_t)) {
+        Serial.println("SdCardStorage: Failed to read header");
+        return SdResult::ERROR_READ_FAILED;
+    }
+    memcpy(&captureLength, bytes, sizeof(uint32_t));
 
-        // Write from scratch buffer (internal RAM) to SD card
-        size_t written = file.write(s_sdScratch, chunkSize);
-        if (written != chunkSize) {
-            return false;
+    if (captureLength == PRESET_MAGIC) {
+        // v2/v3 file: rest of the v2 header (length follows magic)
+        if (available < HEADER_SIZE_V2) {
+            Serial.println("SdCardStorage: Failed to read header");
+            return SdResult::ERROR_READ_FAILED;
+        }
+        memcpy(&header, bytes, HEADER_SIZE_V2);
+
+        bool isV2 = (header.version == PRESET_VERSION_V2 && header.headerSize == HEADER_SIZE_V2);
+        bool isV3 = (header.version == PRESET_VERSION && header.headerSize >= sizeof(PresetHeader));
+        bool isV4 = (header.version == PRESET_VERSION_CODED &&
+                     header.headerSize >= sizeof(PresetHeader) + sizeof(PresetCodedHeader));
+        if (!isV2 && !isV3 && !isV4) {
+            Serial.println("SdCardStorage: Unsupported preset version");
+            return SdResult::ERROR_READ_FAILED;
         }
 
-        bytesWritten += written;
+        if (isV3 || isV4) {
+            // Gate pattern; any fields from newer writers (or slot padding) are skipped
+            uint32_t needed = sizeof(PresetHeader) + (isV4 ? sizeof(PresetCodedHeader) : 0);
+            if (available < needed) {
+                Serial.println("SdCardStorage: Failed to read header");
+                return SdResult::ERROR_READ_FAILED;
+            }
+            memcpy(&header, bytes, sizeof(PresetHeader));
+            if (isV4) {
+                memcpy(&coded, bytes + sizeof(PresetHeader), sizeof(PresetCodedHeader));
+                bool knownCodec = (coded.codec == static_cast<uint8_t>(PresetCodec::LOSSLESS) ||
+                                   coded.codec == static_cast<uint8_t>(PresetCodec::ADPCM));
+                // Frames are read in whole sectors from the sector after the header
+                if (!knownCodec || header.headerSize % SECTOR_SIZE != 0 ||
+                    coded.codedBytes > SLOT_FILE_BYTES - header.headerSize) {
+                    Serial.println("SdCardStorage: Unsupported preset coding");
+                    return SdResult::ERROR_READ_FAILED;
+                }
+            }
+            hasGatePattern = true;
+            fileSampleRate = codeToSampleRate(header.sampleRateCode);
+        }
+        captureLength = header.length;
+        captureSamplesPerBeat = header.captureSamplesPerBeat;
+        dataOffset = header.headerSize;
+    }
+    // else: legacy v1 file - the first word was the length, tempo unknown
+
+    // Samples (and capture tempo in samples per beat) only mean the same thing at the same rate
+    if (fileSampleRate != Timebase::SAMPLE_RATE) {
+        Serial.print("SdCardStorage: Preset recorded at ");
+        Serial.print(fileSampleRate);
+        Serial.print(" Hz, build runs at ");
+        Serial.print(Timebase::SAMPLE_RATE);
+        Serial.println(" Hz");
+        return SdResult::ERROR_SAMPLE_RATE;
     }
 
-    return true;
+    // Sanity check on length - MUST NOT exceed actual buffer capacity
+    // This prevents buffer overflow into adjacent EXTMEM allocations
+    if (captureLength == 0 || captureLength > MAX_PRESET_SAMPLES) {
+#if SD_DEBUG
+        Serial.print("SdCardStorage: Invalid capture length: ");
+        Serial.print(captureLength);
+        Serial.print(" (max: ");
+        Serial.print(MAX_PRESET_SAMPLES);
+        Serial.println(")");
+#endif
+        return SdResult::ERROR_INVALID_LENGTH;
+    }
+
+    outLength = captureLength;
+    outDataOffset = dataOffset;
+    outCodedBytes = coded.codedBytes;
+    outInfo.codec = static_cast<PresetCodec>(coded.codec);
+    outInfo.captureSamplesPerBeat = captureSamplesPerBeat;
+    if (hasGatePattern) {
+        outInfo.hasGatePattern = true;
+        outInfo.gatePattern.numSteps = header.gateSteps;
+        memcpy(outInfo.gatePattern.levels, header.gateLevels, GATE_MAX_STEPS);
+        memcpy(outInfo.gatePattern.shapes, header.gateShapes, GATE_MAX_STEPS);
+
+        if (header.routingMode > 0 && header.routingMode <= ROUTING_MODE_COUNT) {
+            outInfo.hasRouting = true;
+            outInfo.routing.mode = static_cast<RoutingMode>(header.routingMode - 1);
+            outInfo.routing.unpackOrder(header.routingOrder);
+        }
+    }
+    return SdResult::SUCCESS;
 }
 
 /**
- * Read buffer from file in chunks via scratch buffer
- * Destination may be in EXTMEM - we read to internal RAM scratch buffer first
+ * Find (or create and preallocate) the slot's contiguous file and read its header
+ *
+ * A preset saved before slots were preallocated stays a plain FAT file until it is
+ * deleted; if the card can't hold a contiguous file the slot falls back to FAT I/O.
  */
-static bool readChunked(File& file, uint8_t* data, size_t totalBytes) {
-    size_t bytesRead = 0;
+static void prepareSlot(uint8_t slot) {
+    const char* fileName = getFileName(slot);
+    SlotFile& slotFile = s_slotFiles[slot];
+    slotFile.contiguous = false;
+    slotFile.codedRoom = false;
+    s_slotHasPreset[slot] = false;
 
-    while (bytesRead < totalBytes) {
-        size_t chunkSize = min(CHUNK_SIZE_BYTES, totalBytes - bytesRead);
+    bool exists = SD.sdfs.exists(fileName);
+    FsFile file = SD.sdfs.open(fileName, exists ? O_RDONLY : (O_RDWR | O_CREAT));
+    if (!file) {
+        Serial.println("SdCardStorage: Failed to open slot file");
+        return;
+    }
+    if (!exists && !file.preAllocate(SLOT_FILE_BYTES)) {
+        file.close();
+        SD.sdfs.remove(fileName);
+        Serial.print("SdCardStorage: No contiguous space for slot ");
+        Serial.print(slot);
+        Serial.println(" (FAT transfers)");
+        return;
+    }
 
-        // Read from SD card to scratch buffer (internal RAM)
-        size_t readCount = file.read(s_sdScratch, chunkSize);
-        if (readCount != chunkSize) {
-            return false;
+    uint32_t firstSector = 0;
+    uint32_t lastSector = 0;
+    uint64_t fileBytes = file.fileSize();
+    bool slotLayout = (fileBytes == SLOT_FILE_BYTES || fileBytes == PCM_SLOT_FILE_BYTES);
+    if (!slotLayout && exists && fileBytes % SECTOR_SIZE == 0 && fileBytes < SLOT_FILE_BYTES) {
+        // Slot preallocated for a smaller loop budget: zeroed header (empty) or one padded
+        // to a sector. FAT presets have a shorter header and stay on the FAT path.
+        PresetHeader header = {};
+        if (file.read(s_sdScratch, SECTOR_SIZE) == SECTOR_SIZE) {
+            memcpy(&header, s_sdScratch, sizeof(PresetHeader));
         }
+        slotLayout = (header.magic == 0 && header.length == 0) ||
+                     (header.magic == PRESET_MAGIC && header.headerSize == SECTOR_SIZE);
+    }
+    bool contiguous = slotLayout && file.contiguousRange(&firstSector, &lastSector);
+    file.close();
 
-        // Copy from scratch buffer to destination (possibly EXTMEM)
-        memcpy(data + bytesRead, s_sdScratch, chunkSize);
+    if (!contiguous) {
+        s_slotHasPreset[slot] = exists;  // Preset from before preallocation
+        return;
+    }
+    slotFile.contiguous = true;
+    slotFile.firstSector = firstSector;
+    slotFile.codedRoom = (fileBytes == SLOT_FILE_BYTES);
+    slotFile.fileBytes = fileBytes;
+
+    if (!exists) {
+        // New slot: empty header
+        memset(s_sdScratch, 0, SECTOR_SIZE);
+        if (!writeSectors(firstSector, s_sdScratch, 1)) {
+            slotFile.contiguous = false;
+            Serial.println("SdCardStorage: Failed to clear slot header");
+        }
+        return;
+    }
 
-        bytesRead += readCount;
+    uint32_t magic = 0;
+    if (readSectors(firstSector, s_sdScratch, 1)) {
+        memcpy(&magic, s_sdScratch, sizeof(uint32_t));
     }
+    s_slotHasPreset[slot] = (magic == PRESET_MAGIC);
 
-    return true;
+    if (!slotFile.codedRoom && !s_slotHasPreset[slot]) {
+        // Empty slot from before coded presets: reallocate at the coded size
+        slotFile.contiguous = false;
+        if (SD.sdfs.remove(fileName)) {
+            prepareSlot(slot);
+        }
+    }
 }
 
+// ========== CHUNKED TRANSFER ==========
+
 /**
- * Execute save operation
+ * SD card implementation of IPresetStorage
+ * Contiguous slot files use multi-sector raw transfers at known sectors: whole sectors
+ * go straight between the card and the loop buffers (up to DIRECT_CHUNK_BYTES a step),
+ * partial sectors bounce through the internal RAM scratch buffer. Coded slots stage
+ * frames in s_codedBuffer (encoded/decoded a chunk at a time). Plain FAT files
+ * (older presets) go through the file API and the scratch buffer.
  */
-static SdResult executeSave(uint8_t slot, const int16_t* bufferL,
-                            const int16_t* bufferR, uint32_t length) {
+class CardStorage : public IPresetStorage {
+public:
+    SdResult beginSave(uint8_t slot, const int16_t* bufferL, const int16_t* bufferR,
+                       uint32_t length, const PresetInfo& info) override;
+    SdResult beginLoad(uint8_t slot, int16_t* bufferL, int16_t* bufferR,
+                       uint32_t& outLength, PresetInfo& outInfo) override;
+    SdResult step(bool& done) override;
+    void abort() override;
+    SdResult remove(uint8_t slot) override;
+
+    uint32_t getBytesDone() const override { return m_channelDone[0] + m_channelDone[1]; }
+    uint32_t getBytesTotal() const override { return m_channelBytes * 2; }
+    uint32_t getResidentSamples() const override {
+        return min(m_channelDone[0], m_channelDone[1]) / sizeof(int16_t);
+    }
+
+private:
+    enum class Direction : uint8_t { NONE, SAVE, LOAD };
+
+    /**
+     * Move the next chunk: raw sectors (contiguous slot) or file API
+     */
+    SdResult stepRaw(uint32_t channel, uint32_t offset);
+    SdResult stepFile(uint32_t channel, uint32_t offset, size_t chunkSize);
+
+    /**
+     * Coded slot: encode frames and write a chunk, or read a chunk and decode
+     * every whole frame in it (both channels advance together)
+     */
+    SdResult stepCoded();
+
+    /**
+     * Close the file; a failed or aborted FAT save also removes the partial file
+     * (a raw save never wrote its header, so the slot is still empty)
+     */
+    void finish(bool removeFile);
+
+    File m_file;                                   // FAT SAVE: whole file, FAT LOAD: left channel
+    File m_fileR;                                  // FAT LOAD: right channel read position
+    bool m_raw = false;                            // Contiguous slot file (raw sectors)
+    uint32_t m_firstSector = 0;                    // Raw: card sector of the file start
+    uint32_t m_dataOffset = 0;                     // Raw: file offset of the left channel
+    PresetHeader m_header;                         // Raw SAVE: written after the audio
+    PresetCodec m_codec = PresetCodec::PCM;        // Raw: frame coding (PCM = none)
+    uint32_t m_codedBytes = 0;                     // Coded SAVE: bytes written, LOAD: bytes in the file
+    uint32_t m_codedRead = 0;                      // Coded LOAD: bytes read from the card
+    uint32_t m_staged = 0;                         // Coded: bytes waiting in s_codedBuffer
+    Direction m_direction = Direction::NONE;
+    uint8_t m_slot = 0;
+    uint8_t* m_channels[2] = {nullptr, nullptr};   // L, R (read-only for saves)
+    uint32_t m_channelBytes = 0;
+    uint32_t m_channelDone[2] = {0, 0};            // Bytes moved per channel
+};
+
+static CardStorage s_cardStorage;
+
+void CardStorage::finish(bool removeFile) {
+    if (!m_raw) {
+        m_file.close();
+        if (m_fileR) {
+            m_fileR.close();
+        }
+        if (removeFile) {
+            SD.remove(getFileName(m_slot));
+        }
+    }
+    m_direction = Direction::NONE;
+}
+
+SdResult CardStorage::stepRaw(uint32_t channel, uint32_t offset) {
+    if (m_direction == Direction::SAVE) {
+        // Sequential from a sector boundary (L then R). Whole sectors of one channel are
+        // written straight from the loop buffer; the sector where L ends and R begins,
+        // an R buffer that isn't word aligned there, and the zero-padded last sector bounce
+        uint32_t done = getBytesDone();
+        uint32_t total = getBytesTotal();
+        uint32_t sector = m_firstSector + (m_dataOffset + done) / SECTOR_SIZE;
+        const uint8_t* direct = nullptr;
+        uint32_t directBytes = 0;
+        if (done + SECTOR_SIZE <= m_channelBytes) {
+            direct = m_channels[0] + done;
+            directBytes = m_channelBytes - done;
+        } else if (done >= m_channelBytes && done + SECTOR_SIZE <= total &&
+                   isWordAligned(m_channels[1] + (done - m_channelBytes))) {
+            direct = m_channels[1] + (done - m_channelBytes);
+            directBytes = total - done;
+        }
+
+        size_t streamBytes;
+        bool ok;
+        if (direct != nullptr) {
+            uint32_t sectors = min(DIRECT_CHUNK_SECTORS, directBytes / SECTOR_SIZE);
+            streamBytes = sectors * SECTOR_SIZE;
+            ok = writeSectors(sector, direct, sectors);
+        } else {
+            streamBytes = min((done < m_channelBytes) ? SECTOR_SIZE : CHUNK_SIZE_BYTES, total - done);
+            uint32_t sectors = (streamBytes + SECTOR_SIZE - 1) / SECTOR_SIZE;
+            size_t fromL = (done < m_channelBytes) ? min(static_cast<uint32_t>(streamBytes), m_channelBytes - done) : 0;
+            memcpy(s_sdScratch, m_channels[0] + done, fromL);
+            if (fromL < streamBytes) {
+                memcpy(s_sdScratch + fromL, m_channels[1] + (done + fromL - m_channelBytes), streamBytes - fromL);
+            }
+            memset(s_sdScratch + streamBytes, 0, sectors * SECTOR_SIZE - streamBytes);
+            ok = writeSectors(sector, s_sdScratch, sectors);
+        }
+        if (!ok) {
+            finish(true);
+            Serial.println("SdCardStorage: Failed to write preset audio");
+            return SdResult::ERROR_WRITE_FAILED;
+        }
+        done += streamBytes;
+        m_channelDone[0] = min(done, m_channelBytes);
+        m_channelDone[1] = done - m_channelDone[0];
+
+        if (getBytesDone() == getBytesTotal()) {
+            // Audio is on the card: the header makes the slot valid
+            memset(s_sdScratch, 0, SECTOR_SIZE);
+            memcpy(s_sdScratch, &m_header, sizeof(PresetHeader));
+            if (!writeSectors(m_firstSector, s_sdScratch, 1)) {
+                finish(true);
+                Serial.println("SdCardStorage: Failed to write header");
+                return SdResult::ERROR_WRITE_FAILED;
+            }
+        }
+        return SdResult::SUCCESS;
+    }
+
+    // Load: whole sectors land straight in the loop buffer. The right channel starts
+    // mid-sector unless the loop length is a multiple of 256: its first chunk bounces
+    // just up to the next sector boundary, so the rest of R is sector aligned too
+    uint32_t position = m_dataOffset + channel * m_channelBytes + offset;
+    uint32_t sector = m_firstSector + position / SECTOR_SIZE;
+    uint32_t skip = position % SECTOR_SIZE;
+    uint32_t remaining = m_channelBytes - offset;
+    uint8_t* dst = m_channels[channel] + offset;
+
+    size_t chunkSize;
+    bool ok;
+    if (skip == 0 && remaining >= SECTOR_SIZE && isWordAligned(dst)) {
+        uint32_t sectors = min(DIRECT_CHUNK_SECTORS, remaining / SECTOR_SIZE);
+        chunkSize = sectors * SECTOR_SIZE;
+        ok = readSectors(sector, dst, sectors);
+    } else {
+        // Head up to a sector boundary, the tail, or an odd-length R that isn't word aligned
+        chunkSize = min((skip != 0) ? SECTOR_SIZE - skip : CHUNK_SIZE_BYTES, remaining);
+        uint32_t sectors = (skip + chunkSize + SECTOR_SIZE - 1) / SECTOR_SIZE;
+        ok = readSectors(sector, s_sdScratch, sectors);
+        if (ok) {
+            memcpy(dst, s_sdScratch + skip, chunkSize);
+        }
+    }
+    if (!ok) {
+        finish(false);
+        Serial.print("SdCardStorage: Failed to read ");
+        Serial.println(channel == 0 ? "left channel" : "right channel");
+        return SdResult::ERROR_READ_FAILED;
+    }
+    m_channelDone[channel] += chunkSize;
+    return SdResult::SUCCESS;
+}
+
+SdResult CardStorage::stepCoded() {
+    uint32_t length = m_channelBytes / sizeof(int16_t);
+    uint32_t samples = m_channelDone[0] / sizeof(int16_t);
+    const int16_t* sourceL = reinterpret_cast<const int16_t*>(m_channels[0]);
+    const int16_t* sourceR = reinterpret_cast<const int16_t*>(m_channels[1]);
+    int16_t* destL = reinterpret_cast<int16_t*>(m_channels[0]);
+    int16_t* destR = reinterpret_cast<int16_t*>(m_channels[1]);
+
+    if (m_direction == Direction::SAVE) {
+        // Frames until a chunk is staged; whole sectors go out, the rest waits for the next step
+        while (m_staged < DIRECT_CHUNK_BYTES && samples < length) {
+            uint32_t frameSamples = min(PRESET_FRAME_SAMPLES, length - samples);
+            m_staged += s_encoder.encodeFrame(sourceL + samples, sourceR + samples, frameSamples,
+                                              s_codedBuffer + m_staged);
+            samples += frameSamples;
+        }
+        bool last = (samples == length);
+        uint32_t sectors = last ? (m_staged + SECTOR_SIZE - 1) / SECTOR_SIZE : m_staged / SECTOR_SIZE;
+        uint32_t written = min(m_staged, sectors * SECTOR_SIZE);
+        memset(s_codedBuffer + m_staged, 0, sectors * SECTOR_SIZE - written);   // Last sector only
+
+        uint32_t sector = m_firstSector + (m_dataOffset + m_codedBytes) / SECTOR_SIZE;
+        if (!writeSectors(sector, s_codedBuffer, sectors)) {
+            finish(true);
+            Serial.println("SdCardStorage: Failed to write preset audio");
+            return SdResult::ERROR_WRITE_FAILED;
+        }
+        m_codedBytes += written;
+        m_staged -= written;
+        memmove(s_codedBuffer, s_codedBuffer + written, m_staged);
+        m_channelDone[0] = m_channelDone[1] = samples * sizeof(int16_t);
+
+        if (last) {
+            // Frames are on the card: the header makes the slot valid
+            PresetCodedHeader coded;
+            memset(&coded, 0, sizeof(coded));
+            coded.codec = static_cast<uint8_t>(m_codec);
+            coded.codedBytes = m_codedBytes;
+            memset(s_sdScratch, 0, SECTOR_SIZE);
+            memcpy(s_sdScratch, &m_header, sizeof(PresetHeader));
+            memcpy(s_sdScratch + sizeof(PresetHeader), &coded, sizeof(PresetCodedHeader));
+            if (!writeSectors(m_firstSector, s_sdScratch, 1)) {
+                finish(true);
+                Serial.println("SdCardStorage: Failed to write header");
+                return SdResult::ERROR_WRITE_FAILED;
+            }
+        }
+        return SdResult::SUCCESS;
+    }
+
+    // Load: the next chunk lands at CODED_LOAD_OFFSET, right behind the unfinished frame
+    // left from the last one (reads stay on sector boundaries: m_codedRead is a whole
+    // number of chunks until the end). The read target is cache-line aligned, so the
+    // cache maintenance in readSectors() can't touch the leftover in front of it
+    uint8_t* frames = s_codedBuffer + CODED_LOAD_OFFSET - m_staged;
+    uint32_t remaining = m_codedBytes - m_codedRead;
+    if (remaining > 0) {
+        uint32_t bytes = min(DIRECT_CHUNK_BYTES, remaining);
+        uint32_t sectors = (bytes + SECTOR_SIZE - 1) / SECTOR_SIZE;
+        uint32_t sector = m_firstSector + (m_dataOffset + m_codedRead) / SECTOR_SIZE;
+        if (!readSectors(sector, s_codedBuffer + CODED_LOAD_OFFSET, sectors)) {
+            finish(false);
+            Serial.println("SdCardStorage: Failed to read preset audio");
+            return SdResult::ERROR_READ_FAILED;
+        }
+        m_codedRead += bytes;
+        m_staged += bytes;
+    }
+
+    uint32_t offset = 0;
+    bool corrupt = false;
+    while (samples < length) {
+        size_t frameSize = PresetDecoder::frameBytes(frames + offset, m_staged - offset);
+        if (frameSize > PRESET_MAX_FRAME_BYTES) {
+            corrupt = true;
+            break;
+        }
+        if (frameSize == 0 || frameSize > m_staged - offset) {
+            break;   // Rest of the frame comes with the next chunk
+        }
+        uint32_t frameSamples = min(PRESET_FRAME_SAMPLES, length - samples);
+        if (!s_decoder.decodeFrame(frames + offset, frameSize, destL + samples, destR + samples, frameSamples)) {
+            corrupt = true;
+            break;
+        }
+        offset += frameSize;
+        samples += frameSamples;
+    }
+    // Left over: part of a frame (shorter than PRESET_MAX_FRAME_BYTES, so it fits in front
+    // of CODED_LOAD_OFFSET), or nothing once the loop is complete
+    m_staged = (samples < length) ? m_staged - offset : 0;
+    if (!corrupt) {
+        memmove(s_codedBuffer + CODED_LOAD_OFFSET - m_staged, frames + offset, m_staged);
+    }
+    m_channelDone[0] = m_channelDone[1] = samples * sizeof(int16_t);
+
+    if (corrupt || (samples < length && m_codedRead == m_codedBytes && offset == 0)) {
+        finish(false);
+        Serial.println("SdCardStorage: Preset audio is corrupt");
+        return SdResult::ERROR_READ_FAILED;
+    }
+    return SdResult::SUCCESS;
+}
+
+SdResult CardStorage::stepFile(uint32_t channel, uint32_t offset, size_t chunkSize) {
+    uint8_t* data = m_channels[channel] + offset;
+
+    if (m_direction == Direction::SAVE) {
+        // Copy from source (possibly EXTMEM) to internal RAM scratch buffer, then to SD
+        memcpy(s_sdScratch, data, chunkSize);
+        if (m_file.write(s_sdScratch, chunkSize) != chunkSize) {
+            finish(true);
+            Serial.print("SdCardStorage: Failed to write ");
+            Serial.println(channel == 0 ? "left channel" : "right channel");
+            return SdResult::ERROR_WRITE_FAILED;
+        }
+    } else {
+        // Read from SD to scratch buffer (internal RAM), then to destination (possibly EXTMEM)
+        File& file = (channel == 0) ? m_file : m_fileR;
+        if (file.read(s_sdScratch, chunkSize) != chunkSize) {
+            finish(false);
+            Serial.print("SdCardStorage: Failed to read ");
+            Serial.println(channel == 0 ? "left channel" : "right channel");
+            return SdResult::ERROR_READ_FAILED;
+        }
+        memcpy(data, s_sdScratch, chunkSize);
+    }
+    m_channelDone[channel] += chunkSize;
+    return SdResult::SUCCESS;
+}
+
+SdResult CardStorage::step(bool& done) {
+    done = false;
+    if (m_direction == Direction::NONE) {
+        return SdResult::ERROR_INVALID_BUFFER;
+    }
+
+    // Saves write L then R (sequential file); loads alternate L and R chunks so
+    // both channels fill from the loop start together (playable while loading)
+    uint32_t channel;
+    if (m_direction == Direction::SAVE) {
+        channel = (m_channelDone[0] >= m_channelBytes) ? 1 : 0;
+    } else {
+        channel = (m_channelDone[0] > m_channelDone[1]) ? 1 : 0;
+    }
+    uint32_t offset = m_channelDone[channel];
+    SdResult result;
+    if (m_codec != PresetCodec::PCM) {
+        result = stepCoded();
+    } else if (m_raw) {
+        result = stepRaw(channel, offset);  // Sizes its own chunk (direct or bounce)
+    } else {
+        size_t chunkSize = min(static_cast<uint32_t>(CHUNK_SIZE_BYTES), m_channelBytes - offset);
+        result = stepFile(channel, offset, chunkSize);
+    }
+    if (result != SdResult::SUCCESS) {
+        return result;
+    }
+    if (getBytesDone() < getBytesTotal()) {
+        return SdResult::SUCCESS;
+    }
+
+    bool saved = (m_direction == Direction::SAVE);
+    finish(false);
+    done = true;
+
+    Serial.print(saved ? "SdCardStorage: Saved preset " : "SdCardStorage: Loaded preset ");
+    Serial.print(m_slot);
+    Serial.print(" (");
+    if (saved) {
+        s_slotHasPreset[m_slot] = true;
+        uint32_t stored = (m_codec != PresetCodec::PCM) ? m_codedBytes : getBytesDone();
+        Serial.print((stored + sizeof(PresetHeader)) / 1024);
+        Serial.print(" KB");
+        if (m_codec != PresetCodec::PCM) {
+            Serial.print(m_codec == PresetCodec::LOSSLESS ? ", lossless " : ", ADPCM ");
+            Serial.print(static_cast<float>(getBytesDone()) / m_codedBytes, 2);
+            Serial.print(":1");
+        }
+        Serial.println(")");
+    } else {
+        Serial.print(m_channelBytes / sizeof(int16_t));
+        Serial.println(" samples)");
+    }
+    return SdResult::SUCCESS;
+}
+
+void CardStorage::abort() {
+    if (m_direction != Direction::NONE) {
+        finish(m_direction == Direction::SAVE);
+    }
+}
+
+IPresetStorage& cardStorage() {
+    return s_cardStorage;
+}
+
+/**
+ * Run an open transfer to the end (synchronous API)
+ */
+static SdResult runTransfer() {
+    bool done = false;
+    SdResult result = SdResult::SUCCESS;
+    while (!done && result == SdResult::SUCCESS) {
+        result = s_cardStorage.step(done);
+    }
+    return result;
+}
+
+SdResult CardStorage::beginSave(uint8_t slot, const int16_t* bufferL,
+                               const int16_t* bufferR, uint32_t length,
+                               const PresetInfo& info) {
     // Validate parameters
     if (!s_cardInitialized) {
         return SdResult::ERROR_NO_CARD;
@@ -133,62 +799,87 @@ static SdResult executeSave(uint8_t slot, const int16_t* bufferL,
     Serial.print(length);
     Serial.println(" samples)");
 
-    // Delete existing file first (if any)
-    if (SD.exists(fileName)) {
-        SD.remove(fileName);
-    }
-
-    // Open file for writing
-    File file = SD.open(fileName, FILE_WRITE);
-    if (!file) {
-        Serial.println("SdCardStorage: Failed to create file");
-        return SdResult::ERROR_FILE_CREATE;
-    }
+    // One transfer at a time
+    abort();
 
-    // Write header: capture length (4 bytes) via scratch buffer
-    memcpy(s_sdScratch, &length, sizeof(uint32_t));
-    size_t written = file.write(s_sdScratch, sizeof(uint32_t));
-    if (written != sizeof(uint32_t)) {
-        file.close();
-        SD.remove(fileName);
-        Serial.println("SdCardStorage: Failed to write header");
-        return SdResult::ERROR_WRITE_FAILED;
+    SlotFile& slotFile = s_slotFiles[slot];
+    if (slotFile.contiguous && !slotFile.codedRoom &&
+        SECTOR_SIZE + 2ull * length * sizeof(int16_t) > slotFile.fileBytes) {
+        // Slot from a smaller loop budget: this loop goes to a FAT file (reallocated on delete)
+        slotFile.contiguous = false;
     }
+    if (slotFile.contiguous) {
+        // Overwrite: invalidate the old header first, so a failed save leaves an empty slot
+        if (s_slotHasPreset[slot]) {
+            memset(s_sdScratch, 0, SECTOR_SIZE);
+            if (!writeSectors(slotFile.firstSector, s_sdScratch, 1)) {
+                Serial.println("SdCardStorage: Failed to clear slot header");
+                return SdResult::ERROR_WRITE_FAILED;
+            }
+            s_slotHasPreset[slot] = false;
+        }
 
-    // Write left channel data
-    size_t bytesToWrite = length * sizeof(int16_t);
-    if (!writeChunked(file, (const uint8_t*)bufferL, bytesToWrite)) {
-        file.close();
-        SD.remove(fileName);
-        Serial.println("SdCardStorage: Failed to write left channel");
-        return SdResult::ERROR_WRITE_FAILED;
-    }
+        // Audio follows in step(), the header goes last
+        buildHeader(m_header, length, info, SECTOR_SIZE);
+        m_raw = true;
+        m_firstSector = slotFile.firstSector;
+        m_dataOffset = SECTOR_SIZE;
+        m_codec = slotFile.codedRoom ? info.codec : PresetCodec::PCM;
+        if (m_codec != PresetCodec::PCM) {
+            m_header.version = PRESET_VERSION_CODED;
+            s_encoder.begin(m_codec);
+            m_codedBytes = 0;
+            m_staged = 0;
+        }
+    } else {
+        // Delete existing file first (if any)
+        if (SD.exists(fileName)) {
+            SD.remove(fileName);
+        }
 
-    // Write right channel data
-    if (!writeChunked(file, (const uint8_t*)bufferR, bytesToWrite)) {
-        file.close();
-        SD.remove(fileName);
-        Serial.println("SdCardStorage: Failed to write right channel");
-        return SdResult::ERROR_WRITE_FAILED;
-    }
+        // Open file for writing
+        File file = SD.open(fileName, FILE_WRITE);
+        if (!file) {
+            Serial.println("SdCardStorage: Failed to create file");
+            return SdResult::ERROR_FILE_CREATE;
+        }
 
-    file.close();
+        // Write header via scratch buffer
+        PresetHeader header;
+        buildHeader(header, length, info, sizeof(PresetHeader));
+        memcpy(s_sdScratch, &header, sizeof(PresetHeader));
+        size_t written = file.write(s_sdScratch, sizeof(PresetHeader));
+        if (written != sizeof(PresetHeader)) {
+            file.close();
+            SD.remove(fileName);
+            Serial.println("SdCardStorage: Failed to write header");
+            return SdResult::ERROR_WRITE_FAILED;
+        }
 
-    Serial.print("SdCardStorage: Saved preset ");
-    Serial.print(slot);
-    Serial.print(" (");
-    Serial.print((length * 4 + 4) / 1024);
-    Serial.println(" KB)");
+        // Left then right channel data follow in step()
+        m_file = file;
+        m_raw = false;
+        m_codec = PresetCodec::PCM;   // Coding needs a preallocated slot
+    }
 
+    m_direction = Direction::SAVE;
+    m_slot = slot;
+    m_channels[0] = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(bufferL));
+    m_channels[1] = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(bufferR));
+    m_channelBytes = length * sizeof(int16_t);
+    m_channelDone[0] = 0;
+    m_channelDone[1] = 0;
     return SdResult::SUCCESS;
 }
 
-/**
- * Execute load operation
- */
-static SdResult executeLoad(uint8_t slot, int16_t* bufferL,
-                            int16_t* bufferR, uint32_t& outLength) {
+SdResult CardStorage::beginLoad(uint8_t slot, int16_t* bufferL,
+                               int16_t* bufferR, uint32_t& outLength,
+                               PresetInfo& outInfo) {
     outLength = 0;
+    outInfo.captureSamplesPerBeat = 0;
+    outInfo.hasGatePattern = false;
+    outInfo.hasRouting = false;
+    outInfo.codec = PresetCodec::PCM;
 
     // Validate parameters
     if (!s_cardInitialized) {
@@ -209,69 +900,91 @@ static SdResult executeLoad(uint8_t slot, int16_t* bufferL,
     Serial.print(slot);
     Serial.println("...");
 
-    uint32_t captureLength = 0;
+    // One transfer at a time
+    abort();
 
-    // Open file for reading
-    File file = SD.open(fileName, FILE_READ);
-    if (!file) {
-        Serial.println("SdCardStorage: File not found");
-        return SdResult::ERROR_FILE_NOT_FOUND;
-    }
+    uint32_t captureLength = 0;
+    uint32_t dataOffset = 0;
+    uint32_t codedBytes = 0;
+    const SlotFile& slotFile = s_slotFiles[slot];
+
+    if (slotFile.contiguous) {
+        // Header sector straight from the card
+        if (!s_slotHasPreset[slot]) {
+            Serial.println("SdCardStorage: File not found");
+            return SdResult::ERROR_FILE_NOT_FOUND;
+        }
+        if (!readSectors(slotFile.firstSector, s_sdScratch, 1)) {
+            Serial.println("SdCardStorage: Failed to read header");
+            return SdResult::ERROR_READ_FAILED;
+        }
+        SdResult result = parseHeader(s_sdScratch, SECTOR_SIZE, captureLength, outInfo, dataOffset, codedBytes);
+        if (result != SdResult::SUCCESS) {
+            return result;
+        }
 
-    // Read header: capture length (4 bytes) via scratch buffer
-    size_t bytesRead = file.read(s_sdScratch, sizeof(uint32_t));
-    if (bytesRead != sizeof(uint32_t)) {
-        file.close();
-        Serial.println("SdCardStorage: Failed to read header");
-        return SdResult::ERROR_READ_FAILED;
-    }
-    memcpy(&captureLength, s_sdScratch, sizeof(uint32_t));
+        m_raw = true;
+        m_firstSector = slotFile.firstSector;
+        m_dataOffset = dataOffset;
+        m_codec = outInfo.codec;
+        if (m_codec != PresetCodec::PCM) {
+            s_decoder.begin(m_codec);
+            m_codedBytes = codedBytes;
+            m_codedRead = 0;
+            m_staged = 0;
+        }
+    } else {
+        // Open file for reading
+        File file = SD.open(fileName, FILE_READ);
+        if (!file) {
+            Serial.println("SdCardStorage: File not found");
+            return SdResult::ERROR_FILE_NOT_FOUND;
+        }
 
-    // Sanity check on length - MUST NOT exceed actual buffer capacity
-    // This prevents buffer overflow into adjacent EXTMEM allocations
-    if (captureLength == 0 || captureLength > MAX_PRESET_SAMPLES) {
-        file.close();
-#if SD_DEBUG
-        Serial.print("SdCardStorage: Invalid capture length: ");
-        Serial.print(captureLength);
-        Serial.print(" (max: ");
-        Serial.print(MAX_PRESET_SAMPLES);
-        Serial.println(")");
-#endif
-        return SdResult::ERROR_INVALID_LENGTH;
-    }
+        // Header via scratch buffer (v1 files may be shorter than a sector)
+        size_t bytesRead = file.read(s_sdScratch, SECTOR_SIZE);
+        SdResult result = parseHeader(s_sdScratch, bytesRead, captureLength, outInfo, dataOffset, codedBytes);
+        if (result == SdResult::SUCCESS && outInfo.codec != PresetCodec::PCM) {
+            Serial.println("SdCardStorage: Coded preset outside a preallocated slot");
+            result = SdResult::ERROR_READ_FAILED;
+        }
+        if (result != SdResult::SUCCESS) {
+            file.close();
+            return result;
+        }
 
-    // Read left channel data
-    size_t bytesToRead = captureLength * sizeof(int16_t);
-    if (!readChunked(file, (uint8_t*)bufferL, bytesToRead)) {
-        file.close();
-        Serial.println("SdCardStorage: Failed to read left channel");
-        return SdResult::ERROR_READ_FAILED;
+        // Second handle on the same file reads the right channel, so step() can
+        // alternate channels without seeking back and forth
+        uint32_t channelBytes = captureLength * sizeof(int16_t);
+        File fileR = SD.open(fileName, FILE_READ);
+        if (!file.seek(dataOffset) || !fileR || !fileR.seek(dataOffset + channelBytes)) {
+            if (fileR) {
+                fileR.close();
+            }
+            file.close();
+            Serial.println("SdCardStorage: Failed to open right channel");
+            return SdResult::ERROR_READ_FAILED;
+        }
+        m_file = file;
+        m_fileR = fileR;
+        m_raw = false;
+        m_codec = PresetCodec::PCM;
     }
 
-    // Read right channel data
-    if (!readChunked(file, (uint8_t*)bufferR, bytesToRead)) {
-        file.close();
-        Serial.println("SdCardStorage: Failed to read right channel");
-        return SdResult::ERROR_READ_FAILED;
-    }
+    // Left and right channel chunks follow in step()
+    m_direction = Direction::LOAD;
+    m_slot = slot;
+    m_channels[0] = reinterpret_cast<uint8_t*>(bufferL);
+    m_channels[1] = reinterpret_cast<uint8_t*>(bufferR);
+    m_channelBytes = captureLength * sizeof(int16_t);
+    m_channelDone[0] = 0;
+    m_channelDone[1] = 0;
 
-    file.close();
     outLength = captureLength;
-
-    Serial.print("SdCardStorage: Loaded preset ");
-    Serial.print(slot);
-    Serial.print(" (");
-    Serial.print(captureLength);
-    Serial.println(" samples)");
-
     return SdResult::SUCCESS;
 }
 
-/**
- * Execute delete operation
- */
-static SdResult executeDelete(uint8_t slot) {
+SdResult CardStorage::remove(uint8_t slot) {
     // Validate parameters
     if (!s_cardInitialized) {
         return SdResult::ERROR_NO_CARD;
@@ -284,18 +997,27 @@ static SdResult executeDelete(uint8_t slot) {
         return SdResult::ERROR_INVALID_SLOT;
     }
 
-    // Check if file exists
-    if (!SD.exists(fileName)) {
+    if (s_slotFiles[slot].contiguous && s_slotFiles[slot].codedRoom) {
+        // Zeroed header = empty slot (the file and its sectors stay allocated)
+        memset(s_sdScratch, 0, SECTOR_SIZE);
+        if (!writeSectors(s_slotFiles[slot].firstSector, s_sdScratch, 1)) {
+            Serial.println("SdCardStorage: Failed to clear slot header");
+            return SdResult::ERROR_DELETE_FAILED;
+        }
+    } else if (SD.exists(fileName)) {
+        // Attempt to delete file
+        if (!SD.remove(fileName)) {
+            Serial.println("SdCardStorage: Failed to delete file");
+            return SdResult::ERROR_DELETE_FAILED;
+        }
+        prepareSlot(slot);  // Preallocate in its place (next save is raw and can be coded)
+    } else {
         // File doesn't exist - this is success (idempotent delete)
+        s_slotHasPreset[slot] = false;
         return SdResult::SUCCESS;
     }
 
-    // Attempt to delete file
-    if (!SD.remove(fileName)) {
-        Serial.println("SdCardStorage: Failed to delete file");
-        return SdResult::ERROR_DELETE_FAILED;
-    }
-
+    s_slotHasPreset[slot] = false;
     Serial.print("SdCardStorage: Deleted preset ");
     Serial.println(slot);
     return SdResult::SUCCESS;
@@ -305,22 +1027,25 @@ static SdResult executeDelete(uint8_t slot) {
 
 bool begin() {
     // Teensy 4.1 uses built-in SDIO interface (no chip select pin needed)
-    if (SD.begin(BUILTIN_SDCARD)) {
+#if SD_SDIO_DMA
+    bool ok = SD.sdfs.begin(SdioConfig(DMA_SDIO));
+#else
+    bool ok = SD.begin(BUILTIN_SDCARD);
+#endif
+    if (ok) {
         s_cardInitialized = true;
         Serial.println("SdCardStorage: SD card initialized");
 
-        // One-time scan for existing presets at boot
+        // One-time slot setup at boot: preallocate missing slot files, read headers
         for (uint8_t slot = 1; slot <= 4; ++slot) {
-            const char* name = getFileName(slot);
-            if (name) {
-                s_slotHasPreset[slot] = SD.exists(name);
+            prepareSlot(slot);
 #if SD_DEBUG
-                if (s_slotHasPreset[slot]) {
-                    Serial.print("SdCardStorage: Found preset ");
-                    Serial.println(slot);
-                }
-#endif
+            if (s_slotHasPreset[slot]) {
+                Serial.print("SdCardStorage: Found preset ");
+                Serial.print(slot);
+                Serial.println(s_slotFiles[slot].contiguous ? "" : " (FAT file)");
             }
+#endif
         }
 
         return true;
@@ -338,31 +1063,25 @@ bool isCardPresent() {
 // ========== SYNCHRONOUS OPERATIONS ==========
 
 SdResult saveSync(uint8_t slot, const int16_t* bufferL, const int16_t* bufferR,
-                  uint32_t length) {
-    SdResult result = executeSave(slot, bufferL, bufferR, length);
-
-    // Update cached state on success
-    if (result == SdResult::SUCCESS && slot >= 1 && slot <= 4) {
-        s_slotHasPreset[slot] = true;
-    }
-
-    return result;
+                  uint32_t length, const PresetInfo& info) {
+    SdResult result = s_cardStorage.beginSave(slot, bufferL, bufferR, length, info);
+    return (result == SdResult::SUCCESS) ? runTransfer() : result;  // Cache updated on the last chunk
 }
 
 SdResult loadSync(uint8_t slot, int16_t* bufferL, int16_t* bufferR,
-                  uint32_t& outLength) {
-    return executeLoad(slot, bufferL, bufferR, outLength);
+                  uint32_t& outLength, PresetInfo& outInfo) {
+    SdResult result = s_cardStorage.beginLoad(slot, bufferL, bufferR, outLength, outInfo);
+    if (result == SdResult::SUCCESS) {
+        result = runTransfer();
+    }
+    if (result != SdResult::SUCCESS) {
+        outLength = 0;
+    }
+    return result;
 }
 
 SdResult deleteSync(uint8_t slot) {
-    SdResult result = executeDelete(slot);
-
-    // Update cached state on success
-    if (result == SdResult::SUCCESS && slot >= 1 && slot <= 4) {
-        s_slotHasPreset[slot] = false;
-    }
-
-    return result;
+    return s_cardStorage.remove(slot);  // Cache updated on success
 }
 
 bool presetExists(uint8_t slot) {
@@ -375,4 +1094,111 @@ bool presetExists(uint8_t slot) {
     return s_slotHasPreset[slot];
 }
 
+// ========== DIAGNOSTICS ==========
+
+static void printRate(const char* label, uint32_t micros, uint32_t megabytes) {
+    Serial.print(label);
+    Serial.print(micros / 1000 / megabytes);
+    Serial.print(" ms/MB (");
+    Serial.print(static_cast<float>(megabytes) * 1e6f / micros, 2);
+    Serial.println(" MB/s)");
+}
+
+void benchmark(uint32_t megabytes, uint8_t* extmem, uint32_t extmemBytes) {
+    if (!s_cardInitialized || megabytes == 0 || extmem == nullptr ||
+        extmemBytes < DIRECT_CHUNK_BYTES || !isWordAligned(extmem)) {
+        return;
+    }
+    static const char* BENCH_FILE = "bench.bin";
+    const uint32_t bytes = megabytes * 1024 * 1024;
+    const uint32_t extmemChunks = extmemBytes / DIRECT_CHUNK_BYTES;   // Transfers cycle through extmem
+    memset(s_sdScratch, 0x5A, sizeof(s_sdScratch));
+    memset(extmem, 0x5A, extmemChunks * DIRECT_CHUNK_BYTES);
+
+    Serial.print("SdCardStorage: Benchmark, ");
+    Serial.print(megabytes);
+    Serial.println(" MB");
+
+    // Oldest: remove + create + 512-byte file writes (FAT allocation as it goes), file reads
+    uint32_t start = micros();
+    if (SD.exists(BENCH_FILE)) {
+        SD.remove(BENCH_FILE);
+    }
+    File file = SD.open(BENCH_FILE, FILE_WRITE);
+    if (!file) {
+        Serial.println("SdCardStorage: Benchmark file create failed");
+        return;
+    }
+    for (uint32_t done = 0; done < bytes; done += SECTOR_SIZE) {
+        file.write(s_sdScratch, SECTOR_SIZE);
+    }
+    file.close();
+    uint32_t fatWrite = micros() - start;
+
+    start = micros();
+    file = SD.open(BENCH_FILE, FILE_READ);
+    for (uint32_t done = 0; done < bytes; done += SECTOR_SIZE) {
+        file.read(s_sdScratch, SECTOR_SIZE);
+    }
+    file.close();
+    uint32_t fatRead = micros() - start;
+    SD.remove(BENCH_FILE);
+
+    // Raw: preallocated contiguous file (once, like the slots at boot)
+    FsFile rawFile = SD.sdfs.open(BENCH_FILE, O_RDWR | O_CREAT);
+    uint32_t firstSector = 0;
+    uint32_t lastSector = 0;
+    bool contiguous = rawFile && rawFile.preAllocate(bytes) &&
+                      rawFile.contiguousRange(&firstSector, &lastSector);
+    rawFile.close();
+    if (!contiguous) {
+        SD.sdfs.remove(BENCH_FILE);
+        Serial.println("SdCardStorage: Benchmark preallocation failed");
+        return;
+    }
+    const uint32_t sectors = bytes / SECTOR_SIZE;
+
+    // Bounced: CHUNK_SIZE_BYTES through internal RAM, memcpy to/from EXTMEM
+    uint32_t extmemOffset = 0;
+    start = micros();
+    for (uint32_t sector = 0; sector < sectors; sector += CHUNK_SECTORS) {
+        memcpy(s_sdScratch, extmem + extmemOffset, CHUNK_SIZE_BYTES);
+        writeSectors(firstSector + sector, s_sdScratch, CHUNK_SECTORS);
+        extmemOffset = (extmemOffset + CHUNK_SIZE_BYTES) % (extmemChunks * DIRECT_CHUNK_BYTES);
+    }
+    uint32_t bounceWrite = micros() - start;
+
+    extmemOffset = 0;
+    start = micros();
+    for (uint32_t sector = 0; sector < sectors; sector += CHUNK_SECTORS) {
+        readSectors(firstSector + sector, s_sdScratch, CHUNK_SECTORS);
+        memcpy(extmem + extmemOffset, s_sdScratch, CHUNK_SIZE_BYTES);
+        extmemOffset = (extmemOffset + CHUNK_SIZE_BYTES) % (extmemChunks * DIRECT_CHUNK_BYTES);
+    }
+    uint32_t bounceRead = micros() - start;
+
+    // Direct: DIRECT_CHUNK_BYTES between the card and EXTMEM
+    start = micros();
+    for (uint32_t sector = 0; sector < sectors; sector += DIRECT_CHUNK_SECTORS) {
+        uint32_t chunk = (sector / DIRECT_CHUNK_SECTORS) % extmemChunks;
+        writeSectors(firstSector + sector, extmem + chunk * DIRECT_CHUNK_BYTES, DIRECT_CHUNK_SECTORS);
+    }
+    uint32_t directWrite = micros() - start;
+
+    start = micros();
+    for (uint32_t sector = 0; sector < sectors; sector += DIRECT_CHUNK_SECTORS) {
+        uint32_t chunk = (sector / DIRECT_CHUNK_SECTORS) % extmemChunks;
+        readSectors(firstSector + sector, extmem + chunk * DIRECT_CHUNK_BYTES, DIRECT_CHUNK_SECTORS);
+    }
+    uint32_t directRead = micros() - start;
+    SD.sdfs.remove(BENCH_FILE);
+
+    printRate("  FAT save (512 B writes):     ", fatWrite, megabytes);
+    printRate("  FAT load (512 B reads):      ", fatRead, megabytes);
+    printRate("  Raw save (4 KB bounced):     ", bounceWrite, megabytes);
+    printRate("  Raw load (4 KB bounced):     ", bounceRead, megabytes);
+    printRate("  Raw save (16 KB direct):     ", directWrite, megabytes);
+    printRate("  Raw load (16 KB direct):     ", directRead, megabytes);
+}
+
 }
@@ -1,28 +1,61 @@
 /**
- * SdCardStorage.h - SD card HAL for preset storage (synchronous I/O)
+ * SdCardStorage.h - SD card HAL for preset storage (chunked and synchronous I/O)
  *
  * PURPOSE:
  * Provides a hardware abstraction layer for reading and writing preset
  * loop buffers to the microSD card on Teensy 4.1.
  *
  * DESIGN:
- * - Synchronous (blocking) API - called from App thread
- * - Chunked reads/writes for large buffers
+ * - Chunked transfers behind IPresetStorage: beginSave()/beginLoad() handle the
+ *   header, step() moves one chunk (SdWorker yields between steps)
+ * - Loads alternate L and R chunks (two read positions in the file), so the loop
+ *   fills from its start in both channels and can play while it loads
+ * - Slot files are preallocated contiguous at boot (SdFat preAllocate/contiguousRange):
+ *   a chunk is one multi-sector raw transfer at a known sector, no FAT allocation
+ *   or cluster-chain walk per save. Whole sectors go straight between the card and
+ *   the EXTMEM loop buffers (DIRECT_CHUNK_BYTES a step, no bounce copy); only partial
+ *   sectors (where R starts and ends) bounce through a CHUNK_SIZE_BYTES internal RAM
+ *   buffer. Presets saved before that stay plain FAT
+ *   files (file API) until deleted; a card without contiguous room falls back too
+ * - Optional frame coding (PresetCodec: lossless or IMA-ADPCM) on preallocated slots:
+ *   fewer bytes over the SD bus, frames decoded into the loop buffers as they
+ *   arrive (still playable while loading). FAT files are always stored as PCM
+ * - Synchronous wrappers (saveSync/loadSync/deleteSync) run the same steps back to back
  * - Uses Teensy's built-in SD library (SDIO interface for speed)
  *
- * FILE FORMAT:
- * - [4 bytes length][left channel data][right channel data]
+ * FILE FORMAT (v3):
+ * - [84 byte header][left channel data][right channel data]
+ * - Preallocated slots: header padded to 512 bytes (header size field = 512) and
+ *   written after the audio; a zeroed header sector marks an empty slot
+ * - Header: magic "MLPR", uint16 version, uint16 header size,
+ *           uint32 length (samples), uint32 capture samples per beat,
+ *           uint8 gate steps, uint8 routing mode (+1, 0 = none), uint8 routing order,
+ *           uint8 sample rate code (0 = 44.1kHz, 1 = 44.1kHz, 2 = 48kHz, 3 = 96kHz),
+ *           uint8 gate levels[32], uint8 gate shapes[32]
+ * - v4 (coded audio, preallocated slots only): the v3 header, then uint8 codec,
+ *   3 reserved bytes, uint32 coded bytes; [header sector][PresetCodec frames]
+ *   (PCM presets are still written as v3, so older firmware reads them)
+ * - Routing and sample rate live in bytes that earlier v3 writers zeroed, so those
+ *   files load with hasRouting = false (current routing is kept) as 44.1kHz audio
+ * - Loading a preset recorded at another sample rate fails with ERROR_SAMPLE_RATE
+ *   (it would play back pitched); all v1/v2 files are 44.1kHz
+ * - v2 files (16 byte header, no gate pattern) still load (hasGatePattern = false)
+ * - Legacy v1 files ([4 bytes length][L][R]) still load (capture tempo = 0, no stretch)
  * - File names: preset1.bin, preset2.bin, preset3.bin, preset4.bin
  *
  * THREAD SAFETY:
- * - All SD operations must be called from the same thread (App thread)
- * - Caller must use threads.stop()/threads.start() to prevent context switches
+ * - All SD operations must be called from the same thread (the SdWorker thread)
+ * - Context switches between chunks are fine - no other thread touches the card
+ * - presetExists() reads a cache and is safe from any thread
  * - Do NOT call SD functions from ISR or other threads
  */
 
 #pragma once
 
 #include <Arduino.h>
+#include "../dsp/GateSequencer.h"
+#include "../dsp/EffectRouting.h"
+#include "../dsp/PresetCodec.h"
 
 namespace SdCardStorage {
 
@@ -38,9 +71,79 @@ enum class SdResult : uint8_t {
     ERROR_WRITE_FAILED = 6,
     ERROR_READ_FAILED = 7,
     ERROR_DELETE_FAILED = 8,
-    ERROR_INVALID_LENGTH = 9
+    ERROR_INVALID_LENGTH = 9,
+    ERROR_SAMPLE_RATE = 10      // Preset recorded at a different sample rate than this build
 };
 
+/**
+ * Settings stored alongside the loop audio
+ */
+struct PresetInfo {
+    uint32_t captureSamplesPerBeat;   // Tempo the loop was captured at (0 = unknown)
+    bool hasGatePattern;              // false for files older than v3
+    GatePattern gatePattern;          // Choke gate pattern (valid if hasGatePattern)
+    bool hasRouting;                  // false for files saved without routing
+    EffectRouting routing;            // Effect order/topology (valid if hasRouting)
+    PresetCodec codec;                // SAVE: how to store the audio, LOAD: how it was stored
+};
+
+// ========== CHUNKED TRANSFERS ==========
+
+static constexpr uint32_t CHUNK_SIZE_BYTES = 4096;     // Bounced step (FAT files, unaligned raw parts)
+static constexpr uint32_t DIRECT_CHUNK_BYTES = 16384;  // Raw step straight to/from a loop buffer (32 sectors)
+
+/**
+ * Preset storage the SD worker runs requests against
+ * (the SD card, or a RAM stub in tests). One transfer at a time.
+ */
+class IPresetStorage {
+public:
+    virtual ~IPresetStorage() = default;
+
+    /**
+     * Create the preset file and write its header; the audio follows in step()
+     */
+    virtual SdResult beginSave(uint8_t slot, const int16_t* bufferL, const int16_t* bufferR,
+                               uint32_t length, const PresetInfo& info) = 0;
+
+    /**
+     * Open the preset file and read and validate its header; the audio follows in step()
+     *
+     * @param outLength Samples per channel the transfer will load (valid on SUCCESS)
+     * @param outInfo Settings stored with the loop (valid on SUCCESS)
+     */
+    virtual SdResult beginLoad(uint8_t slot, int16_t* bufferL, int16_t* bufferR,
+                               uint32_t& outLength, PresetInfo& outInfo) = 0;
+
+    /**
+     * Move the next chunk of the open transfer
+     *
+     * @param done Set true when the last chunk has moved (file closed)
+     * @return SUCCESS, or the error that ended the transfer (file closed, partial save removed)
+     */
+    virtual SdResult step(bool& done) = 0;
+
+    /**
+     * End the open transfer early (a partial save is removed)
+     */
+    virtual void abort() = 0;
+
+    virtual SdResult remove(uint8_t slot) = 0;
+
+    virtual uint32_t getBytesDone() const = 0;
+    virtual uint32_t getBytesTotal() const = 0;
+
+    /**
+     * Samples loaded into both channels from the start of the loop (open load)
+     */
+    virtual uint32_t getResidentSamples() const = 0;
+};
+
+/**
+ * The SD card storage (valid after begin())
+ */
+IPresetStorage& cardStorage();
+
 // ========== INITIALIZATION ==========
 
 /**
@@ -61,36 +164,35 @@ bool isCardPresent();
 
 /**
  * Save loop buffer to preset file (blocking)
- * Call from App thread only - will block until complete
- * Caller must wrap with threads.stop()/threads.start()
+ * Call from the SD thread only - blocks until complete (presets go through SdWorker)
  *
  * @param slot Preset slot (1-4)
  * @param bufferL Pointer to left channel buffer
  * @param bufferR Pointer to right channel buffer
  * @param length Number of samples to save
+ * @param info Capture tempo, gate pattern and routing to store with the loop
  * @return Result code indicating success or failure
  */
 SdResult saveSync(uint8_t slot, const int16_t* bufferL, const int16_t* bufferR,
-                  uint32_t length);
+                  uint32_t length, const PresetInfo& info);
 
 /**
  * Load loop buffer from preset file (blocking)
- * Call from App thread only - will block until complete
- * Caller must wrap with threads.stop()/threads.start()
+ * Call from the SD thread only - blocks until complete
  *
  * @param slot Preset slot (1-4)
  * @param bufferL Pointer to left channel buffer (output)
  * @param bufferR Pointer to right channel buffer (output)
  * @param outLength Output parameter: number of samples loaded
+ * @param outInfo Output parameter: capture tempo (0 = unknown/legacy file), gate pattern and routing
  * @return Result code indicating success or failure
  */
 SdResult loadSync(uint8_t slot, int16_t* bufferL, int16_t* bufferR,
-                  uint32_t& outLength);
+                  uint32_t& outLength, PresetInfo& outInfo);
 
 /**
  * Delete preset file (blocking)
- * Call from App thread only - will block until complete
- * Caller must wrap with threads.stop()/threads.start()
+ * Call from the SD thread only - blocks until complete
  *
  * @param slot Preset slot (1-4)
  * @return Result code indicating success or failure
@@ -104,8 +206,22 @@ SdResult deleteSync(uint8_t slot);
  * Uses cached state from boot scan and SD operations
  *
  * @param slot Preset slot (1-4)
- * @return true if presetN.bin exists on SD card
+ * @return true if slot N holds a preset
  */
 bool presetExists(uint8_t slot);
 
+// ========== DIAGNOSTICS ==========
+
+/**
+ * Time save/load per MB: 512-byte FAT file I/O (the old path), raw CHUNK_SIZE_BYTES
+ * transfers bounced through internal RAM, and raw DIRECT_CHUNK_BYTES transfers
+ * straight to/from EXTMEM on a preallocated contiguous file; prints the results
+ * Call from setup() before the SD thread starts (MICROLOOP_SD_BENCHMARK builds)
+ *
+ * @param megabytes Amount to write and read back with each method
+ * @param extmem Word-aligned EXTMEM buffer standing in for a loop buffer (contents overwritten)
+ * @param extmemBytes Size of extmem (at least DIRECT_CHUNK_BYTES)
+ */
+void benchmark(uint32_t megabytes, uint8_t* extmem, uint32_t extmemBytes);
+
 }
@@ -0,0 +1,244 @@
+#include "SdWorker.h"
+#include "SpscQueue.h"
+#include <TeensyThreads.h>
+
+using SdCardStorage::SdResult;
+
+// ========== QUEUES ==========
+static SpscQueue<SdRequest, 4> s_requests;   // App -> worker
+static SpscQueue<SdEvent, 16> s_events;      // Worker -> App
+
+static SdCardStorage::IPresetStorage* s_storage = nullptr;
+
+// ========== WORKER THREAD STATE ==========
+static SdRequest s_current;                  // Request in progress
+static bool s_active = false;                // s_current is transferring
+static uint8_t s_lastPercent = 0;            // Last progress reported
+static SdEvent s_completion;                 // Completion waiting for queue room
+static bool s_completionPending = false;
+static SdEvent s_ready;                      // Streaming READY waiting for queue room
+static bool s_readyPending = false;
+static bool s_readySent = false;             // READY queued for s_current
+
+// ========== APP THREAD STATE ==========
+static SdProgressCallback s_onProgress = nullptr;
+static SdCompleteCallback s_onComplete = nullptr;
+static SdReadyCallback s_onReady = nullptr;
+static void* s_callbackContext = nullptr;
+static uint32_t s_submitted = 0;             // Requests queued
+static uint32_t s_completed = 0;             // Completions dispatched
+
+// ========== INTERNAL HELPERS ==========
+
+static SdEvent makeEvent(SdEventType type, uint8_t percent) {
+    SdEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.request = s_current.type;
+    event.slot = s_current.slot;
+    event.percent = percent;
+    event.result = SdResult::SUCCESS;
+    return event;
+}
+
+/**
+ * End the current request and queue its completion
+ */
+static void finish(SdResult result, uint32_t length) {
+    s_completion = makeEvent(SdEventType::COMPLETE, (result == SdResult::SUCCESS) ? 100 : s_lastPercent);
+    s_completion.result = result;
+    if (s_current.type == SdRequestType::LOAD) {
+        s_completion.length = (result == SdResult::SUCCESS) ? length : 0;
+        s_completion.info = s_current.info;   // Header read by beginLoad()
+    }
+    s_completionPending = true;
+    s_active = false;
+}
+
+static uint8_t transferPercent() {
+    uint32_t total = s_storage->getBytesTotal();
+    if (total == 0) {
+        return 0;
+    }
+    return static_cast<uint8_t>((static_cast<uint64_t>(s_storage->getBytesDone()) * 100) / total);
+}
+
+static bool isStreaming() {
+    return s_current.type == SdRequestType::LOAD && s_current.residentSamples != nullptr;
+}
+
+/**
+ * Samples the load is ahead of the read head (0 = playback has caught up)
+ */
+static uint32_t streamLead() {
+    uint32_t resident = s_storage->getResidentSamples();
+    uint32_t head = (s_current.readHead != nullptr) ? *s_current.readHead : 0;
+    return (resident > head) ? resident - head : 0;
+}
+
+/**
+ * Publish resident samples; queue READY once the start watermark is in
+ */
+static void publishStream(bool done) {
+    uint32_t resident = s_storage->getResidentSamples();
+    *s_current.residentSamples = resident;
+
+    if (!s_readySent && (done || resident >= SdWorker::STREAM_START_SAMPLES)) {
+        s_ready = makeEvent(SdEventType::READY, transferPercent());
+        s_ready.length = s_current.length;   // Set by beginLoad()
+        s_ready.info = s_current.info;
+        s_readyPending = true;
+        s_readySent = true;
+    }
+}
+
+/**
+ * Start the next request (DELETE completes here, SAVE/LOAD continue in service())
+ */
+static void startRequest() {
+    s_lastPercent = 0;
+    s_readySent = false;
+    SdResult result;
+
+    switch (s_current.type) {
+        case SdRequestType::SAVE:
+            result = s_storage->beginSave(s_current.slot, s_current.bufferL, s_current.bufferR,
+                                          s_current.length, s_current.info);
+            break;
+
+        case SdRequestType::LOAD:
+            // Length and stored settings come back with the completion
+            result = s_storage->beginLoad(s_current.slot, s_current.bufferL, s_current.bufferR,
+                                          s_current.length, s_current.info);
+            break;
+
+        case SdRequestType::DELETE:
+            finish(s_storage->remove(s_current.slot), 0);
+            return;
+
+        default:
+            finish(SdResult::ERROR_INVALID_BUFFER, 0);
+            return;
+    }
+
+    if (result != SdResult::SUCCESS) {
+        finish(result, 0);
+        return;
+    }
+    s_active = true;
+}
+
+// ========== WORKER THREAD ==========
+
+void SdWorker::begin(SdCardStorage::IPresetStorage& storage) {
+    s_storage = &storage;
+}
+
+bool SdWorker::service() {
+    if (s_storage == nullptr) {
+        return false;
+    }
+
+    // READY, then completion: nothing moves on until the App thread can hear about them
+    if (s_readyPending) {
+        if (!s_events.push(s_ready)) {
+            return true;
+        }
+        s_readyPending = false;
+    }
+    if (s_completionPending) {
+        if (s_events.push(s_completion)) {
+            s_completionPending = false;
+        }
+        return true;
+    }
+
+    if (!s_active) {
+        if (!s_requests.pop(s_current)) {
+            return false;  // Idle
+        }
+        startRequest();
+        return true;
+    }
+
+    // Streaming load close behind the read head: catch up in a burst before yielding
+    uint32_t chunks = 1;
+    if (isStreaming() && streamLead() < STREAM_LOW_WATERMARK_SAMPLES) {
+        chunks = STREAM_BURST_CHUNKS;
+    }
+
+    bool done = false;
+    SdResult result = SdResult::SUCCESS;
+    for (uint32_t i = 0; i < chunks && !done && result == SdResult::SUCCESS; i++) {
+        result = s_storage->step(done);
+    }
+    if (isStreaming() && result == SdResult::SUCCESS) {
+        publishStream(done);
+    }
+    if (result != SdResult::SUCCESS || done) {
+        finish(result, s_current.length);
+        return true;
+    }
+
+    uint8_t percent = transferPercent();
+    if (percent / PROGRESS_STEP_PERCENT > s_lastPercent / PROGRESS_STEP_PERCENT) {
+        s_lastPercent = percent;
+        s_events.push(makeEvent(SdEventType::PROGRESS, percent));  // Dropped if full (next one catches up)
+    }
+    return true;
+}
+
+void SdWorker::threadLoop() {
+    for (;;) {
+        if (SdWorker::service()) {
+            threads.yield();   // One chunk at a time: MIDI, buttons and display run in between
+        } else {
+            threads.delay(IDLE_DELAY_MS);
+        }
+    }
+}
+
+// ========== APP THREAD ==========
+
+void SdWorker::setCallbacks(SdProgressCallback onProgress, SdCompleteCallback onComplete, void* context) {
+    s_onProgress = onProgress;
+    s_onComplete = onComplete;
+    s_callbackContext = context;
+}
+
+void SdWorker::setReadyCallback(SdReadyCallback onReady) {
+    s_onReady = onReady;
+}
+
+bool SdWorker::submit(const SdRequest& request) {
+    if (s_storage == nullptr || !s_requests.push(request)) {
+        return false;
+    }
+    s_submitted++;
+    return true;
+}
+
+bool SdWorker::isBusy() {
+    return s_submitted != s_completed;
+}
+
+uint32_t SdWorker::dispatchEvents() {
+    uint32_t delivered = 0;
+    SdEvent event;
+    while (s_events.pop(event)) {
+        delivered++;
+        if (event.type == SdEventType::COMPLETE) {
+            s_completed++;   // Before the callback, so it may submit the next request
+            if (s_onComplete) {
+                s_onComplete(s_callbackContext, event);
+            }
+        } else if (event.type == SdEventType::READY) {
+            if (s_onReady) {
+                s_onReady(s_callbackContext, event);
+            }
+        } else if (s_onProgress) {
+            s_onProgress(s_callbackContext, event);
+        }
+    }
+    return delivered;
+}
@@ -0,0 +1,134 @@
+/**
+ * SdWorker.h - Dedicated SD card thread with request/completion queues
+ *
+ * PURPOSE:
+ * Preset transfers used to run on the App thread inside threads.stop(), so MIDI
+ * clock, buttons and the display froze for the whole transfer (hundreds of ms
+ * for a full loop). The worker thread owns the SD card instead: the App thread
+ * queues a request and hears back through progress and completion callbacks.
+ *
+ * DESIGN:
+ * - Request queue (App -> worker) and event queue (worker -> App): SpscQueue, no locks
+ * - service() does one unit of work (start a request, or move one chunk -
+ *   at most DIRECT_CHUNK_BYTES); threadLoop() yields after each, so other threads
+ *   wait at most one chunk for the CPU - no threads.stop()
+ * - Only the worker thread touches the card (IPresetStorage is not thread-safe)
+ * - Progress events every PROGRESS_STEP_PERCENT (dropped if the queue is full);
+ *   completion events are held until the queue has room, never dropped
+ * - Callbacks run on the App thread inside dispatchEvents(), never on the worker
+ * - Buffers passed in a request belong to the worker until its completion is dispatched
+ * - Streaming load (residentSamples set): the loop fills from its start in both
+ *   channels and the worker publishes how much is resident after every chunk;
+ *   READY goes out once STREAM_START_SAMPLES are in, so playback can start
+ *   before the file is done. While the load leads the read head by less than
+ *   STREAM_LOW_WATERMARK_SAMPLES, the worker moves up to STREAM_BURST_CHUNKS
+ *   chunks before yielding (playback past the loaded part is silent, never stalled)
+ *
+ * USAGE:
+ *   SdWorker::begin(SdCardStorage::cardStorage());           // setup()
+ *   threads.addThread(sdThreadEntry, 0, 4096);               // Calls SdWorker::threadLoop()
+ *   SdWorker::setCallbacks(onProgress, onComplete, this);    // PresetController::begin()
+ *   SdWorker::submit(request);                               // App thread
+ *   SdWorker::dispatchEvents();                              // App thread loop
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <AudioStream.h>
+#include "SdCardStorage.h"
+
+enum class SdRequestType : uint8_t {
+    SAVE = 0,
+    LOAD = 1,
+    DELETE = 2
+};
+
+struct SdRequest {
+    SdRequestType type;
+    uint8_t slot;                       // Preset slot (1-4)
+    int16_t* bufferL;                   // SAVE: source, LOAD: destination
+    int16_t* bufferR;
+    uint32_t length;                    // SAVE: samples per channel
+    SdCardStorage::PresetInfo info;     // SAVE: settings stored with the loop
+
+    // LOAD streaming (nullptr = not streamed, loop usable on completion only)
+    volatile uint32_t* residentSamples; // Worker publishes samples loaded into both channels
+    const volatile uint32_t* readHead;  // Playback position in the loop (nullptr = not playing)
+};
+
+enum class SdEventType : uint8_t {
+    PROGRESS = 0,
+    COMPLETE = 1,
+    READY = 2                           // Streaming LOAD: first STREAM_START_SAMPLES resident
+};
+
+struct SdEvent {
+    SdEventType type;
+    SdRequestType request;              // Request this event belongs to
+    uint8_t slot;
+    uint8_t percent;                    // Bytes moved so far (100 on success)
+    SdCardStorage::SdResult result;     // COMPLETE only
+    uint32_t length;                    // LOAD ready/complete: samples per channel
+    SdCardStorage::PresetInfo info;     // LOAD ready/complete: settings stored with the loop
+};
+
+// Callback types (called on the App thread from dispatchEvents())
+typedef void (*SdProgressCallback)(void* context, const SdEvent& event);
+typedef void (*SdCompleteCallback)(void* context, const SdEvent& event);
+typedef void (*SdReadyCallback)(void* context, const SdEvent& event);
+
+namespace SdWorker {
+    static constexpr uint8_t PROGRESS_STEP_PERCENT = 10;
+    static constexpr uint32_t IDLE_DELAY_MS = 5;
+
+    // Streaming load watermarks (samples per channel)
+    static constexpr uint32_t STREAM_START_SAMPLES = 16 * AUDIO_BLOCK_SAMPLES;         // Playable from here
+    static constexpr uint32_t STREAM_LOW_WATERMARK_SAMPLES = 64 * AUDIO_BLOCK_SAMPLES; // Burst below this lead
+    static constexpr uint32_t STREAM_BURST_CHUNKS = 2;                                 // Chunks per burst
+
+    /**
+     * Select the storage requests run against (before the thread starts)
+     */
+    void begin(SdCardStorage::IPresetStorage& storage);
+
+    /**
+     * Worker thread body (never returns)
+     */
+    void threadLoop();
+
+    /**
+     * One unit of work (worker thread; tests call it directly)
+     *
+     * @return true if there was work (more may follow), false if idle
+     */
+    bool service();
+
+    // ========== APP THREAD ==========
+
+    void setCallbacks(SdProgressCallback onProgress, SdCompleteCallback onComplete, void* context);
+
+    /**
+     * Callback for READY (streaming loads; before the completion, at most once per load)
+     */
+    void setReadyCallback(SdReadyCallback onReady);
+
+    /**
+     * Queue a request
+     *
+     * @return false if the request queue is full or begin() wasn't called
+     */
+    bool submit(const SdRequest& request);
+
+    /**
+     * Requests submitted whose completion hasn't been dispatched yet
+     */
+    bool isBusy();
+
+    /**
+     * Deliver queued progress/completion events to the callbacks
+     *
+     * @return Number of events delivered
+     */
+    uint32_t dispatchEvents();
+}
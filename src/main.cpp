@@ -7,6 +7,7 @@
 #include "Ssd1306Display.h"
 #include "Mcp23017Input.h"
 #include "SdCardStorage.h"
+#include "SdWorker.h"
 #include "FreezeAudio.h"
 #include "ChokeAudio.h"
 #include "StutterAudio.h"
@@ -14,12 +15,42 @@
 #include "Trace.h"
 #include "Timebase.h"
 #include "TimebaseAudio.h"
+#include "LimiterAudio.h"
+#include "EffectChain.h"
+#include "DspProfiler.h"
+#include "AudioPoolMonitor.h"
+
+// Fused chain: Timebase + all effects run in one AudioStream node (set by CMake)
+#ifndef MICROLOOP_FUSED_CHAIN
+#define MICROLOOP_FUSED_CHAIN 0
+#endif
+
+// SD benchmark at boot: FAT vs raw bounced vs raw direct-to-EXTMEM transfers (set by CMake)
+#ifndef MICROLOOP_SD_BENCHMARK
+#define MICROLOOP_SD_BENCHMARK 0
+#endif
+static constexpr uint32_t SD_BENCHMARK_MB = 4;   // Per method (about one full-length preset)
 
 AudioInputI2S i2s_in;
-TimebaseAudio timekeeper;  // Tracks sample position
 FreezeAudio freeze;    // Circular buffer freeze effect
 ChokeAudio choke;      // Smooth mute effect
 StutterAudio stutter;
+
+#if MICROLOOP_FUSED_CHAIN
+EffectChain chain;     // Timebase → Stutter → Freeze → Choke, processed in place
+AudioOutputI2S i2s_out;
+
+// Audio connections (stereo L+R)
+AudioConnection patchCord1(i2s_in, 0, chain, 0);
+AudioConnection patchCord2(i2s_in, 1, chain, 1);
+AudioConnection patchCord3(chain, 0, i2s_out, 0);
+AudioConnection patchCord4(chain, 1, i2s_out, 1);
+
+// Only the I2S input/output blocks are in flight
+static constexpr uint16_t AUDIO_MEMORY_BLOCKS = 8;
+#else
+TimebaseAudio timekeeper;  // Tracks sample position
+LimiterAudio limiter;      // Output ceiling (last node before the DAC)
 AudioOutputI2S i2s_out;
 
 // Audio connections (stereo L+R)
@@ -29,13 +60,63 @@ AudioConnection patchCord3(timekeeper, 0, stutter, 0);
 AudioConnection patchCord4(timekeeper, 1, stutter, 1);
 AudioConnection patchCord5(stutter, 0, freeze, 0);
 AudioConnection patchCord6(stutter, 1, freeze, 1);
-AudioConnection patchCord7(freeze, 1, choke, 0);
+AudioConnection patchCord7(freeze, 0, choke, 0);
 AudioConnection patchCord8(freeze, 1, choke, 1);
-AudioConnection patchCord9(choke, 0, i2s_out, 0);       // Choke → Left out
-AudioConnection patchCord10(choke, 1, i2s_out, 1);       // Choke → Right out
-
-// Teensy Audio Library SGTL5000 control
-AudioControlSGTL5000 codec;
+AudioConnection patchCord9(choke, 0, limiter, 0);
+AudioConnection patchCord10(choke, 1, limiter, 1);
+AudioConnection patchCord11(limiter, 0, i2s_out, 0);     // Limiter → Left out
+AudioConnection patchCord12(limiter, 1, i2s_out, 1);     // Limiter → Right out
+
+static constexpr uint16_t AUDIO_MEMORY_BLOCKS = 12;
+#endif
+
+/**
+ * Effect registry rows, in serial routing order (same as the per-node patch)
+ * Adding an effect: declare its node above and add a row here
+ */
+struct EffectRegistration {
+    EffectID id;
+    IEffectAudio* effect;
+};
+
+static constexpr EffectRegistration EFFECT_REGISTRY[] = {
+    {EffectID::STUTTER, &stutter},
+    {EffectID::FREEZE, &freeze},
+    {EffectID::CHOKE, &choke},
+};
+
+/**
+ * Teensy Audio Library SGTL5000 control, plus the codec's internal rate
+ * enable() always programs SYS_FS = 44.1kHz; the I2S clocks already follow
+ * AUDIO_SAMPLE_RATE_EXACT, so only the codec needs telling about 48/96kHz
+ */
+class MicroLoopCodec : public AudioControlSGTL5000 {
+public:
+    bool setSampleRate(uint32_t sampleRate) {
+        // CHIP_CLK_CTRL: SYS_FS bits 3:2 (1 = 44.1k, 2 = 48k, 3 = 96k), MCLK_FREQ bits 1:0 = 256*Fs
+        uint16_t sysFs;
+        switch (sampleRate) {
+            case 44100: sysFs = 1; break;
+            case 48000: sysFs = 2; break;
+            case 96000: sysFs = 3; break;
+            default: return false;
+        }
+        return write(0x0004, sysFs << 2);
+    }
+};
+
+MicroLoopCodec codec;
+
+/**
+ * Output limiter of whichever graph is built
+ */
+static LookaheadLimiter& outputLimiter() {
+#if MICROLOOP_FUSED_CHAIN
+    return chain.getLimiter();
+#else
+    return limiter.getLimiter();
+#endif
+}
 
 // Global thread IDs for debugging
 int g_ioThreadId = -1;
@@ -43,14 +124,7 @@ int g_inputThreadId = -1;
 int g_mcpThreadId = -1;
 int g_displayThreadId = -1;
 int g_appThreadId = -1;
-
-// SD operation request from thread to main loop
-// threads.stop()/start() MUST be called from main loop, not from within a thread
-volatile bool g_sdOperationPending = false;
-volatile uint8_t g_sdOperationSlot = 0;
-volatile int g_sdOperationType = 0; // 0=none, 1=save, 2=load, 3=delete
-volatile bool g_sdOperationComplete = false;
-volatile int g_sdOperationResult = 0;
+int g_sdThreadId = -1;
 
 void ioThreadEntry() {
     MidiInput::threadLoop();  // Never returns
@@ -72,6 +146,10 @@ void appThreadEntry() {
     App::threadLoop();  // Never returns
 }
 
+void sdThreadEntry() {
+    SdWorker::threadLoop();  // Never returns
+}
+
 void setup() {
     Serial.begin(115200);
 
@@ -83,7 +161,8 @@ void setup() {
 
     Serial.println("=== MicroLoop Initializing ===");
 
-    AudioMemory(12);
+    AudioMemory(AUDIO_MEMORY_BLOCKS);
+    AudioPoolMonitor::begin(AUDIO_MEMORY_BLOCKS);
 
     if (!codec.enable()) {
         Serial.println("ERROR: Codec init failed!");
@@ -94,6 +173,10 @@ void setup() {
         }
     }
 
+    if (!codec.setSampleRate(Timebase::SAMPLE_RATE)) {
+        Serial.println("ERROR: Codec sample rate config failed!");
+    }
+
     // Configure for line-in and line-out operation
     // IMPORTANT: Use MOTU M4 **REAR LINE INPUTS 3-4** (not front combo jacks!)
     codec.inputSelect(AUDIO_INPUT_LINEIN);  // Use line-in (not mic)
@@ -103,11 +186,15 @@ void setup() {
     codec.volume(0.3);  // Headphone volume (0.0-1.0) - start low to avoid clipping
     codec.unmuteHeadphone();  // Unmute headphone (for testing)
 
-    Serial.println("Audio: OK (using Teensy Audio Library SGTL5000)");
+    Serial.print("Audio: OK (using Teensy Audio Library SGTL5000, ");
+    Serial.print(Timebase::SAMPLE_RATE);
+    Serial.println(" Hz)");
 
     Timebase::begin();
     Serial.println("TimeKeeper: OK");
 
+    DspProfiler::begin(AUDIO_BLOCK_SAMPLES, Timebase::SAMPLE_RATE);  // Effects get slots at registration
+
     MidiInput::begin();
     Serial.println("MIDI: OK (DIN on Serial8)");
 
@@ -117,9 +204,19 @@ void setup() {
         // Continue anyway - SD card is optional for basic functionality
     } else {
         Serial.println("SD Card: OK (SDIO)");
+#if MICROLOOP_SD_BENCHMARK
+        // SD thread not started yet; the loop buffer is empty at boot
+        SdCardStorage::benchmark(SD_BENCHMARK_MB, reinterpret_cast<uint8_t*>(stutter.getBufferL()),
+                                 StutterAudio::getMaxBufferSize() * sizeof(int16_t));
+#endif
     }
+    SdWorker::begin(SdCardStorage::cardStorage());  // Only the SD thread touches the card
 
-    App::begin();
+#if MICROLOOP_FUSED_CHAIN
+    App::begin(&chain);     // Routing editable at runtime
+#else
+    App::begin(nullptr);    // Fixed patch-cord order
+#endif
     Serial.println("App Logic: OK");
 
     if (!NeokeyInput::begin()) {
@@ -149,30 +246,28 @@ void setup() {
         Serial.println("Display: OK (SSD1306 on I2C 0x3C / Wire1)");
     }
 
-    if (!EffectManager::registerEffect(EffectID::STUTTER, &stutter)) {
-        Serial.println("FATAL: Failed to register stutter effect!");
-        while (1) {
-            // Blink LED rapidly to indicate error
-            digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
-            delay(100);
-        }
-    }
-    if (!EffectManager::registerEffect(EffectID::FREEZE, &freeze)) {
-        Serial.println("FATAL: Failed to register freeze effect!");
-        while (1) {
-            // Blink LED rapidly to indicate error
-            digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
-            delay(100);
-        }
-    }
-    if (!EffectManager::registerEffect(EffectID::CHOKE, &choke)) {
-        Serial.println("FATAL: Failed to register choke effect!");
-        while (1) {
-            // Blink LED rapidly to indicate error
-            digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
-            delay(100);
+    for (const EffectRegistration& entry : EFFECT_REGISTRY) {
+        if (!EffectManager::registerEffect(entry.id, entry.effect)) {
+            Serial.print("FATAL: Failed to register ");
+            Serial.print(entry.effect->getName());
+            Serial.println(" effect!");
+            while (1) {
+                // Blink LED rapidly to indicate error
+                digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+                delay(100);
+            }
         }
+#if MICROLOOP_FUSED_CHAIN
+        // Registration order = serial routing (same as the per-node patch: Stutter → Freeze → Choke)
+        // Encoder 4's Routing page and presets reorder it at runtime
+        chain.addStage(entry.effect);
+#endif
     }
+#if MICROLOOP_FUSED_CHAIN
+    Serial.println("Audio: fused effect chain");
+#endif
+    outputLimiter().setProfileSlot(DspProfiler::registerSlot("Limiter"));
+
     Serial.print("Effect Manager: Registered ");
     Serial.print(EffectManager::getNumEffects());
     Serial.println(" effect(s)");
@@ -181,10 +276,12 @@ void setup() {
     g_inputThreadId = threads.addThread(inputThreadEntry, 0, 2048);
     g_mcpThreadId = threads.addThread(mcpThreadEntry, 0, 2048);
     g_displayThreadId = threads.addThread(displayThreadEntry, 0, 2048);
-    // 16KB stack: App thread runs blocking SD save/load/delete operations
     g_appThreadId = threads.addThread(appThreadEntry, 0, 16384);
+    // SD worker: preset transfers chunk by chunk, yielding between chunks (SD library needs the stack)
+    g_sdThreadId = threads.addThread(sdThreadEntry, 0, 8192);
 
-    if (g_ioThreadId < 0 || g_inputThreadId < 0 || g_mcpThreadId < 0 || g_displayThreadId < 0 || g_appThreadId < 0) {
+    if (g_ioThreadId < 0 || g_inputThreadId < 0 || g_mcpThreadId < 0 || g_displayThreadId < 0 ||
+        g_appThreadId < 0 || g_sdThreadId < 0) {
         Serial.println("ERROR: Thread creation failed!");
         while (1);  // Halt
     }
@@ -199,6 +296,69 @@ void setup() {
     Serial.println("  't' - Dump trace buffer");
     Serial.println("  'c' - Clear trace buffer");
     Serial.println("  's' - Show TimeKeeper status");
+    Serial.println("  'a' - Show audio CPU and block pool usage");
+    Serial.println("  'p' - Show per-effect DSP profile (then reset)");
+    Serial.println();
+}
+
+/**
+ * Print per-effect DSP timing (min/avg/max, overruns, histogram), then reset
+ */
+static void printDspProfile() {
+    Serial.println("\n=== DSP Profile ===");
+    Serial.print("Deadline: ");
+    Serial.print(DspProfiler::ticksToNanos(DspProfiler::getDeadlineTicks()) / 1000);
+    Serial.print("us (");
+    Serial.print(DspProfiler::getDeadlineTicks());
+    Serial.println(" cycles)");
+
+    for (uint8_t slot = 0; slot < DspProfiler::getNumSlots(); slot++) {
+        DspProfiler::Stats stats;
+        if (!DspProfiler::getStats(slot, stats)) {
+            continue;
+        }
+
+        Serial.print(stats.name);
+        Serial.print(": n=");
+        Serial.print(stats.count);
+        Serial.print(" min/avg/max=");
+        Serial.print(DspProfiler::ticksToNanos(stats.minTicks) / 1000.0f, 1);
+        Serial.print("/");
+        Serial.print(DspProfiler::ticksToNanos(stats.avgTicks) / 1000.0f, 1);
+        Serial.print("/");
+        Serial.print(DspProfiler::ticksToNanos(stats.maxTicks) / 1000.0f, 1);
+        Serial.print("us (avg ");
+        Serial.print(DspProfiler::toPermille(stats.avgTicks) / 10.0f, 1);
+        Serial.print("%, max ");
+        Serial.print(DspProfiler::toPermille(stats.maxTicks) / 10.0f, 1);
+        Serial.print("%) overruns=");
+        Serial.println(stats.overruns);
+
+        Serial.print("  hist:");
+        for (uint8_t bin = 0; bin < DspProfiler::HIST_BINS; bin++) {
+            uint32_t upper = DspProfiler::binUpperPermille(bin);
+            Serial.print(upper ? " <" : " >=");
+            Serial.print((upper ? upper : DspProfiler::binUpperPermille(bin - 1)) / 10.0f, 1);
+            Serial.print("%:");
+            Serial.print(stats.histogram[bin]);
+        }
+        Serial.println();
+    }
+    Serial.println("===================\n");
+    DspProfiler::reset();
+}
+
+/**
+ * Print one node's degraded-block counts ("held/pass/mono/drop")
+ */
+static void printPoolFallbacks(const char* name, const GuardedStream& node) {
+    Serial.print("  ");
+    Serial.print(name);
+    Serial.print(":");
+    for (uint8_t kind = 0; kind < POOL_FALLBACK_COUNT; kind++) {
+        Serial.print(" ");
+        Serial.print(node.getFallbackCount(static_cast<PoolFallback>(kind)));
+    }
     Serial.println();
 }
 
@@ -236,6 +396,7 @@ void loop() {
         printState(" nk", g_inputThreadId);
         printState(" mcp", g_mcpThreadId);
         printState(" disp", g_displayThreadId);
+        printState(" sd", g_sdThreadId);
         Serial.println();
     }
 
@@ -284,6 +445,78 @@ void loop() {
                 Serial.println("=========================\n");
                 break;
 
+            case 'a':  // Audio CPU and block pool usage (compare fused vs per-node graph)
+                Serial.println("\n=== Audio Usage ===");
+                Serial.print("Graph: ");
+                Serial.println(MICROLOOP_FUSED_CHAIN ? "fused chain" : "per-node");
+                Serial.print("CPU: ");
+                Serial.print(AudioProcessorUsage(), 2);
+                Serial.print("% (max ");
+                Serial.print(AudioProcessorUsageMax(), 2);
+                Serial.println("%)");
+#if MICROLOOP_FUSED_CHAIN
+                {
+                    char routing[16];
+                    chain.formatRouting(chain.getRouting(), routing, sizeof(routing));
+                    Serial.print("Routing: ");
+                    Serial.println(routing);
+                }
+                Serial.print("Chain cycles/block: ");
+                Serial.print(static_cast<uint32_t>(chain.cpu_cycles) << 6);  // AudioStream counts in 64-cycle units
+                Serial.print(" (max ");
+                Serial.print(static_cast<uint32_t>(chain.cpu_cycles_max) << 6);
+                Serial.println(")");
+#else
+                Serial.print("Node cycles/block (timebase+stutter+freeze+choke): ");
+                Serial.print(static_cast<uint32_t>(timekeeper.cpu_cycles + stutter.cpu_cycles +
+                                                   freeze.cpu_cycles + choke.cpu_cycles) << 6);
+                Serial.print(" (max ");
+                Serial.print(static_cast<uint32_t>(timekeeper.cpu_cycles_max + stutter.cpu_cycles_max +
+                                                   freeze.cpu_cycles_max + choke.cpu_cycles_max) << 6);
+                Serial.println(")");
+#endif
+                Serial.print("Blocks: ");
+                Serial.print(AudioMemoryUsage());
+                Serial.print(" (max ");
+                Serial.print(AudioMemoryUsageMax());
+                Serial.print(" of ");
+                Serial.print(AUDIO_MEMORY_BLOCKS);
+                Serial.println(")");
+                Serial.print("Peak since boot: ");
+                Serial.println(AudioPoolMonitor::getPeakBlocks());
+                Serial.print("Degraded blocks:");
+                for (uint8_t kind = 0; kind < POOL_FALLBACK_COUNT; kind++) {
+                    Serial.print(" ");
+                    Serial.print(AudioPoolMonitor::fallbackName(static_cast<PoolFallback>(kind)));
+                    Serial.print("=");
+                    Serial.print(AudioPoolMonitor::getFallbackCount(static_cast<PoolFallback>(kind)));
+                }
+                Serial.println();
+#if MICROLOOP_FUSED_CHAIN
+                printPoolFallbacks("chain", chain);
+#else
+                printPoolFallbacks("stutter", stutter);
+                printPoolFallbacks("freeze", freeze);
+                printPoolFallbacks("choke", choke);
+#endif
+                {
+                    // Deepest gain reduction since the last 'a' (0 dB = never limited)
+                    int32_t minGain = outputLimiter().takeMinGain();
+                    Serial.print("Limiter: max reduction ");
+                    Serial.print(-20.0f * log10f(minGain / 2147483648.0f), 1);
+                    Serial.print(" dB (latency ");
+                    Serial.print(LookaheadLimiter::DELAY_SAMPLES);
+                    Serial.println(" samples)");
+                }
+                Serial.println("===================\n");
+                AudioProcessorUsageMaxReset();
+                AudioMemoryUsageMaxReset();
+                break;
+
+            case 'p':  // Per-effect DSP cycle profile
+                printDspProfile();
+                break;
+
             case '\n':
             case '\r':
                 // Ignore newlines
@@ -292,7 +525,7 @@ void loop() {
             default:
                 Serial.print("Unknown command: ");
                 Serial.println(cmd);
-                Serial.println("Commands: 't' (dump trace), 'c' (clear trace), 's' (status)");
+                Serial.println("Commands: 't' (dump trace), 'c' (clear trace), 's' (status), 'a' (audio usage), 'p' (DSP profile)");
                 break;
         }
     }
@@ -17,6 +17,17 @@
 
 // Include test files (they auto-register via TEST() macro)
 #include "test_spsc_queue.cpp"
+#include "test_grain_engine.cpp"
+#include "test_gain_ramp.cpp"
+#include "test_audio_bus.cpp"
+#include "test_dsp_profiler.cpp"
+#include "test_block_size.cpp"
+#include "test_timebase.cpp"
+#include "test_smoothed_param.cpp"
+#include "test_limiter.cpp"
+#include "test_sd_worker.cpp"
+#include "test_gate_sequencer.cpp"
+#include "test_preset_codec.cpp"
 
 void setup() {
     // Initialize serial
@@ -0,0 +1,117 @@
+/**
+ * test_audio_bus.cpp - Unit tests and cycle benchmark for the 32-bit AudioBus
+ */
+
+#include "test_runner.h"
+#include "AudioBus.h"
+#include "FadeEnvelope.h"
+#include "GainRamp.h"
+#include "Timebase.h"
+#include <AudioStream.h>
+
+static int16_t s_busTestIn[AUDIO_BLOCK_SAMPLES] __attribute__((aligned(4)));
+static int16_t s_busTestOut[AUDIO_BLOCK_SAMPLES] __attribute__((aligned(4)));
+static int32_t s_busTestL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_busTestR[AUDIO_BLOCK_SAMPLES];
+static int32_t s_busTestExpected[AUDIO_BLOCK_SAMPLES];
+static int16_t s_busTestGains[AUDIO_BLOCK_SAMPLES] __attribute__((aligned(4)));
+
+TEST(AudioBus_RoundTrip_ExactAndSaturates) {
+    // Untouched frames come back bit-exact
+    for (int32_t s = -32768; s <= 32767; s += 7) {
+        ASSERT_EQ(AudioBus::narrow(AudioBus::widen(static_cast<int16_t>(s))), s);
+    }
+    ASSERT_EQ(AudioBus::narrow(AudioBus::widen(32767)), 32767);
+
+    // Rounding to nearest, overs clip only at the final conversion
+    ASSERT_EQ(AudioBus::narrow((100 << AudioBus::SHIFT) + AudioBus::ROUND), 101);
+    ASSERT_EQ(AudioBus::narrow((100 << AudioBus::SHIFT) + AudioBus::ROUND - 1), 100);
+    ASSERT_EQ(AudioBus::narrow(40000 << AudioBus::SHIFT), 32767);
+    ASSERT_EQ(AudioBus::narrow(-(40000 << AudioBus::SHIFT)), -32768);
+    ASSERT_EQ(AudioBus::narrow(INT32_MAX), 32767);
+}
+
+TEST(AudioBus_Dither_TriangularZeroMean) {
+    // 1000.25 LSB: output stays within the +/-1 LSB TPDF window and averages to the input
+    uint32_t rng = 0x1234567u;
+    const int32_t input = (1000 << AudioBus::SHIFT) + (1 << (AudioBus::SHIFT - 2));
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        s_busTestL[i] = input;
+    }
+
+    int64_t sum = 0;
+    const uint32_t blocks = 256;
+    for (uint32_t block = 0; block < blocks; block++) {
+        AudioBus::narrowBlockDithered(s_busTestL, s_busTestOut, AUDIO_BLOCK_SAMPLES, rng);
+        for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            ASSERT_TRUE(s_busTestOut[i] >= 999 && s_busTestOut[i] <= 1001);
+            sum += s_busTestOut[i];
+        }
+    }
+
+    // Mean in 1/256 LSB: 1000.25 * 256 = 256064
+    int32_t mean = static_cast<int32_t>((sum << AudioBus::SHIFT) / (blocks * AUDIO_BLOCK_SAMPLES));
+    ASSERT_NEAR(mean, input, 8);
+}
+
+TEST(AudioBus_ApplyBus_BitExactVsReference) {
+    uint32_t rng = 0x9E3779B9u;
+    for (uint32_t pass = 0; pass < 64; pass++) {
+        for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            int32_t sample = static_cast<int32_t>(rng) >> 1;
+            int16_t gain = static_cast<int16_t>((rng >> 16) % (GainRamp::UNITY_Q15 + 1));
+            if (i == 0) { sample = INT32_MIN / 2; gain = GainRamp::UNITY_Q15; }
+            if (i == 1) { sample = INT32_MAX / 2; gain = GainRamp::UNITY_Q15; }
+            if (i == 2) { sample = -1; gain = 1; }
+            s_busTestL[i] = sample;
+            s_busTestExpected[i] = sample;
+            s_busTestGains[i] = gain;
+        }
+
+        GainRamp::applyBus(s_busTestL, s_busTestGains, AUDIO_BLOCK_SAMPLES);
+        GainRamp::applyBusReference(s_busTestExpected, s_busTestGains, AUDIO_BLOCK_SAMPLES);
+
+        for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            ASSERT_EQ(s_busTestL[i], s_busTestExpected[i]);
+        }
+    }
+}
+
+TEST(AudioBus_Performance_ChainOverhead) {
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        s_busTestIn[i] = static_cast<int16_t>(i * 251);
+    }
+
+    // Per stereo block: widen in, choke gain ramp on the bus, dithered narrow out
+    uint32_t rng = 0x6C8E9CF5u;
+    FadeEnvelope envelope;
+    const uint32_t blocks = 1000;
+    uint32_t start = ARM_DWT_CYCCNT;
+    for (uint32_t block = 0; block < blocks; block++) {
+        AudioBus::widenBlock(s_busTestIn, s_busTestL, AUDIO_BLOCK_SAMPLES);
+        AudioBus::widenBlock(s_busTestIn, s_busTestR, AUDIO_BLOCK_SAMPLES);
+        int32_t target = (block & 1) ? GainRamp::UNITY_Q15 : 0;
+        envelope.start(target, 132, FadeCurve::LINEAR);
+        envelope.render(s_busTestGains, AUDIO_BLOCK_SAMPLES);
+        GainRamp::applyBus(s_busTestL, s_busTestGains, AUDIO_BLOCK_SAMPLES);
+        GainRamp::applyBus(s_busTestR, s_busTestGains, AUDIO_BLOCK_SAMPLES);
+        AudioBus::narrowBlockDithered(s_busTestL, s_busTestOut, AUDIO_BLOCK_SAMPLES, rng);
+        AudioBus::narrowBlockDithered(s_busTestR, s_busTestOut, AUDIO_BLOCK_SAMPLES, rng);
+    }
+    uint32_t cyclesPerBlock = (ARM_DWT_CYCCNT - start) / blocks;
+
+    // Audio ISR budget: one block period of CPU cycles
+    uint32_t budget = static_cast<uint32_t>((static_cast<uint64_t>(F_CPU_ACTUAL) * AUDIO_BLOCK_SAMPLES) / Timebase::SAMPLE_RATE);
+
+    Serial.print("\nBus convert + gain + dither (stereo): ");
+    Serial.print(cyclesPerBlock);
+    Serial.print(" cycles/block (");
+    Serial.print((cyclesPerBlock * 1000) / budget);
+    Serial.println(" permille of ISR budget)");
+
+    // Conversion overhead must stay a small slice of the block budget (< 5%)
+    ASSERT_LT(cyclesPerBlock, budget / 20);
+}
@@ -0,0 +1,144 @@
+/**
+ * test_block_size.cpp - Latency vs CPU benchmark matrix across audio block sizes
+ *
+ * The build runs at one AUDIO_BLOCK_SAMPLES (MICROLOOP_BLOCK_SAMPLES), but the
+ * bus and gain kernels take a sample count, so the per-block DSP cost of
+ * 32, 64 and 128 sample blocks is measured side by side here. Fixed per-update
+ * costs (audio ISR entry, AudioStream update_all, receive/transmit) come on
+ * top - compare builds with the serial 'a' and 'p' commands for those.
+ */
+
+#include "test_runner.h"
+#include "AudioBus.h"
+#include "FadeEnvelope.h"
+#include "GainRamp.h"
+#include "TimeStretch.h"
+#include "Timebase.h"
+#include <AudioStream.h>
+
+static constexpr uint32_t MATRIX_MAX_BLOCK = 128;
+static constexpr uint32_t MATRIX_SAMPLE_RATE = Timebase::SAMPLE_RATE;
+
+static int16_t s_matrixIn[MATRIX_MAX_BLOCK] __attribute__((aligned(4)));
+static int16_t s_matrixOut[MATRIX_MAX_BLOCK] __attribute__((aligned(4)));
+static int16_t s_matrixGains[MATRIX_MAX_BLOCK] __attribute__((aligned(4)));
+static int32_t s_matrixL[MATRIX_MAX_BLOCK];
+static int32_t s_matrixR[MATRIX_MAX_BLOCK];
+
+/**
+ * Cycles for one stereo block of n samples: widen, choke gain ramp, dithered narrow
+ */
+static uint32_t matrixCyclesPerBlock(uint32_t n) {
+    uint32_t rng = 0x6C8E9CF5u;
+    FadeEnvelope envelope;
+    const uint32_t blocks = (MATRIX_MAX_BLOCK * 500) / n;  // Same audio duration for every size
+
+    uint32_t start = ARM_DWT_CYCCNT;
+    for (uint32_t block = 0; block < blocks; block++) {
+        AudioBus::widenBlock(s_matrixIn, s_matrixL, n);
+        AudioBus::widenBlock(s_matrixIn, s_matrixR, n);
+        int32_t target = (block & 1) ? GainRamp::UNITY_Q15 : 0;
+        envelope.start(target, 132, FadeCurve::LINEAR);
+        envelope.render(s_matrixGains, n);
+        GainRamp::applyBus(s_matrixL, s_matrixGains, n);
+        GainRamp::applyBus(s_matrixR, s_matrixGains, n);
+        AudioBus::narrowBlockDithered(s_matrixL, s_matrixOut, n, rng);
+        AudioBus::narrowBlockDithered(s_matrixR, s_matrixOut, n, rng);
+    }
+    return (ARM_DWT_CYCCNT - start) / blocks;
+}
+
+TEST(BlockSize_LatencyCpuMatrix) {
+    for (uint32_t i = 0; i < MATRIX_MAX_BLOCK; i++) {
+        s_matrixIn[i] = static_cast<int16_t>(i * 251);
+    }
+
+    Serial.print("\nBuilt block size: ");
+    Serial.println(AUDIO_BLOCK_SAMPLES);
+    Serial.println("Block | Period us | Round trip ms | Cycles/block | Budget % | Cycles/sample");
+
+    const uint32_t sizes[] = {32, 64, 128};
+    for (uint32_t size : sizes) {
+        uint32_t cycles = matrixCyclesPerBlock(size);
+        uint32_t budget = static_cast<uint32_t>((static_cast<uint64_t>(F_CPU_ACTUAL) * size) / MATRIX_SAMPLE_RATE);
+        uint32_t periodUs = (size * 1000000u) / MATRIX_SAMPLE_RATE;
+
+        // Round trip: I2S input block + one update period + I2S output block
+        float roundTripMs = 3.0f * size * 1000.0f / MATRIX_SAMPLE_RATE;
+
+        Serial.print(size);
+        Serial.print("   | ");
+        Serial.print(periodUs);
+        Serial.print("      | ");
+        Serial.print(roundTripMs, 2);
+        Serial.print("          | ");
+        Serial.print(cycles);
+        Serial.print("         | ");
+        Serial.print((cycles * 100.0f) / budget, 2);
+        Serial.print("     | ");
+        Serial.println(static_cast<float>(cycles) / size, 2);
+
+        // Kernel cost stays a small slice of the (shorter) block budget
+        ASSERT_LT(cycles, budget / 20);
+    }
+}
+
+// WSOLA hop is fixed; the built block size only changes how the output FIFO drains
+static constexpr uint32_t STRETCH_TEST_LOOP = 4096;
+static int16_t s_stretchLoopL[STRETCH_TEST_LOOP];
+static int16_t s_stretchLoopR[STRETCH_TEST_LOOP];
+static int16_t s_stretchOutL[AUDIO_BLOCK_SAMPLES];
+static int16_t s_stretchOutR[AUDIO_BLOCK_SAMPLES];
+
+/**
+ * Fill the test loop with uncorrelated noise (no period for the search to alias onto)
+ */
+static void fillStretchLoop() {
+    uint32_t rng = 0x2545F491u;
+    for (uint32_t i = 0; i < STRETCH_TEST_LOOP; i++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        s_stretchLoopL[i] = static_cast<int16_t>(rng);
+        s_stretchLoopR[i] = static_cast<int16_t>(rng >> 16);
+    }
+}
+
+TEST(BlockSize_TimeStretchUnityMatchesSource) {
+    // At unity every hop's best match is the exact continuation, so the output is the
+    // loop itself from the first block on (within the 1 LSB the two window halves round
+    // away), across hop boundaries, block boundaries and the loop wrap
+    fillStretchLoop();
+    static TimeStretch s_stretch;
+    uint32_t expected = STRETCH_TEST_LOOP - (3 * TimeStretch::HOP) / 2;
+    s_stretch.reset(s_stretchLoopL, s_stretchLoopR, STRETCH_TEST_LOOP, expected);
+
+    const uint32_t blocks = (2 * STRETCH_TEST_LOOP) / AUDIO_BLOCK_SAMPLES;
+    for (uint32_t b = 0; b < blocks; b++) {
+        s_stretch.process(s_stretchLoopL, s_stretchLoopR, STRETCH_TEST_LOOP, TimeStretch::RATIO_UNITY_Q16,
+                          s_stretchOutL, s_stretchOutR);
+        for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            ASSERT_NEAR(s_stretchOutL[i], s_stretchLoopL[expected], 1);
+            ASSERT_NEAR(s_stretchOutR[i], s_stretchLoopR[expected], 1);
+            if (++expected >= STRETCH_TEST_LOOP) expected = 0;
+        }
+        ASSERT_EQ(s_stretch.getPosition(), expected);
+    }
+}
+
+TEST(BlockSize_TimeStretchRatioAdvance) {
+    // One frame per HOP output samples whatever the block size: after n hops the
+    // read position has advanced n * HOP * ratio (Q16 remainder carried), wrapped
+    fillStretchLoop();
+    static TimeStretch s_stretch;
+    const uint32_t ratios[] = {0x8000, 0xC000, 0x1199A, 0x18000, 0x28000};  // 0.5, 0.75, ~1.1, 1.5, 2.5
+    const uint32_t hops = 48;
+    for (uint32_t ratio : ratios) {
+        s_stretch.reset(s_stretchLoopL, s_stretchLoopR, STRETCH_TEST_LOOP, 0);
+        for (uint32_t b = 0; b < hops * (TimeStretch::HOP / AUDIO_BLOCK_SAMPLES); b++) {
+            s_stretch.process(s_stretchLoopL, s_stretchLoopR, STRETCH_TEST_LOOP, ratio, s_stretchOutL, s_stretchOutR);
+        }
+        uint64_t advance = (static_cast<uint64_t>(hops) * TimeStretch::HOP * ratio) >> 16;
+        ASSERT_EQ(s_stretch.getPosition(), static_cast<uint32_t>(advance % STRETCH_TEST_LOOP));
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * test_dsp_profiler.cpp - Unit tests for DspProfiler statistics
+ * (Teensy: DWT cycle counter; host build: std::chrono backend)
+ */
+
+#include "test_runner.h"
+#include "DspProfiler.h"
+#include "Timebase.h"
+#include <AudioStream.h>
+
+TEST(DspProfiler_Stats_MinAvgMaxOverruns) {
+    DspProfiler::begin(AUDIO_BLOCK_SAMPLES, Timebase::SAMPLE_RATE);
+    static uint8_t s_slot = DspProfiler::registerSlot("TestA");
+    ASSERT_TRUE(s_slot != DspProfiler::INVALID_SLOT);
+    DspProfiler::reset();
+
+    uint32_t deadline = DspProfiler::getDeadlineTicks();
+    ASSERT_TRUE(deadline > 0);
+
+    // 2 blocks: 1/256 and 3/8 of the deadline, then one overrun
+    DspProfiler::record(s_slot, deadline / 256);
+    DspProfiler::endBlock();
+    DspProfiler::record(s_slot, (deadline * 3) / 8);
+    DspProfiler::endBlock();
+    DspProfiler::record(s_slot, deadline + 1);
+    DspProfiler::endBlock();
+
+    DspProfiler::Stats stats;
+    ASSERT_TRUE(DspProfiler::getStats(s_slot, stats));
+    ASSERT_EQ(stats.count, 3u);
+    ASSERT_EQ(stats.minTicks, deadline / 256);
+    ASSERT_EQ(stats.maxTicks, deadline + 1);
+    ASSERT_EQ(stats.avgTicks, (deadline / 256 + (deadline * 3) / 8 + deadline + 1) / 3);
+    ASSERT_EQ(stats.overruns, 1u);
+
+    // log2 bins: <1/128, ..., [1/4, 1/2), >=1/2
+    ASSERT_EQ(stats.histogram[0], 1u);
+    ASSERT_EQ(stats.histogram[DspProfiler::HIST_BINS - 2], 1u);
+    ASSERT_EQ(stats.histogram[DspProfiler::HIST_BINS - 1], 1u);
+
+    // Block total follows the per-block sums
+    ASSERT_TRUE(DspProfiler::getStats(DspProfiler::TOTAL_SLOT, stats));
+    ASSERT_EQ(stats.count, 3u);
+    ASSERT_EQ(stats.overruns, 1u);
+    ASSERT_EQ(DspProfiler::toPermille(deadline / 2), 500u);
+
+    DspProfiler::reset();
+    ASSERT_TRUE(DspProfiler::getStats(s_slot, stats));
+    ASSERT_EQ(stats.count, 0u);
+    ASSERT_EQ(stats.minTicks, 0u);
+
+    // Unregistered slots are ignored
+    DspProfiler::record(DspProfiler::INVALID_SLOT, 1);
+    ASSERT_FALSE(DspProfiler::getStats(DspProfiler::MAX_SLOTS, stats));
+}
+
+TEST(DspProfiler_Now_MeasuresWork) {
+    volatile uint32_t sink = 0;
+    uint32_t start = DspProfiler::now();
+    for (uint32_t i = 0; i < 10000; i++) {
+        sink = sink + i;
+    }
+    uint32_t elapsed = DspProfiler::now() - start;
+
+    // Non-zero and far below one second
+    ASSERT_TRUE(elapsed > 0);
+    ASSERT_LT(DspProfiler::ticksToNanos(elapsed), 1000000000u);
+}
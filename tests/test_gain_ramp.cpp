@@ -0,0 +1,122 @@
+/**
+ * test_gain_ramp.cpp - Unit tests and cycle benchmark for GainRamp kernels
+ */
+
+#include "test_runner.h"
+#include "AudioBus.h"
+#include "FadeEnvelope.h"
+#include "GainRamp.h"
+#include <AudioStream.h>
+
+static int16_t s_rampTestGains[AUDIO_BLOCK_SAMPLES];
+static int16_t s_rampTestL[AUDIO_BLOCK_SAMPLES];
+static int16_t s_rampTestR[AUDIO_BLOCK_SAMPLES];
+static int32_t s_rampTestBusL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_rampTestBusR[AUDIO_BLOCK_SAMPLES];
+
+/**
+ * Previous ChokeAudio float ramp (per channel), kept as the benchmark baseline
+ */
+static float floatGainRamp(int16_t* data, size_t numSamples, float currentGain, float gainIncrement) {
+    for (size_t i = 0; i < numSamples; i++) {
+        currentGain += gainIncrement;
+        if (currentGain < 0.0f) currentGain = 0.0f;
+        if (currentGain > 1.0f) currentGain = 1.0f;
+        int32_t sample = static_cast<int32_t>(data[i]) * currentGain;
+        if (sample > 32767) sample = 32767;
+        if (sample < -32768) sample = -32768;
+        data[i] = static_cast<int16_t>(sample);
+    }
+    return currentGain;
+}
+
+TEST(GainRamp_LinearFade_ExactLengthThenSettled) {
+    // Choke ramps come from FadeEnvelope: exactly 132 falling samples, then held at mute
+    FadeEnvelope envelope;
+    envelope.start(0, 132, FadeCurve::LINEAR);
+    int32_t previous = GainRamp::UNITY_Q15;
+    for (uint32_t i = 0; i < 140; i++) {
+        int16_t gain;
+        envelope.render(&gain, 1);
+        ASSERT_TRUE(gain <= previous);
+        if (i < 131) {
+            ASSERT_GT(gain, 0);
+        } else {
+            ASSERT_EQ(gain, 0);
+        }
+        previous = gain;
+    }
+    ASSERT_TRUE(envelope.isSettled());
+}
+
+TEST(GainRamp_Performance_VsFloat) {
+    const uint32_t blocks = 1000;
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        s_rampTestL[i] = static_cast<int16_t>(i * 251);
+        s_rampTestR[i] = static_cast<int16_t>(-static_cast<int32_t>(i * 199));
+    }
+
+    // Baseline: float ramp run separately for each channel
+    float floatGain = 1.0f;
+    uint32_t start = ARM_DWT_CYCCNT;
+    for (uint32_t block = 0; block < blocks; block++) {
+        float increment = ((block & 1) ? 1.0f : -1.0f) / 132.0f;
+        floatGainRamp(s_rampTestL, AUDIO_BLOCK_SAMPLES, floatGain, increment);
+        floatGain = floatGainRamp(s_rampTestR, AUDIO_BLOCK_SAMPLES, floatGain, increment);
+    }
+    uint32_t floatCycles = (ARM_DWT_CYCCNT - start) / blocks;
+
+    // Fixed point, as ChokeAudio runs it: one shared envelope ramp, applyBus per channel
+    AudioBus::widenBlock(s_rampTestL, s_rampTestBusL, AUDIO_BLOCK_SAMPLES);
+    AudioBus::widenBlock(s_rampTestR, s_rampTestBusR, AUDIO_BLOCK_SAMPLES);
+    FadeEnvelope envelope;
+    start = ARM_DWT_CYCCNT;
+    for (uint32_t block = 0; block < blocks; block++) {
+        int32_t target = (block & 1) ? GainRamp::UNITY_Q15 : 0;
+        envelope.start(target, 132, FadeCurve::LINEAR);
+        envelope.render(s_rampTestGains, AUDIO_BLOCK_SAMPLES);
+        GainRamp::applyBus(s_rampTestBusL, s_rampTestGains, AUDIO_BLOCK_SAMPLES);
+        GainRamp::applyBus(s_rampTestBusR, s_rampTestGains, AUDIO_BLOCK_SAMPLES);
+    }
+    uint32_t fixedCycles = (ARM_DWT_CYCCNT - start) / blocks;
+
+    Serial.print("\nStereo gain ramp: float ");
+    Serial.print(floatCycles);
+    Serial.print(" cycles/block, Q15 bus ");
+    Serial.print(fixedCycles);
+    Serial.println(" cycles/block");
+
+    ASSERT_LT(fixedCycles, floatCycles);
+}
+
+TEST(GainRamp_MixBus_EndpointsAndBitExact) {
+    static int32_t dry[AUDIO_BLOCK_SAMPLES];
+    static int32_t wet[AUDIO_BLOCK_SAMPLES];
+    static int32_t expected[AUDIO_BLOCK_SAMPLES];
+
+    // Full bus range on both inputs: the crossfade must not overflow
+    uint32_t rng = 0x9E3779B9u;
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        dry[i] = (i & 1) ? -(1 << 30) : static_cast<int32_t>(rng) >> 2;
+        wet[i] = (i & 1) ? (1 << 30) - 1 : -(static_cast<int32_t>(rng >> 2));
+        s_rampTestGains[i] = static_cast<int16_t>((rng >> 17) % (GainRamp::UNITY_Q15 + 1));
+        expected[i] = dry[i];
+    }
+    s_rampTestGains[0] = 0;
+    s_rampTestGains[1] = GainRamp::UNITY_Q15;
+
+    int32_t dry0 = dry[0];
+    int32_t wet1 = wet[1];
+    GainRamp::mixBus(dry, wet, s_rampTestGains, AUDIO_BLOCK_SAMPLES);
+    GainRamp::mixBusReference(expected, wet, s_rampTestGains, AUDIO_BLOCK_SAMPLES);
+
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        ASSERT_EQ(dry[i], expected[i]);
+    }
+    // Endpoints within the Q15 unity rounding (1/32768 of full scale)
+    ASSERT_NEAR(dry[0], dry0, (1 << 30) / 32768 + 2);
+    ASSERT_NEAR(dry[1], wet1, (1 << 30) / 32768 + 2);
+}
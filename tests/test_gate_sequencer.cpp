@@ -0,0 +1,59 @@
+/**
+ * test_gate_sequencer.cpp - GateSequencer steps stay on the Timebase 1/16 grid
+ */
+
+#include "test_runner.h"
+#include "GateSequencer.h"
+#include "Timebase.h"
+
+/**
+ * Is position a 1/16 boundary of the beat grid (step k ends at floor(k * spb / 4))?
+ */
+static bool onSixteenthBoundary(uint64_t position, uint32_t spb) {
+    uint32_t withinBeat = static_cast<uint32_t>(position % spb);
+    for (uint32_t k = 0; k < GateSequencer::STEPS_PER_BEAT; k++) {
+        if (withinBeat == (k * spb) / GateSequencer::STEPS_PER_BEAT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST(GateSequencer_StepsStayOnGrid) {
+    // 1/16 is not a whole number of samples at either tempo: truncated step lengths
+    // would drift a few samples a beat. The second tempo arrives mid-pattern
+    const uint32_t tempos[2] = {22051, 20003};
+    const uint32_t beatsPerTempo = 16;
+    Timebase::reset();
+    Timebase::setSamplesPerBeat(tempos[0]);
+    Timebase::incrementSamples(1000);   // Start mid-step
+
+    GateSequencer gate;
+    gate.sync();
+    uint8_t lastStep = gate.getCurrentStep();
+    uint32_t checked = 0;
+    uint32_t offGrid = 0;
+    int16_t gain;
+    for (uint32_t t = 0; t < 2; t++) {
+        Timebase::setSamplesPerBeat(tempos[t]);
+        bool settled = (t == 0);   // First boundary after a tempo change was placed at the old tempo
+        for (uint32_t i = 0; i < beatsPerTempo * tempos[t]; i++) {
+            gate.render(&gain, 1);
+            if (gate.getCurrentStep() != lastStep) {
+                lastStep = gate.getCurrentStep();
+                if (settled) {
+                    checked++;
+                    if (!onSixteenthBoundary(Timebase::getSamplePosition(), tempos[t])) {
+                        offGrid++;
+                    }
+                }
+                settled = true;
+            }
+            Timebase::incrementSamples(1);
+        }
+    }
+    Timebase::reset();
+
+    ASSERT_EQ(offGrid, 0u);
+    ASSERT_GT(checked, 2 * beatsPerTempo * GateSequencer::STEPS_PER_BEAT - 4);
+}
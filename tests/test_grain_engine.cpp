@@ -0,0 +1,64 @@
+/**
+ * test_grain_engine.cpp - Unit tests and cycle benchmark for GrainEngine
+ */
+
+#include "test_runner.h"
+#include "GrainEngine.h"
+#include "Timebase.h"
+
+static constexpr uint32_t GRAIN_TEST_SOURCE = 8192;
+static DMAMEM int16_t s_grainTestL[GRAIN_TEST_SOURCE];
+static DMAMEM int16_t s_grainTestR[GRAIN_TEST_SOURCE];
+
+TEST(GrainEngine_ConstantInput_UnityGain) {
+    for (uint32_t i = 0; i < GRAIN_TEST_SOURCE; i++) {
+        s_grainTestL[i] = 10000;
+        s_grainTestR[i] = -10000;
+    }
+
+    GrainEngine grains;
+    grains.start(s_grainTestL, s_grainTestR, GRAIN_TEST_SOURCE - 1, 0, GRAIN_TEST_SOURCE, GrainEngine::MAX_GRAINS);
+
+    // Run past several grain respawns - staggered Hann windows must sum flat
+    int16_t outL[AUDIO_BLOCK_SAMPLES];
+    int16_t outR[AUDIO_BLOCK_SAMPLES];
+    for (uint32_t block = 0; block < 64; block++) {
+        grains.process(outL, outR);
+        for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            ASSERT_NEAR(outL[i], 10000, 16);
+            ASSERT_NEAR(outR[i], -10000, 16);
+        }
+    }
+}
+
+TEST(GrainEngine_Performance_8Grains) {
+    for (uint32_t i = 0; i < GRAIN_TEST_SOURCE; i++) {
+        s_grainTestL[i] = static_cast<int16_t>((i * 37) & 0x7FFF);
+        s_grainTestR[i] = static_cast<int16_t>(-static_cast<int32_t>((i * 53) & 0x7FFF));
+    }
+
+    GrainEngine grains;
+    grains.start(s_grainTestL, s_grainTestR, GRAIN_TEST_SOURCE - 1, 0, GRAIN_TEST_SOURCE, GrainEngine::MAX_GRAINS);
+
+    int16_t outL[AUDIO_BLOCK_SAMPLES];
+    int16_t outR[AUDIO_BLOCK_SAMPLES];
+    const uint32_t blocks = 256;
+
+    uint32_t start = ARM_DWT_CYCCNT;
+    for (uint32_t block = 0; block < blocks; block++) {
+        grains.process(outL, outR);
+    }
+    uint32_t cyclesPerBlock = (ARM_DWT_CYCCNT - start) / blocks;
+
+    // Audio ISR budget: one block period of CPU cycles
+    uint32_t budget = static_cast<uint32_t>((static_cast<uint64_t>(F_CPU_ACTUAL) * AUDIO_BLOCK_SAMPLES) / Timebase::SAMPLE_RATE);
+
+    Serial.print("\n8 grains: ");
+    Serial.print(cyclesPerBlock);
+    Serial.print(" cycles/block (");
+    Serial.print((cyclesPerBlock * 1000) / budget);
+    Serial.println(" permille of ISR budget)");
+
+    // Target: < 5% of the audio ISR budget
+    ASSERT_LT(cyclesPerBlock, budget / 20);
+}
@@ -0,0 +1,105 @@
+/**
+ * test_limiter.cpp - Unit tests and cycle budget for LookaheadLimiter
+ */
+
+#include "test_runner.h"
+#include "LookaheadLimiter.h"
+#include "AudioBus.h"
+#include "Timebase.h"
+
+static LookaheadLimiter s_limiter;
+static int32_t s_limL[AUDIO_BLOCK_SAMPLES];
+static int32_t s_limR[AUDIO_BLOCK_SAMPLES];
+
+/**
+ * Fill one block with a square-ish tone at amplitude (bus units), phase continues from sampleIndex
+ */
+static void fillLimiterTone(int32_t amplitude, uint32_t sampleIndex) {
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        uint32_t phase = (sampleIndex + i) % 40;
+        int32_t value = (phase < 20) ? amplitude : -amplitude;
+        s_limL[i] = value;
+        s_limR[i] = -value / 2;
+    }
+}
+
+TEST(Limiter_QuietAudioIsDelayedOnly) {
+    s_limiter.reset();
+    const int32_t quiet = LookaheadLimiter::CEILING / 2;
+
+    // Input ramp, kept to compare against the delayed output
+    static int32_t input[3 * AUDIO_BLOCK_SAMPLES];
+    for (uint32_t i = 0; i < 3 * AUDIO_BLOCK_SAMPLES; i++) {
+        input[i] = static_cast<int32_t>((i * 7919u) % 2000u) * (quiet / 1000) - quiet;
+    }
+
+    for (uint32_t block = 0; block < 3; block++) {
+        for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            s_limL[i] = input[block * AUDIO_BLOCK_SAMPLES + i];
+            s_limR[i] = -s_limL[i];
+        }
+        s_limiter.process(s_limL, s_limR);
+
+        for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            int32_t t = static_cast<int32_t>(block * AUDIO_BLOCK_SAMPLES + i) -
+                        static_cast<int32_t>(LookaheadLimiter::DELAY_SAMPLES);
+            int32_t expected = (t >= 0) ? input[t] : 0;
+            ASSERT_EQ(s_limL[i], expected);
+            ASSERT_EQ(s_limR[i], -expected);
+        }
+    }
+    ASSERT_EQ(s_limiter.getGain(), LookaheadLimiter::UNITY_Q31);
+    ASSERT_EQ(s_limiter.takeMinGain(), LookaheadLimiter::UNITY_Q31);
+}
+
+TEST(Limiter_LoudBurstsStayUnderCeiling) {
+    s_limiter.reset();
+    const int32_t loud = LookaheadLimiter::CEILING * 4;   // +12 dB over the ceiling
+
+    uint32_t sampleIndex = 0;
+    for (uint32_t block = 0; block < 200; block++) {
+        // Bursts on and off so attack and release both run
+        int32_t amplitude = ((block / 10) & 1) ? loud : LookaheadLimiter::CEILING / 4;
+        fillLimiterTone(amplitude, sampleIndex);
+        s_limiter.process(s_limL, s_limR);
+        sampleIndex += AUDIO_BLOCK_SAMPLES;
+
+        for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            ASSERT_TRUE(s_limL[i] <= LookaheadLimiter::CEILING && s_limL[i] >= -LookaheadLimiter::CEILING);
+            ASSERT_TRUE(s_limR[i] <= LookaheadLimiter::CEILING && s_limR[i] >= -LookaheadLimiter::CEILING);
+        }
+    }
+
+    // About -12 dB of reduction was needed
+    int32_t minGain = s_limiter.takeMinGain();
+    ASSERT_TRUE(minGain < LookaheadLimiter::UNITY_Q31 / 4 + LookaheadLimiter::UNITY_Q31 / 100);
+    ASSERT_TRUE(minGain > LookaheadLimiter::UNITY_Q31 / 5);
+}
+
+TEST(Limiter_CycleBudget) {
+    s_limiter.reset();
+    const uint32_t blocks = 1000;
+    const int32_t loud = LookaheadLimiter::CEILING * 2;
+
+    // Worst case: limiting throughout (attack/release and the multiply on every sample)
+    uint32_t cycles = 0;
+    uint32_t sampleIndex = 0;
+    for (uint32_t block = 0; block < blocks; block++) {
+        fillLimiterTone((block & 1) ? loud : loud / 3, sampleIndex);
+        sampleIndex += AUDIO_BLOCK_SAMPLES;
+        uint32_t start = ARM_DWT_CYCCNT;
+        s_limiter.process(s_limL, s_limR);
+        cycles += ARM_DWT_CYCCNT - start;
+    }
+    cycles /= blocks;
+
+    uint32_t budget = static_cast<uint32_t>((static_cast<uint64_t>(F_CPU_ACTUAL) * AUDIO_BLOCK_SAMPLES) /
+                                            Timebase::SAMPLE_RATE);
+    Serial.print("\nLimiter: ");
+    Serial.print(cycles);
+    Serial.print(" cycles/block (");
+    Serial.print((cycles * 100.0f) / budget, 2);
+    Serial.println("% CPU)");
+
+    ASSERT_LT(cycles, budget * 3 / 100);
+}
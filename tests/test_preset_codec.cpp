@@ -0,0 +1,169 @@
+/**
+ * test_preset_codec.cpp - PresetCodec round trips, corrupt frames, ratio and decode speed
+ */
+
+#include "test_runner.h"
+#include "PresetCodec.h"
+#include "Timebase.h"
+#include <math.h>
+
+static constexpr uint32_t CODEC_TEST_SAMPLES = 8 * PRESET_FRAME_SAMPLES + 37;   // Short last frame
+static int16_t s_codecL[CODEC_TEST_SAMPLES];
+static int16_t s_codecR[CODEC_TEST_SAMPLES];
+static int16_t s_decodedL[CODEC_TEST_SAMPLES];
+static int16_t s_decodedR[CODEC_TEST_SAMPLES];
+static uint8_t s_coded[(CODEC_TEST_SAMPLES / PRESET_FRAME_SAMPLES + 1) * PRESET_MAX_FRAME_BYTES];
+static PresetEncoder s_encoder;
+static PresetDecoder s_decoder;
+
+/**
+ * Loop-like test audio: two detuned partials with a little noise, a full-scale
+ * square burst, a silent stretch and a white noise burst (stored verbatim)
+ */
+static void fillCodecSignal() {
+    uint32_t noise = 0x12345678;
+    for (uint32_t i = 0; i < CODEC_TEST_SAMPLES; i++) {
+        noise ^= noise << 13;
+        noise ^= noise >> 17;
+        noise ^= noise << 5;
+        int32_t dither = static_cast<int32_t>(noise >> 28) - 8;
+        float t = static_cast<float>(i) / Timebase::SAMPLE_RATE;
+        int32_t left = static_cast<int32_t>(12000.0f * sinf(2.0f * 3.14159265f * 220.0f * t) +
+                                            3000.0f * sinf(2.0f * 3.14159265f * 661.0f * t)) + dither;
+        int32_t right = static_cast<int32_t>(11000.0f * sinf(2.0f * 3.14159265f * 221.0f * t)) - dither;
+
+        if (i >= 2 * PRESET_FRAME_SAMPLES && i < 2 * PRESET_FRAME_SAMPLES + 300) {
+            left = (i & 8) ? INT16_MAX : INT16_MIN;            // Extremes: side spans 17 bits
+            right = -left - 1;
+        } else if (i >= 4 * PRESET_FRAME_SAMPLES && i < 5 * PRESET_FRAME_SAMPLES) {
+            left = 0;
+            right = 0;
+        } else if (i >= 6 * PRESET_FRAME_SAMPLES && i < 7 * PRESET_FRAME_SAMPLES) {
+            left = static_cast<int16_t>(noise);
+            right = static_cast<int16_t>(noise >> 16);
+        }
+        s_codecL[i] = static_cast<int16_t>(left);
+        s_codecR[i] = static_cast<int16_t>(right);
+    }
+}
+
+static size_t encodeCodecSignal(PresetCodec codec) {
+    s_encoder.begin(codec);
+    size_t coded = 0;
+    for (uint32_t start = 0; start < CODEC_TEST_SAMPLES; start += PRESET_FRAME_SAMPLES) {
+        uint32_t n = min(PRESET_FRAME_SAMPLES, CODEC_TEST_SAMPLES - start);
+        size_t bytes = s_encoder.encodeFrame(s_codecL + start, s_codecR + start, n, s_coded + coded);
+        if (bytes > PRESET_MAX_FRAME_BYTES) {
+            return 0;
+        }
+        coded += bytes;
+    }
+    return coded;
+}
+
+/**
+ * Decode the whole stream frame by frame, false on any rejected or misframed frame
+ */
+static bool decodeCodecSignal(PresetCodec codec, size_t coded) {
+    s_decoder.begin(codec);
+    size_t offset = 0;
+    for (uint32_t start = 0; start < CODEC_TEST_SAMPLES; start += PRESET_FRAME_SAMPLES) {
+        uint32_t n = min(PRESET_FRAME_SAMPLES, CODEC_TEST_SAMPLES - start);
+        size_t bytes = PresetDecoder::frameBytes(s_coded + offset, coded - offset);
+        if (bytes == 0 || bytes > coded - offset ||
+            !s_decoder.decodeFrame(s_coded + offset, bytes, s_decodedL + start, s_decodedR + start, n)) {
+            return false;
+        }
+        offset += bytes;
+    }
+    return offset == coded;
+}
+
+TEST(PresetCodec_LosslessRoundTrip) {
+    fillCodecSignal();
+    size_t coded = encodeCodecSignal(PresetCodec::LOSSLESS);
+    ASSERT_GT(coded, 0u);
+    ASSERT_LT(coded, CODEC_TEST_SAMPLES * 2 * sizeof(int16_t));
+
+    ASSERT_TRUE(decodeCodecSignal(PresetCodec::LOSSLESS, coded));
+    ASSERT_EQ(memcmp(s_codecL, s_decodedL, sizeof(s_codecL)), 0);
+    ASSERT_EQ(memcmp(s_codecR, s_decodedR, sizeof(s_codecR)), 0);
+}
+
+TEST(PresetCodec_AdpcmRoundTrip) {
+    fillCodecSignal();
+    size_t coded = encodeCodecSignal(PresetCodec::ADPCM);
+    ASSERT_LT(coded * 3, CODEC_TEST_SAMPLES * 2 * sizeof(int16_t));   // Better than 3:1
+    ASSERT_TRUE(decodeCodecSignal(PresetCodec::ADPCM, coded));
+
+    // Lossy: check the signal-to-error ratio over the tonal part
+    float signal = 0.0f;
+    float error = 0.0f;
+    for (uint32_t i = 0; i < 2 * PRESET_FRAME_SAMPLES; i++) {
+        float l = s_codecL[i];
+        float r = s_codecR[i];
+        float dl = l - s_decodedL[i];
+        float dr = r - s_decodedR[i];
+        signal += l * l + r * r;
+        error += dl * dl + dr * dr;
+    }
+    ASSERT_GT(signal, error * 1000.0f);   // > 30 dB
+    ASSERT_EQ(s_decodedL[0], s_codecL[0]);  // Frame starts are exact
+}
+
+TEST(PresetCodec_CorruptFramesRejected) {
+    fillCodecSignal();
+    size_t coded = encodeCodecSignal(PresetCodec::LOSSLESS);
+    size_t first = PresetDecoder::frameBytes(s_coded, coded);
+    ASSERT_GT(first, PRESET_FRAME_HEADER_BYTES);
+    ASSERT_EQ(PresetDecoder::frameBytes(s_coded, PRESET_FRAME_HEADER_BYTES - 1), 0u);
+
+    // Rice frame cut short: the reader runs past the payload
+    s_decoder.begin(PresetCodec::LOSSLESS);
+    uint8_t frame[PRESET_MAX_FRAME_BYTES];
+    memcpy(frame, s_coded, first);
+    size_t shortPayload = (first - PRESET_FRAME_HEADER_BYTES) / 2;
+    frame[0] = static_cast<uint8_t>(shortPayload);
+    frame[1] = static_cast<uint8_t>(shortPayload >> 8);
+    ASSERT_FALSE(s_decoder.decodeFrame(frame, PRESET_FRAME_HEADER_BYTES + shortPayload,
+                                       s_decodedL, s_decodedR, PRESET_FRAME_SAMPLES));
+
+    // Unknown frame type, and a frame from the other codec
+    memcpy(frame, s_coded, first);
+    frame[2] = 7;
+    ASSERT_FALSE(s_decoder.decodeFrame(frame, first, s_decodedL, s_decodedR, PRESET_FRAME_SAMPLES));
+    s_decoder.begin(PresetCodec::ADPCM);
+    ASSERT_FALSE(s_decoder.decodeFrame(s_coded, first, s_decodedL, s_decodedR, PRESET_FRAME_SAMPLES));
+}
+
+TEST(PresetCodec_RatioAndDecodeSpeed) {
+    fillCodecSignal();
+    const uint32_t pcmBytes = CODEC_TEST_SAMPLES * 2 * sizeof(int16_t);
+    const uint32_t passes = 20;
+    PresetCodec codecs[2] = {PresetCodec::LOSSLESS, PresetCodec::ADPCM};
+    const char* names[2] = {"\nLossless: ", "ADPCM:    "};
+
+    for (uint32_t c = 0; c < 2; c++) {
+        size_t coded = encodeCodecSignal(codecs[c]);
+        uint32_t cycles = 0;
+        for (uint32_t pass = 0; pass < passes; pass++) {
+            uint32_t start = ARM_DWT_CYCCNT;
+            bool ok = decodeCodecSignal(codecs[c], coded);
+            cycles += ARM_DWT_CYCCNT - start;
+            ASSERT_TRUE(ok);
+        }
+
+        // Real time would be one pass per CODEC_TEST_SAMPLES of audio
+        float seconds = static_cast<float>(cycles) / F_CPU_ACTUAL;
+        float realtimeSeconds = static_cast<float>(passes) * CODEC_TEST_SAMPLES / Timebase::SAMPLE_RATE;
+        Serial.print(names[c]);
+        Serial.print(static_cast<float>(pcmBytes) / coded, 2);
+        Serial.print(":1, decode ");
+        Serial.print((static_cast<float>(pcmBytes) * passes / 1e6f) / seconds, 1);
+        Serial.print(" MB/s (");
+        Serial.print(realtimeSeconds / seconds, 0);
+        Serial.println("x real time)");
+
+        ASSERT_LT(seconds * 20.0f, realtimeSeconds);   // Far ahead of playback
+    }
+}
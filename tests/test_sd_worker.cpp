@@ -0,0 +1,346 @@
+/**
+ * test_sd_worker.cpp - SdWorker queues, callbacks and MIDI tick latency
+ *
+ * Runs the worker against a RAM stub of the preset storage (no SD card needed).
+ * The stub waits CHUNK_LATENCY_US per chunk like a card does. The tick latency
+ * test times each worker call during a streaming load: a tick waits for at most
+ * one call (a burst of chunks), where threads.stop() held ticks back for the
+ * whole transfer.
+ * The streaming test checks a load is playable (READY) before it completes.
+ */
+
+#include "test_runner.h"
+#include "SdWorker.h"
+
+using SdCardStorage::SdResult;
+
+/**
+ * Preset storage in RAM: one file, chunked like the SD card
+ */
+class RamPresetStorage : public SdCardStorage::IPresetStorage {
+public:
+    static constexpr uint32_t MAX_SAMPLES = 4096;
+    static constexpr uint32_t CHUNK_LATENCY_US = 200;   // Simulated card time per chunk
+    static constexpr uint32_t CHUNK_BYTES = 512;        // Smaller than the card's, so a short loop still takes many steps
+
+    SdResult beginSave(uint8_t slot, const int16_t* bufferL, const int16_t* bufferR,
+                       uint32_t length, const SdCardStorage::PresetInfo& info) override {
+        if (length == 0 || length > MAX_SAMPLES) {
+            return SdResult::ERROR_INVALID_LENGTH;
+        }
+        m_fileSlot = 0;  // Replaced on success
+        m_pendingSlot = slot;
+        m_pendingInfo = info;
+        start(true, const_cast<int16_t*>(bufferL), const_cast<int16_t*>(bufferR), length);
+        return SdResult::SUCCESS;
+    }
+
+    SdResult beginLoad(uint8_t slot, int16_t* bufferL, int16_t* bufferR,
+                       uint32_t& outLength, SdCardStorage::PresetInfo& outInfo) override {
+        if (slot != m_fileSlot) {
+            return SdResult::ERROR_FILE_NOT_FOUND;
+        }
+        outLength = m_fileLength;
+        outInfo = m_fileInfo;
+        start(false, bufferL, bufferR, m_fileLength);
+        return SdResult::SUCCESS;
+    }
+
+    SdResult step(bool& done) override {
+        // Saves write L then R, loads alternate channels (like the card)
+        uint32_t channel = m_saving ? ((m_channelDone[0] >= m_channelBytes) ? 1 : 0)
+                                    : ((m_channelDone[0] > m_channelDone[1]) ? 1 : 0);
+        uint32_t offset = m_channelDone[channel];
+        uint32_t chunk = m_channelBytes - offset;
+        if (chunk > CHUNK_BYTES) chunk = CHUNK_BYTES;
+
+        uint8_t* file = reinterpret_cast<uint8_t*>(m_file) + channel * m_channelBytes + offset;
+        uint8_t* buffer = reinterpret_cast<uint8_t*>(m_buffers[channel]) + offset;
+        if (m_saving) {
+            memcpy(file, buffer, chunk);
+        } else {
+            memcpy(buffer, file, chunk);
+        }
+        delayMicroseconds(CHUNK_LATENCY_US);
+
+        m_channelDone[channel] += chunk;
+        m_steps++;
+        done = (getBytesDone() == getBytesTotal());
+        if (done && m_saving) {
+            m_fileSlot = m_pendingSlot;
+            m_fileLength = m_channelBytes / sizeof(int16_t);
+            m_fileInfo = m_pendingInfo;
+        }
+        return SdResult::SUCCESS;
+    }
+
+    void abort() override {}
+
+    SdResult remove(uint8_t slot) override {
+        if (slot == m_fileSlot) {
+            m_fileSlot = 0;
+        }
+        return SdResult::SUCCESS;
+    }
+
+    uint32_t getBytesDone() const override { return m_channelDone[0] + m_channelDone[1]; }
+    uint32_t getBytesTotal() const override { return m_channelBytes * 2; }
+    uint32_t getResidentSamples() const override {
+        uint32_t bytes = (m_channelDone[0] < m_channelDone[1]) ? m_channelDone[0] : m_channelDone[1];
+        return bytes / sizeof(int16_t);
+    }
+
+    uint32_t getSteps() const { return m_steps; }   // Chunks moved since construction
+
+private:
+    void start(bool saving, int16_t* bufferL, int16_t* bufferR, uint32_t length) {
+        m_saving = saving;
+        m_buffers[0] = bufferL;
+        m_buffers[1] = bufferR;
+        m_channelBytes = length * sizeof(int16_t);
+        m_channelDone[0] = 0;
+        m_channelDone[1] = 0;
+    }
+
+    int16_t m_file[2 * MAX_SAMPLES];   // [L][R], like the preset file body
+    uint8_t m_fileSlot = 0;            // 0 = no file
+    uint32_t m_fileLength = 0;
+    SdCardStorage::PresetInfo m_fileInfo;
+    uint8_t m_pendingSlot = 0;
+    SdCardStorage::PresetInfo m_pendingInfo;
+
+    bool m_saving = false;
+    int16_t* m_buffers[2] = {nullptr, nullptr};
+    uint32_t m_channelBytes = 0;
+    uint32_t m_channelDone[2] = {0, 0};
+    uint32_t m_steps = 0;
+};
+
+static RamPresetStorage s_ramStorage;
+static int16_t s_sdSrcL[RamPresetStorage::MAX_SAMPLES];
+static int16_t s_sdSrcR[RamPresetStorage::MAX_SAMPLES];
+static int16_t s_sdDstL[RamPresetStorage::MAX_SAMPLES];
+static int16_t s_sdDstR[RamPresetStorage::MAX_SAMPLES];
+
+// Callback bookkeeping
+static uint32_t s_sdProgressEvents = 0;
+static uint8_t s_sdLastPercent = 0;
+static bool s_sdProgressMonotonic = true;
+static uint32_t s_sdCompleteEvents = 0;
+static SdEvent s_sdLastComplete;
+static uint32_t s_sdReadyEvents = 0;
+static uint32_t s_sdReadyBeforeComplete = 0;   // READY events seen while no completion was
+static SdEvent s_sdLastReady;
+
+static void onTestProgress(void* context, const SdEvent& event) {
+    (void)context;
+    if (event.percent < s_sdLastPercent) {
+        s_sdProgressMonotonic = false;
+    }
+    s_sdLastPercent = event.percent;
+    s_sdProgressEvents++;
+}
+
+static void onTestComplete(void* context, const SdEvent& event) {
+    (void)context;
+    s_sdLastComplete = event;
+    s_sdCompleteEvents++;
+}
+
+static void onTestReady(void* context, const SdEvent& event) {
+    (void)context;
+    s_sdLastReady = event;
+    s_sdReadyEvents++;
+    if (s_sdCompleteEvents == 0) {
+        s_sdReadyBeforeComplete++;
+    }
+}
+
+static void resetSdCallbacks() {
+    s_sdReadyEvents = 0;
+    s_sdReadyBeforeComplete = 0;
+    SdWorker::setReadyCallback(onTestReady);
+    s_sdProgressEvents = 0;
+    s_sdLastPercent = 0;
+    s_sdProgressMonotonic = true;
+    s_sdCompleteEvents = 0;
+    SdWorker::begin(s_ramStorage);
+    SdWorker::setCallbacks(onTestProgress, onTestComplete, nullptr);
+}
+
+static SdRequest makeSdRequest(SdRequestType type, uint8_t slot, int16_t* bufferL, int16_t* bufferR,
+                               uint32_t length) {
+    SdRequest request;
+    memset(&request, 0, sizeof(request));
+    request.type = type;
+    request.slot = slot;
+    request.bufferL = bufferL;
+    request.bufferR = bufferR;
+    request.length = length;
+    return request;
+}
+
+/**
+ * Run the worker (as its thread would) until the queued requests are dispatched
+ */
+static void runSdWorker() {
+    for (uint32_t i = 0; i < 100000 && SdWorker::isBusy(); i++) {
+        SdWorker::service();
+        SdWorker::dispatchEvents();
+    }
+}
+
+TEST(SdWorker_SaveLoadDeleteRoundTrip) {
+    resetSdCallbacks();
+    const uint32_t length = RamPresetStorage::MAX_SAMPLES;
+    for (uint32_t i = 0; i < length; i++) {
+        s_sdSrcL[i] = static_cast<int16_t>(i * 7);
+        s_sdSrcR[i] = static_cast<int16_t>(-static_cast<int32_t>(i) * 3);
+    }
+
+    // Save: progress in steps, then one completion
+    SdRequest save = makeSdRequest(SdRequestType::SAVE, 2, s_sdSrcL, s_sdSrcR, length);
+    save.info.captureSamplesPerBeat = 22050;
+    ASSERT_TRUE(SdWorker::submit(save));
+    ASSERT_TRUE(SdWorker::isBusy());
+    runSdWorker();
+    ASSERT_FALSE(SdWorker::isBusy());
+    ASSERT_EQ(s_sdCompleteEvents, 1u);
+    ASSERT_TRUE(s_sdLastComplete.result == SdResult::SUCCESS);
+    ASSERT_EQ(s_sdLastComplete.slot, 2);
+    ASSERT_EQ(s_sdLastComplete.percent, 100);
+    ASSERT_TRUE(s_sdProgressEvents >= 100 / SdWorker::PROGRESS_STEP_PERCENT - 1);
+    ASSERT_TRUE(s_sdProgressMonotonic);
+
+    // Load into other buffers: same audio and settings back
+    resetSdCallbacks();
+    ASSERT_TRUE(SdWorker::submit(makeSdRequest(SdRequestType::LOAD, 2, s_sdDstL, s_sdDstR, 0)));
+    runSdWorker();
+    ASSERT_EQ(s_sdCompleteEvents, 1u);
+    ASSERT_TRUE(s_sdLastComplete.result == SdResult::SUCCESS);
+    ASSERT_EQ(s_sdLastComplete.length, length);
+    ASSERT_EQ(s_sdLastComplete.info.captureSamplesPerBeat, 22050u);
+    ASSERT_EQ(memcmp(s_sdSrcL, s_sdDstL, sizeof(s_sdSrcL)), 0);
+    ASSERT_EQ(memcmp(s_sdSrcR, s_sdDstR, sizeof(s_sdSrcR)), 0);
+
+    // Delete, then a load of that slot fails with no audio
+    resetSdCallbacks();
+    ASSERT_TRUE(SdWorker::submit(makeSdRequest(SdRequestType::DELETE, 2, nullptr, nullptr, 0)));
+    ASSERT_TRUE(SdWorker::submit(makeSdRequest(SdRequestType::LOAD, 2, s_sdDstL, s_sdDstR, 0)));
+    runSdWorker();
+    ASSERT_EQ(s_sdCompleteEvents, 2u);
+    ASSERT_TRUE(s_sdLastComplete.request == SdRequestType::LOAD);
+    ASSERT_TRUE(s_sdLastComplete.result == SdResult::ERROR_FILE_NOT_FOUND);
+    ASSERT_EQ(s_sdLastComplete.length, 0u);
+}
+
+// ========== MIDI TICK LATENCY ==========
+// threadLoop() yields after every service() call, so a MIDI tick that arrives
+// mid-transfer waits for at most the one call in progress. The test times every
+// call of a streaming load with playback caught up to the loaded edge (each call
+// a full burst) - that longest call is the tick latency the worker adds.
+// Besides the stub's simulated card time, a call only copies one chunk
+static constexpr uint32_t TEST_CHUNK_OVERHEAD_US = 100;
+
+TEST(SdWorker_TickLatency) {
+    resetSdCallbacks();
+    const uint32_t length = RamPresetStorage::MAX_SAMPLES;
+    ASSERT_TRUE(SdWorker::submit(makeSdRequest(SdRequestType::SAVE, 1, s_sdSrcL, s_sdSrcR, length)));
+    runSdWorker();
+    ASSERT_TRUE(s_sdLastComplete.result == SdResult::SUCCESS);
+
+    resetSdCallbacks();
+    volatile uint32_t resident = 0;
+    volatile uint32_t readHead = 0;
+    SdRequest load = makeSdRequest(SdRequestType::LOAD, 1, s_sdDstL, s_sdDstR, 0);
+    load.residentSamples = &resident;
+    load.readHead = &readHead;
+    ASSERT_TRUE(SdWorker::submit(load));
+
+    uint32_t calls = 0;
+    uint32_t maxCall = 0;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < 100000 && SdWorker::isBusy(); i++) {
+        readHead = resident;   // Playback right behind the load
+        uint32_t callStart = micros();
+        SdWorker::service();
+        uint32_t call = micros() - callStart;
+        if (call > maxCall) maxCall = call;
+        calls++;
+        SdWorker::dispatchEvents();   // The App thread's turn
+    }
+    uint32_t total = micros() - start;   // What threads.stop() held every tick back by
+
+    Serial.print("\nSD worker: ");
+    Serial.print(calls);
+    Serial.print(" worker calls during a ");
+    Serial.print(total);
+    Serial.print(" us streaming load; max tick delay ");
+    Serial.print(maxCall);
+    Serial.println(" us (was the whole transfer)");
+
+    ASSERT_EQ(s_sdCompleteEvents, 1u);
+    ASSERT_TRUE(s_sdLastComplete.result == SdResult::SUCCESS);
+    ASSERT_EQ(memcmp(s_sdSrcL, s_sdDstL, sizeof(s_sdSrcL)), 0);
+    // One burst of chunks, not the transfer
+    ASSERT_LT(maxCall, SdWorker::STREAM_BURST_CHUNKS *
+                           (RamPresetStorage::CHUNK_LATENCY_US + TEST_CHUNK_OVERHEAD_US));
+    ASSERT_LT(maxCall * 8, total);
+}
+
+TEST(SdWorker_StreamingLoad) {
+    resetSdCallbacks();
+    const uint32_t length = RamPresetStorage::MAX_SAMPLES;
+    for (uint32_t i = 0; i < length; i++) {
+        s_sdSrcL[i] = static_cast<int16_t>(i * 5 + 1);
+        s_sdSrcR[i] = static_cast<int16_t>(-static_cast<int32_t>(i) * 9);
+    }
+    ASSERT_TRUE(SdWorker::submit(makeSdRequest(SdRequestType::SAVE, 3, s_sdSrcL, s_sdSrcR, length)));
+    runSdWorker();
+    ASSERT_TRUE(s_sdLastComplete.result == SdResult::SUCCESS);
+
+    // Streaming load: read head parked at the loop start, as playback would be
+    resetSdCallbacks();
+    memset(s_sdDstL, 0, sizeof(s_sdDstL));
+    memset(s_sdDstR, 0, sizeof(s_sdDstR));
+    volatile uint32_t resident = 0;
+    volatile uint32_t readHead = 0;
+    SdRequest load = makeSdRequest(SdRequestType::LOAD, 3, s_sdDstL, s_sdDstR, 0);
+    load.residentSamples = &resident;
+    load.readHead = &readHead;
+    ASSERT_TRUE(SdWorker::submit(load));
+
+    // Run until READY: the loop start is resident in both channels, the rest isn't yet
+    for (uint32_t i = 0; i < 100000 && s_sdReadyEvents == 0 && SdWorker::isBusy(); i++) {
+        SdWorker::service();
+        SdWorker::dispatchEvents();
+    }
+    ASSERT_EQ(s_sdReadyEvents, 1u);
+    ASSERT_EQ(s_sdCompleteEvents, 0u);
+    ASSERT_EQ(s_sdLastReady.length, length);
+    ASSERT_TRUE(s_sdLastReady.percent < 100);
+    uint32_t readyResident = resident;
+    ASSERT_TRUE(readyResident >= SdWorker::STREAM_START_SAMPLES || readyResident == length);
+    ASSERT_EQ(memcmp(s_sdSrcL, s_sdDstL, readyResident * sizeof(int16_t)), 0);
+    ASSERT_EQ(memcmp(s_sdSrcR, s_sdDstR, readyResident * sizeof(int16_t)), 0);
+    ASSERT_TRUE(readyResident == length || s_sdDstR[length - 1] == 0);
+
+    // Read head caught up with the load: one service() moves a burst of chunks
+    if (readyResident < length) {
+        readHead = resident;
+        uint32_t stepsBefore = s_ramStorage.getSteps();
+        SdWorker::service();
+        uint32_t burst = s_ramStorage.getSteps() - stepsBefore;
+        ASSERT_TRUE(burst > 1);
+        ASSERT_TRUE(burst <= SdWorker::STREAM_BURST_CHUNKS);
+        ASSERT_TRUE(resident > readyResident);
+    }
+
+    runSdWorker();
+    ASSERT_EQ(s_sdCompleteEvents, 1u);
+    ASSERT_EQ(s_sdReadyBeforeComplete, 1u);
+    ASSERT_TRUE(s_sdLastComplete.result == SdResult::SUCCESS);
+    ASSERT_EQ(resident, length);
+    ASSERT_EQ(memcmp(s_sdSrcL, s_sdDstL, sizeof(s_sdSrcL)), 0);
+    ASSERT_EQ(memcmp(s_sdSrcR, s_sdDstR, sizeof(s_sdSrcR)), 0);
+}
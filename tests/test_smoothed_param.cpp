@@ -0,0 +1,61 @@
+/**
+ * test_smoothed_param.cpp - Unit tests for SmoothedParam ramps
+ */
+
+#include "test_runner.h"
+#include "SmoothedParam.h"
+#include "Timebase.h"
+
+TEST(SmoothedParam_LinearRampHasFixedLength) {
+    const uint32_t rampSamples = Timebase::msToSamples(SmoothedParam::DEFAULT_TIME_MS);
+    SmoothedParam param(100.0f, 100.0f, SmoothingMode::LINEAR, SmoothedParam::DEFAULT_TIME_MS);
+    ASSERT_TRUE(param.isSettledAt(GainRamp::UNITY_Q15));
+
+    // Small and large changes both take the configured time (within one block)
+    const float targets[2] = {90.0f, 0.0f};
+    for (uint8_t t = 0; t < 2; t++) {
+        param.setTarget(targets[t]);
+        ASSERT_FALSE(param.isSettled());
+
+        int32_t previous = param.getCurrent();
+        uint32_t samples = 0;
+        while (!param.isSettled() && samples < 10 * rampSamples) {
+            const int16_t* ramp = param.render();
+            for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+                ASSERT_TRUE(ramp[i] <= previous);  // Falling, never overshoots
+                previous = ramp[i];
+            }
+            samples += AUDIO_BLOCK_SAMPLES;
+        }
+        ASSERT_NEAR(samples, rampSamples, AUDIO_BLOCK_SAMPLES);
+    }
+    ASSERT_EQ(param.getCurrent(), 0);
+    ASSERT_NEAR(param.getTarget(), 0.0f, 0.01f);
+}
+
+TEST(SmoothedParam_OnePoleLandsExactly) {
+    SmoothedParam param(1.0f, 0.0f, SmoothingMode::ONE_POLE, 5);
+    const uint32_t tau = Timebase::msToSamples(5);
+
+    param.setTarget(1.0f);
+    const int16_t* ramp = param.render();
+    ASSERT_GT(ramp[0], 0);
+    ASSERT_LT(ramp[AUDIO_BLOCK_SAMPLES - 1], GainRamp::UNITY_Q15);
+
+    // Reaches the target exactly (no endless approach) within ~12 time constants
+    uint32_t samples = AUDIO_BLOCK_SAMPLES;
+    while (!param.isSettled() && samples < 20 * tau) {
+        param.render();
+        samples += AUDIO_BLOCK_SAMPLES;
+    }
+    ASSERT_TRUE(param.isSettledAt(GainRamp::UNITY_Q15));
+    ASSERT_LT(samples, 12 * tau + AUDIO_BLOCK_SAMPLES);
+
+    // Falling ramps land too; settle() jumps without rendering
+    param.setTarget(0.25f);
+    param.settle();
+    ASSERT_TRUE(param.isSettledAt(8192));
+    ramp = param.render();
+    ASSERT_EQ(ramp[0], 8192);
+    ASSERT_EQ(ramp[AUDIO_BLOCK_SAMPLES - 1], 8192);
+}
@@ -0,0 +1,65 @@
+/**
+ * test_timebase.cpp - Unit tests for rate-generic tempo math
+ * (pure integer math, checked against all three supported rates on-device)
+ */
+
+#include "test_runner.h"
+#include "Timebase.h"
+
+static constexpr uint32_t s_testRates[] = {44100, 48000, 96000};
+
+/**
+ * MIDI tick period for an integer BPM in Q8 microseconds, rounded to nearest
+ */
+static uint32_t tickPeriodQ8ForBpm(uint32_t bpm) {
+    uint64_t twice = (60000000ULL << (Timebase::TICK_PERIOD_FRAC_BITS + 1)) / (bpm * Timebase::MIDI_PPQN);
+    return static_cast<uint32_t>((twice + 1) / 2);
+}
+
+TEST(Timebase_TempoExact_AllRates) {
+    // Every integer BPM at every supported rate lands on a nearest integer of rate * 60 / bpm
+    // (exactly rate * 60 / bpm whenever that is whole, e.g. 22050 / 24000 / 48000 at 120 BPM)
+    for (uint32_t rate : s_testRates) {
+        for (uint32_t bpm = Timebase::MIN_BPM; bpm <= Timebase::MAX_BPM; bpm++) {
+            uint32_t spb = Timebase::samplesPerBeatFromTick(tickPeriodQ8ForBpm(bpm), rate);
+            int64_t error = static_cast<int64_t>(spb) * bpm - static_cast<int64_t>(rate) * 60;
+            if (error < 0) error = -error;
+            ASSERT_TRUE(2 * error <= static_cast<int64_t>(bpm));
+        }
+        ASSERT_EQ(Timebase::samplesPerBeatFromTick(tickPeriodQ8ForBpm(120), rate), rate / 2);
+    }
+}
+
+TEST(Timebase_DerivedConstants_FollowRate) {
+    static_assert(Timebase::msToSamples(3, 44100) == 132, "3ms @ 44.1kHz");
+    static_assert(Timebase::msToSamples(3, 48000) == 144, "3ms @ 48kHz");
+    static_assert(Timebase::msToSamples(1000, 96000) == 96000, "1s @ 96kHz");
+
+    ASSERT_EQ(Timebase::msToSamples(1000), Timebase::SAMPLE_RATE);
+    ASSERT_EQ(Timebase::MIN_SAMPLES_PER_BEAT, (Timebase::SAMPLE_RATE * 60) / Timebase::MAX_BPM);
+    ASSERT_EQ(Timebase::MAX_SAMPLES_PER_BEAT, (Timebase::SAMPLE_RATE * 60) / Timebase::MIN_BPM);
+
+    // App's tick filter spans the whole tempo range
+    ASSERT_TRUE(tickPeriodQ8ForBpm(Timebase::MAX_BPM) >= (Timebase::MIN_TICK_PERIOD_US << Timebase::TICK_PERIOD_FRAC_BITS));
+    ASSERT_TRUE(tickPeriodQ8ForBpm(Timebase::MIN_BPM) <= (Timebase::MAX_TICK_PERIOD_US << Timebase::TICK_PERIOD_FRAC_BITS));
+
+    // Default tempo (120 BPM) before any MIDI clock arrives
+    Timebase::reset();
+    ASSERT_EQ(Timebase::getSamplesPerBeat(), Timebase::SAMPLE_RATE / 2);
+}
+
+TEST(Timebase_SyncToMIDIClock_BuiltRate) {
+    Timebase::reset();
+
+    // 100 BPM: 0.6s per beat
+    Timebase::syncToMIDIClock(tickPeriodQ8ForBpm(100));
+    ASSERT_EQ(Timebase::getSamplesPerBeat(), (Timebase::SAMPLE_RATE * 60) / 100);
+
+    // Outside MIN_BPM..MAX_BPM: ignored, previous tempo kept
+    Timebase::syncToMIDIClock(tickPeriodQ8ForBpm(400));
+    ASSERT_EQ(Timebase::getSamplesPerBeat(), (Timebase::SAMPLE_RATE * 60) / 100);
+    Timebase::syncToMIDIClock(tickPeriodQ8ForBpm(20));
+    ASSERT_EQ(Timebase::getSamplesPerBeat(), (Timebase::SAMPLE_RATE * 60) / 100);
+
+    Timebase::reset();
+}